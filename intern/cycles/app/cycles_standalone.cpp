@@ -20,7 +20,9 @@
 #include "render/camera.h"
 #include "device/device.h"
 #include "render/scene.h"
+#include "render/scene_binary.h"
 #include "render/session.h"
+#include "render/stats.h"
 #include "render/integrator.h"
 
 #include "util/util_args.h"
@@ -53,6 +55,8 @@ struct Options {
 	bool quiet;
 	bool show_help, interactive, pause;
 	string output_path;
+	string profile_path;
+	string scene_dump_path;
 } options;
 
 static void session_print(const string& str)
@@ -130,8 +134,24 @@ static void scene_init()
 {
 	options.scene = new Scene(options.scene_params, options.session->device);
 
-	/* Read XML */
-	xml_read_file(options.scene, options.filepath.c_str());
+	/* Read binary scene dump or XML */
+	bool is_binary = scene_is_binary(options.filepath);
+
+	if(is_binary) {
+		if(!scene_read_binary(options.scene, options.filepath)) {
+			fprintf(stderr, "Failed to read binary scene \"%s\".\n", options.filepath.c_str());
+			exit(EXIT_FAILURE);
+		}
+	}
+	else {
+		xml_read_file(options.scene, options.filepath.c_str());
+	}
+
+	if(options.scene_dump_path != "") {
+		if(!scene_write_binary(options.scene, options.scene_dump_path)) {
+			fprintf(stderr, "Failed to write binary scene \"%s\".\n", options.scene_dump_path.c_str());
+		}
+	}
 
 	/* Camera width/height override? */
 	if(!(options.width == 0 || options.height == 0)) {
@@ -143,8 +163,10 @@ static void scene_init()
 		options.height = options.scene->camera->height;
 	}
 
-	/* Calculate Viewplane */
-	options.scene->camera->compute_auto_viewplane();
+	/* Calculate Viewplane, binary scenes store the viewplane synced from Blender. */
+	if(!is_binary) {
+		options.scene->camera->compute_auto_viewplane();
+	}
 }
 
 static void session_init()
@@ -167,8 +189,28 @@ static void session_init()
 	options.session->start();
 }
 
+static void session_write_profile()
+{
+	RenderStats stats;
+	options.session->collect_statistics(&stats);
+
+	FILE *f = path_fopen(options.profile_path, "wb");
+	if(!f) {
+		fprintf(stderr, "Failed to write profiling statistics to %s\n", options.profile_path.c_str());
+		return;
+	}
+
+	string report = stats.json_report();
+	fwrite(report.data(), 1, report.size(), f);
+	fclose(f);
+}
+
 static void session_exit()
 {
+	if(options.session && options.profile_path != "") {
+		session_write_profile();
+	}
+
 	if(options.session) {
 		delete options.session;
 		options.session = NULL;
@@ -379,8 +421,9 @@ static void options_parse(int argc, const char **argv)
 	ArgParse ap;
 	bool help = false, debug = false, version = false;
 	int verbosity = 1;
+	float checkpoint_interval = (float)options.session_params.checkpoint_interval;
 
-	ap.options ("Usage: cycles [options] file.xml",
+	ap.options ("Usage: cycles [options] file.xml|file.cyb",
 		"%*", files_parse, "",
 		"--device %s", &devicename, ("Devices to use: " + device_names).c_str(),
 #ifdef WITH_OSL
@@ -390,7 +433,11 @@ static void options_parse(int argc, const char **argv)
 		"--quiet", &options.quiet, "In background mode, don't print progress messages",
 		"--samples %d", &options.session_params.samples, "Number of samples to render",
 		"--output %s", &options.output_path, "File path to write output image",
+		"--profile %s", &options.profile_path, "File path to write render statistics and CPU kernel profiling data as JSON",
 		"--threads %d", &options.session_params.threads, "CPU Rendering Threads",
+		"--checkpoint %s", &options.session_params.checkpoint_path, "File path to periodically save the render to, and resume it from when it exists",
+		"--checkpoint-interval %f", &checkpoint_interval, "Seconds between writing checkpoints",
+		"--write-scene %s", &options.scene_dump_path, "File path to write the loaded scene to as binary, for faster loading",
 		"--width  %d", &options.width, "Window width in pixel",
 		"--height %d", &options.height, "Window height in pixel",
 		"--tile-width %d", &options.session_params.tile_size.x, "Tile width in pixels",
@@ -446,9 +493,16 @@ static void options_parse(int argc, const char **argv)
 	options.session_params.background = true;
 #endif
 
+	/* Collect kernel profiling data for the JSON statistics. */
+	if(options.profile_path != "") {
+		options.session_params.use_profiling = true;
+	}
+
 	/* Use progressive rendering */
 	options.session_params.progressive = true;
 
+	options.session_params.checkpoint_interval = checkpoint_interval;
+
 	/* find matching device */
 	DeviceType device_type = Device::type_from_string(devicename.c_str());
 	vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
@@ -81,8 +81,8 @@ class CyclesRender(bpy.types.RenderEngine):
     def render(self, depsgraph):
         engine.render(self, depsgraph)
 
-    def bake(self, depsgraph, obj, pass_type, pass_filter, object_id, pixel_array, num_pixels, depth, result):
-        engine.bake(self, depsgraph, obj, pass_type, pass_filter, object_id, pixel_array, num_pixels, depth, result)
+    def bake_jobs(self, depsgraph, jobs):
+        engine.bake_jobs(self, depsgraph, jobs)
 
     # viewport render
     def view_update(self, context):
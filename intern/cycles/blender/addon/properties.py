@@ -542,6 +542,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Use BVH spatial splits: longer builder time, faster render",
         default=False,
     )
+    use_compact_attributes: BoolProperty(
+        name="Compact Attributes",
+        description="Store UV maps, normals and tangents with reduced precision, "
+                    "to save memory in scenes with many or large meshes",
+        default=False,
+    )
     debug_use_hair_bvh: BoolProperty(
         name="Use Hair BVH",
         description="Use special type BVH optimized for hair (uses more ram but renders faster)",
@@ -736,6 +742,14 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Artificial limit on OpenCL memory usage in MB (0 to disable limit)"
     )
 
+    debug_scene_dump_path: StringProperty(
+        name="Scene Dump",
+        description="Write the synced scene to this file as binary before rendering, "
+                    "for fast re-rendering with the standalone Cycles app",
+        subtype='FILE_PATH',
+        default="",
+    )
+
     @classmethod
     def register(cls):
         bpy.types.Scene.cycles = PointerProperty(
@@ -1349,6 +1363,11 @@ class CyclesRenderLayerSettings(bpy.types.PropertyGroup):
         description="When removing pixels that don't carry information, use a relative threshold instead of an absolute one (can help to reduce artifacts, but might cause detail loss around edges)",
         default=False,
     )
+    denoising_after_render: BoolProperty(
+        name="Denoise After Render",
+        description="Denoise the whole frame once all tiles are rendered, using all threads (keeps all tiles in memory until the end)",
+        default=False,
+    )
     denoising_store_passes: BoolProperty(
         name="Store denoising passes",
         description="Store the denoising feature passes and the noisy image",
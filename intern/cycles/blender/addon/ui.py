@@ -657,6 +657,10 @@ class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Pa
         sub.active = not cscene.debug_use_spatial_splits and not cscene.use_bvh_embree
         sub.prop(cscene, "debug_bvh_time_steps")
 
+        col.separator()
+
+        col.prop(cscene, "use_compact_attributes")
+
 
 class CYCLES_RENDER_PT_performance_final_render(CyclesButtonsPanel, Panel):
     bl_label = "Final Render"
@@ -937,6 +941,7 @@ class CYCLES_RENDER_PT_denoising(CyclesButtonsPanel, Panel):
         layout.prop(cycles_view_layer, "denoising_strength", slider=True, text="Strength")
         layout.prop(cycles_view_layer, "denoising_feature_strength", slider=True, text="Feature Strength")
         layout.prop(cycles_view_layer, "denoising_relative_pca")
+        layout.prop(cycles_view_layer, "denoising_after_render")
 
         layout.separator()
 
@@ -1898,6 +1903,11 @@ class CYCLES_RENDER_PT_debug(CyclesButtonsPanel, Panel):
         col = layout.column()
         col.prop(cscene, "debug_bvh_type")
 
+        col.separator()
+
+        col = layout.column()
+        col.prop(cscene, "debug_scene_dump_path")
+
 
 class CYCLES_RENDER_PT_simplify(CyclesButtonsPanel, Panel):
     bl_label = "Simplify"
@@ -27,6 +27,8 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_logging.h"
+#include "util/util_task.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -112,6 +114,55 @@ static void InterpolateKeySegments(int seg,
 		curveinterp_v3_v3v3v3v3(keyloc, &ckey_loc1, &ckey_loc2, &ckey_loc3, &ckey_loc4, t);
 }
 
+/* Hair keys of a range of particles, exported in parallel. Every particle
+ * gets a fixed number of key slots, keys at the same location as the previous
+ * key are skipped. */
+struct HairKeysExport {
+	void *psys;
+	int first_particle;
+	int steps;
+
+	float3 *keys;
+	float *times;
+	array<int> num_keys;
+	array<float> lengths;
+};
+
+static void hair_keys_export_range(HairKeysExport *hair, int start, int end)
+{
+	vector<float> co(hair->steps * 3);
+
+	for(int i = start; i < end; i++) {
+		int num_co = psys_hair_path_keys_get(hair->psys,
+		                                     hair->first_particle + i,
+		                                     hair->steps,
+		                                     (float (*)[3])&co[0]);
+
+		float3 *keys = hair->keys + (size_t)i*hair->steps;
+		float *times = hair->times + (size_t)i*hair->steps;
+		int keynum = 0;
+		float curve_length = 0.0f;
+		float3 pcKey = make_float3(0.0f, 0.0f, 0.0f);
+
+		for(int step_no = 0; step_no < num_co; step_no++) {
+			float3 cKey = make_float3(co[step_no*3 + 0], co[step_no*3 + 1], co[step_no*3 + 2]);
+			if(step_no > 0) {
+				float step_length = len(cKey - pcKey);
+				if(step_length == 0.0f)
+					continue;
+				curve_length += step_length;
+			}
+			keys[keynum] = cKey;
+			times[keynum] = curve_length;
+			pcKey = cKey;
+			keynum++;
+		}
+
+		hair->num_keys[i] = keynum;
+		hair->lengths[i] = curve_length;
+	}
+}
+
 static bool ObtainCacheParticleData(Mesh *mesh,
                                     BL::Mesh *b_mesh,
                                     BL::Object *b_ob,
@@ -124,9 +175,6 @@ static bool ObtainCacheParticleData(Mesh *mesh,
 	if(!(mesh && b_mesh && b_ob && CData))
 		return false;
 
-	Transform tfm = get_transform(b_ob->matrix_world());
-	Transform itfm = transform_quick_inverse(tfm);
-
 	BL::Object::modifiers_iterator b_mod;
 	for(b_ob->modifiers.begin(b_mod); b_mod != b_ob->modifiers.end(); ++b_mod) {
 		if((b_mod->type() == b_mod->type_PARTICLE_SYSTEM) && (background ? b_mod->show_render() : b_mod->show_viewport())) {
@@ -170,37 +218,56 @@ static bool ObtainCacheParticleData(Mesh *mesh,
 				CData->curve_firstkey.reserve(CData->curve_firstkey.size() + num_add);
 				CData->curve_keynum.reserve(CData->curve_keynum.size() + num_add);
 				CData->curve_length.reserve(CData->curve_length.size() + num_add);
-				CData->curvekey_co.reserve(CData->curvekey_co.size() + num_add*ren_step);
-				CData->curvekey_time.reserve(CData->curvekey_time.size() + num_add*ren_step);
 
-				for(; pa_no < totparts+totchild; pa_no++) {
-					int keynum = 0;
-					CData->curve_firstkey.push_back_slow(keyno);
-
-					float curve_length = 0.0f;
-					float3 pcKey;
-					for(int step_no = 0; step_no < ren_step; step_no++) {
-						float nco[3];
-						b_psys.co_hair(*b_ob, pa_no, step_no, nco);
-						float3 cKey = make_float3(nco[0], nco[1], nco[2]);
-						cKey = transform_point(&itfm, cKey);
-						if(step_no > 0) {
-							float step_length = len(cKey - pcKey);
-							if(step_length == 0.0f)
-								continue;
-							curve_length += step_length;
-						}
-						CData->curvekey_co.push_back_slow(cKey);
-						CData->curvekey_time.push_back_slow(curve_length);
-						pcKey = cKey;
-						keynum++;
+				/* Export keys of all particles in parallel into fixed size
+				 * slots, reading the path cache directly rather than through
+				 * RNA for every key. */
+				size_t first_key_slot = CData->curvekey_co.size();
+				HairKeysExport hair;
+				hair.psys = b_psys.ptr.data;
+				hair.first_particle = pa_no;
+				hair.steps = ren_step;
+				hair.keys = CData->curvekey_co.resize(first_key_slot + num_add*ren_step) + first_key_slot;
+				hair.times = CData->curvekey_time.resize(first_key_slot + num_add*ren_step) + first_key_slot;
+				hair.num_keys.resize(num_add);
+				hair.lengths.resize(num_add);
+
+				const int chunk_size = 1024;
+				TaskPool pool;
+				for(int start = 0; start < num_add; start += chunk_size) {
+					pool.push(function_bind(&hair_keys_export_range,
+					                        &hair,
+					                        start,
+					                        min(start + chunk_size, num_add)),
+					          false);
+				}
+				pool.wait_work();
+
+				/* Compact the slots in place. */
+				float3 *curvekey_co = CData->curvekey_co.data();
+				float *curvekey_time = CData->curvekey_time.data();
+				size_t key_index = first_key_slot;
+
+				for(int i = 0; i < num_add; i++) {
+					int keynum = hair.num_keys[i];
+					size_t slot = first_key_slot + (size_t)i*ren_step;
+
+					CData->curve_firstkey.push_back_reserved(keyno);
+
+					if(key_index != slot) {
+						memmove(curvekey_co + key_index, curvekey_co + slot, sizeof(float3)*keynum);
+						memmove(curvekey_time + key_index, curvekey_time + slot, sizeof(float)*keynum);
 					}
+					key_index += keynum;
 					keyno += keynum;
 
-					CData->curve_keynum.push_back_slow(keynum);
-					CData->curve_length.push_back_slow(curve_length);
+					CData->curve_keynum.push_back_reserved(keynum);
+					CData->curve_length.push_back_reserved(hair.lengths[i]);
 					curvenum++;
 				}
+
+				CData->curvekey_co.resize(key_index);
+				CData->curvekey_time.resize(key_index);
 			}
 		}
 	}
@@ -545,6 +612,54 @@ static void ExportCurveTriangleGeometry(Mesh *mesh,
 	/* texture coords still needed */
 }
 
+/* Curve segments to export, with offsets into the mesh curve arrays so that
+ * they can be filled in parallel. */
+struct CurveSegmentsExport {
+	Mesh *mesh;
+	ParticleCurveData *CData;
+	float *intercept;
+	float *random;
+
+	array<int> sys;
+	array<int> curve;
+	array<int> first_key;
+};
+
+static void curve_segments_export_range(CurveSegmentsExport *data, int start, int end)
+{
+	Mesh *mesh = data->mesh;
+	ParticleCurveData *CData = data->CData;
+
+	for(int i = start; i < end; i++) {
+		const int sys = data->sys[i];
+		const int curve = data->curve[i];
+		int key = data->first_key[i];
+
+		for(int curvekey = CData->curve_firstkey[curve]; curvekey < CData->curve_firstkey[curve] + CData->curve_keynum[curve]; curvekey++) {
+			float3 ickey_loc = CData->curvekey_co[curvekey];
+			float time = CData->curvekey_time[curvekey]/CData->curve_length[curve];
+			float radius = shaperadius(CData->psys_shape[sys], CData->psys_rootradius[sys], CData->psys_tipradius[sys], time);
+
+			if(CData->psys_closetip[sys] && (curvekey == CData->curve_firstkey[curve] + CData->curve_keynum[curve] - 1))
+				radius = 0.0f;
+
+			mesh->curve_keys[key] = ickey_loc;
+			mesh->curve_radius[key] = radius;
+			if(data->intercept)
+				data->intercept[key] = time;
+
+			key++;
+		}
+
+		if(data->random) {
+			data->random[i] = hash_int_01(i);
+		}
+
+		mesh->curve_first_key[i] = data->first_key[i];
+		mesh->curve_shader[i] = CData->psys_shader[sys];
+	}
+}
+
 static void ExportCurveSegments(Scene *scene, Mesh *mesh, ParticleCurveData *CData)
 {
 	int num_keys = 0;
@@ -561,12 +676,20 @@ static void ExportCurveSegments(Scene *scene, Mesh *mesh, ParticleCurveData *CDa
 	if(mesh->need_attribute(scene, ATTR_STD_CURVE_RANDOM))
 		attr_random = mesh->curve_attributes.add(ATTR_STD_CURVE_RANDOM);
 
-	/* compute and reserve size of arrays */
+	/* compute size of arrays and offset of every curve */
+	CurveSegmentsExport data;
+	data.mesh = mesh;
+	data.CData = CData;
+
 	for(int sys = 0; sys < CData->psys_firstcurve.size(); sys++) {
 		for(int curve = CData->psys_firstcurve[sys]; curve < CData->psys_firstcurve[sys] + CData->psys_curvenum[sys]; curve++) {
 			if(CData->curve_keynum[curve] <= 1 || CData->curve_length[curve] == 0.0f)
 				continue;
 
+			data.sys.push_back_slow(sys);
+			data.curve.push_back_slow(curve);
+			data.first_key.push_back_slow(num_keys);
+
 			num_keys += CData->curve_keynum[curve];
 			num_curves++;
 		}
@@ -576,43 +699,22 @@ static void ExportCurveSegments(Scene *scene, Mesh *mesh, ParticleCurveData *CDa
 		VLOG(1) << "Exporting curve segments for mesh " << mesh->name;
 	}
 
-	mesh->reserve_curves(mesh->num_curves() + num_curves, mesh->curve_keys.size() + num_keys);
+	mesh->resize_curves(num_curves, num_keys);
 
-	num_keys = 0;
-	num_curves = 0;
+	data.intercept = (attr_intercept)? attr_intercept->data_float(): NULL;
+	data.random = (attr_random)? attr_random->data_float(): NULL;
 
 	/* actually export */
-	for(int sys = 0; sys < CData->psys_firstcurve.size(); sys++) {
-		for(int curve = CData->psys_firstcurve[sys]; curve < CData->psys_firstcurve[sys] + CData->psys_curvenum[sys]; curve++) {
-			if(CData->curve_keynum[curve] <= 1 || CData->curve_length[curve] == 0.0f)
-				continue;
-
-			size_t num_curve_keys = 0;
-
-			for(int curvekey = CData->curve_firstkey[curve]; curvekey < CData->curve_firstkey[curve] + CData->curve_keynum[curve]; curvekey++) {
-				float3 ickey_loc = CData->curvekey_co[curvekey];
-				float time = CData->curvekey_time[curvekey]/CData->curve_length[curve];
-				float radius = shaperadius(CData->psys_shape[sys], CData->psys_rootradius[sys], CData->psys_tipradius[sys], time);
-
-				if(CData->psys_closetip[sys] && (curvekey == CData->curve_firstkey[curve] + CData->curve_keynum[curve] - 1))
-					radius = 0.0f;
-
-				mesh->add_curve_key(ickey_loc, radius);
-				if(attr_intercept)
-					attr_intercept->add(time);
-
-				num_curve_keys++;
-			}
-
-			if(attr_random != NULL) {
-				attr_random->add(hash_int_01(num_curves));
-			}
-
-			mesh->add_curve(num_keys, CData->psys_shader[sys]);
-			num_keys += num_curve_keys;
-			num_curves++;
-		}
+	const int chunk_size = 4096;
+	TaskPool pool;
+	for(int start = 0; start < num_curves; start += chunk_size) {
+		pool.push(function_bind(&curve_segments_export_range,
+		                        &data,
+		                        start,
+		                        min(start + chunk_size, num_curves)),
+		          false);
 	}
+	pool.wait_work();
 
 	/* check allocation */
 	if((mesh->curve_keys.size() != num_keys) || (mesh->num_curves() != num_curves)) {
@@ -960,6 +1062,8 @@ void BlenderSync::sync_curves(Mesh *mesh,
 
 	ParticleCurveData CData;
 
+	scoped_timer timer;
+
 	ObtainCacheParticleData(mesh, &b_mesh, &b_ob, &CData, !preview);
 
 	/* add hair geometry to mesh */
@@ -1104,6 +1208,21 @@ void BlenderSync::sync_curves(Mesh *mesh,
 	}
 
 	mesh->compute_bounds();
+
+	if(!motion && mesh->num_curves()) {
+		size_t mem_used = mesh->curve_keys.size() * sizeof(float3) +
+		                  mesh->curve_radius.size() * sizeof(float) +
+		                  mesh->curve_first_key.size() * sizeof(int) +
+		                  mesh->curve_shader.size() * sizeof(int);
+		foreach(const Attribute& attr, mesh->curve_attributes.attributes) {
+			mem_used += attr.buffer.size();
+		}
+
+		VLOG(1) << "Synced " << mesh->num_curves() << " curves with "
+		        << mesh->curve_keys.size() << " keys for mesh " << mesh->name
+		        << " in " << timer.get_time() << " seconds, "
+		        << string_human_readable_size(mem_used) << " used.";
+	}
 }
 
 CCL_NAMESPACE_END
@@ -284,15 +284,12 @@ static PyObject *render_func(PyObject * /*self*/, PyObject *args)
 	Py_RETURN_NONE;
 }
 
-/* pixel_array and result passed as pointers */
+/* first job of the list passed as pointer */
 static PyObject *bake_func(PyObject * /*self*/, PyObject *args)
 {
-	PyObject *pysession, *pydepsgraph, *pyobject;
-	PyObject *pypixel_array, *pyresult;
-	const char *pass_type;
-	int num_pixels, depth, object_id, pass_filter;
+	PyObject *pysession, *pydepsgraph, *pyjobs;
 
-	if(!PyArg_ParseTuple(args, "OOOsiiOiiO", &pysession, &pydepsgraph, &pyobject, &pass_type, &pass_filter, &object_id, &pypixel_array, &num_pixels, &depth, &pyresult))
+	if(!PyArg_ParseTuple(args, "OOO", &pysession, &pydepsgraph, &pyjobs))
 		return NULL;
 
 	BlenderSession *session = (BlenderSession*)PyLong_AsVoidPtr(pysession);
@@ -301,19 +298,13 @@ static PyObject *bake_func(PyObject * /*self*/, PyObject *args)
 	RNA_pointer_create(NULL, &RNA_Depsgraph, PyLong_AsVoidPtr(pydepsgraph), &depsgraphptr);
 	BL::Depsgraph b_depsgraph(depsgraphptr);
 
-	PointerRNA objectptr;
-	RNA_id_pointer_create((ID*)PyLong_AsVoidPtr(pyobject), &objectptr);
-	BL::Object b_object(objectptr);
-
-	void *b_result = PyLong_AsVoidPtr(pyresult);
-
-	PointerRNA bakepixelptr;
-	RNA_pointer_create(NULL, &RNA_BakePixel, PyLong_AsVoidPtr(pypixel_array), &bakepixelptr);
-	BL::BakePixel b_bake_pixel(bakepixelptr);
+	PointerRNA bakejobptr;
+	RNA_pointer_create(NULL, &RNA_BakeJob, PyLong_AsVoidPtr(pyjobs), &bakejobptr);
+	BL::BakeJob b_bake_jobs(bakejobptr);
 
 	python_thread_state_save(&session->python_thread_state);
 
-	session->bake(b_depsgraph, b_object, pass_type, pass_filter, object_id, b_bake_pixel, (size_t)num_pixels, depth, (float *)b_result);
+	session->bake(b_depsgraph, b_bake_jobs);
 
 	python_thread_state_restore(&session->python_thread_state);
 
@@ -26,6 +26,7 @@
 #include "render/mesh.h"
 #include "render/object.h"
 #include "render/scene.h"
+#include "render/scene_binary.h"
 #include "render/session.h"
 #include "render/shader.h"
 #include "render/stats.h"
@@ -448,6 +449,7 @@ void BlenderSession::render(BL::Depsgraph& b_depsgraph_)
 	bool run_denoising = full_denoising || write_denoising_passes;
 
 	session->tile_manager.schedule_denoising = run_denoising;
+	session->tile_manager.denoise_after_render = get_boolean(crl, "denoising_after_render");
 	buffer_params.denoising_data_pass = run_denoising;
 	buffer_params.denoising_clean_pass = (scene->film->denoising_flags & DENOISING_CLEAN_ALL_PASSES);
 	buffer_params.denoising_prefiltered_pass = write_denoising_passes;
@@ -498,6 +500,21 @@ void BlenderSession::render(BL::Depsgraph& b_depsgraph_)
 		                &python_thread_state);
 		builtin_images_load();
 
+		/* Write the synced scene for re-rendering with the standalone app. This
+		 * must happen before device update, which applies object transforms to
+		 * meshes. */
+		if(view_index == 0) {
+			PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+			string dump_path = get_string(cscene, "debug_scene_dump_path");
+
+			if(!dump_path.empty()) {
+				dump_path = blender_absolute_path(b_data, b_scene, dump_path);
+				if(!scene_write_binary(scene, dump_path)) {
+					fprintf(stderr, "Cycles: failed to write scene dump to %s\n", dump_path.c_str());
+				}
+			}
+		}
+
 		/* Attempt to free all data which is held by Blender side, since at this
 		 * point we knwo that we've got everything to render current view layer.
 		 */
@@ -632,19 +649,10 @@ static int bake_pass_filter_get(const int pass_filter)
 }
 
 void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
-                          BL::Object& b_object,
-                          const string& pass_type,
-                          const int pass_filter,
-                          const int object_id,
-                          BL::BakePixel& pixel_array,
-                          const size_t num_pixels,
-                          const int /*depth*/,
-                          float result[])
+                          BL::BakeJob& b_jobs)
 {
 	b_depsgraph = b_depsgraph_;
 
-	ShaderEvalType shader_type = get_shader_type(pass_type);
-
 	/* Set baking flag in advance, so kernel loading can check if we need
 	 * any baking capabilities.
 	 */
@@ -653,17 +661,22 @@ void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
 	/* ensure kernels are loaded before we do any scene updates */
 	session->load_kernels();
 
-	if(shader_type == SHADER_EVAL_UV) {
-		/* force UV to be available */
-		Pass::add(PASS_UV, scene->film->passes);
-	}
+	/* passes needed by any of the jobs */
+	for(BL::BakeJob b_job = b_jobs; b_job.ptr.data; b_job = b_job.next()) {
+		ShaderEvalType shader_type = get_shader_type(get_enum_identifier(b_job.ptr, "pass_type"));
+
+		if(shader_type == SHADER_EVAL_UV) {
+			/* force UV to be available */
+			Pass::add(PASS_UV, scene->film->passes);
+		}
 
-	int bake_pass_filter = bake_pass_filter_get(pass_filter);
-	bake_pass_filter = BakeManager::shader_type_to_pass_filter(shader_type, bake_pass_filter);
+		int bake_pass_filter = bake_pass_filter_get(b_job.pass_filter());
+		bake_pass_filter = BakeManager::shader_type_to_pass_filter(shader_type, bake_pass_filter);
 
-	/* force use_light_pass to be true if we bake more than just colors */
-	if(bake_pass_filter & ~BAKE_FILTER_COLOR) {
-		Pass::add(PASS_LIGHT, scene->film->passes);
+		/* force use_light_pass to be true if we bake more than just colors */
+		if(bake_pass_filter & ~BAKE_FILTER_COLOR) {
+			Pass::add(PASS_LIGHT, scene->film->passes);
+		}
 	}
 
 	/* create device and update scene */
@@ -683,7 +696,7 @@ void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
 		builtin_images_load();
 	}
 
-	BakeData *bake_data = NULL;
+	vector<BakeJob> bake_jobs;
 
 	if(!session->progress.get_cancel()) {
 		/* get buffer parameters */
@@ -697,25 +710,39 @@ void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
 		session->reset(buffer_params, session_params.samples);
 		session->update_scene();
 
-		/* find object index. todo: is arbitrary - copied from mesh_displace.cpp */
-		size_t object_index = OBJECT_NONE;
-		int tri_offset = 0;
+		for(BL::BakeJob b_job = b_jobs; b_job.ptr.data; b_job = b_job.next()) {
+			BL::Object b_object = b_job.object();
 
-		for(size_t i = 0; i < scene->objects.size(); i++) {
-			if(strcmp(scene->objects[i]->name.c_str(), b_object.name().c_str()) == 0) {
-				object_index = i;
-				tri_offset = scene->objects[i]->mesh->tri_offset;
-				break;
+			/* find object index. todo: is arbitrary - copied from mesh_displace.cpp */
+			size_t object_index = OBJECT_NONE;
+			int tri_offset = 0;
+
+			for(size_t i = 0; i < scene->objects.size(); i++) {
+				if(strcmp(scene->objects[i]->name.c_str(), b_object.name().c_str()) == 0) {
+					object_index = i;
+					tri_offset = scene->objects[i]->mesh->tri_offset;
+					break;
+				}
 			}
-		}
 
-		/* Object might have been disabled for rendering or excluded in some
-		 * other way, in that case Blender will report a warning afterwards. */
-		if (object_index != OBJECT_NONE) {
-			int object = object_index;
+			/* Object might have been disabled for rendering or excluded in some
+			 * other way, in that case Blender will report a warning afterwards. */
+			if(object_index == OBJECT_NONE) {
+				continue;
+			}
 
-			bake_data = scene->bake_manager->init(object, tri_offset, num_pixels);
-			populate_bake_data(bake_data, object_id, pixel_array, num_pixels);
+			ShaderEvalType shader_type = get_shader_type(get_enum_identifier(b_job.ptr, "pass_type"));
+			int bake_pass_filter = bake_pass_filter_get(b_job.pass_filter());
+
+			BakeJob job;
+			job.object = object_index;
+			job.tri_offset = tri_offset;
+			job.num_pixels = b_job.num_pixels();
+			job.shader_type = shader_type;
+			job.pass_filter = BakeManager::shader_type_to_pass_filter(shader_type, bake_pass_filter);
+			job.populate = function_bind(&populate_bake_data, _1, b_job.object_id(), b_job.pixel_array(), b_job.num_pixels());
+			job.result = (float*)b_job.result().ptr.data;
+			bake_jobs.push_back(job);
 		}
 
 		/* set number of samples */
@@ -727,10 +754,12 @@ void BlenderSession::bake(BL::Depsgraph& b_depsgraph_,
 	}
 
 	/* Perform bake. Check cancel to avoid crash with incomplete scene data. */
-	if(!session->progress.get_cancel() && bake_data) {
-		scene->bake_manager->bake(scene->device, &scene->dscene, scene, session->progress, shader_type, bake_pass_filter, bake_data, result);
+	if(!session->progress.get_cancel() && !bake_jobs.empty()) {
+		scene->bake_manager->bake(scene->device, &scene->dscene, scene, session->progress, bake_jobs);
 	}
 
+	scene->bake_manager->set_baking(false);
+
 	/* free all memory used (host and device), so we wouldn't leave render
 	 * engine with extra memory allocated
 	 */
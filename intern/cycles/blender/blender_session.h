@@ -60,15 +60,9 @@ public:
 	/* offline render */
 	void render(BL::Depsgraph& b_depsgraph);
 
+	/* bake the list of jobs starting at b_jobs, syncing the scene once */
 	void bake(BL::Depsgraph& b_depsgrah,
-	          BL::Object& b_object,
-	          const string& pass_type,
-	          const int custom_flag,
-	          const int object_id,
-	          BL::BakePixel& pixel_array,
-	          const size_t num_pixels,
-	          const int depth,
-	          float pixels[]);
+	          BL::BakeJob& b_jobs);
 
 	void write_render_result(BL::RenderResult& b_rr,
 	                         BL::RenderLayer& b_rlay,
@@ -691,6 +691,8 @@ SceneParams BlenderSync::get_scene_params(BL::Scene& b_scene,
 		params.texture_limit = 0;
 	}
 
+	params.use_compact_attributes = RNA_boolean_get(&cscene, "use_compact_attributes");
+
 	/* TODO(sergey): Once OSL supports per-microarchitecture optimization get
 	 * rid of this.
 	 */
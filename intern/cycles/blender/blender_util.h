@@ -37,6 +37,7 @@ void BKE_image_user_frame_calc(void *iuser, int cfra);
 void BKE_image_user_file_path(void *iuser, void *ima, char *path);
 unsigned char *BKE_image_get_pixels_for_frame(void *image, int frame);
 float *BKE_image_get_float_pixels_for_frame(void *image, int frame);
+int psys_hair_path_keys_get(const void *psys, int particle_no, int max_keys, float (*r_co)[3]);
 }
 
 CCL_NAMESPACE_BEGIN
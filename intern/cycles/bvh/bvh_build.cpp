@@ -989,11 +989,12 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range,
 				if(need_prim_time) {
 					local_prim_time[index] = p_time[i][j];
 				}
-				if(params.use_unaligned_nodes && !alignment_found) {
-					alignment_found =
-						unaligned_heuristic.compute_aligned_space(p_ref[i][j],
-						                                          &aligned_space);
-				}
+			}
+			if(params.use_unaligned_nodes) {
+				alignment_found =
+					unaligned_heuristic.compute_average_aligned_space(&p_ref[i][0],
+					                                                  num,
+					                                                  &aligned_space);
 			}
 			LeafNode *leaf_node = new LeafNode(bounds[i],
 			                                   visibility[i],
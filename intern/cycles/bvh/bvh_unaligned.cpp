@@ -37,34 +37,22 @@ Transform BVHUnaligned::compute_aligned_space(
         const BVHObjectBinning& range,
         const BVHReference *references) const
 {
-	for(int i = range.start(); i < range.end(); ++i) {
-		const BVHReference& ref = references[i];
-		Transform aligned_space;
-		/* Use first primitive which defines correct direction to define
-		 * the orientation space.
-		 */
-		if(compute_aligned_space(ref, &aligned_space)) {
-			return aligned_space;
-		}
-	}
-	return transform_identity();
+	Transform aligned_space;
+	compute_average_aligned_space(references + range.start(),
+	                              range.size(),
+	                              &aligned_space);
+	return aligned_space;
 }
 
 Transform BVHUnaligned::compute_aligned_space(
         const BVHRange& range,
         const BVHReference *references) const
 {
-	for(int i = range.start(); i < range.end(); ++i) {
-		const BVHReference& ref = references[i];
-		Transform aligned_space;
-		/* Use first primitive which defines correct direction to define
-		 * the orientation space.
-		 */
-		if(compute_aligned_space(ref, &aligned_space)) {
-			return aligned_space;
-		}
-	}
-	return transform_identity();
+	Transform aligned_space;
+	compute_average_aligned_space(references + range.start(),
+	                              range.size(),
+	                              &aligned_space);
+	return aligned_space;
 }
 
 bool BVHUnaligned::compute_aligned_space(const BVHReference& ref,
@@ -92,6 +80,68 @@ bool BVHUnaligned::compute_aligned_space(const BVHReference& ref,
 	return false;
 }
 
+bool BVHUnaligned::segment_direction(const BVHReference& ref,
+                                     float3 *direction) const
+{
+	const Object *object = objects_[ref.prim_object()];
+	const int packed_type = ref.prim_type();
+	const int type = (packed_type & PRIMITIVE_ALL);
+	if(type & PRIMITIVE_CURVE) {
+		const int curve_index = ref.prim_index();
+		const int segment = PRIMITIVE_UNPACK_SEGMENT(packed_type);
+		const Mesh *mesh = object->mesh;
+		const Mesh::Curve& curve = mesh->get_curve(curve_index);
+		const int key = curve.first_key + segment;
+		*direction = mesh->curve_keys[key + 1] - mesh->curve_keys[key];
+		return true;
+	}
+	return false;
+}
+
+bool BVHUnaligned::compute_average_aligned_space(const BVHReference *references,
+                                                 int num,
+                                                 Transform *aligned_space) const
+{
+	/* Thin curves in a cluster are rarely perfectly parallel, so instead of
+	 * using the direction of a single segment, average the directions of the
+	 * segments, flipped into the same hemisphere and weighted by length. For
+	 * large ranges only a fixed number of evenly spaced segments is used to
+	 * keep the cost per node bounded.
+	 */
+	const int max_samples = 64;
+	const int step = max(num / max_samples, 1);
+	float3 sum = make_float3(0.0f, 0.0f, 0.0f);
+
+	for(int i = 0; i < num; i += step) {
+		float3 direction;
+		if(!segment_direction(references[i], &direction)) {
+			continue;
+		}
+		if(dot(sum, direction) < 0.0f) {
+			direction = -direction;
+		}
+		sum += direction;
+	}
+
+	float length;
+	const float3 axis = normalize_len(sum, &length);
+	if(length > 1e-6f) {
+		*aligned_space = make_transform_frame(axis);
+		return true;
+	}
+
+	/* Directions cancelled out or were too short, fall back to the first
+	 * primitive which defines a correct direction. */
+	for(int i = 0; i < num; ++i) {
+		if(compute_aligned_space(references[i], aligned_space)) {
+			return true;
+		}
+	}
+
+	*aligned_space = transform_identity();
+	return false;
+}
+
 BoundBox BVHUnaligned::compute_aligned_prim_boundbox(
         const BVHReference& prim,
         const Transform& aligned_space) const
@@ -48,6 +48,15 @@ public:
 	bool compute_aligned_space(const BVHReference& ref,
 	                           Transform *aligned_space) const;
 
+	/* Calculate alignment from the average direction of the curve segments
+	 * in the given references.
+	 *
+	 * Return true when space was calculated successfully.
+	 */
+	bool compute_average_aligned_space(const BVHReference *references,
+	                                   int num,
+	                                   Transform *aligned_space) const;
+
 	/* Calculate primitive's bounding box in given space. */
 	BoundBox compute_aligned_prim_boundbox(
 	        const BVHReference& prim,
@@ -71,6 +80,10 @@ public:
 	static Transform compute_node_transform(const BoundBox& bounds,
 	                                        const Transform& aligned_space);
 protected:
+	/* Get direction of a curve segment, scaled by its length. Returns false
+	 * for primitives which are not curve segments. */
+	bool segment_direction(const BVHReference& ref, float3 *direction) const;
+
 	/* List of objects BVH is being created for. */
 	const vector<Object*>& objects_;
 };
@@ -550,6 +550,7 @@ DeviceInfo Device::get_multi_device(const vector<DeviceInfo>& subdevices, int th
 	info.num = 0;
 
 	info.has_half_images = true;
+	info.has_sparse_images = true;
 	info.has_volume_decoupled = true;
 	info.has_osl = true;
 	info.has_profiling = true;
@@ -585,6 +586,7 @@ DeviceInfo Device::get_multi_device(const vector<DeviceInfo>& subdevices, int th
 
 		/* Accumulate device info. */
 		info.has_half_images &= device.has_half_images;
+		info.has_sparse_images &= device.has_sparse_images;
 		info.has_volume_decoupled &= device.has_volume_decoupled;
 		info.has_osl &= device.has_osl;
 		info.has_profiling &= device.has_profiling;
@@ -422,6 +422,7 @@ public:
 
 			TextureInfo& info = texture_info[flat_slot];
 			info.data = (uint64_t)mem.host_pointer;
+			info.grid_info = 0;
 			info.cl_buffer = 0;
 			info.interpolation = mem.interpolation;
 			info.extension = mem.extension;
@@ -429,6 +430,12 @@ public:
 			info.height = mem.data_height;
 			info.depth = mem.data_depth;
 
+			if(mem.grid_info_offset) {
+				/* Sparse 3D texture, tile index table follows the voxels. */
+				info.grid_info = (uint64_t)((char*)mem.host_pointer +
+				                            mem.memory_elements_size(mem.grid_info_offset));
+			}
+
 			need_texture_info = true;
 		}
 
@@ -476,6 +483,149 @@ public:
 		}
 	};
 
+	/* Runs func over bands of rows in parallel. All denoising kernels that are
+	 * split this way only write to the rows of their band, so the result does
+	 * not depend on the number of threads. */
+	void denoising_parallel_rows(int y0, int y1, const function<void(int, int)>& func)
+	{
+		const int num_threads = max(TaskScheduler::num_threads(), 1);
+		const int h = y1 - y0;
+		if(num_threads == 1 || h < 8) {
+			func(y0, y1);
+			return;
+		}
+
+		const int band_h = max(divide_up(h, num_threads * 4), 4);
+		TaskPool pool;
+		for(int y = y0; y < y1; y += band_h) {
+			pool.push(function_bind(func, y, min(y + band_h, y1)), false);
+		}
+		pool.wait_work();
+	}
+
+	/* Computes the weights of a single NLM shift. The weights end up in
+	 * blurDifference, difference is only used as temporary memory. */
+	void denoising_nlm_shift_weights(int dx, int dy,
+	                                 float *guide,
+	                                 float *variance,
+	                                 float *scale,
+	                                 float *difference,
+	                                 float *blurDifference,
+	                                 int *local_rect,
+	                                 int stride,
+	                                 int channel_offset,
+	                                 int frame_offset,
+	                                 float a,
+	                                 float k_2,
+	                                 int f)
+	{
+		filter_nlm_calc_difference_kernel()(dx, dy,
+		                                    guide,
+		                                    variance,
+		                                    scale,
+		                                    difference,
+		                                    local_rect,
+		                                    stride, channel_offset,
+		                                    frame_offset, a, k_2);
+
+		filter_nlm_blur_kernel()       (difference, blurDifference, local_rect, stride, f);
+		filter_nlm_calc_weight_kernel()(blurDifference, difference, local_rect, stride, f);
+		filter_nlm_blur_kernel()       (difference, blurDifference, local_rect, stride, f);
+	}
+
+	/* Number of shifts whose weights are computed in parallel, limited by
+	 * the temporary memory that was allocated for the task. */
+	int denoising_shift_batch(int num_shifts, DenoisingTask *task)
+	{
+		return clamp(task->buffer.cpu_shift_batch, 1, num_shifts);
+	}
+
+	/* Computes the weights of a batch of shifts in parallel. Shift j of the batch
+	 * uses layers 2j and 2j+1 of the temporary memory. */
+	void denoising_nlm_batch_weights(int first_shift, int num, int r,
+	                                 float *guide,
+	                                 float *variance,
+	                                 float *scale,
+	                                 float *temporary_mem,
+	                                 int w, int h,
+	                                 int stride,
+	                                 int channel_offset,
+	                                 int frame_offset,
+	                                 float a,
+	                                 float k_2,
+	                                 int f,
+	                                 int pass_stride,
+	                                 int4 *local_rects)
+	{
+		TaskPool pool;
+		for(int j = 0; j < num; j++) {
+			int i = first_shift + j;
+			int dy = i / (2*r+1) - r;
+			int dx = i % (2*r+1) - r;
+
+			local_rects[j] = make_int4(max(0, -dx), max(0, -dy), w - max(0, dx), h - max(0, dy));
+
+			float *difference     = temporary_mem + (2*j + 0)*pass_stride;
+			float *blurDifference = temporary_mem + (2*j + 1)*pass_stride;
+
+			if(num == 1) {
+				denoising_nlm_shift_weights(dx, dy, guide, variance, scale,
+				                            difference, blurDifference, &local_rects[j].x,
+				                            stride, channel_offset, frame_offset, a, k_2, f);
+			}
+			else {
+				pool.push(function_bind(&CPUDevice::denoising_nlm_shift_weights, this,
+				                        dx, dy, guide, variance, scale,
+				                        difference, blurDifference, &local_rects[j].x,
+				                        stride, channel_offset, frame_offset, a, k_2, f), false);
+			}
+		}
+		pool.wait_work();
+	}
+
+	void denoising_nlm_update_rows(int y0, int y1,
+	                               int first_shift, int num, int r,
+	                               int4 *local_rects,
+	                               float *image,
+	                               float *temporary_mem,
+	                               float *out,
+	                               float *weightAccum,
+	                               int channel_offset,
+	                               int stride,
+	                               int f,
+	                               int pass_stride)
+	{
+		/* Shifts are processed in order, so the accumulation matches sequential filtering. */
+		for(int j = 0; j < num; j++) {
+			int i = first_shift + j;
+			int dy = i / (2*r+1) - r;
+			int dx = i % (2*r+1) - r;
+
+			int4 band = local_rects[j];
+			band.y = max(band.y, y0);
+			band.w = min(band.w, y1);
+			if(band.y >= band.w) {
+				continue;
+			}
+
+			filter_nlm_update_output_kernel()(dx, dy,
+			                                  temporary_mem + (2*j + 1)*pass_stride,
+			                                  image,
+			                                  temporary_mem + (2*j + 0)*pass_stride,
+			                                  out,
+			                                  weightAccum,
+			                                  &band.x,
+			                                  channel_offset,
+			                                  stride, f);
+		}
+	}
+
+	void denoising_nlm_normalize_rows(int y0, int y1, float *out, float *weightAccum, int w, int width)
+	{
+		int local_rect[4] = {0, y0, width, y1};
+		filter_nlm_normalize_kernel()(out, weightAccum, local_rect, w);
+	}
+
 	bool denoising_non_local_means(device_ptr image_ptr, device_ptr guide_ptr, device_ptr variance_ptr, device_ptr out_ptr,
 	                               DenoisingTask *task)
 	{
@@ -490,56 +640,56 @@ public:
 		int w = align_up(rect.z-rect.x, 4);
 		int h = rect.w-rect.y;
 		int stride = task->buffer.stride;
-		int channel_offset = task->nlm_state.is_color? task->buffer.pass_stride : 0;
+		int pass_stride = task->buffer.pass_stride;
+		int channel_offset = task->nlm_state.is_color? pass_stride : 0;
+
+		int num_shifts = (2*r+1)*(2*r+1);
+		int batch = denoising_shift_batch(num_shifts, task);
 
 		float *temporary_mem = (float*) task->buffer.temporary_mem.device_pointer;
-		float *blurDifference = temporary_mem;
-		float *difference     = temporary_mem + task->buffer.pass_stride;
-		float *weightAccum    = temporary_mem + 2*task->buffer.pass_stride;
+		float *weightAccum   = temporary_mem + 2*batch*pass_stride;
 
 		memset(weightAccum, 0, sizeof(float)*w*h);
 		memset((float*) out_ptr, 0, sizeof(float)*w*h);
 
-		for(int i = 0; i < (2*r+1)*(2*r+1); i++) {
-			int dy = i / (2*r+1) - r;
-			int dx = i % (2*r+1) - r;
-
-			int local_rect[4] = {max(0, -dx), max(0, -dy), rect.z-rect.x - max(0, dx), rect.w-rect.y - max(0, dy)};
-			filter_nlm_calc_difference_kernel()(dx, dy,
-			                                    (float*) guide_ptr,
-			                                    (float*) variance_ptr,
-			                                    NULL,
-			                                    difference,
-			                                    local_rect,
-			                                    w, channel_offset,
-			                                    0, a, k_2);
-
-			filter_nlm_blur_kernel()       (difference, blurDifference, local_rect, w, f);
-			filter_nlm_calc_weight_kernel()(blurDifference, difference, local_rect, w, f);
-			filter_nlm_blur_kernel()       (difference, blurDifference, local_rect, w, f);
-
-			filter_nlm_update_output_kernel()(dx, dy,
-			                                  blurDifference,
-			                                  (float*) image_ptr,
-			                                  difference,
-			                                  (float*) out_ptr,
-			                                  weightAccum,
-			                                  local_rect,
-			                                  channel_offset,
-			                                  stride, f);
+		/* The weights of a batch of shifts are computed in parallel, after which
+		 * they are accumulated into the output in parallel over bands of rows. */
+		vector<int4> local_rects(batch);
+		for(int i = 0; i < num_shifts; i += batch) {
+			int num = min(batch, num_shifts - i);
+
+			denoising_nlm_batch_weights(i, num, r,
+			                            (float*) guide_ptr,
+			                            (float*) variance_ptr,
+			                            NULL,
+			                            temporary_mem,
+			                            rect.z-rect.x, h,
+			                            w, channel_offset, 0,
+			                            a, k_2, f,
+			                            pass_stride,
+			                            &local_rects[0]);
+
+			denoising_parallel_rows(0, h, function_bind(&CPUDevice::denoising_nlm_update_rows, this,
+			                                            _1, _2, i, num, r,
+			                                            &local_rects[0],
+			                                            (float*) image_ptr,
+			                                            temporary_mem,
+			                                            (float*) out_ptr,
+			                                            weightAccum,
+			                                            channel_offset,
+			                                            stride, f,
+			                                            pass_stride));
 		}
 
-		int local_rect[4] = {0, 0, rect.z-rect.x, rect.w-rect.y};
-		filter_nlm_normalize_kernel()((float*) out_ptr, weightAccum, local_rect, w);
+		denoising_parallel_rows(0, h, function_bind(&CPUDevice::denoising_nlm_normalize_rows, this,
+		                                            _1, _2, (float*) out_ptr, weightAccum, w, rect.z-rect.x));
 
 		return true;
 	}
 
-	bool denoising_construct_transform(DenoisingTask *task)
+	void denoising_construct_transform_rows(int y0, int y1, DenoisingTask *task)
 	{
-		ProfilingHelper profiling(task->profiler, PROFILING_DENOISING_CONSTRUCT_TRANSFORM);
-
-		for(int y = 0; y < task->filter_area.w; y++) {
+		for(int y = y0; y < y1; y++) {
 			for(int x = 0; x < task->filter_area.z; x++) {
 				filter_construct_transform_kernel()((float*) task->buffer.mem.device_pointer,
 				                                    task->tile_info,
@@ -556,53 +706,49 @@ public:
 				                                    task->pca_threshold);
 			}
 		}
-		return true;
 	}
 
-	bool denoising_accumulate(device_ptr color_ptr,
-	                          device_ptr color_variance_ptr,
-	                          device_ptr scale_ptr,
-	                          int frame,
-	                          DenoisingTask *task)
+	bool denoising_construct_transform(DenoisingTask *task)
 	{
-		ProfilingHelper profiling(task->profiler, PROFILING_DENOISING_RECONSTRUCT);
+		ProfilingHelper profiling(task->profiler, PROFILING_DENOISING_CONSTRUCT_TRANSFORM);
 
-		float *temporary_mem = (float*) task->buffer.temporary_mem.device_pointer;
-		float *difference     = temporary_mem;
-		float *blurDifference = temporary_mem + task->buffer.pass_stride;
+		denoising_parallel_rows(0, task->filter_area.w,
+		                        function_bind(&CPUDevice::denoising_construct_transform_rows, this, _1, _2, task));
+		return true;
+	}
 
+	void denoising_gramian_rows(int y0, int y1,
+	                            int first_shift, int num,
+	                            int4 *local_rects,
+	                            float *temporary_mem,
+	                            int frame,
+	                            DenoisingTask *task)
+	{
 		int r = task->radius;
 		int frame_offset = frame * task->buffer.frame_stride;
-		for(int i = 0; i < (2*r+1)*(2*r+1); i++) {
+
+		/* Shifts are processed in order, so the accumulation matches sequential filtering. */
+		for(int j = 0; j < num; j++) {
+			int i = first_shift + j;
 			int dy = i / (2*r+1) - r;
 			int dx = i % (2*r+1) - r;
 
-			int local_rect[4] = {max(0, -dx), max(0, -dy),
-			                     task->reconstruction_state.source_w - max(0, dx),
-			                     task->reconstruction_state.source_h - max(0, dy)};
-			filter_nlm_calc_difference_kernel()(dx, dy,
-			                                    (float*) color_ptr,
-			                                    (float*) color_variance_ptr,
-			                                    (float*) scale_ptr,
-			                                    difference,
-			                                    local_rect,
-			                                    task->buffer.stride,
-			                                    task->buffer.pass_stride,
-			                                    frame_offset,
-			                                    1.0f,
-			                                    task->nlm_k_2);
-			filter_nlm_blur_kernel()(difference, blurDifference, local_rect, task->buffer.stride, 4);
-			filter_nlm_calc_weight_kernel()(blurDifference, difference, local_rect, task->buffer.stride, 4);
-			filter_nlm_blur_kernel()(difference, blurDifference, local_rect, task->buffer.stride, 4);
+			int4 band = local_rects[j];
+			band.y = max(band.y, y0);
+			band.w = min(band.w, y1);
+			if(band.y >= band.w) {
+				continue;
+			}
+
 			filter_nlm_construct_gramian_kernel()(dx, dy,
 			                                      task->tile_info->frames[frame],
-			                                      blurDifference,
+			                                      temporary_mem + (2*j + 1)*task->buffer.pass_stride,
 			                                      (float*)  task->buffer.mem.device_pointer,
 			                                      (float*)  task->storage.transform.device_pointer,
 			                                      (int*)    task->storage.rank.device_pointer,
 			                                      (float*)  task->storage.XtWX.device_pointer,
 			                                      (float3*) task->storage.XtWY.device_pointer,
-			                                      local_rect,
+			                                      &band.x,
 			                                      &task->reconstruction_state.filter_window.x,
 			                                      task->buffer.stride,
 			                                      4,
@@ -610,14 +756,56 @@ public:
 			                                      frame_offset,
 			                                      task->buffer.use_time);
 		}
+	}
+
+	bool denoising_accumulate(device_ptr color_ptr,
+	                          device_ptr color_variance_ptr,
+	                          device_ptr scale_ptr,
+	                          int frame,
+	                          DenoisingTask *task)
+	{
+		ProfilingHelper profiling(task->profiler, PROFILING_DENOISING_RECONSTRUCT);
+
+		float *temporary_mem = (float*) task->buffer.temporary_mem.device_pointer;
+
+		int r = task->radius;
+		int frame_offset = frame * task->buffer.frame_stride;
+		int num_shifts = (2*r+1)*(2*r+1);
+		int batch = denoising_shift_batch(num_shifts, task);
+
+		vector<int4> local_rects(batch);
+		for(int i = 0; i < num_shifts; i += batch) {
+			int num = min(batch, num_shifts - i);
+
+			denoising_nlm_batch_weights(i, num, r,
+			                            (float*) color_ptr,
+			                            (float*) color_variance_ptr,
+			                            (float*) scale_ptr,
+			                            temporary_mem,
+			                            task->reconstruction_state.source_w,
+			                            task->reconstruction_state.source_h,
+			                            task->buffer.stride,
+			                            task->buffer.pass_stride,
+			                            frame_offset,
+			                            1.0f, task->nlm_k_2, 4,
+			                            task->buffer.pass_stride,
+			                            &local_rects[0]);
+
+			denoising_parallel_rows(0, task->reconstruction_state.source_h,
+			                        function_bind(&CPUDevice::denoising_gramian_rows, this,
+			                                      _1, _2, i, num,
+			                                      &local_rects[0],
+			                                      temporary_mem,
+			                                      frame,
+			                                      task));
+		}
 
 		return true;
 	}
 
-	bool denoising_solve(device_ptr output_ptr,
-	                     DenoisingTask *task)
+	void denoising_solve_rows(int y0, int y1, device_ptr output_ptr, DenoisingTask *task)
 	{
-		for(int y = 0; y < task->filter_area.w; y++) {
+		for(int y = y0; y < y1; y++) {
 			for(int x = 0; x < task->filter_area.z; x++) {
 				filter_finalize_kernel()(x,
 				                         y,
@@ -630,6 +818,13 @@ public:
 				                         task->render_buffer.samples);
 			}
 		}
+	}
+
+	bool denoising_solve(device_ptr output_ptr,
+	                     DenoisingTask *task)
+	{
+		denoising_parallel_rows(0, task->filter_area.w,
+		                        function_bind(&CPUDevice::denoising_solve_rows, this, _1, _2, output_ptr, task));
 		return true;
 	}
 
@@ -808,6 +1003,9 @@ public:
 		denoising.filter_area = make_int4(tile.x, tile.y, tile.w, tile.h);
 		denoising.render_buffer.samples = tile.sample;
 		denoising.buffer.gpu_temporary_mem = false;
+		/* Compute the weights of several shifts at once so a single tile keeps all
+		 * threads busy, e.g. for the last tiles of a frame. */
+		denoising.buffer.cpu_shift_batch = clamp(TaskScheduler::num_threads(), 1, 16);
 
 		denoising.run_denoising(&tile);
 	}
@@ -1127,6 +1325,7 @@ void device_cpu_info(vector<DeviceInfo>& devices)
 	info.has_volume_decoupled = true;
 	info.has_osl = true;
 	info.has_half_images = true;
+	info.has_sparse_images = true;
 	info.has_profiling = true;
 
 	devices.insert(devices.begin(), info);
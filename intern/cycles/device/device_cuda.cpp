@@ -1221,6 +1221,7 @@ public:
 		/* Set Mapping and tag that we need to (re-)upload to device */
 		TextureInfo& info = texture_info[flat_slot];
 		info.data = (uint64_t)cmem->texobject;
+		info.grid_info = 0;
 		info.cl_buffer = 0;
 		info.interpolation = mem.interpolation;
 		info.extension = mem.extension;
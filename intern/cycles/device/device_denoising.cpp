@@ -121,7 +121,7 @@ void DenoisingTask::setup_denoising_buffer()
 	buffer.mem.alloc_to_device(mem_size, false);
 	buffer.use_time = (tile_info->num_frames > 1);
 
-	/* CPUs process shifts sequentially while GPUs process them in parallel. */
+	/* CPUs process shifts in small batches while GPUs process them all in parallel. */
 	int num_layers;
 	if(buffer.gpu_temporary_mem) {
 		/* Shadowing prefiltering uses a radius of 6, so allocate at least that much. */
@@ -130,7 +130,7 @@ void DenoisingTask::setup_denoising_buffer()
 		num_layers = 2*num_shifts + 1;
 	}
 	else {
-		num_layers = 3;
+		num_layers = 2*max(buffer.cpu_shift_batch, 1) + 1;
 	}
 	/* Allocate two layers per shift as well as one for the weight accumulation. */
 	buffer.temporary_mem.alloc_to_device(num_layers * buffer.pass_stride);
@@ -165,10 +165,13 @@ public:
 		bool use_intensity;
 
 		bool gpu_temporary_mem;
+		/* Number of shifts the CPU processes in parallel. */
+		int cpu_shift_batch;
 
 		DenoiseBuffers(Device *device)
 		: mem(device, "denoising pixel buffer"),
-		  temporary_mem(device, "denoising temporary mem")
+		  temporary_mem(device, "denoising temporary mem"),
+		  cpu_shift_batch(1)
 	    {}
 	} buffer;
 
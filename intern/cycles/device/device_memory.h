@@ -204,6 +204,9 @@ public:
 	const char *name;
 	InterpolationType interpolation;
 	ExtensionType extension;
+	/* Element offset of the tile index table of sparse 3D textures, zero for
+	 * dense textures. See util_sparse_grid.h. */
+	size_t grid_info_offset;
 
 	/* Pointers. */
 	Device *device;
@@ -340,6 +343,7 @@ public:
 		data_width = width;
 		data_height = height;
 		data_depth = depth;
+		grid_info_offset = 0;
 
 		return data();
 	}
@@ -368,6 +372,7 @@ public:
 		data_width = width;
 		data_height = height;
 		data_depth = depth;
+		grid_info_offset = 0;
 
 		return data();
 	}
@@ -382,6 +387,7 @@ public:
 		data_width = 0;
 		data_height = 0;
 		data_depth = 0;
+		grid_info_offset = 0;
 		host_pointer = from.steal_pointer();
 		assert(device_pointer == 0);
 	}
@@ -396,6 +402,7 @@ public:
 		data_width = 0;
 		data_height = 0;
 		data_depth = 0;
+		grid_info_offset = 0;
 		host_pointer = 0;
 		assert(device_pointer == 0);
 	}
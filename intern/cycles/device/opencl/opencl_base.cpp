@@ -674,6 +674,7 @@ void OpenCLDeviceBase::flush_texture_buffers()
 
 		MemoryManager::BufferDescriptor desc = memory_manager.get_descriptor(slot.name);
 		info.data = desc.offset;
+		info.grid_info = 0;
 		info.cl_buffer = desc.device_buffer;
 
 		if(string_startswith(slot.name, "__tex_image")) {
@@ -0,0 +1,414 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "graph/node_binary.h"
+
+#include "util/util_foreach.h"
+#include "util/util_transform.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Alignment of array data in the buffer. */
+static const size_t BINARY_ALIGNMENT = 16;
+
+/* Writer */
+
+void BinaryWriter::write_data(const void *value, size_t size)
+{
+	const uint8_t *bytes = (const uint8_t*)value;
+	data.insert(data.end(), bytes, bytes + size);
+}
+
+void BinaryWriter::write_aligned_data(const void *value, size_t size)
+{
+	data.resize(align_up(data.size(), BINARY_ALIGNMENT), 0);
+	write_data(value, size);
+}
+
+void BinaryWriter::write_string(ustring value)
+{
+	write_uint((uint)value.size());
+	write_data(value.c_str(), value.size());
+}
+
+void BinaryWriter::write_node_ref(const Node *node)
+{
+	map<const Node*, int>::iterator it = node_index.find(node);
+	write_int((it != node_index.end())? it->second: -1);
+}
+
+void BinaryWriter::add_node(const Node *node)
+{
+	int index = (int)node_index.size();
+	node_index[node] = index;
+}
+
+/* Reader */
+
+BinaryReader::BinaryReader(const vector<uint8_t>& data)
+: error(false), data(data), offset(0)
+{
+}
+
+void BinaryReader::read_data(void *value, size_t size)
+{
+	if(error || size > data.size() - offset) {
+		error = true;
+		memset(value, 0, size);
+		return;
+	}
+
+	memcpy(value, &data[offset], size);
+	offset += size;
+}
+
+const uint8_t *BinaryReader::read_aligned_data(size_t size)
+{
+	size_t aligned_offset = align_up(offset, BINARY_ALIGNMENT);
+
+	if(error || aligned_offset > data.size() || size > data.size() - aligned_offset) {
+		error = true;
+		return NULL;
+	}
+
+	offset = aligned_offset + size;
+	return (size)? &data[aligned_offset]: NULL;
+}
+
+int BinaryReader::read_int()
+{
+	int value;
+	read_data(&value, sizeof(value));
+	return value;
+}
+
+uint BinaryReader::read_uint()
+{
+	uint value;
+	read_data(&value, sizeof(value));
+	return value;
+}
+
+float BinaryReader::read_float()
+{
+	float value;
+	read_data(&value, sizeof(value));
+	return value;
+}
+
+ustring BinaryReader::read_string()
+{
+	uint size = read_uint();
+
+	if(error || size > data.size() - offset) {
+		error = true;
+		return ustring();
+	}
+
+	ustring value(string((const char*)&data[offset], size));
+	offset += size;
+	return value;
+}
+
+Node *BinaryReader::read_node_ref(const NodeType *type)
+{
+	int index = read_int();
+
+	if(index < 0 || index >= (int)nodes.size()) {
+		return NULL;
+	}
+
+	Node *node = nodes[index];
+	return (type == NULL || node->type == type)? node: NULL;
+}
+
+/* Node */
+
+static bool binary_socket_is_stored(const SocketType& socket)
+{
+	return !(socket.type == SocketType::CLOSURE ||
+	         socket.type == SocketType::UNDEFINED ||
+	         (socket.flags & SocketType::INTERNAL));
+}
+
+void binary_write_node(BinaryWriter& writer, const Node *node)
+{
+	writer.write_string(node->name);
+
+	uint num_sockets = 0;
+	foreach(const SocketType& socket, node->type->inputs) {
+		if(binary_socket_is_stored(socket) && !node->has_default_value(socket)) {
+			num_sockets++;
+		}
+	}
+
+	writer.write_uint(num_sockets);
+
+	foreach(const SocketType& socket, node->type->inputs) {
+		if(!binary_socket_is_stored(socket) || node->has_default_value(socket)) {
+			continue;
+		}
+
+		writer.write_string(socket.name);
+		writer.write_int((int)socket.type);
+
+		switch(socket.type)
+		{
+			case SocketType::BOOLEAN:
+				writer.write_int(node->get_bool(socket));
+				break;
+			case SocketType::FLOAT:
+				writer.write_float(node->get_float(socket));
+				break;
+			case SocketType::INT:
+			case SocketType::ENUM:
+				writer.write_int(node->get_int(socket));
+				break;
+			case SocketType::UINT:
+				writer.write_uint(node->get_uint(socket));
+				break;
+			case SocketType::COLOR:
+			case SocketType::VECTOR:
+			case SocketType::POINT:
+			case SocketType::NORMAL:
+			{
+				float3 value = node->get_float3(socket);
+				writer.write_data(&value, sizeof(value));
+				break;
+			}
+			case SocketType::POINT2:
+			{
+				float2 value = node->get_float2(socket);
+				writer.write_data(&value, sizeof(value));
+				break;
+			}
+			case SocketType::STRING:
+				writer.write_string(node->get_string(socket));
+				break;
+			case SocketType::TRANSFORM:
+			{
+				Transform value = node->get_transform(socket);
+				writer.write_data(&value, sizeof(value));
+				break;
+			}
+			case SocketType::NODE:
+				writer.write_node_ref(node->get_node(socket));
+				break;
+			case SocketType::BOOLEAN_ARRAY:
+				writer.write_array(node->get_bool_array(socket));
+				break;
+			case SocketType::FLOAT_ARRAY:
+				writer.write_array(node->get_float_array(socket));
+				break;
+			case SocketType::INT_ARRAY:
+				writer.write_array(node->get_int_array(socket));
+				break;
+			case SocketType::COLOR_ARRAY:
+			case SocketType::VECTOR_ARRAY:
+			case SocketType::POINT_ARRAY:
+			case SocketType::NORMAL_ARRAY:
+				writer.write_array(node->get_float3_array(socket));
+				break;
+			case SocketType::POINT2_ARRAY:
+				writer.write_array(node->get_float2_array(socket));
+				break;
+			case SocketType::TRANSFORM_ARRAY:
+				writer.write_array(node->get_transform_array(socket));
+				break;
+			case SocketType::STRING_ARRAY:
+			{
+				const array<ustring>& value = node->get_string_array(socket);
+				writer.write_uint((uint)value.size());
+				for(size_t i = 0; i < value.size(); i++) {
+					writer.write_string(value[i]);
+				}
+				break;
+			}
+			case SocketType::NODE_ARRAY:
+			{
+				const array<Node*>& value = node->get_node_array(socket);
+				writer.write_uint((uint)value.size());
+				for(size_t i = 0; i < value.size(); i++) {
+					writer.write_node_ref(value[i]);
+				}
+				break;
+			}
+			case SocketType::CLOSURE:
+			case SocketType::UNDEFINED:
+				break;
+		}
+	}
+}
+
+void binary_read_node(BinaryReader& reader, Node *node)
+{
+	node->name = reader.read_string();
+
+	uint num_sockets = reader.read_uint();
+
+	for(uint i = 0; i < num_sockets && !reader.error; i++) {
+		ustring name = reader.read_string();
+		SocketType::Type type = (SocketType::Type)reader.read_int();
+
+		/* Values of sockets that no longer exist or changed type are read
+		 * and skipped, so older files remain readable. */
+		const SocketType *input = node->type->find_input(name);
+		const SocketType *socket = (input && input->type == type && binary_socket_is_stored(*input))? input: NULL;
+
+		switch(type)
+		{
+			case SocketType::BOOLEAN:
+			{
+				bool value = (reader.read_int() != 0);
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::FLOAT:
+			{
+				float value = reader.read_float();
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::INT:
+			{
+				int value = reader.read_int();
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::ENUM:
+			{
+				int value = reader.read_int();
+				if(socket && socket->enum_values->exists(value)) node->set(*socket, value);
+				break;
+			}
+			case SocketType::UINT:
+			{
+				uint value = reader.read_uint();
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::COLOR:
+			case SocketType::VECTOR:
+			case SocketType::POINT:
+			case SocketType::NORMAL:
+			{
+				float3 value;
+				reader.read_data(&value, sizeof(value));
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::POINT2:
+			{
+				float2 value;
+				reader.read_data(&value, sizeof(value));
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::STRING:
+			{
+				ustring value = reader.read_string();
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::TRANSFORM:
+			{
+				Transform value;
+				reader.read_data(&value, sizeof(value));
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::NODE:
+			{
+				Node *value = reader.read_node_ref((socket)? *(socket->node_type): NULL);
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::BOOLEAN_ARRAY:
+			{
+				array<bool> value;
+				reader.read_array(value);
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::FLOAT_ARRAY:
+			{
+				array<float> value;
+				reader.read_array(value);
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::INT_ARRAY:
+			{
+				array<int> value;
+				reader.read_array(value);
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::COLOR_ARRAY:
+			case SocketType::VECTOR_ARRAY:
+			case SocketType::POINT_ARRAY:
+			case SocketType::NORMAL_ARRAY:
+			{
+				array<float3> value;
+				reader.read_array(value);
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::POINT2_ARRAY:
+			{
+				array<float2> value;
+				reader.read_array(value);
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::TRANSFORM_ARRAY:
+			{
+				array<Transform> value;
+				reader.read_array(value);
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::STRING_ARRAY:
+			{
+				uint size = reader.read_uint();
+				array<ustring> value;
+				for(uint j = 0; j < size && !reader.error; j++) {
+					value.push_back_slow(reader.read_string());
+				}
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::NODE_ARRAY:
+			{
+				uint size = reader.read_uint();
+				array<Node*> value;
+				for(uint j = 0; j < size && !reader.error; j++) {
+					value.push_back_slow(reader.read_node_ref((socket)? *(socket->node_type): NULL));
+				}
+				if(socket) node->set(*socket, value);
+				break;
+			}
+			case SocketType::CLOSURE:
+			case SocketType::UNDEFINED:
+			default:
+				/* Unknown value size, the rest of the data can't be read. */
+				reader.error = true;
+				break;
+		}
+	}
+}
+
+CCL_NAMESPACE_END
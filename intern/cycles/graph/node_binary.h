@@ -0,0 +1,104 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "graph/node.h"
+
+#include "util/util_array.h"
+#include "util/util_map.h"
+#include "util/util_string.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Binary Node Serialization
+ *
+ * Writes node socket values through NodeType reflection into a flat byte
+ * buffer, as the binary counterpart of node_xml. Array data is aligned, so
+ * it can be copied or mapped from the file in one block. Values are stored
+ * in native byte order, files are not portable between architectures.
+ *
+ * Node references are stored as indices in the order nodes were written, the
+ * referenced node must be written first. */
+
+class BinaryWriter {
+public:
+	void write_int(int value) { write_data(&value, sizeof(value)); }
+	void write_uint(uint value) { write_data(&value, sizeof(value)); }
+	void write_float(float value) { write_data(&value, sizeof(value)); }
+	void write_string(ustring value);
+	void write_node_ref(const Node *node);
+
+	void write_data(const void *data, size_t size);
+	void write_aligned_data(const void *data, size_t size);
+
+	template<typename T>
+	void write_array(const array<T>& value)
+	{
+		write_uint((uint)value.size());
+		write_aligned_data(value.data(), sizeof(T) * value.size());
+	}
+
+	/* Register a node so later nodes can reference it. */
+	void add_node(const Node *node);
+
+	vector<uint8_t> data;
+	map<const Node*, int> node_index;
+};
+
+class BinaryReader {
+public:
+	explicit BinaryReader(const vector<uint8_t>& data);
+
+	int read_int();
+	uint read_uint();
+	float read_float();
+	ustring read_string();
+	Node *read_node_ref(const NodeType *type);
+
+	void read_data(void *data, size_t size);
+	const uint8_t *read_aligned_data(size_t size);
+
+	template<typename T>
+	void read_array(array<T>& value)
+	{
+		uint size = read_uint();
+		const uint8_t *data = read_aligned_data(sizeof(T) * size);
+		if(data) {
+			value.resize(size);
+			memcpy(value.data(), data, sizeof(T) * size);
+		}
+		else {
+			value.clear();
+		}
+	}
+
+	void add_node(Node *node) { nodes.push_back(node); }
+
+	/* Set when reading past the end of the data or when reading invalid
+	 * values, all reads return zero afterwards. */
+	bool error;
+
+	const vector<uint8_t>& data;
+	size_t offset;
+	vector<Node*> nodes;
+};
+
+void binary_write_node(BinaryWriter& writer, const Node *node);
+void binary_read_node(BinaryReader& reader, Node *node);
+
+CCL_NAMESPACE_END
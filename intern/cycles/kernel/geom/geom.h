@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "kernel/geom/geom_attribute_compact.h"
 #include "kernel/geom/geom_attribute.h"
 #include "kernel/geom/geom_object.h"
 #ifdef __PATCH_EVAL__
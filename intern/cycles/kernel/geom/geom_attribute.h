@@ -94,6 +94,20 @@ ccl_device_inline AttributeDescriptor find_attribute(KernelGlobals *kg, const Sh
 	return desc;
 }
 
+ccl_device_inline float3 attribute_float3_fetch(KernelGlobals *kg, const AttributeDescriptor desc, int index)
+{
+	/* see geom_attribute_compact.h */
+	if(desc.flags & ATTR_COMPACT_HALF) {
+		return attribute_half_decode(kernel_tex_fetch(__attributes_uchar4, index));
+	}
+	else if(desc.flags & ATTR_COMPACT_OCTAHEDRAL) {
+		return attribute_octahedral_decode(kernel_tex_fetch(__attributes_uchar4, index));
+	}
+	else {
+		return float4_to_float3(kernel_tex_fetch(__attributes_float3, index));
+	}
+}
+
 /* Transform matrix attribute on meshes */
 
 ccl_device Transform primitive_attribute_matrix(KernelGlobals *kg, const ShaderData *sd, const AttributeDescriptor desc)
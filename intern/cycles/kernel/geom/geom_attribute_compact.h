@@ -0,0 +1,133 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Compact attributes
+ *
+ * Texture coordinates and unit vectors are optionally stored in 32 bits per
+ * element instead of a float4, the packed bits are kept in the byte attribute
+ * array. Texture coordinates are two half floats, unit vectors are encoded
+ * with an octahedral mapping to two 16 bit integers.
+ *
+ * Encoding happens on the host when the attributes are stored, the kernel
+ * decodes them in attribute_float3_fetch(). */
+
+/* Largest error of texture coordinates stored as half floats, which is the
+ * rounding error of halfs in the [-1, 1] range. Coordinates outside of it lose
+ * more and are only stored as halfs when they happen to be represented
+ * exactly, such as the borders of UDIM tiles. */
+#define ATTR_HALF_TOLERANCE (1.0f / 4096.0f)
+/* Coordinates beyond this are always stored as full floats. */
+#define ATTR_HALF_RANGE 2.0f
+
+ccl_device_inline uint attribute_compact_bits(uchar4 c)
+{
+	return (uint)c.x | ((uint)c.y << 8) | ((uint)c.z << 16) | ((uint)c.w << 24);
+}
+
+ccl_device_inline float attribute_half_to_float(uint h)
+{
+	/* Denormals and infinity are never written, only zero needs special care. */
+	uint sign = (h & 0x8000) << 16;
+	uint value = h & 0x7FFF;
+	return __uint_as_float(sign | ((value == 0)? 0: (value << 13) + 0x38000000));
+}
+
+ccl_device_inline float3 attribute_half_decode(uchar4 c)
+{
+	uint bits = attribute_compact_bits(c);
+	return make_float3(attribute_half_to_float(bits & 0xFFFF),
+	                   attribute_half_to_float(bits >> 16),
+	                   0.0f);
+}
+
+ccl_device_inline float3 attribute_octahedral_decode(uchar4 c)
+{
+	uint bits = attribute_compact_bits(c);
+	float x = (float)(bits & 0xFFFF) * (2.0f / 65535.0f) - 1.0f;
+	float y = (float)(bits >> 16) * (2.0f / 65535.0f) - 1.0f;
+	float z = 1.0f - fabsf(x) - fabsf(y);
+
+	if(z < 0.0f) {
+		float ox = x;
+		x = (1.0f - fabsf(y)) * ((ox >= 0.0f)? 1.0f: -1.0f);
+		y = (1.0f - fabsf(ox)) * ((y >= 0.0f)? 1.0f: -1.0f);
+	}
+
+	return normalize(make_float3(x, y, z));
+}
+
+/* Encoding is only done on the host. */
+#ifndef __KERNEL_GPU__
+
+ccl_device_inline uchar4 attribute_compact_bytes(uint bits)
+{
+	return make_uchar4(bits & 0xFF, (bits >> 8) & 0xFF, (bits >> 16) & 0xFF, bits >> 24);
+}
+
+/* Unlike float_to_half() this rounds to the nearest half, which keeps the
+ * error within ATTR_HALF_TOLERANCE in the [-1, 1] range. */
+ccl_device_inline uint attribute_float_to_half(float f)
+{
+	uint bits = __float_as_uint(f);
+	uint sign = (bits >> 16) & 0x8000;
+	uint value = bits & 0x7FFFFFFF;
+
+	/* Flush denormals to zero, clamp to the largest half. */
+	if(value < 0x38800000) {
+		return sign;
+	}
+	uint h = (value + 0x1000 - 0x38000000) >> 13;
+	return sign | ((h > 0x7BFF)? 0x7BFF: h);
+}
+
+ccl_device_inline uchar4 attribute_half_encode(const float3 f)
+{
+	return attribute_compact_bytes(attribute_float_to_half(f.x) |
+	                               (attribute_float_to_half(f.y) << 16));
+}
+
+/* Whether the texture coordinate survives the half float encoding. */
+ccl_device_inline bool attribute_half_is_precise(const float3 f)
+{
+	if(!(fabsf(f.x) <= ATTR_HALF_RANGE && fabsf(f.y) <= ATTR_HALF_RANGE)) {
+		return false;
+	}
+
+	float3 decoded = attribute_half_decode(attribute_half_encode(f));
+	return fabsf(decoded.x - f.x) <= ATTR_HALF_TOLERANCE &&
+	       fabsf(decoded.y - f.y) <= ATTR_HALF_TOLERANCE;
+}
+
+ccl_device_inline uchar4 attribute_octahedral_encode(const float3 f)
+{
+	float3 n = f / (fabsf(f.x) + fabsf(f.y) + fabsf(f.z));
+	float x = n.x, y = n.y;
+
+	if(n.z < 0.0f) {
+		x = (1.0f - fabsf(n.y)) * ((n.x >= 0.0f)? 1.0f: -1.0f);
+		y = (1.0f - fabsf(n.x)) * ((n.y >= 0.0f)? 1.0f: -1.0f);
+	}
+
+	uint qx = (uint)(clamp(x*0.5f + 0.5f, 0.0f, 1.0f)*65535.0f + 0.5f);
+	uint qy = (uint)(clamp(y*0.5f + 0.5f, 0.0f, 1.0f)*65535.0f + 0.5f);
+	return attribute_compact_bytes(qx | (qy << 16));
+}
+
+#endif  /* __KERNEL_GPU__ */
+
+CCL_NAMESPACE_END
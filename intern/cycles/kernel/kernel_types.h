@@ -837,6 +837,10 @@ typedef enum AttributeStandard {
 typedef enum AttributeFlag {
 	ATTR_FINAL_SIZE = (1 << 0),
 	ATTR_SUBDIVIDED = (1 << 1),
+	/* Float3 attributes stored in 32 bits per element in __attributes_uchar4,
+	 * as two half floats or as an octahedral encoded unit vector. */
+	ATTR_COMPACT_HALF = (1 << 2),
+	ATTR_COMPACT_OCTAHEDRAL = (1 << 3),
 } AttributeFlag;
 
 typedef struct AttributeDescriptor {
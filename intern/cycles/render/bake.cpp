@@ -21,6 +21,7 @@
 #include "render/integrator.h"
 
 #include "util/util_foreach.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -90,6 +91,11 @@ uint4 BakeData::data(int i)
 		);
 }
 
+size_t BakeData::memory_size(size_t num_pixels)
+{
+	return num_pixels * (sizeof(int) + 6 * sizeof(float));
+}
+
 uint4 BakeData::differentials(int i)
 {
 	return make_uint4(
@@ -100,12 +106,23 @@ uint4 BakeData::differentials(int i)
 		  );
 }
 
+BakeJob::BakeJob()
+: object(OBJECT_NONE),
+  tri_offset(0),
+  num_pixels(0),
+  shader_type(SHADER_EVAL_COMBINED),
+  pass_filter(0),
+  result(NULL)
+{
+}
+
 BakeManager::BakeManager()
 {
 	m_bake_data = NULL;
 	m_is_baking = false;
 	need_update = true;
 	m_shader_limit = 512 * 512;
+	m_memory_budget = (size_t)1024 * 1024 * 1024;
 }
 
 BakeManager::~BakeManager()
@@ -130,47 +147,65 @@ BakeData *BakeManager::init(const int object, const size_t tri_offset, const siz
 	return m_bake_data;
 }
 
+void BakeManager::set_memory_budget(const size_t budget)
+{
+	m_memory_budget = budget;
+}
+
 void BakeManager::set_shader_limit(const size_t x, const size_t y)
 {
 	m_shader_limit = x * y;
 	m_shader_limit = (size_t)pow(2, ceil(log(m_shader_limit)/log(2)));
 }
 
-bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, ShaderEvalType shader_type, const int pass_filter, BakeData *bake_data, float result[])
+size_t BakeManager::num_tile_samples(size_t num_pixels, int num_samples)
 {
-	size_t num_pixels = bake_data->size();
-
-	int num_samples = aa_samples(scene, bake_data, shader_type);
-
-	/* calculate the total pixel samples for the progress bar */
-	total_pixel_samples = 0;
+	size_t total = 0;
 	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += m_shader_limit) {
 		size_t shader_size = (size_t)fminf(num_pixels - shader_offset, m_shader_limit);
-		total_pixel_samples += shader_size * num_samples;
+		total += shader_size * num_samples;
+	}
+	return total;
+}
+
+bool BakeManager::bake_tiles(Device *device,
+                             DeviceScene *dscene,
+                             Progress& progress,
+                             ShaderEvalType shader_type,
+                             const int pass_filter,
+                             int num_samples,
+                             const vector<BakeData*>& bake_data,
+                             const vector<float*>& results)
+{
+	size_t num_pixels = 0;
+	foreach(BakeData *data, bake_data) {
+		num_pixels += data->size();
 	}
-	progress.reset_sample();
-	progress.set_total_pixel_samples(total_pixel_samples);
 
 	/* needs to be up to date for baking specific AA samples */
 	dscene->data.integrator.aa_samples = num_samples;
 	device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
 
+	/* Pixels of all jobs are baked in the same device tasks, job and pixel
+	 * index of the first pixel of the current task. */
+	size_t job = 0, job_pixel = 0;
+
 	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += m_shader_limit) {
-		size_t shader_size = (size_t)fminf(num_pixels - shader_offset, m_shader_limit);
+		size_t shader_size = min(num_pixels - shader_offset, m_shader_limit);
 
 		/* setup input for device task */
 		device_vector<uint4> d_input(device, "bake_input", MEM_READ_ONLY);
 		uint4 *d_input_data = d_input.alloc(shader_size * 2);
 		size_t d_input_size = 0;
 
-		for(size_t i = shader_offset; i < (shader_offset + shader_size); i++) {
-			d_input_data[d_input_size++] = bake_data->data(i);
-			d_input_data[d_input_size++] = bake_data->differentials(i);
-		}
+		for(size_t i = 0, input_job = job, input_pixel = job_pixel; i < shader_size; i++, input_pixel++) {
+			while(input_pixel == bake_data[input_job]->size()) {
+				input_job++;
+				input_pixel = 0;
+			}
 
-		if(d_input_size == 0) {
-			m_is_baking = false;
-			return false;
+			d_input_data[d_input_size++] = bake_data[input_job]->data(input_pixel);
+			d_input_data[d_input_size++] = bake_data[input_job]->differentials(input_pixel);
 		}
 
 		/* run device task */
@@ -197,7 +232,6 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 		if(progress.get_cancel()) {
 			d_input.free();
 			d_output.free();
-			m_is_baking = false;
 			return false;
 		}
 
@@ -205,18 +239,21 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 		d_input.free();
 
 		/* read result */
-		int k = 0;
-
 		float4 *offset = d_output.data();
 
 		size_t depth = 4;
-		for(size_t i=shader_offset; i < (shader_offset + shader_size); i++) {
-			size_t index = i * depth;
-			float4 out = offset[k++];
+		for(size_t k = 0; k < shader_size; k++, job_pixel++) {
+			while(job_pixel == bake_data[job]->size()) {
+				job++;
+				job_pixel = 0;
+			}
+
+			if(bake_data[job]->is_valid(job_pixel)) {
+				float *result = results[job] + job_pixel * depth;
+				float4 out = offset[k];
 
-			if(bake_data->is_valid(i)) {
 				for(size_t j=0; j < 4; j++) {
-					result[index + j] = out[j];
+					result[j] = out[j];
 				}
 			}
 		}
@@ -224,10 +261,126 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 		d_output.free();
 	}
 
-	m_is_baking = false;
 	return true;
 }
 
+bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, ShaderEvalType shader_type, const int pass_filter, BakeData *bake_data, float result[])
+{
+	int num_samples = aa_samples(scene, bake_data, shader_type);
+
+	/* calculate the total pixel samples for the progress bar */
+	total_pixel_samples = num_tile_samples(bake_data->size(), num_samples);
+	progress.reset_sample();
+	progress.set_total_pixel_samples(total_pixel_samples);
+
+	bool success = bake_tiles(device,
+	                          dscene,
+	                          progress,
+	                          shader_type,
+	                          pass_filter,
+	                          num_samples,
+	                          vector<BakeData*>(1, bake_data),
+	                          vector<float*>(1, result));
+
+	m_is_baking = false;
+	return success;
+}
+
+static void bake_job_populate(BakeJob *job, BakeData *bake_data)
+{
+	if(job->populate) {
+		job->populate(bake_data);
+	}
+}
+
+bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, vector<BakeJob>& jobs)
+{
+	m_is_baking = true;
+
+	/* calculate the total pixel samples for the progress bar */
+	total_pixel_samples = 0;
+	foreach(BakeJob& job, jobs) {
+		int num_samples = aa_samples(scene, job.object, job.shader_type);
+		total_pixel_samples += num_tile_samples(job.num_pixels, num_samples);
+	}
+	progress.reset_sample();
+	progress.set_total_pixel_samples(total_pixel_samples);
+
+	bool success = true;
+	size_t job_start = 0;
+
+	while(job_start < jobs.size() && success) {
+		/* Find jobs that fit in the memory budget, always at least one. */
+		size_t job_end = job_start + 1;
+		size_t memory = BakeData::memory_size(jobs[job_start].num_pixels);
+
+		while(job_end < jobs.size()) {
+			size_t job_memory = BakeData::memory_size(jobs[job_end].num_pixels);
+			if(memory + job_memory > m_memory_budget) {
+				break;
+			}
+			memory += job_memory;
+			job_end++;
+		}
+
+		/* Populate pixel data in parallel. */
+		vector<BakeData*> bake_data(job_end - job_start, NULL);
+		TaskPool pool;
+
+		for(size_t i = job_start; i < job_end; i++) {
+			BakeJob& job = jobs[i];
+			bake_data[i - job_start] = new BakeData(job.object, job.tri_offset, job.num_pixels);
+			pool.push(function_bind(&bake_job_populate, &job, bake_data[i - job_start]), false);
+		}
+
+		pool.wait_work();
+
+		/* Jobs evaluating the same pass with the same number of samples share
+		 * device tasks, so small objects don't each run their own task. */
+		size_t group_start = job_start;
+
+		while(group_start < job_end && success) {
+			BakeJob& first = jobs[group_start];
+			int num_samples = aa_samples(scene, first.object, first.shader_type);
+
+			vector<BakeData*> group_data;
+			vector<float*> group_results;
+			size_t group_end = group_start;
+
+			while(group_end < job_end &&
+			      jobs[group_end].shader_type == first.shader_type &&
+			      jobs[group_end].pass_filter == first.pass_filter &&
+			      aa_samples(scene, jobs[group_end].object, first.shader_type) == num_samples)
+			{
+				group_data.push_back(bake_data[group_end - job_start]);
+				group_results.push_back(jobs[group_end].result);
+				group_end++;
+			}
+
+			success = !progress.get_cancel() &&
+			          bake_tiles(device,
+			                     dscene,
+			                     progress,
+			                     first.shader_type,
+			                     first.pass_filter,
+			                     num_samples,
+			                     group_data,
+			                     group_results);
+
+			group_start = group_end;
+		}
+
+		for(size_t i = 0; i < bake_data.size(); i++) {
+			delete bake_data[i];
+		}
+
+		job_start = job_end;
+	}
+
+	m_is_baking = false;
+	return success;
+}
+
 void BakeManager::device_update(Device * /*device*/,
                                 DeviceScene * /*dscene*/,
                                 Scene * /*scene*/,
@@ -246,13 +399,18 @@ void BakeManager::device_free(Device * /*device*/, DeviceScene * /*dscene*/)
 }
 
 int BakeManager::aa_samples(Scene *scene, BakeData *bake_data, ShaderEvalType type)
+{
+	return aa_samples(scene, bake_data->object(), type);
+}
+
+int BakeManager::aa_samples(Scene *scene, int object_index, ShaderEvalType type)
 {
 	if(type == SHADER_EVAL_UV || type == SHADER_EVAL_ROUGHNESS) {
 		return 1;
 	}
 	else if(type == SHADER_EVAL_NORMAL) {
 		/* Only antialias normal if mesh has bump mapping. */
-		Object *object = scene->objects[bake_data->object()];
+		Object *object = scene->objects[object_index];
 
 		if(object->mesh) {
 			foreach(Shader *shader, object->mesh->used_shaders) {
@@ -20,6 +20,7 @@
 #include "device/device.h"
 #include "render/scene.h"
 
+#include "util/util_function.h"
 #include "util/util_progress.h"
 #include "util/util_vector.h"
 
@@ -38,6 +39,9 @@ public:
 	uint4 differentials(int i);
 	bool is_valid(int i);
 
+	/* Memory used by the pixel arrays of the given number of pixels. */
+	static size_t memory_size(size_t num_pixels);
+
 private:
 	int m_object;
 	size_t m_tri_offset;
@@ -51,6 +55,25 @@ private:
 	vector<float>m_dvdy;
 };
 
+/* Job in a batched bake, baking one pass of one object into a result array
+ * of 4 floats per pixel. The pixel data is filled in by the populate callback
+ * only shortly before the job is baked, so that not all jobs of a large batch
+ * need their BakeData in memory at the same time. */
+class BakeJob {
+public:
+	BakeJob();
+
+	int object;
+	size_t tri_offset;
+	size_t num_pixels;
+
+	ShaderEvalType shader_type;
+	int pass_filter;
+
+	function<void(BakeData *bake_data)> populate;
+	float *result;
+};
+
 class BakeManager {
 public:
 	BakeManager();
@@ -63,22 +86,36 @@ public:
 
 	void set_shader_limit(const size_t x, const size_t y);
 
+	/* Set the memory budget for the pixel data of batched bake jobs. */
+	void set_memory_budget(const size_t budget);
+
 	bool bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, ShaderEvalType shader_type, const int pass_filter, BakeData *bake_data, float result[]);
 
+	/* Bake multiple jobs on the same synced scene and BVH. Pixel data of as
+	 * many jobs as fit in the memory budget is populated in parallel, after
+	 * which jobs baking the same pass are baked together in shared device
+	 * tasks. */
+	bool bake(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress, vector<BakeJob>& jobs);
+
 	void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_free(Device *device, DeviceScene *dscene);
 
 	static int shader_type_to_pass_filter(ShaderEvalType type, const int pass_filter);
 	static int aa_samples(Scene *scene, BakeData *bake_data, ShaderEvalType type);
+	static int aa_samples(Scene *scene, int object, ShaderEvalType type);
 
 	bool need_update;
 
 	size_t total_pixel_samples;
 
 private:
+	size_t num_tile_samples(size_t num_pixels, int num_samples);
+	bool bake_tiles(Device *device, DeviceScene *dscene, Progress& progress, ShaderEvalType shader_type, const int pass_filter, int num_samples, const vector<BakeData*>& bake_data, const vector<float*>& results);
+
 	BakeData *m_bake_data;
 	bool m_is_baking;
 	size_t m_shader_limit;
+	size_t m_memory_budget;
 };
 
 CCL_NAMESPACE_END
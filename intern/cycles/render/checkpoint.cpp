@@ -0,0 +1,301 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/buffers.h"
+#include "render/checkpoint.h"
+
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* File layout, all values are 32 bit and in native byte order:
+ *
+ * header:  magic, version, full_x, full_y, width, height, pass_stride,
+ *          num_passes, pass types
+ * tiles:   num_tiles, then per tile x, y, w, h, sample followed by
+ *          w*h*pass_stride floats. */
+static const uint CHECKPOINT_MAGIC = 0x4B435943; /* "CYCK" */
+static const uint CHECKPOINT_VERSION = 1;
+
+RenderCheckpoint::RenderCheckpoint()
+: full_x(0), full_y(0), width(0), height(0), pass_stride(0)
+{
+}
+
+void RenderCheckpoint::reset(BufferParams& params)
+{
+	full_x = params.full_x;
+	full_y = params.full_y;
+	width = params.width;
+	height = params.height;
+	pass_stride = params.get_passes_size();
+
+	pass_types.clear();
+	foreach(const Pass& pass, params.passes) {
+		pass_types.push_back(pass.type);
+	}
+
+	tiles.clear();
+}
+
+bool RenderCheckpoint::matches(BufferParams& params) const
+{
+	if(full_x != params.full_x || full_y != params.full_y ||
+	   width != params.width || height != params.height ||
+	   pass_stride != params.get_passes_size() ||
+	   pass_types.size() != params.passes.size())
+	{
+		return false;
+	}
+
+	for(size_t i = 0; i < pass_types.size(); i++) {
+		if(pass_types[i] != params.passes[i].type) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void RenderCheckpoint::add_tile(const RenderTile& rtile, int sample)
+{
+	Tile *tile = NULL;
+	foreach(Tile& other, tiles) {
+		if(other.x == rtile.x && other.y == rtile.y && other.w == rtile.w && other.h == rtile.h) {
+			tile = &other;
+			break;
+		}
+	}
+
+	if(!tile) {
+		tiles.push_back(Tile());
+		tile = &tiles.back();
+		tile->x = rtile.x;
+		tile->y = rtile.y;
+		tile->w = rtile.w;
+		tile->h = rtile.h;
+	}
+
+	tile->sample = sample;
+	tile->data.resize((size_t)rtile.w*rtile.h*pass_stride);
+
+	const float *buffer = rtile.buffers->buffer.data();
+	size_t row_size = (size_t)rtile.w*pass_stride;
+
+	for(int y = 0; y < rtile.h; y++) {
+		size_t index = (size_t)(rtile.offset + rtile.x + (rtile.y + y)*rtile.stride)*pass_stride;
+		memcpy(&tile->data[y*row_size], buffer + index, sizeof(float)*row_size);
+	}
+}
+
+int RenderCheckpoint::get_sample(int x, int y, int w, int h) const
+{
+	int sample = 0;
+	int64_t covered = 0;
+
+	foreach(const Tile& tile, tiles) {
+		int x0 = max(x, tile.x), x1 = min(x + w, tile.x + tile.w);
+		int y0 = max(y, tile.y), y1 = min(y + h, tile.y + tile.h);
+		if(x0 >= x1 || y0 >= y1) {
+			continue;
+		}
+
+		if(covered > 0 && tile.sample != sample) {
+			return 0;
+		}
+
+		sample = tile.sample;
+		covered += (int64_t)(x1 - x0)*(y1 - y0);
+	}
+
+	/* Stored tiles never overlap, so the area tells whether all pixels are covered. */
+	return (covered == (int64_t)w*h)? sample: 0;
+}
+
+int RenderCheckpoint::restore_tile(const RenderTile& rtile) const
+{
+	int sample = get_sample(rtile.x, rtile.y, rtile.w, rtile.h);
+	if(sample == 0) {
+		return 0;
+	}
+
+	float *buffer = rtile.buffers->buffer.data();
+
+	foreach(const Tile& tile, tiles) {
+		int x0 = max(rtile.x, tile.x), x1 = min(rtile.x + rtile.w, tile.x + tile.w);
+		int y0 = max(rtile.y, tile.y), y1 = min(rtile.y + rtile.h, tile.y + tile.h);
+		if(x0 >= x1 || y0 >= y1) {
+			continue;
+		}
+
+		size_t row_size = (size_t)(x1 - x0)*pass_stride;
+		for(int y = y0; y < y1; y++) {
+			size_t from = ((size_t)(y - tile.y)*tile.w + (x0 - tile.x))*pass_stride;
+			size_t to = (size_t)(rtile.offset + x0 + y*rtile.stride)*pass_stride;
+			memcpy(buffer + to, &tile.data[from], sizeof(float)*row_size);
+		}
+	}
+
+	return sample;
+}
+
+bool RenderCheckpoint::write(const string& filepath) const
+{
+	/* Write to a temporary file first, so a job that is killed while writing
+	 * does not destroy the previous checkpoint. */
+	string temp_filepath = filepath + ".tmp";
+	FILE *f = path_fopen(temp_filepath, "wb");
+	if(!f) {
+		VLOG(1) << "Failed to open checkpoint file " << temp_filepath << " for writing.";
+		return false;
+	}
+
+	vector<int> header;
+	header.push_back((int)CHECKPOINT_MAGIC);
+	header.push_back((int)CHECKPOINT_VERSION);
+	header.push_back(full_x);
+	header.push_back(full_y);
+	header.push_back(width);
+	header.push_back(height);
+	header.push_back(pass_stride);
+	header.push_back((int)pass_types.size());
+	header.insert(header.end(), pass_types.begin(), pass_types.end());
+	header.push_back((int)tiles.size());
+
+	bool success = (fwrite(&header[0], sizeof(int), header.size(), f) == header.size());
+
+	foreach(const Tile& tile, tiles) {
+		if(!success) {
+			break;
+		}
+
+		int tile_header[5] = {tile.x, tile.y, tile.w, tile.h, tile.sample};
+		success = (fwrite(tile_header, sizeof(int), 5, f) == 5) &&
+		          (fwrite(&tile.data[0], sizeof(float), tile.data.size(), f) == tile.data.size());
+	}
+
+	success = (fclose(f) == 0) && success;
+
+	if(!success || !path_rename(temp_filepath, filepath)) {
+		VLOG(1) << "Failed to write checkpoint file " << filepath << ".";
+		path_remove(temp_filepath);
+		return false;
+	}
+
+	return true;
+}
+
+bool RenderCheckpoint::read(const string& filepath)
+{
+	tiles.clear();
+
+	FILE *f = path_fopen(filepath, "rb");
+	if(!f) {
+		return false;
+	}
+
+	/* Sizes in the file are checked against the file size before allocating. */
+	const size_t file_size = path_file_size(filepath);
+	size_t read_size = 0;
+
+	int header[8];
+	bool success = (fread(header, sizeof(int), 8, f) == 8) &&
+	               (header[0] == (int)CHECKPOINT_MAGIC) &&
+	               (header[1] == (int)CHECKPOINT_VERSION) &&
+	               (header[4] > 0) &&
+	               (header[5] > 0) &&
+	               (header[6] > 0) &&
+	               (header[7] >= 0) &&
+	               (header[7] <= PASS_CATEGORY_LIGHT_END);
+	read_size += sizeof(header);
+
+	if(success) {
+		full_x = header[2];
+		full_y = header[3];
+		width = header[4];
+		height = header[5];
+		pass_stride = header[6];
+		pass_types.resize(header[7]);
+
+		int num_tiles = 0;
+		success = (pass_types.empty() ||
+		           fread(&pass_types[0], sizeof(int), pass_types.size(), f) == pass_types.size()) &&
+		          (fread(&num_tiles, sizeof(int), 1, f) == 1) &&
+		          (num_tiles >= 0) &&
+		          ((int64_t)num_tiles <= (int64_t)width*height);
+		read_size += sizeof(int)*(pass_types.size() + 1);
+
+		foreach(int pass_type, pass_types) {
+			if(pass_type <= PASS_NONE || pass_type > PASS_CATEGORY_LIGHT_END) {
+				success = false;
+			}
+		}
+
+		for(int i = 0; success && i < num_tiles; i++) {
+			int tile_header[5];
+			if(fread(tile_header, sizeof(int), 5, f) != 5) {
+				success = false;
+				break;
+			}
+			read_size += sizeof(tile_header);
+
+			Tile tile;
+			tile.x = tile_header[0];
+			tile.y = tile_header[1];
+			tile.w = tile_header[2];
+			tile.h = tile_header[3];
+			tile.sample = tile_header[4];
+
+			/* Tiles must lie inside of the frame. */
+			if(tile.w <= 0 || tile.h <= 0 || tile.sample <= 0 ||
+			   tile.x < full_x || tile.y < full_y ||
+			   (int64_t)tile.x + tile.w > (int64_t)full_x + width ||
+			   (int64_t)tile.y + tile.h > (int64_t)full_y + height)
+			{
+				success = false;
+				break;
+			}
+
+			size_t num_floats = (file_size > read_size)? (file_size - read_size)/sizeof(float): 0;
+			if((size_t)tile.w*tile.h > num_floats/pass_stride) {
+				success = false;
+				break;
+			}
+
+			size_t data_size = (size_t)tile.w*tile.h*pass_stride;
+			tile.data.resize(data_size);
+			success = (fread(&tile.data[0], sizeof(float), tile.data.size(), f) == tile.data.size());
+			read_size += sizeof(float)*data_size;
+			if(success) {
+				tiles.push_back(tile);
+			}
+		}
+	}
+
+	fclose(f);
+
+	if(!success) {
+		VLOG(1) << "Invalid checkpoint file " << filepath << ", ignoring it.";
+		tiles.clear();
+		return false;
+	}
+
+	return true;
+}
+
+CCL_NAMESPACE_END
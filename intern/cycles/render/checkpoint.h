@@ -0,0 +1,78 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include "util/util_string.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class BufferParams;
+class RenderTile;
+
+/* Render Checkpoint
+ *
+ * Render buffer contents of tiles along with the number of samples they
+ * contain, periodically written to disk so an interrupted render can continue
+ * sampling where it left off instead of starting over. Tiles are stored in
+ * image coordinates, the same as RenderTile. */
+
+class RenderCheckpoint {
+public:
+	RenderCheckpoint();
+
+	/* Clear all tiles and set the frame layout the checkpoint belongs to. */
+	void reset(BufferParams& params);
+	bool empty() const { return tiles.empty(); }
+
+	/* Whether the checkpoint can be used to resume a render with these parameters. */
+	bool matches(BufferParams& params) const;
+
+	/* Store the buffer contents of a tile, replacing an earlier version. */
+	void add_tile(const RenderTile& rtile, int sample);
+
+	/* Copy stored data into the rectangle of the tile. Returns the number of
+	 * samples in it, or 0 when it is not fully covered by tiles with the same
+	 * number of samples, in which case nothing is copied. */
+	int restore_tile(const RenderTile& rtile) const;
+
+	/* Number of samples of the rectangle without copying any data. */
+	int get_sample(int x, int y, int w, int h) const;
+
+	bool write(const string& filepath) const;
+	bool read(const string& filepath);
+
+protected:
+	struct Tile {
+		int x, y, w, h;
+		int sample;
+		vector<float> data;
+	};
+
+	int full_x, full_y;
+	int width, height;
+	int pass_stride;
+	vector<int> pass_types;
+
+	vector<Tile> tiles;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __CHECKPOINT_H__ */
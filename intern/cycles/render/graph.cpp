@@ -729,6 +729,33 @@ void ShaderGraph::compute_displacement_hash()
 	displacement_hash = md5.get_hex();
 }
 
+string ShaderGraph::compute_hash()
+{
+	/* Compute hash of all nodes and links of the graph, to detect shaders with
+	 * identical graphs which can share the compiled code. Is to be called on a
+	 * finalized graph, so constant folded and simplified graphs compare equal. */
+	MD5Hash md5;
+	foreach(ShaderNode *node, nodes) {
+		node->hash(md5);
+		node->hash_extra(md5);
+		md5.append((uint8_t*)&node->id, sizeof(node->id));
+		md5.append((uint8_t*)&node->bump, sizeof(node->bump));
+		foreach(ShaderInput *input, node->inputs) {
+			if(input->link) {
+				int link_id = input->link->parent->id;
+				md5.append((uint8_t*)&link_id, sizeof(link_id));
+				md5.append(input->link->name().string());
+			}
+			else {
+				int link_id = -1;
+				md5.append((uint8_t*)&link_id, sizeof(link_id));
+			}
+		}
+	}
+
+	return md5.get_hex();
+}
+
 void ShaderGraph::clean(Scene *scene)
 {
 	/* Graph simplification */
@@ -199,6 +199,10 @@ public:
 	 * is to be handled in the subclass.
 	 */
 	virtual bool equals(const ShaderNode& other);
+
+	/* Append settings which are not stored in sockets but affect the compiled
+	 * shader to the hash, same as the extra settings compared in equals(). */
+	virtual void hash_extra(MD5Hash& /*md5*/) {}
 };
 
 
@@ -260,6 +264,7 @@ public:
 
 	void remove_proxy_nodes();
 	void compute_displacement_hash();
+	string compute_hash();
 	void simplify(Scene *scene);
 	void finalize(Scene *scene,
 	              bool do_bump = false,
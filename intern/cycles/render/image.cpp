@@ -23,6 +23,7 @@
 #include "util/util_logging.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
+#include "util/util_sparse_grid.h"
 #include "util/util_texture.h"
 #include "util/util_unique_ptr.h"
 
@@ -93,6 +94,7 @@ ImageManager::ImageManager(const DeviceInfo& info)
 	/* Set image limits */
 	max_num_images = TEX_NUM_MAX;
 	has_half_images = info.has_half_images;
+	has_sparse_images = info.has_sparse_images;
 
 	for(size_t type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
 		tex_num_images[type] = 0;
@@ -712,6 +714,44 @@ bool ImageManager::file_load_image(Image *img,
 	return true;
 }
 
+/* Store mostly empty 3D textures as sparse grid, to reduce memory usage
+ * and speed up building of volume bounding meshes. */
+template<typename T>
+static bool image_make_sparse(device_vector<T>& tex_img)
+{
+	const size_t width = tex_img.data_width;
+	const size_t height = tex_img.data_height;
+	const size_t depth = tex_img.data_depth;
+
+	if(depth <= 1) {
+		return false;
+	}
+
+	const size_t dense_size = tex_img.memory_size();
+	array<T> sparse_grid;
+	size_t grid_info_offset;
+
+	if(!create_sparse_grid(tex_img.data(),
+	                       width, height, depth,
+	                       &sparse_grid,
+	                       &grid_info_offset))
+	{
+		return false;
+	}
+
+	tex_img.steal_data(sparse_grid);
+	tex_img.data_width = width;
+	tex_img.data_height = height;
+	tex_img.data_depth = depth;
+	tex_img.grid_info_offset = grid_info_offset;
+
+	VLOG(1) << "Sparse 3D texture " << tex_img.name << ": "
+	        << string_human_readable_size(dense_size) << " dense, "
+	        << string_human_readable_size(tex_img.memory_size()) << " sparse.";
+
+	return true;
+}
+
 void ImageManager::device_load_image(Device *device,
                                      Scene *scene,
                                      ImageDataType type,
@@ -763,6 +803,10 @@ void ImageManager::device_load_image(Device *device,
 			pixels[3] = TEX_IMAGE_MISSING_A;
 		}
 
+		if(has_sparse_images) {
+			image_make_sparse(*tex_img);
+		}
+
 		img->mem = tex_img;
 		img->mem->interpolation = img->interpolation;
 		img->mem->extension = img->extension;
@@ -786,6 +830,10 @@ void ImageManager::device_load_image(Device *device,
 			pixels[0] = TEX_IMAGE_MISSING_R;
 		}
 
+		if(has_sparse_images) {
+			image_make_sparse(*tex_img);
+		}
+
 		img->mem = tex_img;
 		img->mem->interpolation = img->interpolation;
 		img->mem->extension = img->extension;
@@ -35,9 +35,14 @@
 #include "subd/subd_patch_table.h"
 
 #include "util/util_foreach.h"
+#include "util/util_half.h"
 #include "util/util_logging.h"
+#include "util/util_map.h"
 #include "util/util_progress.h"
 #include "util/util_set.h"
+#include "util/util_task.h"
+
+#include "kernel/geom/geom_attribute_compact.h"
 
 #ifdef WITH_EMBREE
 #  include "bvh/bvh_embree.h"
@@ -1150,6 +1155,10 @@ MeshManager::MeshManager()
 {
 	need_update = true;
 	need_flags_update = true;
+	attributes_float_size = 0;
+	attributes_float3_size = 0;
+	attributes_uchar4_size = 0;
+	attributes_saved_size = 0;
 }
 
 MeshManager::~MeshManager()
@@ -1376,16 +1385,91 @@ void MeshManager::update_svm_attributes(Device *, DeviceScene *dscene, Scene *sc
 	dscene->attributes_map.copy_to_device();
 }
 
+/* Decide whether a float3 attribute can be stored in compact form, returns
+ * the ATTR_COMPACT_* flag for it or 0 to store full floats. Decoding happens
+ * in attribute_float3_fetch() in the kernel. */
+static uint attribute_compact_flag(Mesh *mesh, Attribute *mattr, AttributePrimitive prim)
+{
+	/* Subdivision patch evaluation and motion blur read full floats. */
+	if(prim == ATTR_PRIM_SUBD) {
+		return 0;
+	}
+	if(!(mattr->element == ATTR_ELEMENT_VERTEX ||
+	     mattr->element == ATTR_ELEMENT_CORNER ||
+	     mattr->element == ATTR_ELEMENT_FACE ||
+	     mattr->element == ATTR_ELEMENT_CURVE ||
+	     mattr->element == ATTR_ELEMENT_CURVE_KEY))
+	{
+		return 0;
+	}
+
+	size_t size = mattr->element_size(mesh, prim);
+	const float3 *data = mattr->data_float3();
+
+	if(mattr->type == TypeDesc::TypePoint) {
+		/* Texture coordinates: the standard UV map, and other UV maps which
+		 * are unnamed corner attributes without a third component. */
+		if(mattr->std != ATTR_STD_UV &&
+		   !(mattr->std == ATTR_STD_NONE && mattr->element == ATTR_ELEMENT_CORNER))
+		{
+			return 0;
+		}
+		for(size_t i = 0; i < size; i++) {
+			if(data[i].z != 0.0f || !attribute_half_is_precise(data[i])) {
+				return 0;
+			}
+		}
+		return ATTR_COMPACT_HALF;
+	}
+	else if(mattr->type == TypeDesc::TypeNormal || mattr->type == TypeDesc::TypeVector) {
+		/* Normals and tangents, only when all of them have unit length. */
+		for(size_t i = 0; i < size; i++) {
+			if(fabsf(len_squared(data[i]) - 1.0f) > 1e-3f) {
+				return 0;
+			}
+		}
+		return ATTR_COMPACT_OCTAHEDRAL;
+	}
+
+	return 0;
+}
+
 static void update_attribute_element_size(Mesh *mesh,
                                           Attribute *mattr,
                                           AttributePrimitive prim,
+                                          bool use_compact,
+                                          set<Attribute*>& stored,
                                           size_t *attr_float_size,
                                           size_t *attr_float3_size,
-                                          size_t *attr_uchar4_size)
+                                          size_t *attr_uchar4_size,
+                                          size_t *attr_full_size)
 {
 	if(mattr) {
 		size_t size = mattr->element_size(mesh, prim);
 
+		/* Size as if every request had its own full precision copy. */
+		if(mattr->element == ATTR_ELEMENT_VOXEL) {
+			/* pass */
+		}
+		else if(mattr->element == ATTR_ELEMENT_CORNER_BYTE) {
+			*attr_full_size += size * sizeof(uchar4);
+		}
+		else if(mattr->type == TypeDesc::TypeFloat) {
+			*attr_full_size += size * sizeof(float);
+		}
+		else if(mattr->type == TypeDesc::TypeMatrix) {
+			*attr_full_size += size * 3 * sizeof(float4);
+		}
+		else {
+			*attr_full_size += size * sizeof(float4);
+		}
+
+		/* Requests by name and by standard can refer to the same attribute,
+		 * it's only stored once. */
+		if(!stored.insert(mattr).second) {
+			return;
+		}
+
 		if(mattr->element == ATTR_ELEMENT_VOXEL) {
 			/* pass */
 		}
@@ -1398,6 +1482,9 @@ static void update_attribute_element_size(Mesh *mesh,
 		else if(mattr->type == TypeDesc::TypeMatrix) {
 			*attr_float3_size += size * 4;
 		}
+		else if(use_compact && attribute_compact_flag(mesh, mattr, prim)) {
+			*attr_uchar4_size += size;
+		}
 		else {
 			*attr_float3_size += size;
 		}
@@ -1413,6 +1500,8 @@ static void update_attribute_element_offset(Mesh *mesh,
                                             size_t& attr_uchar4_offset,
                                             Attribute *mattr,
                                             AttributePrimitive prim,
+                                            bool use_compact,
+                                            map<Attribute*, AttributeDescriptor>& stored,
                                             TypeDesc& type,
                                             AttributeDescriptor& desc)
 {
@@ -1422,8 +1511,16 @@ static void update_attribute_element_offset(Mesh *mesh,
 		desc.flags = mattr->flags;
 		type = mattr->type;
 
+		/* reuse attribute data already stored for another request */
+		map<Attribute*, AttributeDescriptor>::iterator it = stored.find(mattr);
+		if(it != stored.end()) {
+			desc = it->second;
+			return;
+		}
+
 		/* store attribute data in arrays */
 		size_t size = mattr->element_size(mesh, prim);
+		uint compact = (use_compact)? attribute_compact_flag(mesh, mattr, prim): 0;
 
 		AttributeElement& element = desc.element;
 		int& offset = desc.offset;
@@ -1463,6 +1560,24 @@ static void update_attribute_element_offset(Mesh *mesh,
 			}
 			attr_float3_offset += size * 3;
 		}
+		else if(compact) {
+			float3 *data = mattr->data_float3();
+			offset = attr_uchar4_offset;
+			desc.flags |= compact;
+
+			assert(attr_uchar4.size() >= offset + size);
+			if(compact == ATTR_COMPACT_HALF) {
+				for(size_t k = 0; k < size; k++) {
+					attr_uchar4[offset+k] = attribute_half_encode(data[k]);
+				}
+			}
+			else {
+				for(size_t k = 0; k < size; k++) {
+					attr_uchar4[offset+k] = attribute_octahedral_encode(data[k]);
+				}
+			}
+			attr_uchar4_offset += size;
+		}
 		else {
 			float4 *data = mattr->data_float4();
 			offset = attr_float3_offset;
@@ -1502,6 +1617,8 @@ static void update_attribute_element_offset(Mesh *mesh,
 			offset -= mesh->curvekey_offset;
 		else if(element == ATTR_ELEMENT_CURVE_KEY_MOTION)
 			offset -= mesh->curvekey_offset;
+
+		stored[mattr] = desc;
 	}
 	else {
 		/* attribute not found */
@@ -1536,9 +1653,12 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	/* Pre-allocate attributes to avoid arrays re-allocation which would
 	 * take 2x of overall attribute memory usage.
 	 */
+	bool use_compact = scene->params.use_compact_attributes;
 	size_t attr_float_size = 0;
 	size_t attr_float3_size = 0;
 	size_t attr_uchar4_size = 0;
+	size_t attr_full_size = 0;
+	set<Attribute*> sized_attributes;
 	for(size_t i = 0; i < scene->meshes.size(); i++) {
 		Mesh *mesh = scene->meshes[i];
 		AttributeRequestSet& attributes = mesh_attributes[i];
@@ -1550,21 +1670,30 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 			update_attribute_element_size(mesh,
 			                              triangle_mattr,
 			                              ATTR_PRIM_TRIANGLE,
+			                              use_compact,
+			                              sized_attributes,
 			                              &attr_float_size,
 			                              &attr_float3_size,
-			                              &attr_uchar4_size);
+			                              &attr_uchar4_size,
+			                              &attr_full_size);
 			update_attribute_element_size(mesh,
 			                              curve_mattr,
 			                              ATTR_PRIM_CURVE,
+			                              use_compact,
+			                              sized_attributes,
 			                              &attr_float_size,
 			                              &attr_float3_size,
-			                              &attr_uchar4_size);
+			                              &attr_uchar4_size,
+			                              &attr_full_size);
 			update_attribute_element_size(mesh,
 			                              subd_mattr,
 			                              ATTR_PRIM_SUBD,
+			                              use_compact,
+			                              sized_attributes,
 			                              &attr_float_size,
 			                              &attr_float3_size,
-			                              &attr_uchar4_size);
+			                              &attr_uchar4_size,
+			                              &attr_full_size);
 		}
 	}
 
@@ -1575,14 +1704,13 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 	size_t attr_float_offset = 0;
 	size_t attr_float3_offset = 0;
 	size_t attr_uchar4_offset = 0;
+	map<Attribute*, AttributeDescriptor> stored_attributes;
 
 	/* Fill in attributes. */
 	for(size_t i = 0; i < scene->meshes.size(); i++) {
 		Mesh *mesh = scene->meshes[i];
 		AttributeRequestSet& attributes = mesh_attributes[i];
 
-		/* todo: we now store std and name attributes from requests even if
-		 * they actually refer to the same mesh attributes, optimize */
 		foreach(AttributeRequest& req, attributes.requests) {
 			Attribute *triangle_mattr = mesh->attributes.find(req);
 			Attribute *curve_mattr = mesh->curve_attributes.find(req);
@@ -1594,6 +1722,8 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 			                                dscene->attributes_uchar4, attr_uchar4_offset,
 			                                triangle_mattr,
 			                                ATTR_PRIM_TRIANGLE,
+			                                use_compact,
+			                                stored_attributes,
 			                                req.triangle_type,
 			                                req.triangle_desc);
 
@@ -1603,6 +1733,8 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 			                                dscene->attributes_uchar4, attr_uchar4_offset,
 			                                curve_mattr,
 			                                ATTR_PRIM_CURVE,
+			                                use_compact,
+			                                stored_attributes,
 			                                req.curve_type,
 			                                req.curve_desc);
 
@@ -1612,6 +1744,8 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 			                                dscene->attributes_uchar4, attr_uchar4_offset,
 			                                subd_mattr,
 			                                ATTR_PRIM_SUBD,
+			                                use_compact,
+			                                stored_attributes,
 			                                req.subd_type,
 			                                req.subd_desc);
 
@@ -1627,6 +1761,17 @@ void MeshManager::device_update_attributes(Device *device, DeviceScene *dscene,
 
 	if(progress.get_cancel()) return;
 
+	attributes_float_size = dscene->attributes_float.memory_size();
+	attributes_float3_size = dscene->attributes_float3.memory_size();
+	attributes_uchar4_size = dscene->attributes_uchar4.memory_size();
+
+	size_t attr_size = attributes_float_size + attributes_float3_size + attributes_uchar4_size;
+	attributes_saved_size = (attr_full_size > attr_size)? attr_full_size - attr_size: 0;
+
+	VLOG(1) << "Attribute memory " << string_human_readable_size(attr_size)
+	        << ", saved " << string_human_readable_size(attributes_saved_size)
+	        << " by sharing and compact storage.";
+
 	/* copy to device */
 	progress.set_status("Updating Mesh", "Copying Attributes to device");
 
@@ -2064,6 +2209,25 @@ void MeshManager::device_update_volume_images(Device *device,
 	pool.wait_work();
 }
 
+void MeshManager::tessellate_mesh(Mesh *mesh, Progress *progress)
+{
+	if(progress->get_cancel()) {
+		return;
+	}
+
+	string key = TessellationCache::compute_key(mesh);
+
+	if(tessellation_cache.lookup(key, mesh)) {
+		VLOG(2) << "Reusing cached tessellation for mesh " << mesh->name << ".";
+		return;
+	}
+
+	DiagSplit dsplit(*mesh->subd_params);
+	mesh->tessellate(&dsplit);
+
+	tessellation_cache.insert(key, mesh);
+}
+
 void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	if(!need_update)
@@ -2108,30 +2272,28 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 
 	/* Tessellate meshes that are using subdivision */
 	if(total_tess_needed) {
-		size_t i = 0;
+		progress.set_status("Updating Mesh",
+		                    string_printf("Tessellating %u meshes", (uint)total_tess_needed));
+
+		TaskPool pool;
+
 		foreach(Mesh *mesh, scene->meshes) {
 			if(mesh->need_update &&
 			   mesh->subdivision_type != Mesh::SUBDIVISION_NONE &&
 			   mesh->num_subd_verts == 0 &&
 			   mesh->subd_params)
 			{
-				string msg = "Tessellating ";
-				if(mesh->name == "")
-					msg += string_printf("%u/%u", (uint)(i+1), (uint)total_tess_needed);
-				else
-					msg += string_printf("%s %u/%u", mesh->name.c_str(), (uint)(i+1), (uint)total_tess_needed);
-
-				progress.set_status("Updating Mesh", msg);
-
-				DiagSplit dsplit(*mesh->subd_params);
-				mesh->tessellate(&dsplit);
-
-				i++;
-
-				if(progress.get_cancel()) return;
+				pool.push(function_bind(&MeshManager::tessellate_mesh,
+				                        this,
+				                        mesh,
+				                        &progress),
+				          false);
 			}
-
 		}
+
+		pool.wait_work();
+
+		if(progress.get_cancel()) return;
 	}
 
 	/* Update images needed for true displacement. */
@@ -2160,23 +2322,22 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	if(progress.get_cancel()) return;
 
 	/* Update displacement. */
-	bool displacement_done = false;
+	vector<Mesh*> updated_meshes;
 	size_t num_bvh = 0;
 
 	foreach(Mesh *mesh, scene->meshes) {
 		if(mesh->need_update) {
-			if(displace(device, dscene, scene, mesh, progress)) {
-				displacement_done = true;
-			}
+			updated_meshes.push_back(mesh);
 
 			if(mesh->need_build_bvh()) {
 				num_bvh++;
 			}
 		}
-
-		if(progress.get_cancel()) return;
 	}
 
+	bool displacement_done = displace(device, dscene, scene, updated_meshes, progress);
+	if(progress.get_cancel()) return;
+
 	/* Device re-update after displacement. */
 	if(displacement_done) {
 		device_free(device, dscene);
@@ -2267,6 +2428,10 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	dscene->attributes_float.free();
 	dscene->attributes_float3.free();
 	dscene->attributes_uchar4.free();
+	attributes_float_size = 0;
+	attributes_float3_size = 0;
+	attributes_uchar4_size = 0;
+	attributes_saved_size = 0;
 
 #ifdef WITH_OSL
 	OSLGlobals *og = (OSLGlobals*)device->osl_memory();
@@ -2294,6 +2459,11 @@ void MeshManager::collect_statistics(const Scene *scene, RenderStats *stats)
 		        NamedSizeEntry(string(mesh->name.c_str()),
 		                       mesh->get_total_size_in_bytes()));
 	}
+
+	stats->mesh.attributes.add_entry(NamedSizeEntry("Float", attributes_float_size));
+	stats->mesh.attributes.add_entry(NamedSizeEntry("Float3", attributes_float3_size));
+	stats->mesh.attributes.add_entry(NamedSizeEntry("Byte and compact", attributes_uchar4_size));
+	stats->mesh.attributes_saved = attributes_saved_size;
 }
 
 bool Mesh::need_attribute(Scene *scene, AttributeStandard std)
@@ -27,6 +27,7 @@
 #include "util/util_list.h"
 #include "util/util_map.h"
 #include "util/util_param.h"
+#include "util/util_thread.h"
 #include "util/util_transform.h"
 #include "util/util_types.h"
 #include "util/util_vector.h"
@@ -327,6 +328,42 @@ public:
 	void tessellate(DiagSplit *split);
 };
 
+/* Tessellation Cache
+ *
+ * Stores the result of tessellating subdivision meshes, so that a mesh that is
+ * synced again with the same control mesh, subdivision settings and a similar
+ * dicing camera does not need to be split and diced again. Entries are keyed by
+ * a hash of all of these, with the camera quantized into buckets, and the least
+ * recently used entries are evicted when the memory limit is exceeded. */
+
+class TessellationCache {
+public:
+	TessellationCache();
+	~TessellationCache();
+
+	/* Compute the key for a mesh before it is tessellated. */
+	static string compute_key(Mesh *mesh);
+
+	/* Copy tessellated geometry into the mesh, returns false if not cached. */
+	bool lookup(const string& key, Mesh *mesh);
+	/* Store the tessellated geometry of the mesh. */
+	void insert(const string& key, Mesh *mesh);
+
+	void clear();
+
+	size_t memory_limit;
+
+protected:
+	struct Entry;
+
+	void evict(size_t needed);
+
+	unordered_map<string, Entry*> entries;
+	size_t memory_used;
+	uint64_t use_counter;
+	thread_mutex mutex;
+};
+
 /* Mesh Manager */
 
 class MeshManager {
@@ -334,10 +371,14 @@ public:
 	bool need_update;
 	bool need_flags_update;
 
+	TessellationCache tessellation_cache;
+
 	MeshManager();
 	~MeshManager();
 
-	bool displace(Device *device, DeviceScene *dscene, Scene *scene, Mesh *mesh, Progress& progress);
+	/* Evaluate true displacement for the given meshes, returns true if any
+	 * of them was displaced. */
+	bool displace(Device *device, DeviceScene *dscene, Scene *scene, const vector<Mesh*>& meshes, Progress& progress);
 
 	/* attributes */
 	void update_osl_attributes(Device *device, Scene *scene, vector<AttributeRequestSet>& mesh_attributes);
@@ -355,6 +396,13 @@ public:
 	void collect_statistics(const Scene *scene, RenderStats *stats);
 
 protected:
+	/* Attribute memory per storage type, and memory saved by sharing and
+	 * compact storage, for statistics. */
+	size_t attributes_float_size;
+	size_t attributes_float3_size;
+	size_t attributes_uchar4_size;
+	size_t attributes_saved_size;
+
 	/* Calculate verts/triangles/curves offsets in global arrays. */
 	void mesh_calc_offset(Scene *scene);
 
@@ -379,6 +427,8 @@ protected:
 	                       Scene *scene,
 	                       Progress& progress);
 
+	void tessellate_mesh(Mesh *mesh, Progress *progress);
+
 	void device_update_displacement_images(Device *device,
 	                                       Scene *scene,
 	                                       Progress& progress);
@@ -22,7 +22,9 @@
 #include "render/shader.h"
 
 #include "util/util_foreach.h"
+#include "util/util_map.h"
 #include "util/util_progress.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -41,39 +43,39 @@ static float3 compute_face_normal(const Mesh::Triangle& t, float3 *verts)
 	return norm / normlen;
 }
 
-bool MeshManager::displace(Device *device, DeviceScene *dscene, Scene *scene, Mesh *mesh, Progress& progress)
-{
-	/* verify if we have a displacement shader */
-	if(!mesh->has_true_displacement()) {
-		return false;
-	}
+/* Shader inputs for displacing a single mesh. */
+struct DisplaceMesh {
+	Mesh *mesh;
+	int object_index;
 
-	string msg = string_printf("Computing Displacement %s", mesh->name.c_str());
-	progress.set_status("Updating Mesh", msg);
+	/* Shader input and vertex index for every displaced vertex. */
+	vector<uint4> input;
+	vector<int> verts;
 
-	/* find object index. todo: is arbitrary */
-	size_t object_index = OBJECT_NONE;
+	/* Offset of the input in the combined shader evaluation. */
+	size_t offset;
+};
 
-	for(size_t i = 0; i < scene->objects.size(); i++) {
-		if(scene->objects[i]->mesh == mesh) {
-			object_index = i;
-			break;
-		}
-	}
+static Shader *displace_triangle_shader(Scene *scene, Mesh *mesh, size_t tri)
+{
+	int shader_index = mesh->shader[tri];
+	return (shader_index < mesh->used_shaders.size()) ?
+		mesh->used_shaders[shader_index] : scene->default_surface;
+}
 
-	/* setup input for device task */
+static void displace_setup_input(Scene *scene, DisplaceMesh *dmesh)
+{
+	Mesh *mesh = dmesh->mesh;
 	const size_t num_verts = mesh->verts.size();
+	const size_t num_triangles = mesh->num_triangles();
 	vector<bool> done(num_verts, false);
-	device_vector<uint4> d_input(device, "displace_input", MEM_READ_ONLY);
-	uint4 *d_input_data = d_input.alloc(num_verts);
-	size_t d_input_size = 0;
 
-	size_t num_triangles = mesh->num_triangles();
+	dmesh->input.reserve(num_verts);
+	dmesh->verts.reserve(num_verts);
+
 	for(size_t i = 0; i < num_triangles; i++) {
 		Mesh::Triangle t = mesh->get_triangle(i);
-		int shader_index = mesh->shader[i];
-		Shader *shader = (shader_index < mesh->used_shaders.size()) ?
-			mesh->used_shaders[shader_index] : scene->default_surface;
+		Shader *shader = displace_triangle_shader(scene, mesh, i);
 
 		if(!shader->has_displacement || shader->displacement_method == DISPLACE_BUMP) {
 			continue;
@@ -86,7 +88,7 @@ bool MeshManager::displace(Device *device, DeviceScene *dscene, Scene *scene, Me
 			done[t.v[j]] = true;
 
 			/* set up object, primitive and barycentric coordinates */
-			int object = object_index;
+			int object = dmesh->object_index;
 			int prim = mesh->tri_offset + i;
 			float u, v;
 
@@ -107,80 +109,88 @@ bool MeshManager::displace(Device *device, DeviceScene *dscene, Scene *scene, Me
 
 			/* back */
 			uint4 in = make_uint4(object, prim, __float_as_int(u), __float_as_int(v));
-			d_input_data[d_input_size++] = in;
+			dmesh->input.push_back(in);
+			dmesh->verts.push_back(t.v[j]);
 		}
 	}
+}
 
-	if(d_input_size == 0)
-		return false;
-
-	/* run device task */
-	device_vector<float4> d_output(device, "displace_output", MEM_READ_WRITE);
-	d_output.alloc(d_input_size);
-	d_output.zero_to_device();
-	d_input.copy_to_device();
-
-	/* needs to be up to data for attribute access */
-	device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
+static void displace_compute_vertex_normals(Mesh *mesh,
+                                            const vector<bool>& tri_has_true_disp,
+                                            float3 *P,
+                                            float3 *fN,
+                                            float3 *vN)
+{
+	const size_t num_triangles = mesh->num_triangles();
+	const bool flip = mesh->transform_negative_scaled;
 
-	DeviceTask task(DeviceTask::SHADER);
-	task.shader_input = d_input.device_pointer;
-	task.shader_output = d_output.device_pointer;
-	task.shader_eval_type = SHADER_EVAL_DISPLACE;
-	task.shader_x = 0;
-	task.shader_w = d_output.size();
-	task.num_samples = 1;
-	task.get_cancel = function_bind(&Progress::get_cancel, &progress);
+	/* zero vertex normals on triangles with true displacement */
+	for(size_t i = 0; i < num_triangles; i++) {
+		if(tri_has_true_disp[i]) {
+			for(size_t j = 0; j < 3; j++) {
+				vN[mesh->get_triangle(i).v[j]] = make_float3(0.0f, 0.0f, 0.0f);
+			}
+		}
+	}
 
-	device->task_add(task);
-	device->task_wait();
+	/* add face normals to vertex normals, using precomputed face normals
+	 * for the static position and computing them for motion steps */
+	for(size_t i = 0; i < num_triangles; i++) {
+		if(tri_has_true_disp[i]) {
+			Mesh::Triangle t = mesh->get_triangle(i);
+			float3 N = (fN)? fN[i]: compute_face_normal(t, P);
 
-	if(progress.get_cancel()) {
-		d_input.free();
-		d_output.free();
-		return false;
+			for(size_t j = 0; j < 3; j++) {
+				vN[t.v[j]] += N;
+			}
+		}
 	}
 
-	d_output.copy_from_device(0, 1, d_output.size());
-	d_input.free();
+	/* normalize vertex normals */
+	vector<bool> done(mesh->verts.size(), false);
 
-	/* read result */
-	done.clear();
-	done.resize(num_verts, false);
-	int k = 0;
+	for(size_t i = 0; i < num_triangles; i++) {
+		if(tri_has_true_disp[i]) {
+			for(size_t j = 0; j < 3; j++) {
+				int vert = mesh->get_triangle(i).v[j];
 
-	float4 *offset = d_output.data();
+				if(done[vert]) {
+					continue;
+				}
 
-	Attribute *attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-	for(size_t i = 0; i < num_triangles; i++) {
-		Mesh::Triangle t = mesh->get_triangle(i);
-		int shader_index = mesh->shader[i];
-		Shader *shader = (shader_index < mesh->used_shaders.size()) ?
-			mesh->used_shaders[shader_index] : scene->default_surface;
+				vN[vert] = normalize(vN[vert]);
+				if(flip)
+					vN[vert] = -vN[vert];
 
-		if(!shader->has_displacement || shader->displacement_method == DISPLACE_BUMP) {
-			continue;
+				done[vert] = true;
+			}
 		}
+	}
+}
 
-		for(int j = 0; j < 3; j++) {
-			if(!done[t.v[j]]) {
-				done[t.v[j]] = true;
-				float3 off = float4_to_float3(offset[k++]);
-				/* Avoid illegal vertex coordinates. */
-				off = ensure_finite3(off);
-				mesh->verts[t.v[j]] += off;
-				if(attr_mP != NULL) {
-					for(int step = 0; step < mesh->motion_steps - 1; step++) {
-						float3 *mP = attr_mP->data_float3() + step*num_verts;
-						mP[t.v[j]] += off;
-					}
-				}
+static void displace_apply(Scene *scene, DisplaceMesh *dmesh, const float4 *offset)
+{
+	Mesh *mesh = dmesh->mesh;
+	const size_t num_verts = mesh->verts.size();
+	const size_t num_triangles = mesh->num_triangles();
+
+	/* read result */
+	Attribute *attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+
+	for(size_t k = 0; k < dmesh->verts.size(); k++) {
+		int vert = dmesh->verts[k];
+		float3 off = float4_to_float3(offset[k]);
+		/* Avoid illegal vertex coordinates. */
+		off = ensure_finite3(off);
+		mesh->verts[vert] += off;
+		if(attr_mP != NULL) {
+			for(int step = 0; step < mesh->motion_steps - 1; step++) {
+				float3 *mP = attr_mP->data_float3() + step*num_verts;
+				mP[vert] += off;
 			}
 		}
 	}
 
-	d_output.free();
-
 	/* for displacement method both, we only need to recompute the face
 	 * normals, as bump mapping in the shader will already alter the
 	 * vertex normal, so we start from the non-displaced vertex normals
@@ -197,122 +207,179 @@ bool MeshManager::displace(Device *device, DeviceScene *dscene, Scene *scene, Me
 		}
 	}
 
-	if(need_recompute_vertex_normals) {
-		bool flip = mesh->transform_negative_scaled;
-		vector<bool> tri_has_true_disp(num_triangles, false);
+	if(!need_recompute_vertex_normals) {
+		return;
+	}
 
-		for(size_t i = 0; i < num_triangles; i++) {
-			int shader_index = mesh->shader[i];
-			Shader *shader = (shader_index < mesh->used_shaders.size()) ?
-				mesh->used_shaders[shader_index] : scene->default_surface;
+	vector<bool> tri_has_true_disp(num_triangles, false);
 
-			tri_has_true_disp[i] = shader->has_displacement && shader->displacement_method == DISPLACE_TRUE;
-		}
+	for(size_t i = 0; i < num_triangles; i++) {
+		Shader *shader = displace_triangle_shader(scene, mesh, i);
+		tri_has_true_disp[i] = shader->has_displacement && shader->displacement_method == DISPLACE_TRUE;
+	}
 
-		/* static vertex normals */
+	/* static vertex normals */
+	Attribute *attr_fN = mesh->attributes.find(ATTR_STD_FACE_NORMAL);
+	Attribute *attr_vN = mesh->attributes.find(ATTR_STD_VERTEX_NORMAL);
 
-		/* get attributes */
-		Attribute *attr_fN = mesh->attributes.find(ATTR_STD_FACE_NORMAL);
-		Attribute *attr_vN = mesh->attributes.find(ATTR_STD_VERTEX_NORMAL);
+	displace_compute_vertex_normals(mesh,
+	                                tri_has_true_disp,
+	                                mesh->verts.data(),
+	                                attr_fN->data_float3(),
+	                                attr_vN->data_float3());
 
-		float3 *fN = attr_fN->data_float3();
-		float3 *vN = attr_vN->data_float3();
+	/* motion vertex normals */
+	Attribute *attr_mN = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_NORMAL);
 
-		/* compute vertex normals */
+	if(mesh->has_motion_blur() && attr_mP && attr_mN) {
+		for(int step = 0; step < mesh->motion_steps - 1; step++) {
+			float3 *mP = attr_mP->data_float3() + step*num_verts;
+			float3 *mN = attr_mN->data_float3() + step*num_verts;
 
-		/* zero vertex normals on triangles with true displacement */
-		for(size_t i = 0; i < num_triangles; i++) {
-			if(tri_has_true_disp[i]) {
-				for(size_t j = 0; j < 3; j++) {
-					vN[mesh->get_triangle(i).v[j]] = make_float3(0.0f, 0.0f, 0.0f);
-				}
-			}
+			displace_compute_vertex_normals(mesh, tri_has_true_disp, mP, NULL, mN);
 		}
+	}
+}
 
-		/* add face normals to vertex normals */
-		for(size_t i = 0; i < num_triangles; i++) {
-			if(tri_has_true_disp[i]) {
-				for(size_t j = 0; j < 3; j++) {
-					vN[mesh->get_triangle(i).v[j]] += fN[i];
-				}
-			}
+bool MeshManager::displace(Device *device,
+                           DeviceScene *dscene,
+                           Scene *scene,
+                           const vector<Mesh*>& meshes,
+                           Progress& progress)
+{
+	/* find object index. todo: is arbitrary */
+	unordered_map<Mesh*, int> object_index_map;
+
+	for(size_t i = 0; i < scene->objects.size(); i++) {
+		object_index_map.insert(std::make_pair(scene->objects[i]->mesh, (int)i));
+	}
+
+	/* verify if we have a displacement shader */
+	vector<DisplaceMesh> dmeshes;
+
+	foreach(Mesh *mesh, meshes) {
+		if(!mesh->has_true_displacement()) {
+			continue;
 		}
 
-		/* normalize vertex normals */
-		done.clear();
-		done.resize(num_verts, false);
+		unordered_map<Mesh*, int>::iterator it = object_index_map.find(mesh);
 
-		for(size_t i = 0; i < num_triangles; i++) {
-			if(tri_has_true_disp[i]) {
-				for(size_t j = 0; j < 3; j++) {
-					int vert = mesh->get_triangle(i).v[j];
+		DisplaceMesh dmesh;
+		dmesh.mesh = mesh;
+		dmesh.object_index = (it != object_index_map.end())? it->second: OBJECT_NONE;
+		dmesh.offset = 0;
+		dmeshes.push_back(dmesh);
+	}
 
-					if(done[vert]) {
-						continue;
-					}
+	if(dmeshes.size() == 0) {
+		return false;
+	}
 
-					vN[vert] = normalize(vN[vert]);
-					if(flip)
-						vN[vert] = -vN[vert];
+	progress.set_status("Updating Mesh",
+	                    string_printf("Computing Displacement for %u meshes", (uint)dmeshes.size()));
 
-					done[vert] = true;
-				}
-			}
+	/* setup input for device task, in parallel for all meshes */
+	{
+		TaskPool pool;
+
+		for(size_t i = 0; i < dmeshes.size(); i++) {
+			pool.push(function_bind(&displace_setup_input, scene, &dmeshes[i]), false);
 		}
 
-		/* motion vertex normals */
-		Attribute *attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
-		Attribute *attr_mN = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_NORMAL);
+		pool.wait_work();
+	}
 
-		if(mesh->has_motion_blur() && attr_mP && attr_mN) {
-			for(int step = 0; step < mesh->motion_steps - 1; step++) {
-				float3 *mP = attr_mP->data_float3() + step*mesh->verts.size();
-				float3 *mN = attr_mN->data_float3() + step*mesh->verts.size();
-
-				/* compute */
-
-				/* zero vertex normals on triangles with true displacement */
-				for(size_t i = 0; i < num_triangles; i++) {
-					if(tri_has_true_disp[i]) {
-						for(size_t j = 0; j < 3; j++) {
-							mN[mesh->get_triangle(i).v[j]] = make_float3(0.0f, 0.0f, 0.0f);
-						}
-					}
-				}
+	size_t total_size = 0;
 
-				/* add face normals to vertex normals */
-				for(size_t i = 0; i < num_triangles; i++) {
-					if(tri_has_true_disp[i]) {
-						for(size_t j = 0; j < 3; j++) {
-							float3 fN = compute_face_normal(mesh->get_triangle(i), mP);
-							mN[mesh->get_triangle(i).v[j]] += fN;
-						}
-					}
-				}
+	foreach(DisplaceMesh& dmesh, dmeshes) {
+		dmesh.offset = total_size;
+		total_size += dmesh.input.size();
+	}
 
-				/* normalize vertex normals */
-				done.clear();
-				done.resize(num_verts, false);
+	if(total_size == 0)
+		return false;
 
-				for(size_t i = 0; i < num_triangles; i++) {
-					if(tri_has_true_disp[i]) {
-						for(size_t j = 0; j < 3; j++) {
-							int vert = mesh->get_triangle(i).v[j];
+	/* needs to be up to data for attribute access */
+	device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
 
-							if(done[vert]) {
-								continue;
-							}
+	/* Evaluate shaders for all meshes together, split into chunks to limit
+	 * device memory usage. Results are applied to each mesh and its normals
+	 * recomputed as soon as all of its vertices are evaluated, while the
+	 * device is busy with the next chunk. */
+	const size_t max_chunk_size = 1 << 20;
+	vector<float4> offsets(total_size);
 
-							mN[vert] = normalize(mN[vert]);
-							if(flip)
-								mN[vert] = -mN[vert];
+	device_vector<uint4> d_input(device, "displace_input", MEM_READ_ONLY);
+	device_vector<float4> d_output(device, "displace_output", MEM_READ_WRITE);
 
-							done[vert] = true;
-						}
-					}
-				}
+	TaskPool apply_pool;
+	size_t next_mesh = 0;
+
+	for(size_t chunk_start = 0; chunk_start < total_size; chunk_start += max_chunk_size) {
+		size_t chunk_size = min(max_chunk_size, total_size - chunk_start);
+		size_t chunk_end = chunk_start + chunk_size;
+
+		/* gather input of all meshes overlapping this chunk */
+		uint4 *d_input_data = d_input.alloc(chunk_size);
+
+		foreach(DisplaceMesh& dmesh, dmeshes) {
+			size_t start = max(dmesh.offset, chunk_start);
+			size_t end = min(dmesh.offset + dmesh.input.size(), chunk_end);
+
+			if(start < end) {
+				memcpy(d_input_data + (start - chunk_start),
+				       &dmesh.input[start - dmesh.offset],
+				       sizeof(uint4) * (end - start));
 			}
 		}
+
+		/* run device task */
+		d_output.alloc(chunk_size);
+		d_output.zero_to_device();
+		d_input.copy_to_device();
+
+		DeviceTask task(DeviceTask::SHADER);
+		task.shader_input = d_input.device_pointer;
+		task.shader_output = d_output.device_pointer;
+		task.shader_eval_type = SHADER_EVAL_DISPLACE;
+		task.shader_x = 0;
+		task.shader_w = d_output.size();
+		task.num_samples = 1;
+		task.get_cancel = function_bind(&Progress::get_cancel, &progress);
+
+		device->task_add(task);
+		device->task_wait();
+
+		if(progress.get_cancel()) {
+			break;
+		}
+
+		d_output.copy_from_device(0, 1, d_output.size());
+		memcpy(&offsets[chunk_start], d_output.data(), sizeof(float4) * chunk_size);
+
+		/* apply displacement to meshes that are complete now */
+		while(next_mesh < dmeshes.size() &&
+		      dmeshes[next_mesh].offset + dmeshes[next_mesh].input.size() <= chunk_end)
+		{
+			DisplaceMesh& dmesh = dmeshes[next_mesh++];
+
+			if(dmesh.input.size()) {
+				apply_pool.push(function_bind(&displace_apply,
+				                              scene,
+				                              &dmesh,
+				                              &offsets[dmesh.offset]),
+				                false);
+			}
+		}
+	}
+
+	d_input.free();
+	d_output.free();
+
+	apply_pool.wait_work();
+
+	if(progress.get_cancel()) {
+		return false;
 	}
 
 	return true;
@@ -24,6 +24,8 @@
 
 #include "util/util_foreach.h"
 #include "util/util_algorithm.h"
+#include "util/util_md5.h"
+#include "util/util_task.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -339,6 +341,30 @@ struct OsdPatch : Patch {
 
 #endif
 
+static QuadDice::SubPatch make_subpatch(Patch *patch, float u0, float v0, float u1, float v1)
+{
+	QuadDice::SubPatch subpatch;
+
+	subpatch.patch = patch;
+	subpatch.P00 = make_float2(u0, v0);
+	subpatch.P10 = make_float2(u1, v0);
+	subpatch.P01 = make_float2(u0, v1);
+	subpatch.P11 = make_float2(u1, v1);
+
+	return subpatch;
+}
+
+static void split_subpatches(DiagSplit *split,
+                             vector<QuadDice::SubPatch> *subpatches,
+                             size_t start,
+                             size_t end)
+{
+	for(size_t i = start; i < end; i++) {
+		QuadDice::SubPatch& subpatch = (*subpatches)[i];
+		split->split_quad(subpatch.patch, &subpatch);
+	}
+}
+
 void Mesh::tessellate(DiagSplit *split)
 {
 #ifdef WITH_OPENSUBDIV
@@ -369,25 +395,56 @@ void Mesh::tessellate(DiagSplit *split)
 	Attribute *attr_vN = subd_attributes.find(ATTR_STD_VERTEX_NORMAL);
 	float3* vN = attr_vN->data_float3();
 
+	/* Create all patches up front, they need to stay alive while their
+	 * subpatches are split in parallel and diced afterwards. */
+	size_t num_patches = 0;
+	size_t num_subpatches = 0;
+
+	for(int f = 0; f < num_faces; f++) {
+		SubdFace& face = subd_faces[f];
+
+		num_patches += (face.is_quad())? 1: face.num_corners;
+		num_subpatches += (face.is_quad())? 4: face.num_corners;
+	}
+
+	vector<LinearQuadPatch> linear_patches;
+#ifdef WITH_OPENSUBDIV
+	vector<OsdPatch> osd_patches;
+
+	if(subdivision_type == SUBDIVISION_CATMULL_CLARK) {
+		osd_patches.reserve(num_patches);
+	}
+	else
+#endif
+	{
+		linear_patches.reserve(num_patches);
+	}
+
+	vector<QuadDice::SubPatch> subpatches;
+	subpatches.reserve(num_subpatches);
+
 	for(int f = 0; f < num_faces; f++) {
 		SubdFace& face = subd_faces[f];
 
 		if(face.is_quad()) {
 			/* quad */
-			QuadDice::SubPatch subpatch;
+			Patch *patch;
 
-			LinearQuadPatch quad_patch;
 #ifdef WITH_OPENSUBDIV
-			OsdPatch osd_patch(&osd_data);
-
 			if(subdivision_type == SUBDIVISION_CATMULL_CLARK) {
+				osd_patches.push_back(OsdPatch(&osd_data));
+
+				OsdPatch& osd_patch = osd_patches.back();
 				osd_patch.patch_index = face.ptex_offset;
 
-				subpatch.patch = &osd_patch;
+				patch = &osd_patch;
 			}
 			else
 #endif
 			{
+				linear_patches.push_back(LinearQuadPatch());
+
+				LinearQuadPatch& quad_patch = linear_patches.back();
 				float3 *hull = quad_patch.hull;
 				float3 *normals = quad_patch.normals;
 
@@ -412,50 +469,31 @@ void Mesh::tessellate(DiagSplit *split)
 				swap(hull[2], hull[3]);
 				swap(normals[2], normals[3]);
 
-				subpatch.patch = &quad_patch;
+				patch = &quad_patch;
 			}
 
-			subpatch.patch->shader = face.shader;
+			patch->shader = face.shader;
 
 			/* Quad faces need to be split at least once to line up with split ngons, we do this
 			 * here in this manner because if we do it later edge factors may end up slightly off.
 			 */
-			subpatch.P00 = make_float2(0.0f, 0.0f);
-			subpatch.P10 = make_float2(0.5f, 0.0f);
-			subpatch.P01 = make_float2(0.0f, 0.5f);
-			subpatch.P11 = make_float2(0.5f, 0.5f);
-			split->split_quad(subpatch.patch, &subpatch);
-
-			subpatch.P00 = make_float2(0.5f, 0.0f);
-			subpatch.P10 = make_float2(1.0f, 0.0f);
-			subpatch.P01 = make_float2(0.5f, 0.5f);
-			subpatch.P11 = make_float2(1.0f, 0.5f);
-			split->split_quad(subpatch.patch, &subpatch);
-
-			subpatch.P00 = make_float2(0.0f, 0.5f);
-			subpatch.P10 = make_float2(0.5f, 0.5f);
-			subpatch.P01 = make_float2(0.0f, 1.0f);
-			subpatch.P11 = make_float2(0.5f, 1.0f);
-			split->split_quad(subpatch.patch, &subpatch);
-
-			subpatch.P00 = make_float2(0.5f, 0.5f);
-			subpatch.P10 = make_float2(1.0f, 0.5f);
-			subpatch.P01 = make_float2(0.5f, 1.0f);
-			subpatch.P11 = make_float2(1.0f, 1.0f);
-			split->split_quad(subpatch.patch, &subpatch);
+			subpatches.push_back(make_subpatch(patch, 0.0f, 0.0f, 0.5f, 0.5f));
+			subpatches.push_back(make_subpatch(patch, 0.5f, 0.0f, 1.0f, 0.5f));
+			subpatches.push_back(make_subpatch(patch, 0.0f, 0.5f, 0.5f, 1.0f));
+			subpatches.push_back(make_subpatch(patch, 0.5f, 0.5f, 1.0f, 1.0f));
 		}
 		else {
 			/* ngon */
 #ifdef WITH_OPENSUBDIV
 			if(subdivision_type == SUBDIVISION_CATMULL_CLARK) {
-				OsdPatch patch(&osd_data);
-
-				patch.shader = face.shader;
-
 				for(int corner = 0; corner < face.num_corners; corner++) {
+					osd_patches.push_back(OsdPatch(&osd_data));
+
+					OsdPatch& patch = osd_patches.back();
+					patch.shader = face.shader;
 					patch.patch_index = face.ptex_offset + corner;
 
-					split->split_quad(&patch);
+					subpatches.push_back(make_subpatch(&patch, 0.0f, 0.0f, 1.0f, 1.0f));
 				}
 			}
 			else
@@ -471,7 +509,9 @@ void Mesh::tessellate(DiagSplit *split)
 				}
 
 				for(int corner = 0; corner < face.num_corners; corner++) {
-					LinearQuadPatch patch;
+					linear_patches.push_back(LinearQuadPatch());
+
+					LinearQuadPatch& patch = linear_patches.back();
 					float3 *hull = patch.hull;
 					float3 *normals = patch.normals;
 
@@ -503,12 +543,41 @@ void Mesh::tessellate(DiagSplit *split)
 						}
 					}
 
-					split->split_quad(&patch);
+					subpatches.push_back(make_subpatch(&patch, 0.0f, 0.0f, 1.0f, 1.0f));
 				}
 			}
 		}
 	}
 
+	/* Split subpatches in parallel. Each task has its own DiagSplit, and the
+	 * results are diced in the original order afterwards so that the resulting
+	 * vertices and triangles do not depend on thread scheduling. */
+	const size_t chunk_size = 64;
+	size_t num_chunks = divide_up(subpatches.size(), chunk_size);
+	vector<DiagSplit> splits(num_chunks, DiagSplit(split->params));
+
+	if(num_chunks > 1) {
+		TaskPool pool;
+
+		for(size_t i = 0; i < num_chunks; i++) {
+			pool.push(function_bind(&split_subpatches,
+			                        &splits[i],
+			                        &subpatches,
+			                        i * chunk_size,
+			                        min((i + 1) * chunk_size, subpatches.size())),
+			          false);
+		}
+
+		pool.wait_work();
+	}
+	else if(num_chunks == 1) {
+		split_subpatches(&splits[0], &subpatches, 0, subpatches.size());
+	}
+
+	for(size_t i = 0; i < num_chunks; i++) {
+		splits[i].dice_quads();
+	}
+
 	/* interpolate center points for attributes */
 	foreach(Attribute& attr, subd_attributes.attributes) {
 #ifdef WITH_OPENSUBDIV
@@ -612,4 +681,295 @@ void Mesh::tessellate(DiagSplit *split)
 #endif
 }
 
+/* Tessellation Cache */
+
+struct TessellationCache::Entry {
+	array<float3> verts;
+	array<int> triangles;
+	array<int> shader;
+	array<bool> smooth;
+	array<int> triangle_patch;
+	array<float2> vert_patch_uv;
+
+	list<Attribute> attributes;
+	list<Attribute> subd_attributes;
+
+	PackedPatchTable *patch_table;
+	Mesh::SubdivisionType subdivision_type;
+	size_t num_subd_verts;
+
+	size_t memory_size;
+	uint64_t last_used;
+
+	Entry()
+	: patch_table(NULL),
+	  subdivision_type(Mesh::SUBDIVISION_NONE),
+	  num_subd_verts(0),
+	  memory_size(0),
+	  last_used(0)
+	{
+	}
+
+	~Entry()
+	{
+		delete patch_table;
+	}
+};
+
+static void md5_append_data(MD5Hash& md5, const void *data, size_t size)
+{
+	const uint8_t *bytes = (const uint8_t*)data;
+	const size_t max_chunk = (size_t)1 << 30;
+
+	while(size > 0) {
+		size_t chunk = min(size, max_chunk);
+		md5.append(bytes, (int)chunk);
+		bytes += chunk;
+		size -= chunk;
+	}
+}
+
+template<typename T>
+static void md5_append_array(MD5Hash& md5, const array<T>& data)
+{
+	md5_append_data(md5, data.data(), data.size() * sizeof(T));
+}
+
+template<typename T>
+static void md5_append_value(MD5Hash& md5, const T& value)
+{
+	md5_append_data(md5, &value, sizeof(T));
+}
+
+/* Drop the lowest mantissa bits, so that tiny changes to the dicing camera
+ * fall into the same bucket and reuse the existing tessellation. */
+static void md5_append_quantized(MD5Hash& md5, const float *data, int num)
+{
+	for(int i = 0; i < num; i++) {
+		uint bits = __float_as_uint(data[i]) & 0xFFFFF000u;
+		md5_append_value(md5, bits);
+	}
+}
+
+static void md5_append_attributes(MD5Hash& md5, const AttributeSet& attributes)
+{
+	foreach(const Attribute& attr, attributes.attributes) {
+		/* Voxel data is not used for tessellation. */
+		if(attr.element == ATTR_ELEMENT_VOXEL) {
+			continue;
+		}
+
+		md5.append(attr.name.string());
+		md5_append_value(md5, (int)attr.std);
+		md5_append_value(md5, (int)attr.element);
+		md5_append_value(md5, attr.flags);
+		md5_append_data(md5, attr.buffer.data(), attr.buffer.size());
+	}
+}
+
+static size_t attributes_memory_size(const list<Attribute>& attributes)
+{
+	size_t size = 0;
+	foreach(const Attribute& attr, attributes) {
+		size += attr.buffer.size();
+	}
+	return size;
+}
+
+/* Voxel attributes own image slots in the image manager, so they are never
+ * copied into or out of the cache and stay on the mesh instead. */
+static void copy_non_voxel_attributes(const list<Attribute>& from, list<Attribute>& to)
+{
+	list<Attribute>::iterator it = to.begin();
+	while(it != to.end()) {
+		if(it->element != ATTR_ELEMENT_VOXEL) {
+			it = to.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	foreach(const Attribute& attr, from) {
+		if(attr.element != ATTR_ELEMENT_VOXEL) {
+			to.push_back(attr);
+		}
+	}
+}
+
+TessellationCache::TessellationCache()
+{
+	memory_limit = (size_t)512 * 1024 * 1024;
+	memory_used = 0;
+	use_counter = 0;
+}
+
+TessellationCache::~TessellationCache()
+{
+	clear();
+}
+
+string TessellationCache::compute_key(Mesh *mesh)
+{
+	MD5Hash md5;
+
+	/* Control mesh. */
+	md5_append_value(md5, (int)mesh->subdivision_type);
+	md5_append_array(md5, mesh->verts);
+	md5_append_array(md5, mesh->subd_face_corners);
+	md5_append_array(md5, mesh->subd_creases);
+
+	/* Hash face members individually, the struct has padding. */
+	for(size_t i = 0; i < mesh->subd_faces.size(); i++) {
+		const Mesh::SubdFace& face = mesh->subd_faces[i];
+		int data[5] = {face.start_corner,
+		               face.num_corners,
+		               face.shader,
+		               (int)face.smooth,
+		               face.ptex_offset};
+		md5_append_data(md5, data, sizeof(data));
+	}
+
+	md5_append_attributes(md5, mesh->attributes);
+	md5_append_attributes(md5, mesh->subd_attributes);
+
+	/* Dicing settings. */
+	const SubdParams& params = *mesh->subd_params;
+
+	md5_append_value(md5, (int)params.ptex);
+	md5_append_value(md5, params.test_steps);
+	md5_append_value(md5, params.split_threshold);
+	md5_append_value(md5, params.dicing_rate);
+	md5_append_value(md5, params.max_level);
+
+	/* Dicing camera bucket. */
+	if(params.camera) {
+		const Camera *cam = params.camera;
+
+		md5_append_value(md5, (int)cam->type);
+		md5_append_value(md5, cam->width);
+		md5_append_value(md5, cam->height);
+		md5_append_value(md5, cam->offscreen_dicing_scale);
+
+		md5_append_quantized(md5, (const float*)&params.objecttoworld, sizeof(Transform) / sizeof(float));
+		md5_append_quantized(md5, (const float*)&cam->worldtocamera, sizeof(Transform) / sizeof(float));
+		md5_append_quantized(md5, (const float*)&cam->rastertocamera, sizeof(ProjectionTransform) / sizeof(float));
+		md5_append_quantized(md5, &cam->full_dx.x, 3);
+		md5_append_quantized(md5, &cam->full_dy.x, 3);
+	}
+
+	return md5.get_hex();
+}
+
+bool TessellationCache::lookup(const string& key, Mesh *mesh)
+{
+	thread_scoped_lock lock(mutex);
+
+	unordered_map<string, Entry*>::iterator it = entries.find(key);
+	if(it == entries.end()) {
+		return false;
+	}
+
+	Entry *entry = it->second;
+	entry->last_used = ++use_counter;
+
+	mesh->subdivision_type = entry->subdivision_type;
+	mesh->verts = entry->verts;
+	mesh->triangles = entry->triangles;
+	mesh->shader = entry->shader;
+	mesh->smooth = entry->smooth;
+	mesh->triangle_patch = entry->triangle_patch;
+	mesh->vert_patch_uv = entry->vert_patch_uv;
+	mesh->num_subd_verts = entry->num_subd_verts;
+
+	copy_non_voxel_attributes(entry->attributes, mesh->attributes.attributes);
+	copy_non_voxel_attributes(entry->subd_attributes, mesh->subd_attributes.attributes);
+
+	delete mesh->patch_table;
+	mesh->patch_table = NULL;
+
+	if(entry->patch_table) {
+		mesh->patch_table = new PackedPatchTable(*entry->patch_table);
+	}
+
+	return true;
+}
+
+void TessellationCache::insert(const string& key, Mesh *mesh)
+{
+	Entry *entry = new Entry();
+
+	entry->subdivision_type = mesh->subdivision_type;
+	entry->verts = mesh->verts;
+	entry->triangles = mesh->triangles;
+	entry->shader = mesh->shader;
+	entry->smooth = mesh->smooth;
+	entry->triangle_patch = mesh->triangle_patch;
+	entry->vert_patch_uv = mesh->vert_patch_uv;
+	entry->num_subd_verts = mesh->num_subd_verts;
+
+	copy_non_voxel_attributes(mesh->attributes.attributes, entry->attributes);
+	copy_non_voxel_attributes(mesh->subd_attributes.attributes, entry->subd_attributes);
+
+	if(mesh->patch_table) {
+		entry->patch_table = new PackedPatchTable(*mesh->patch_table);
+	}
+
+	entry->memory_size = entry->verts.size() * sizeof(float3) +
+	                     entry->triangles.size() * sizeof(int) +
+	                     entry->shader.size() * sizeof(int) +
+	                     entry->smooth.size() * sizeof(bool) +
+	                     entry->triangle_patch.size() * sizeof(int) +
+	                     entry->vert_patch_uv.size() * sizeof(float2) +
+	                     attributes_memory_size(entry->attributes) +
+	                     attributes_memory_size(entry->subd_attributes);
+
+	if(entry->patch_table) {
+		entry->memory_size += entry->patch_table->table.size() * sizeof(uint);
+	}
+
+	thread_scoped_lock lock(mutex);
+
+	if(entry->memory_size > memory_limit || entries.find(key) != entries.end()) {
+		delete entry;
+		return;
+	}
+
+	evict(entry->memory_size);
+
+	entry->last_used = ++use_counter;
+	entries[key] = entry;
+	memory_used += entry->memory_size;
+}
+
+void TessellationCache::evict(size_t needed)
+{
+	/* Remove least recently used entries until the new entry fits. */
+	while(entries.size() && memory_used + needed > memory_limit) {
+		unordered_map<string, Entry*>::iterator oldest = entries.begin();
+
+		for(unordered_map<string, Entry*>::iterator it = entries.begin(); it != entries.end(); ++it) {
+			if(it->second->last_used < oldest->second->last_used) {
+				oldest = it;
+			}
+		}
+
+		memory_used -= oldest->second->memory_size;
+		delete oldest->second;
+		entries.erase(oldest);
+	}
+}
+
+void TessellationCache::clear()
+{
+	thread_scoped_lock lock(mutex);
+
+	for(unordered_map<string, Entry*>::iterator it = entries.begin(); it != entries.end(); ++it) {
+		delete it->second;
+	}
+
+	entries.clear();
+	memory_used = 0;
+}
+
 CCL_NAMESPACE_END
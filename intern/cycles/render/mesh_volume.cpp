@@ -21,6 +21,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_sparse_grid.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -357,6 +358,27 @@ void VolumeMeshBuilder::convert_quads_to_tris(const vector<QuadData> &quads,
 struct VoxelAttributeGrid {
 	float *data;
 	int channels;
+	/* Tile index table for sparse grids, NULL for dense grids. */
+	const int *tile_indices;
+
+	size_t voxel_index(const int3 &resolution, int x, int y, int z) const
+	{
+		if(tile_indices) {
+			return sparse_grid_voxel_index(tile_indices,
+			                               x, y, z,
+			                               resolution.x, resolution.y);
+		}
+		return compute_voxel_index(resolution, x, y, z);
+	}
+
+	/* Check whether the tile containing given voxel is known to be empty. */
+	bool tile_is_empty(const int3 &resolution, int x, int y, int z) const
+	{
+		return tile_indices &&
+		       tile_indices[sparse_grid_tile_index(x, y, z,
+		                                           resolution.x,
+		                                           resolution.y)] == 0;
+	}
 };
 
 void MeshManager::create_volume_mesh(Scene *scene,
@@ -394,6 +416,10 @@ void MeshManager::create_volume_mesh(Scene *scene,
 		VoxelAttributeGrid voxel_grid;
 		voxel_grid.data = static_cast<float*>(image_memory->host_pointer);
 		voxel_grid.channels = image_memory->data_elements;
+		voxel_grid.tile_indices = (image_memory->grid_info_offset)?
+			(const int*)((char*)image_memory->host_pointer +
+			             image_memory->memory_elements_size(image_memory->grid_info_offset)):
+			NULL;
 		voxel_grids.push_back(voxel_grid);
 	}
 
@@ -449,19 +475,43 @@ void MeshManager::create_volume_mesh(Scene *scene,
 	VolumeMeshBuilder builder(&volume_params);
 	const float isovalue = mesh->volume_isovalue;
 
-	for(int z = 0; z < resolution.z; ++z) {
-		for(int y = 0; y < resolution.y; ++y) {
-			for(int x = 0; x < resolution.x; ++x) {
-				size_t voxel_index = compute_voxel_index(resolution, x, y, z);
+	/* Process voxels tile by tile, so tiles which are empty in all sparse
+	 * grids can be skipped without looking at their voxels. Empty voxels are
+	 * zero, so they can only be skipped for a positive isovalue. */
+	const int tile_size = TEX_SPARSE_TILE_SIZE;
+
+	for(int tz = 0; tz < resolution.z; tz += tile_size) {
+		for(int ty = 0; ty < resolution.y; ty += tile_size) {
+			for(int tx = 0; tx < resolution.x; tx += tile_size) {
+				bool tile_is_empty = (isovalue > 0.0f);
 
-				for(size_t i = 0; i < voxel_grids.size(); ++i) {
-					const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
-					const int channels = voxel_grid.channels;
+				for(size_t i = 0; i < voxel_grids.size() && tile_is_empty; ++i) {
+					tile_is_empty = voxel_grids[i].tile_is_empty(resolution, tx, ty, tz);
+				}
+
+				if(tile_is_empty) {
+					continue;
+				}
 
-					for(int c = 0; c < channels; c++) {
-						if(voxel_grid.data[voxel_index * channels + c] >= isovalue) {
-							builder.add_node_with_padding(x, y, z);
-							break;
+				const int z_end = min(tz + tile_size, resolution.z);
+				const int y_end = min(ty + tile_size, resolution.y);
+				const int x_end = min(tx + tile_size, resolution.x);
+
+				for(int z = tz; z < z_end; ++z) {
+					for(int y = ty; y < y_end; ++y) {
+						for(int x = tx; x < x_end; ++x) {
+							for(size_t i = 0; i < voxel_grids.size(); ++i) {
+								const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
+								const int channels = voxel_grid.channels;
+								const size_t voxel_index = voxel_grid.voxel_index(resolution, x, y, z);
+
+								for(int c = 0; c < channels; c++) {
+									if(voxel_grid.data[voxel_index * channels + c] >= isovalue) {
+										builder.add_node_with_padding(x, y, z);
+										break;
+									}
+								}
+							}
 						}
 					}
 				}
@@ -30,6 +30,7 @@
 #include "util/util_sky_model.h"
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_md5.h"
 #include "util/util_transform.h"
 
 CCL_NAMESPACE_BEGIN
@@ -277,6 +278,12 @@ ShaderNode *ImageTextureNode::clone() const
 	return node;
 }
 
+void ImageTextureNode::hash_extra(MD5Hash& md5)
+{
+	md5.append((uint8_t*)&builtin_data, sizeof(builtin_data));
+	md5.append((uint8_t*)&animated, sizeof(animated));
+}
+
 void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attributes)
 {
 #ifdef WITH_PTEX
@@ -474,6 +481,12 @@ ShaderNode *EnvironmentTextureNode::clone() const
 	return node;
 }
 
+void EnvironmentTextureNode::hash_extra(MD5Hash& md5)
+{
+	md5.append((uint8_t*)&builtin_data, sizeof(builtin_data));
+	md5.append((uint8_t*)&animated, sizeof(animated));
+}
+
 void EnvironmentTextureNode::attributes(Shader *shader, AttributeRequestSet *attributes)
 {
 #ifdef WITH_PTEX
@@ -1511,6 +1524,11 @@ ShaderNode *PointDensityTextureNode::clone() const
 	return node;
 }
 
+void PointDensityTextureNode::hash_extra(MD5Hash& md5)
+{
+	md5.append((uint8_t*)&builtin_data, sizeof(builtin_data));
+}
+
 void PointDensityTextureNode::attributes(Shader *shader,
                                          AttributeRequestSet *attributes)
 {
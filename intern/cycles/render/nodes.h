@@ -107,6 +107,7 @@ public:
 		       builtin_data == image_node.builtin_data &&
 		       animated == image_node.animated;
 	}
+	virtual void hash_extra(MD5Hash& md5);
 };
 
 class EnvironmentTextureNode : public ImageSlotTextureNode {
@@ -137,6 +138,7 @@ public:
 		       builtin_data == env_node.builtin_data &&
 		       animated == env_node.animated;
 	}
+	virtual void hash_extra(MD5Hash& md5);
 };
 
 class SkyTextureNode : public TextureNode {
@@ -285,6 +287,7 @@ public:
 		return ShaderNode::equals(other) &&
 		       builtin_data == point_dendity_node.builtin_data;
 	}
+	virtual void hash_extra(MD5Hash& md5);
 };
 
 class IESLightNode : public TextureNode {
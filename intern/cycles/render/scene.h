@@ -168,6 +168,8 @@ public:
 	int num_bvh_time_steps;
 	bool persistent_data;
 	int texture_limit;
+	/* Store texture coordinates, normals and tangents with reduced precision. */
+	bool use_compact_attributes;
 
 	SceneParams()
 	{
@@ -179,6 +181,7 @@ public:
 		num_bvh_time_steps = 0;
 		persistent_data = false;
 		texture_limit = 0;
+		use_compact_attributes = false;
 	}
 
 	bool modified(const SceneParams& params)
@@ -189,7 +192,8 @@ public:
 		&& use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes
 		&& num_bvh_time_steps == params.num_bvh_time_steps
 		&& persistent_data == params.persistent_data
-		&& texture_limit == params.texture_limit); }
+		&& texture_limit == params.texture_limit
+		&& use_compact_attributes == params.use_compact_attributes); }
 };
 
 /* Scene */
@@ -0,0 +1,588 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "graph/node_binary.h"
+
+#include "render/background.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/graph.h"
+#include "render/integrator.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/scene_binary.h"
+#include "render/shader.h"
+
+#include "subd/subd_dice.h"
+
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* File layout, in this order:
+ *
+ * header:      magic, version, sizeof(float3), sizeof(Transform)
+ * shaders:     count, then per shader its sockets and graph nodes and links
+ * background, film, integrator, camera
+ * meshes:      count, then per mesh its sockets, shaders, subdivision data
+ *              and attributes
+ * objects:     count, then per object its sockets
+ * lights:      count, then per light its sockets
+ *
+ * Nodes are written before anything referencing them, so references can be
+ * stored as indices. */
+static const uint SCENE_BINARY_MAGIC = 0x42535943; /* "CYSB" */
+static const uint SCENE_BINARY_VERSION = 1;
+
+/* Shaders */
+
+static void write_shader_graph(BinaryWriter& writer, ShaderGraph *graph)
+{
+	/* Shader nodes can only link to nodes in the same graph, they use their
+	 * own index space. */
+	vector<ShaderNode*> nodes;
+	map<ShaderNode*, int> node_index;
+
+	foreach(ShaderNode *node, graph->nodes) {
+		if(node->special_type != SHADER_SPECIAL_TYPE_OUTPUT &&
+		   NodeType::find(node->type->name) != node->type)
+		{
+			VLOG(1) << "Shader node " << node->name << " of type " << node->type->name
+			        << " can't be stored in binary scene, skipping it.";
+			continue;
+		}
+
+		if(node->type->name == "image_texture" && ((ImageTextureNode*)node)->builtin_data) {
+			VLOG(1) << "Builtin image " << ((ImageTextureNode*)node)->filename
+			        << " is stored by name only.";
+		}
+		else if(node->type->name == "environment_texture" && ((EnvironmentTextureNode*)node)->builtin_data) {
+			VLOG(1) << "Builtin image " << ((EnvironmentTextureNode*)node)->filename
+			        << " is stored by name only.";
+		}
+
+		node_index[node] = (int)nodes.size();
+		nodes.push_back(node);
+	}
+
+	writer.write_uint((uint)nodes.size());
+	foreach(ShaderNode *node, nodes) {
+		writer.write_string(node->type->name);
+		binary_write_node(writer, node);
+	}
+
+	uint num_links = 0;
+	foreach(ShaderNode *node, nodes) {
+		foreach(ShaderInput *input, node->inputs) {
+			if(input->link && node_index.find(input->link->parent) != node_index.end()) {
+				num_links++;
+			}
+		}
+	}
+
+	writer.write_uint(num_links);
+	foreach(ShaderNode *node, nodes) {
+		foreach(ShaderInput *input, node->inputs) {
+			ShaderOutput *output = input->link;
+			if(output && node_index.find(output->parent) != node_index.end()) {
+				writer.write_int(node_index[output->parent]);
+				writer.write_string(output->name());
+				writer.write_int(node_index[node]);
+				writer.write_string(input->name());
+			}
+		}
+	}
+}
+
+static ShaderGraph *read_shader_graph(BinaryReader& reader)
+{
+	ShaderGraph *graph = new ShaderGraph();
+	vector<ShaderNode*> nodes;
+
+	uint num_nodes = reader.read_uint();
+	for(uint i = 0; i < num_nodes && !reader.error; i++) {
+		ustring type_name = reader.read_string();
+		const NodeType *node_type = NodeType::find(type_name);
+
+		if(!node_type || node_type->type != NodeType::SHADER) {
+			VLOG(1) << "Unknown shader node type " << type_name << " in binary scene.";
+			reader.error = true;
+			break;
+		}
+
+		/* The output node always exists in the graph. */
+		ShaderNode *node = (type_name == "output")? graph->output():
+		                                            (ShaderNode*)node_type->create(node_type);
+		binary_read_node(reader, node);
+
+		if(node != graph->output()) {
+			graph->add(node);
+		}
+
+		nodes.push_back(node);
+	}
+
+	uint num_links = reader.read_uint();
+	for(uint i = 0; i < num_links && !reader.error; i++) {
+		int from_index = reader.read_int();
+		ustring from_name = reader.read_string();
+		int to_index = reader.read_int();
+		ustring to_name = reader.read_string();
+
+		if(from_index < 0 || from_index >= (int)nodes.size() ||
+		   to_index < 0 || to_index >= (int)nodes.size())
+		{
+			reader.error = true;
+			break;
+		}
+
+		ShaderOutput *output = nodes[from_index]->output(from_name);
+		ShaderInput *input = nodes[to_index]->input(to_name);
+
+		if(output && input) {
+			graph->connect(output, input);
+		}
+	}
+
+	return graph;
+}
+
+/* Meshes */
+
+static void write_attributes(BinaryWriter& writer, const AttributeSet& attributes)
+{
+	uint num_attributes = 0;
+	foreach(const Attribute& attr, attributes.attributes) {
+		if(attr.element != ATTR_ELEMENT_VOXEL) {
+			num_attributes++;
+		}
+	}
+
+	writer.write_uint(num_attributes);
+
+	foreach(const Attribute& attr, attributes.attributes) {
+		if(attr.element == ATTR_ELEMENT_VOXEL) {
+			/* Voxel attributes refer to image slots that are not stored. */
+			continue;
+		}
+
+		writer.write_string(attr.name);
+		writer.write_int((int)attr.std);
+		writer.write_int((int)attr.type.basetype);
+		writer.write_int((int)attr.type.aggregate);
+		writer.write_int((int)attr.type.vecsemantics);
+		writer.write_int(attr.type.arraylen);
+		writer.write_int((int)attr.element);
+		writer.write_uint(attr.flags);
+		writer.write_uint((uint)attr.buffer.size());
+		writer.write_aligned_data(attr.data(), attr.buffer.size());
+	}
+}
+
+static bool attribute_type_is_valid(TypeDesc type)
+{
+	return (type == TypeDesc::TypeFloat || type == TypeDesc::TypeColor ||
+	        type == TypeDesc::TypePoint || type == TypeDesc::TypeVector ||
+	        type == TypeDesc::TypeNormal || type == TypeDesc::TypeMatrix);
+}
+
+static void read_attributes(BinaryReader& reader,
+                            Mesh *mesh,
+                            AttributeSet& attributes,
+                            AttributePrimitive prim)
+{
+	uint num_attributes = reader.read_uint();
+
+	for(uint i = 0; i < num_attributes && !reader.error; i++) {
+		ustring name = reader.read_string();
+		int std = reader.read_int();
+		int basetype = reader.read_int();
+		int aggregate = reader.read_int();
+		int vecsemantics = reader.read_int();
+		int arraylen = reader.read_int();
+		int element = reader.read_int();
+		uint flags = reader.read_uint();
+		uint size = reader.read_uint();
+		const uint8_t *data = reader.read_aligned_data(size);
+
+		if(reader.error) {
+			break;
+		}
+
+		/* Types and elements the writer never stores are rejected before using
+		 * them for sizes, voxel attributes are not stored. */
+		TypeDesc type((TypeDesc::BASETYPE)basetype,
+		              (TypeDesc::AGGREGATE)aggregate,
+		              (TypeDesc::VECSEMANTICS)vecsemantics,
+		              arraylen);
+		if(std < ATTR_STD_NONE || std >= ATTR_STD_NUM ||
+		   element <= ATTR_ELEMENT_NONE || element >= ATTR_ELEMENT_VOXEL ||
+		   !attribute_type_is_valid(type))
+		{
+			VLOG(1) << "Invalid attribute " << name << " in binary scene.";
+			reader.error = true;
+			break;
+		}
+
+		Attribute *attr = attributes.add(name, type, (AttributeElement)element);
+		attr->std = (AttributeStandard)std;
+		attr->flags = flags;
+
+		/* Final size attributes take their size from the data. */
+		size_t data_sizeof = attr->data_sizeof();
+		size_t expected_size = (flags & ATTR_FINAL_SIZE)? size - size % data_sizeof:
+		                                                  attr->buffer_size(mesh, prim);
+		if(size != expected_size) {
+			VLOG(1) << "Attribute " << name << " in binary scene has " << size
+			        << " bytes, expected " << expected_size << ".";
+			attributes.remove(name);
+			reader.error = true;
+			break;
+		}
+
+		attr->buffer.assign((const char*)data, (const char*)data + size);
+	}
+}
+
+static void write_mesh(BinaryWriter& writer, Mesh *mesh)
+{
+	binary_write_node(writer, mesh);
+
+	writer.write_int(mesh->geometry_flags);
+	writer.write_float(mesh->volume_isovalue);
+
+	writer.write_uint((uint)mesh->used_shaders.size());
+	foreach(Shader *shader, mesh->used_shaders) {
+		writer.write_node_ref(shader);
+	}
+
+	writer.write_int((int)mesh->subdivision_type);
+	writer.write_array(mesh->subd_faces);
+	writer.write_array(mesh->subd_face_corners);
+	writer.write_int(mesh->num_ngons);
+	writer.write_array(mesh->subd_creases);
+
+	writer.write_int(mesh->subd_params != NULL);
+	if(mesh->subd_params) {
+		writer.write_float(mesh->subd_params->dicing_rate);
+		writer.write_int(mesh->subd_params->max_level);
+		writer.write_data(&mesh->subd_params->objecttoworld, sizeof(Transform));
+	}
+
+	write_attributes(writer, mesh->attributes);
+	write_attributes(writer, mesh->curve_attributes);
+	write_attributes(writer, mesh->subd_attributes);
+}
+
+/* Indices are used without bounds checks when building the device arrays,
+ * a corrupt file must not get that far. */
+static bool mesh_indices_are_valid(const Mesh *mesh)
+{
+	const size_t num_verts = mesh->verts.size();
+	const size_t num_shaders = mesh->used_shaders.size();
+	const size_t num_triangles = mesh->num_triangles();
+
+	if(mesh->triangles.size() != num_triangles * 3 ||
+	   mesh->shader.size() != num_triangles ||
+	   mesh->smooth.size() != num_triangles)
+	{
+		return false;
+	}
+
+	for(size_t i = 0; i < mesh->triangles.size(); i++) {
+		if(mesh->triangles[i] < 0 || (size_t)mesh->triangles[i] >= num_verts) {
+			return false;
+		}
+	}
+
+	for(size_t i = 0; i < num_triangles; i++) {
+		if(mesh->shader[i] < 0 || (size_t)mesh->shader[i] >= num_shaders) {
+			return false;
+		}
+	}
+
+	const size_t num_curves = mesh->curve_first_key.size();
+	if(mesh->curve_shader.size() != num_curves ||
+	   mesh->curve_radius.size() != mesh->curve_keys.size())
+	{
+		return false;
+	}
+
+	for(size_t i = 0; i < num_curves; i++) {
+		int first_key = mesh->curve_first_key[i];
+		int last_key = (i + 1 < num_curves)? mesh->curve_first_key[i + 1]:
+		                                     (int)mesh->curve_keys.size();
+		if(first_key < 0 || first_key >= last_key || (size_t)last_key > mesh->curve_keys.size() ||
+		   mesh->curve_shader[i] < 0 || (size_t)mesh->curve_shader[i] >= num_shaders)
+		{
+			return false;
+		}
+	}
+
+	const size_t num_corners = mesh->subd_face_corners.size();
+
+	for(size_t i = 0; i < mesh->subd_faces.size(); i++) {
+		const Mesh::SubdFace& face = mesh->subd_faces[i];
+		if(face.start_corner < 0 || face.num_corners < 3 ||
+		   (size_t)face.start_corner + (size_t)face.num_corners > num_corners ||
+		   face.shader < 0 || (size_t)face.shader >= num_shaders)
+		{
+			return false;
+		}
+	}
+
+	for(size_t i = 0; i < num_corners; i++) {
+		if(mesh->subd_face_corners[i] < 0 || (size_t)mesh->subd_face_corners[i] >= num_verts) {
+			return false;
+		}
+	}
+
+	for(size_t i = 0; i < mesh->subd_creases.size(); i++) {
+		const Mesh::SubdEdgeCrease& crease = mesh->subd_creases[i];
+		if(crease.v[0] < 0 || (size_t)crease.v[0] >= num_verts ||
+		   crease.v[1] < 0 || (size_t)crease.v[1] >= num_verts)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool read_mesh(BinaryReader& reader, Mesh *mesh)
+{
+	binary_read_node(reader, mesh);
+
+	mesh->geometry_flags = reader.read_int();
+	mesh->volume_isovalue = reader.read_float();
+
+	uint num_shaders = reader.read_uint();
+	for(uint i = 0; i < num_shaders && !reader.error; i++) {
+		Shader *shader = (Shader*)reader.read_node_ref(Shader::node_type);
+		if(shader) {
+			mesh->used_shaders.push_back(shader);
+		}
+	}
+
+	mesh->subdivision_type = (Mesh::SubdivisionType)reader.read_int();
+	reader.read_array(mesh->subd_faces);
+	reader.read_array(mesh->subd_face_corners);
+	mesh->num_ngons = reader.read_int();
+	reader.read_array(mesh->subd_creases);
+
+	if(reader.read_int()) {
+		mesh->subd_params = new SubdParams(mesh);
+		mesh->subd_params->dicing_rate = reader.read_float();
+		mesh->subd_params->max_level = reader.read_int();
+		reader.read_data(&mesh->subd_params->objecttoworld, sizeof(Transform));
+	}
+
+	if(reader.error) {
+		return false;
+	}
+
+	if(!mesh_indices_are_valid(mesh)) {
+		VLOG(1) << "Mesh " << mesh->name << " in binary scene has invalid indices.";
+		return false;
+	}
+
+	read_attributes(reader, mesh, mesh->attributes, ATTR_PRIM_TRIANGLE);
+	read_attributes(reader, mesh, mesh->curve_attributes, ATTR_PRIM_CURVE);
+	read_attributes(reader, mesh, mesh->subd_attributes, ATTR_PRIM_SUBD);
+
+	return !reader.error;
+}
+
+/* Scene */
+
+bool scene_write_binary(Scene *scene, const string& filepath)
+{
+	BinaryWriter writer;
+
+	writer.write_uint(SCENE_BINARY_MAGIC);
+	writer.write_uint(SCENE_BINARY_VERSION);
+	writer.write_uint(sizeof(float3));
+	writer.write_uint(sizeof(Transform));
+
+	writer.write_uint((uint)scene->shaders.size());
+	foreach(Shader *shader, scene->shaders) {
+		binary_write_node(writer, shader);
+		write_shader_graph(writer, shader->graph);
+		writer.add_node(shader);
+	}
+
+	binary_write_node(writer, scene->background);
+	binary_write_node(writer, scene->film);
+	binary_write_node(writer, scene->integrator);
+
+	Camera *cam = scene->camera;
+	binary_write_node(writer, cam);
+	writer.write_int(cam->width);
+	writer.write_int(cam->height);
+	writer.write_int(cam->full_width);
+	writer.write_int(cam->full_height);
+	writer.write_int(cam->use_spherical_stereo);
+	writer.write_int(cam->use_perspective_motion);
+
+	writer.write_uint((uint)scene->meshes.size());
+	foreach(Mesh *mesh, scene->meshes) {
+		write_mesh(writer, mesh);
+		writer.add_node(mesh);
+	}
+
+	writer.write_uint((uint)scene->objects.size());
+	foreach(Object *object, scene->objects) {
+		binary_write_node(writer, object);
+		writer.write_string(object->asset_name);
+	}
+
+	writer.write_uint((uint)scene->lights.size());
+	foreach(Light *light, scene->lights) {
+		binary_write_node(writer, light);
+	}
+
+	if(!path_write_binary(filepath, writer.data)) {
+		VLOG(1) << "Failed to write binary scene " << filepath << ".";
+		return false;
+	}
+
+	VLOG(1) << "Wrote binary scene " << filepath << ", "
+	        << string_human_readable_size(writer.data.size()) << ".";
+
+	return true;
+}
+
+static bool scene_read_header(BinaryReader& reader)
+{
+	return (reader.read_uint() == SCENE_BINARY_MAGIC) &&
+	       (reader.read_uint() == SCENE_BINARY_VERSION) &&
+	       (reader.read_uint() == sizeof(float3)) &&
+	       (reader.read_uint() == sizeof(Transform)) &&
+	       !reader.error;
+}
+
+bool scene_is_binary(const string& filepath)
+{
+	FILE *f = path_fopen(filepath, "rb");
+	if(!f) {
+		return false;
+	}
+
+	uint magic = 0;
+	bool is_binary = (fread(&magic, sizeof(magic), 1, f) == 1) && (magic == SCENE_BINARY_MAGIC);
+	fclose(f);
+
+	return is_binary;
+}
+
+bool scene_read_binary(Scene *scene, const string& filepath)
+{
+	/* Read the whole file at once, arrays are then copied out of the buffer
+	 * in single blocks. */
+	vector<uint8_t> data;
+	if(!path_read_binary(filepath, data)) {
+		VLOG(1) << "Failed to read binary scene " << filepath << ".";
+		return false;
+	}
+
+	BinaryReader reader(data);
+	if(!scene_read_header(reader)) {
+		VLOG(1) << "Binary scene " << filepath << " has an unsupported version or platform.";
+		return false;
+	}
+
+	/* Default shaders already exist in the scene, they are overwritten so
+	 * that the default shader pointers remain valid. */
+	uint num_shaders = reader.read_uint();
+	for(uint i = 0; i < num_shaders && !reader.error; i++) {
+		Shader *shader;
+		if(i < scene->shaders.size()) {
+			shader = scene->shaders[i];
+		}
+		else {
+			shader = new Shader();
+			scene->shaders.push_back(shader);
+		}
+
+		binary_read_node(reader, shader);
+		shader->set_graph(read_shader_graph(reader));
+		shader->tag_update(scene);
+		reader.add_node(shader);
+	}
+
+	binary_read_node(reader, scene->background);
+	binary_read_node(reader, scene->film);
+	binary_read_node(reader, scene->integrator);
+
+	Camera *cam = scene->camera;
+	binary_read_node(reader, cam);
+	cam->width = reader.read_int();
+	cam->height = reader.read_int();
+	cam->full_width = reader.read_int();
+	cam->full_height = reader.read_int();
+	cam->use_spherical_stereo = (reader.read_int() != 0);
+	cam->use_perspective_motion = (reader.read_int() != 0);
+
+	uint num_meshes = reader.read_uint();
+	for(uint i = 0; i < num_meshes && !reader.error; i++) {
+		Mesh *mesh = new Mesh();
+		if(!read_mesh(reader, mesh)) {
+			reader.error = true;
+		}
+		scene->meshes.push_back(mesh);
+		reader.add_node(mesh);
+	}
+
+	uint num_objects = reader.read_uint();
+	for(uint i = 0; i < num_objects && !reader.error; i++) {
+		Object *object = new Object();
+		binary_read_node(reader, object);
+		object->asset_name = reader.read_string();
+		scene->objects.push_back(object);
+	}
+
+	uint num_lights = reader.read_uint();
+	for(uint i = 0; i < num_lights && !reader.error; i++) {
+		Light *light = new Light();
+		binary_read_node(reader, light);
+		scene->lights.push_back(light);
+	}
+
+	if(reader.error) {
+		VLOG(1) << "Binary scene " << filepath << " is corrupt.";
+		return false;
+	}
+
+	/* Same as the XML reader, the scene is rendered without changes. */
+	scene->params.bvh_type = SceneParams::BVH_STATIC;
+
+	scene->background->tag_update(scene);
+	scene->film->tag_update(scene);
+	scene->integrator->tag_update(scene);
+	cam->need_update = true;
+	scene->mesh_manager->tag_update(scene);
+	scene->object_manager->tag_update(scene);
+	scene->light_manager->tag_update(scene);
+
+	return true;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SCENE_BINARY_H__
+#define __SCENE_BINARY_H__
+
+#include "util/util_string.h"
+
+CCL_NAMESPACE_BEGIN
+
+class Scene;
+
+/* Binary Scene Dump
+ *
+ * Stores a synced scene as it is before device update: film, integrator,
+ * background, camera, shaders, meshes, objects and lights. Loading it is
+ * much faster than parsing XML or syncing from Blender again, which makes
+ * it useful for re-rendering the same scene with the standalone app.
+ *
+ * Images are stored by filename only, builtin images packed or generated
+ * in Blender and OSL script nodes can not be stored. Particle systems,
+ * volume data and object attributes are not stored either. The file uses
+ * native byte order and is tied to the Cycles version that wrote it. */
+
+bool scene_write_binary(Scene *scene, const string& filepath);
+bool scene_read_binary(Scene *scene, const string& filepath);
+
+/* Test if the file starts with the binary scene header. */
+bool scene_is_binary(const string& filepath);
+
+CCL_NAMESPACE_END
+
+#endif /* __SCENE_BINARY_H__ */
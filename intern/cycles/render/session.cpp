@@ -33,6 +33,7 @@
 #include "util/util_logging.h"
 #include "util/util_math.h"
 #include "util/util_opengl.h"
+#include "util/util_path.h"
 #include "util/util_task.h"
 #include "util/util_time.h"
 
@@ -70,6 +71,7 @@ Session::Session(const SessionParams& params_)
 
 	reset_time = 0.0;
 	last_update_time = 0.0;
+	checkpoint_time = 0.0;
 
 	delayed_reset.do_reset = false;
 	delayed_reset.samples = 0;
@@ -215,6 +217,7 @@ void Session::run_gpu()
 			/* if no work left and in background mode, we can stop immediately */
 			if(no_tiles) {
 				progress.set_status("Finished");
+				checkpoint_finish();
 				break;
 			}
 		}
@@ -281,6 +284,8 @@ void Session::run_gpu()
 
 			if(!device->error_message().empty())
 				progress.set_cancel(device->error_message());
+			else if(!progress.get_cancel())
+				checkpoint_progressive();
 
 			/* update status and timing */
 			update_status_time();
@@ -367,8 +372,15 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 	Tile *tile;
 	int device_num = device->device_number(tile_device);
 
-	if(!tile_manager.next_tile(tile, device_num))
-		return false;
+	while(!tile_manager.next_tile(tile, device_num)) {
+		/* Rather than letting the thread finish, wait for tiles that are still
+		 * being rendered to make their neighbors available for denoising. */
+		if(progress.get_cancel() || !tile_manager.has_pending_denoising(device_num))
+			return false;
+
+		/* Time out to notice cancellation while no tile is released. */
+		denoising_tiles_cond.wait_for(tile_lock, std::chrono::milliseconds(100));
+	}
 
 	/* fill render tile */
 	rtile.x = tile_manager.state.buffer.full_x + tile->x;
@@ -390,12 +402,16 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 
 		rtile.buffer = buffers->buffer.device_pointer;
 		rtile.buffers = buffers;
+		rtile.sample = tile_manager.state.sample;
+
+		checkpoint_resume_tile(rtile);
 
 		device->map_tile(tile_device, rtile);
 
 		return true;
 	}
 
+	bool allocated = false;
 	if(tile->buffers == NULL) {
 		/* fill buffer parameters */
 		BufferParams buffer_params = tile_manager.params;
@@ -407,6 +423,7 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 		/* allocate buffers */
 		tile->buffers = new RenderBuffers(tile_device);
 		tile->buffers->reset(buffer_params);
+		allocated = true;
 	}
 
 	tile->buffers->params.get_offset_stride(rtile.offset, rtile.stride);
@@ -415,6 +432,10 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 	rtile.buffers = tile->buffers;
 	rtile.sample = tile_manager.state.sample;
 
+	if(allocated) {
+		checkpoint_resume_tile(rtile);
+	}
+
 	/* this will tag tile as IN PROGRESS in blender-side render pipeline,
 	 * which is needed to highlight currently rendering tile before first
 	 * sample was processed for it
@@ -447,11 +468,19 @@ void Session::release_tile(RenderTile& rtile)
 
 	bool delete_tile;
 
+	bool render_finished = (rtile.task == RenderTile::PATH_TRACE);
+	bool tile_written = false;
+
 	if(tile_manager.finish_tile(rtile.tile_index, delete_tile)) {
 		if(write_render_tile_cb && params.progressive_refine == false) {
 			write_render_tile_cb(rtile);
 		}
 
+		if(render_finished && !params.progressive && !progress.get_cancel()) {
+			checkpoint_add_tile(rtile);
+			tile_written = true;
+		}
+
 		if(delete_tile) {
 			delete rtile.buffers;
 			tile_manager.state.tiles[rtile.tile_index].buffers = NULL;
@@ -463,7 +492,16 @@ void Session::release_tile(RenderTile& rtile)
 		}
 	}
 
+	if(render_finished && tile_manager.schedule_denoising) {
+		denoising_tiles_cond.notify_all();
+	}
+
 	update_status_time();
+
+	if(tile_written) {
+		tile_lock.unlock();
+		checkpoint_write(false);
+	}
 }
 
 void Session::map_neighbor_tiles(RenderTile *tiles, Device *tile_device)
@@ -543,6 +581,7 @@ void Session::run_cpu()
 			/* if no work left and in background mode, we can stop immediately */
 			if(no_tiles) {
 				progress.set_status("Finished");
+				checkpoint_finish();
 				break;
 			}
 		}
@@ -629,10 +668,16 @@ void Session::run_cpu()
 				delayed_reset.do_reset = false;
 				reset_(delayed_reset.params, delayed_reset.samples);
 			}
-			else if(need_tonemap) {
-				/* tonemap only if we do not reset, we don't we don't
-				 * want to show the result of an incomplete sample */
-				tonemap(tile_manager.state.sample);
+			else {
+				if(need_tonemap) {
+					/* tonemap only if we do not reset, we don't we don't
+					 * want to show the result of an incomplete sample */
+					tonemap(tile_manager.state.sample);
+				}
+
+				if(!no_tiles && !progress.get_cancel()) {
+					checkpoint_progressive();
+				}
 			}
 
 			if(!device->error_message().empty())
@@ -781,9 +826,28 @@ void Session::reset_(BufferParams& buffer_params, int samples)
 		}
 	}
 
+	checkpoint_reset(buffer_params, samples);
 	tile_manager.reset(buffer_params, samples);
 	progress.reset_sample();
 
+	if(tile_manager.resume_sample > 0) {
+		/* Continue progressive rendering from the checkpoint. */
+		if(buffers) {
+			RenderTile rtile;
+			rtile.x = buffer_params.full_x;
+			rtile.y = buffer_params.full_y;
+			rtile.w = buffer_params.width;
+			rtile.h = buffer_params.height;
+			rtile.buffers = buffers;
+			buffers->params.get_offset_stride(rtile.offset, rtile.stride);
+			resume_checkpoint.restore_tile(rtile);
+			buffers->buffer.copy_to_device();
+		}
+
+		progress.add_samples((uint64_t)tile_manager.resume_sample*buffer_params.width*buffer_params.height,
+		                     tile_manager.resume_sample);
+	}
+
 	bool show_progress = params.background || tile_manager.get_num_effective_samples() != INT_MAX;
 	progress.set_total_pixel_samples(show_progress? tile_manager.state.total_pixel_samples : 0);
 
@@ -960,6 +1024,10 @@ void Session::render()
 		buffers->zero();
 	}
 
+	if(!params.progressive && tile_manager.state.sample == tile_manager.range_start_sample) {
+		checkpoint_restore_tiles();
+	}
+
 	/* Add path trace task. */
 	DeviceTask task(DeviceTask::RENDER);
 
@@ -1064,6 +1132,269 @@ bool Session::update_progressive_refine(bool cancel)
 	return write;
 }
 
+bool Session::use_checkpoint()
+{
+	/* Sample ranges are combined by the caller, and denoised tiles can't be
+	 * rendered further, so neither of them is checkpointed. */
+	return params.background &&
+	       !params.checkpoint_path.empty() &&
+	       tile_manager.range_start_sample == 0 &&
+	       tile_manager.range_num_samples == -1 &&
+	       !tile_manager.schedule_denoising;
+}
+
+void Session::checkpoint_reset(BufferParams& buffer_params, int samples)
+{
+	thread_scoped_lock checkpoint_lock(checkpoint_mutex);
+
+	tile_manager.resume_sample = 0;
+	checkpoint.reset(buffer_params);
+	resume_checkpoint.reset(buffer_params);
+	checkpoint_time = time_dt();
+
+	if(!use_checkpoint() || !path_exists(params.checkpoint_path)) {
+		return;
+	}
+
+	if(!resume_checkpoint.read(params.checkpoint_path) || !resume_checkpoint.matches(buffer_params)) {
+		VLOG(1) << "Checkpoint " << params.checkpoint_path << " does not match the render, starting over.";
+		resume_checkpoint.reset(buffer_params);
+		return;
+	}
+
+	if(params.progressive) {
+		/* All pixels are sampled together, so the whole frame must have the same
+		 * number of samples and there must be samples left to render. */
+		int sample = resume_checkpoint.get_sample(buffer_params.full_x, buffer_params.full_y,
+		                                          buffer_params.width, buffer_params.height);
+		if(sample == 0 || sample >= samples) {
+			resume_checkpoint.reset(buffer_params);
+			return;
+		}
+
+		tile_manager.resume_sample = sample;
+		VLOG(1) << "Resuming render from checkpoint at sample " << sample << ".";
+	}
+	else {
+		VLOG(1) << "Resuming render from checkpoint.";
+	}
+}
+
+void Session::checkpoint_restore_tiles()
+{
+	if(resume_checkpoint.empty()) {
+		return;
+	}
+
+	int end_sample = tile_manager.state.sample + tile_manager.state.num_samples;
+	bool restored = false;
+
+	foreach(Tile& tile, tile_manager.state.tiles) {
+		RenderTile rtile;
+		rtile.x = tile_manager.state.buffer.full_x + tile.x;
+		rtile.y = tile_manager.state.buffer.full_y + tile.y;
+		rtile.w = tile.w;
+		rtile.h = tile.h;
+
+		int sample = resume_checkpoint.get_sample(rtile.x, rtile.y, rtile.w, rtile.h);
+		if(sample == 0) {
+			continue;
+		}
+
+		if(sample < end_sample) {
+			/* Unfinished tiles continue rendering when they are acquired, only
+			 * the shared buffers must be filled in advance. */
+			if(buffers) {
+				rtile.buffers = buffers;
+				tile_manager.state.buffer.get_offset_stride(rtile.offset, rtile.stride);
+				resume_checkpoint.restore_tile(rtile);
+				restored = true;
+			}
+			continue;
+		}
+
+		/* Finished tiles are written right away and not rendered again. */
+		if(buffers) {
+			rtile.buffers = buffers;
+			tile_manager.state.buffer.get_offset_stride(rtile.offset, rtile.stride);
+			restored = true;
+		}
+		else {
+			BufferParams buffer_params = tile_manager.params;
+			buffer_params.full_x = rtile.x;
+			buffer_params.full_y = rtile.y;
+			buffer_params.width = rtile.w;
+			buffer_params.height = rtile.h;
+
+			rtile.buffers = new RenderBuffers(device);
+			rtile.buffers->reset(buffer_params);
+			rtile.buffers->params.get_offset_stride(rtile.offset, rtile.stride);
+		}
+
+		resume_checkpoint.restore_tile(rtile);
+
+		rtile.start_sample = 0;
+		rtile.num_samples = end_sample;
+		rtile.sample = end_sample;
+		rtile.resolution = tile_manager.state.resolution_divider;
+		rtile.tile_index = tile.index;
+		rtile.task = RenderTile::PATH_TRACE;
+
+		{
+			thread_scoped_lock checkpoint_lock(checkpoint_mutex);
+			checkpoint.add_tile(rtile, end_sample);
+		}
+
+		if(write_render_tile_cb && params.progressive_refine == false) {
+			write_render_tile_cb(rtile);
+		}
+
+		if(rtile.buffers != buffers) {
+			delete rtile.buffers;
+		}
+
+		tile_manager.skip_tile(tile.index);
+		progress.add_samples((uint64_t)end_sample*rtile.w*rtile.h, end_sample);
+		progress.add_finished_tile(false);
+	}
+
+	if(restored) {
+		buffers->buffer.copy_to_device();
+	}
+}
+
+void Session::checkpoint_resume_tile(RenderTile& rtile)
+{
+	if(resume_checkpoint.empty()) {
+		return;
+	}
+
+	/* Shared buffers are restored before rendering starts. */
+	bool restore = (rtile.buffers != buffers);
+
+	if(params.progressive) {
+		if(restore && resume_checkpoint.restore_tile(rtile)) {
+			rtile.buffers->buffer.copy_to_device();
+		}
+		return;
+	}
+
+	int end_sample = rtile.start_sample + rtile.num_samples;
+	int sample = resume_checkpoint.get_sample(rtile.x, rtile.y, rtile.w, rtile.h);
+	if(sample <= rtile.start_sample || sample >= end_sample) {
+		return;
+	}
+
+	if(restore) {
+		resume_checkpoint.restore_tile(rtile);
+		rtile.buffers->buffer.copy_to_device();
+	}
+
+	rtile.start_sample = sample;
+	rtile.num_samples = end_sample - sample;
+	rtile.sample = sample;
+
+	progress.add_samples((uint64_t)sample*rtile.w*rtile.h, sample);
+}
+
+void Session::checkpoint_add_tile(RenderTile& rtile)
+{
+	if(!use_checkpoint()) {
+		return;
+	}
+
+	/* Only the pixels of the tile are stored, but shared buffers are copied
+	 * as a whole. */
+	rtile.buffers->copy_from_device();
+
+	thread_scoped_lock checkpoint_lock(checkpoint_mutex);
+	checkpoint.add_tile(rtile, rtile.sample);
+}
+
+void Session::checkpoint_progressive()
+{
+	if(!params.progressive || !use_checkpoint() ||
+	   tile_manager.state.resolution_divider != params.pixel_size ||
+	   time_dt() - checkpoint_time < params.checkpoint_interval)
+	{
+		return;
+	}
+
+	int sample = tile_manager.state.sample + tile_manager.state.num_samples;
+
+	{
+		thread_scoped_lock checkpoint_lock(checkpoint_mutex);
+
+		if(buffers) {
+			RenderTile rtile;
+			rtile.x = tile_manager.state.buffer.full_x;
+			rtile.y = tile_manager.state.buffer.full_y;
+			rtile.w = tile_manager.state.buffer.width;
+			rtile.h = tile_manager.state.buffer.height;
+			rtile.buffers = buffers;
+			tile_manager.state.buffer.get_offset_stride(rtile.offset, rtile.stride);
+
+			buffers->copy_from_device();
+			checkpoint.add_tile(rtile, sample);
+		}
+		else {
+			foreach(Tile& tile, tile_manager.state.tiles) {
+				if(!tile.buffers) {
+					continue;
+				}
+
+				RenderTile rtile;
+				rtile.x = tile_manager.state.buffer.full_x + tile.x;
+				rtile.y = tile_manager.state.buffer.full_y + tile.y;
+				rtile.w = tile.w;
+				rtile.h = tile.h;
+				rtile.buffers = tile.buffers;
+				tile.buffers->params.get_offset_stride(rtile.offset, rtile.stride);
+
+				tile.buffers->copy_from_device();
+				checkpoint.add_tile(rtile, sample);
+			}
+		}
+	}
+
+	checkpoint_write(true);
+}
+
+void Session::checkpoint_write(bool force)
+{
+	if(!use_checkpoint()) {
+		return;
+	}
+
+	/* Write a copy so rendering threads releasing tiles are not blocked on
+	 * file access. */
+	RenderCheckpoint snapshot;
+	{
+		thread_scoped_lock checkpoint_lock(checkpoint_mutex);
+
+		double current_time = time_dt();
+		if(checkpoint.empty() || (!force && current_time - checkpoint_time < params.checkpoint_interval)) {
+			return;
+		}
+
+		snapshot = checkpoint;
+		checkpoint_time = current_time;
+	}
+
+	scoped_timer timer;
+	if(snapshot.write(params.checkpoint_path)) {
+		VLOG(1) << "Wrote checkpoint " << params.checkpoint_path << " in " << timer.get_time() << " seconds.";
+	}
+}
+
+void Session::checkpoint_finish()
+{
+	/* The render is complete, resuming from the checkpoint is no longer needed. */
+	if(use_checkpoint() && path_exists(params.checkpoint_path)) {
+		path_remove(params.checkpoint_path);
+	}
+}
+
 void Session::device_free()
 {
 	scene->device_free();
@@ -18,6 +18,7 @@
 #define __SESSION_H__
 
 #include "render/buffers.h"
+#include "render/checkpoint.h"
 #include "device/device.h"
 #include "render/shader.h"
 #include "render/stats.h"
@@ -73,6 +74,11 @@ public:
 	double text_timeout;
 	double progressive_update_timeout;
 
+	/* Background renders periodically write their buffers to this file, and
+	 * continue from it when it exists at the start of the render. */
+	string checkpoint_path;
+	double checkpoint_interval;
+
 	ShadingSystem shadingsystem;
 
 	function<bool(const uchar *pixels,
@@ -110,6 +116,8 @@ public:
 		text_timeout = 1.0;
 		progressive_update_timeout = 1.0;
 
+		checkpoint_interval = 60.0;
+
 		shadingsystem = SHADINGSYSTEM_SVM;
 		tile_order = TILE_CENTER;
 	}
@@ -224,6 +232,7 @@ protected:
 	thread_condition_variable pause_cond;
 	thread_mutex pause_mutex;
 	thread_mutex tile_mutex;
+	thread_condition_variable denoising_tiles_cond;
 	thread_mutex buffers_mutex;
 	thread_mutex display_mutex;
 
@@ -236,6 +245,21 @@ protected:
 	double last_update_time;
 	bool update_progressive_refine(bool cancel);
 
+	/* checkpointing */
+	RenderCheckpoint checkpoint;
+	RenderCheckpoint resume_checkpoint;
+	thread_mutex checkpoint_mutex;
+	double checkpoint_time;
+
+	bool use_checkpoint();
+	void checkpoint_reset(BufferParams& params, int samples);
+	void checkpoint_restore_tiles();
+	void checkpoint_resume_tile(RenderTile& rtile);
+	void checkpoint_add_tile(RenderTile& rtile);
+	void checkpoint_progressive();
+	void checkpoint_write(bool force);
+	void checkpoint_finish();
+
 	DeviceRequestedFeatures get_requested_device_features();
 
 	/* ** Split kernel routines ** */
@@ -44,6 +44,63 @@ bool namedSampleCountPairComparator(const NamedSampleCountPair& a, const NamedSa
 	return a.samples > b.samples;
 }
 
+/* Names of the profiling events, in the order of the ProfilingEvent enum. */
+const char *profiling_event_names[PROFILING_NUM_EVENTS] = {
+	"Unknown",
+	"Ray setup",
+	"Path integration",
+	"Scene intersection",
+	"Indirect emission",
+	"Volumes",
+	"Shader Setup",
+	"Shader Eval",
+	"Shader Apply",
+	"Ambient Occlusion",
+	"Subsurface",
+	"Connect Light",
+	"Surface Bounce",
+	"Result writing",
+	"Full Intersection",
+	"Local Intersection",
+	"Shadow All Intersection",
+	"Volume Intersection",
+	"Volume All Intersection",
+	"Surface Closure Evaluation",
+	"Surface Closure Sampling",
+	"Volume Closure Evaluation",
+	"Volume Closure Sampling",
+	"Denoising",
+	"Construct Transform",
+	"Reconstruct",
+	"Divide Shadow",
+	"Non-Local means",
+	"Combine Halves",
+	"Get Feature",
+	"Detect Outliers",
+};
+
+string json_escape(const string& str)
+{
+	string result = "\"";
+	foreach(char c, str) {
+		switch(c) {
+			case '"': result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\t': result += "\\t"; break;
+			default:
+				if((unsigned char)c < 0x20) {
+					result += string_printf("\\u%04x", (int)c);
+				}
+				else {
+					result += c;
+				}
+				break;
+		}
+	}
+	return result + "\"";
+}
+
 }  // namespace
 
 NamedSizeEntry::NamedSizeEntry()
@@ -88,6 +145,19 @@ string NamedSizeStats::full_report(int indent_level)
 	return result;
 }
 
+string NamedSizeStats::json_report()
+{
+	string result = string_printf("{\"total_size\": %zu, \"entries\": [", total_size);
+	sort(entries.begin(), entries.end(), namedSizeEntryComparator);
+	for(size_t i = 0; i < entries.size(); i++) {
+		result += string_printf("%s{\"name\": %s, \"size\": %zu}",
+		                        (i == 0)? "": ", ",
+		                        json_escape(entries[i].name).c_str(),
+		                        entries[i].size);
+	}
+	return result + "]}";
+}
+
 /* Named time sample statistics. */
 
 NamedNestedSampleStats::NamedNestedSampleStats()
@@ -142,24 +212,50 @@ string NamedNestedSampleStats::full_report(int indent_level, uint64_t total_samp
 	return result;
 }
 
+string NamedNestedSampleStats::json_report()
+{
+	update_sum();
+
+	string result = string_printf("{\"name\": %s, \"self_samples\": %llu, \"sum_samples\": %llu, \"entries\": [",
+	                              json_escape(name).c_str(),
+	                              (unsigned long long) self_samples,
+	                              (unsigned long long) sum_samples);
+
+	sort(entries.begin(), entries.end(), namedTimeSampleEntryComparator);
+	for(size_t i = 0; i < entries.size(); i++) {
+		result += (i == 0)? "": ", ";
+		result += entries[i].json_report();
+	}
+	return result + "]}";
+}
+
 /* Named sample count pairs. */
 
-NamedSampleCountPair::NamedSampleCountPair(const ustring& name, uint64_t samples, uint64_t hits)
- : name(name), samples(samples), hits(hits)
+NamedSampleCountPair::NamedSampleCountPair(const ustring& name,
+                                           uint64_t samples,
+                                           uint64_t hits,
+                                           const vector<uint64_t>& event_samples)
+ : name(name), samples(samples), hits(hits), event_samples(event_samples)
 {}
 
 NamedSampleCountStats::NamedSampleCountStats()
 {}
 
-void NamedSampleCountStats::add(const ustring& name, uint64_t samples, uint64_t hits)
+void NamedSampleCountStats::add(const ustring& name,
+                                uint64_t samples,
+                                uint64_t hits,
+                                const vector<uint64_t>& event_samples)
 {
 	entry_map::iterator entry = entries.find(name);
 	if(entry != entries.end()) {
 		entry->second.samples += samples;
 		entry->second.hits += hits;
+		for(size_t i = 0; i < event_samples.size(); i++) {
+			entry->second.event_samples[i] += event_samples[i];
+		}
 		return;
 	}
-	entries.emplace(name, NamedSampleCountPair(name, samples, hits));
+	entries.emplace(name, NamedSampleCountPair(name, samples, hits, event_samples));
 }
 
 string NamedSampleCountStats::full_report(int indent_level)
@@ -191,20 +287,81 @@ string NamedSampleCountStats::full_report(int indent_level)
 		                                 entry.name.c_str(),
 		                                 seconds,
 		                                 relative);
+
+		/* Break down time by kernel event, most expensive first. */
+		vector<std::pair<uint64_t, int> > events;
+		for(size_t i = 0; i < entry.event_samples.size(); i++) {
+			if(entry.event_samples[i] > 0) {
+				events.push_back(std::make_pair(entry.event_samples[i], (int)i));
+			}
+		}
+		sort(events.begin(), events.end(), std::greater<std::pair<uint64_t, int> >());
+
+		const string sub_indent((indent_level + 1) * kIndentNumSpaces, ' ');
+		for(size_t i = 0; i < events.size(); i++) {
+			result += sub_indent + string_printf("%-30s: %.2fs (%3.2f%%)\n",
+			                                     profiling_event_names[events[i].second],
+			                                     events[i].first * 0.001,
+			                                     100.0 * events[i].first / entry.samples);
+		}
 	}
 	return result;
 }
 
+string NamedSampleCountStats::json_report()
+{
+	vector<NamedSampleCountPair> sorted_entries;
+	sorted_entries.reserve(entries.size());
+
+	foreach(entry_map::const_reference entry, entries) {
+		sorted_entries.push_back(entry.second);
+	}
+
+	sort(sorted_entries.begin(), sorted_entries.end(), namedSampleCountPairComparator);
+
+	string result = "[";
+	for(size_t i = 0; i < sorted_entries.size(); i++) {
+		const NamedSampleCountPair& entry = sorted_entries[i];
+
+		result += string_printf("%s{\"name\": %s, \"samples\": %llu, \"hits\": %llu, \"events\": {",
+		                        (i == 0)? "": ", ",
+		                        json_escape(entry.name.string()).c_str(),
+		                        (unsigned long long) entry.samples,
+		                        (unsigned long long) entry.hits);
+
+		bool first = true;
+		for(size_t j = 0; j < entry.event_samples.size(); j++) {
+			if(entry.event_samples[j] > 0) {
+				result += string_printf("%s%s: %llu",
+				                        first? "": ", ",
+				                        json_escape(profiling_event_names[j]).c_str(),
+				                        (unsigned long long) entry.event_samples[j]);
+				first = false;
+			}
+		}
+
+		result += "}}";
+	}
+	return result + "]";
+}
+
 /* Mesh statistics. */
 
-MeshStats::MeshStats() {
+MeshStats::MeshStats()
+    : attributes_saved(0) {
 }
 
 string MeshStats::full_report(int indent_level)
 {
 	const string indent(indent_level * kIndentNumSpaces, ' ');
+	const string child_indent((indent_level + 1) * kIndentNumSpaces, ' ');
 	string result = "";
 	result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+	result += indent + "Attributes:\n" + attributes.full_report(indent_level + 1);
+	result += string_printf("%sSaved memory: %s (%s)\n",
+	                        child_indent.c_str(),
+	                        string_human_readable_size(attributes_saved).c_str(),
+	                        string_human_readable_number(attributes_saved).c_str());
 	return result;
 }
 
@@ -275,19 +432,28 @@ void RenderStats::collect_profiling(Scene *scene, Profiler& prof)
 	prefilter.add_entry("Detect Outliers", prof.get_event(PROFILING_DENOISING_DETECT_OUTLIERS));
 	prefilter.add_entry("Combine Halves", prof.get_event(PROFILING_DENOISING_COMBINE_HALVES));
 
+	vector<uint64_t> event_samples(PROFILING_NUM_EVENTS);
+
 	shaders.entries.clear();
 	foreach(Shader *shader, scene->shaders) {
 		uint64_t samples, hits;
 		if(prof.get_shader(shader->id, samples, hits)) {
-			shaders.add(shader->name, samples, hits);
+			for(int i = 0; i < PROFILING_NUM_EVENTS; i++) {
+				event_samples[i] = prof.get_shader_event(shader->id, (ProfilingEvent)i);
+			}
+			shaders.add(shader->name, samples, hits, event_samples);
 		}
 	}
 
 	objects.entries.clear();
 	foreach(Object *object, scene->objects) {
 		uint64_t samples, hits;
-		if(prof.get_object(object->get_device_index(), samples, hits)) {
-			objects.add(object->name, samples, hits);
+		int index = object->get_device_index();
+		if(prof.get_object(index, samples, hits)) {
+			for(int i = 0; i < PROFILING_NUM_EVENTS; i++) {
+				event_samples[i] = prof.get_object_event(index, (ProfilingEvent)i);
+			}
+			objects.add(object->name, samples, hits, event_samples);
 		}
 	}
 }
@@ -308,4 +474,22 @@ string RenderStats::full_report()
 	return result;
 }
 
+string RenderStats::json_report()
+{
+	string result = "{\n";
+	result += "  \"mesh\": {\"geometry\": " + mesh.geometry.json_report() +
+	          ", \"attributes\": " + mesh.attributes.json_report() +
+	          string_printf(", \"attributes_saved\": %zu", mesh.attributes_saved) + "},\n";
+	result += "  \"image\": {\"textures\": " + image.textures.json_report() + "},\n";
+	result += string_printf("  \"has_profiling\": %s", has_profiling? "true": "false");
+	if(has_profiling) {
+		/* Samples are taken every millisecond. */
+		result += ",\n  \"sample_interval\": 0.001";
+		result += ",\n  \"kernel\": " + kernel.json_report();
+		result += ",\n  \"shaders\": " + shaders.json_report();
+		result += ",\n  \"objects\": " + objects.json_report();
+	}
+	return result + "\n}\n";
+}
+
 CCL_NAMESPACE_END
@@ -55,6 +55,9 @@ public:
 	/* Generate full human-readable report. */
 	string full_report(int indent_level = 0);
 
+	/* Generate machine-readable report in JSON format. */
+	string json_report();
+
 	/* Total size of all entries. */
 	size_t total_size;
 
@@ -75,6 +78,7 @@ public:
 	void update_sum();
 
 	string full_report(int indent_level = 0, uint64_t total_samples = 0);
+	string json_report();
 
 	string name;
 
@@ -87,14 +91,19 @@ public:
 
 /* Named entry containing both a time-sample count for objects of a type and a
  * total count of processed items.
- * This allows to estimate the time spent per item. */
+ * This allows to estimate the time spent per item. The samples are also
+ * split up by kernel event, to tell where in the kernel the time was spent. */
 class NamedSampleCountPair {
 public:
-	NamedSampleCountPair(const ustring& name, uint64_t samples, uint64_t hits);
+	NamedSampleCountPair(const ustring& name,
+	                     uint64_t samples,
+	                     uint64_t hits,
+	                     const vector<uint64_t>& event_samples);
 
 	ustring name;
 	uint64_t samples;
 	uint64_t hits;
+	vector<uint64_t> event_samples;
 };
 
 /* Contains statistics about pairs of samples and counts as described above. */
@@ -103,7 +112,11 @@ public:
 	NamedSampleCountStats();
 
 	string full_report(int indent_level = 0);
-	void add(const ustring& name, uint64_t samples, uint64_t hits);
+	string json_report();
+	void add(const ustring& name,
+	         uint64_t samples,
+	         uint64_t hits,
+	         const vector<uint64_t>& event_samples);
 
 	typedef unordered_map<ustring, NamedSampleCountPair, ustringHash> entry_map;
 	entry_map entries;
@@ -122,6 +135,11 @@ public:
 	 * memory like BVH.
 	 */
 	NamedSizeStats geometry;
+
+	/* Device memory used by attributes per storage type, and the memory saved
+	 * by sharing attributes between requests and storing them compactly. */
+	NamedSizeStats attributes;
+	size_t attributes_saved;
 };
 
 /* Statistics about images held in memory. */
@@ -143,6 +161,9 @@ public:
 	/* Return full report as string. */
 	string full_report();
 
+	/* Return report in JSON format, for processing by other tools. */
+	string json_report();
+
 	/* Collect kernel sampling information from Stats. */
 	void collect_profiling(Scene *scene, Profiler& prof);
 
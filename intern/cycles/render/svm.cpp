@@ -32,6 +32,13 @@ CCL_NAMESPACE_BEGIN
 
 /* Shader Manager */
 
+SVMShaderManager::CompiledShader::CompiledShader()
+: background(false),
+  used(false),
+  source(NULL)
+{
+}
+
 SVMShaderManager::SVMShaderManager()
 {
 }
@@ -42,51 +49,138 @@ SVMShaderManager::~SVMShaderManager()
 
 void SVMShaderManager::reset(Scene * /*scene*/)
 {
+	compiled_shaders_.clear();
+}
+
+static bool svm_shader_has_bump(Shader *shader)
+{
+	ShaderNode *output = shader->graph->output();
+	return (shader->displacement_method != DISPLACE_TRUE) &&
+	       output->input("Surface")->link && output->input("Displacement")->link;
+}
+
+static void svm_shader_copy_flags(Shader *shader, const Shader *source)
+{
+	shader->has_surface = source->has_surface;
+	shader->has_surface_emission = source->has_surface_emission;
+	shader->has_surface_transparent = source->has_surface_transparent;
+	shader->has_surface_bssrdf = source->has_surface_bssrdf;
+	shader->has_bump = source->has_bump;
+	shader->has_bssrdf_bump = source->has_bssrdf_bump;
+	shader->has_volume = source->has_volume;
+	shader->has_displacement = source->has_displacement;
+	shader->has_surface_spatial_varying = source->has_surface_spatial_varying;
+	shader->has_volume_spatial_varying = source->has_volume_spatial_varying;
+	shader->has_object_dependency = source->has_object_dependency;
+	shader->has_attribute_dependency = source->has_attribute_dependency;
+	shader->has_integrator_dependency = source->has_integrator_dependency;
+}
+
+void SVMShaderManager::device_update_compiled_shaders(Scene *scene,
+                                                      vector<Shader*>& compile_shaders)
+{
+	set<Shader*> scene_shaders(scene->shaders.begin(), scene->shaders.end());
+
+	/* Forget shaders which were removed from the scene. */
+	CompiledShaderMap::iterator it = compiled_shaders_.begin();
+	while(it != compiled_shaders_.end()) {
+		if(scene_shaders.find(it->first) == scene_shaders.end()) {
+			it = compiled_shaders_.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	/* Find shaders which were modified since they were compiled. Shaders with
+	 * integrator dependency are always compiled, their nodes depend on settings
+	 * outside of the shader graph. */
+	set<Shader*> modified_shaders;
+	foreach(Shader *shader, scene->shaders) {
+		it = compiled_shaders_.find(shader);
+		if(it == compiled_shaders_.end() ||
+		   shader->need_update ||
+		   shader->has_integrator_dependency ||
+		   it->second.used != shader->used ||
+		   it->second.background != (shader == scene->default_background))
+		{
+			modified_shaders.insert(shader);
+		}
+	}
+
+	/* Shaders sharing nodes of a modified or removed shader are to be compiled
+	 * again, since image slots of the source shader might have been freed. */
+	foreach(Shader *shader, scene->shaders) {
+		if(modified_shaders.find(shader) != modified_shaders.end()) {
+			continue;
+		}
+		Shader *source = compiled_shaders_[shader].source;
+		if(source != shader &&
+		   (scene_shaders.find(source) == scene_shaders.end() ||
+		    modified_shaders.find(source) != modified_shaders.end()))
+		{
+			modified_shaders.insert(shader);
+		}
+	}
+
+	compile_shaders.clear();
+	foreach(Shader *shader, scene->shaders) {
+		if(modified_shaders.find(shader) != modified_shaders.end()) {
+			CompiledShader& compiled = compiled_shaders_[shader];
+			compiled = CompiledShader();
+			compiled.background = (shader == scene->default_background);
+			compiled.used = shader->used;
+			compile_shaders.push_back(shader);
+		}
+	}
+}
+
+void SVMShaderManager::device_update_shader_hash(Scene *scene,
+                                                 Shader *shader,
+                                                 Progress *progress)
+{
+	if(progress->get_cancel()) {
+		return;
+	}
+	assert(shader->graph);
+
+	/* Finalize the graph before hashing, so that graphs which only differ in
+	 * parts removed by constant folding and simplification compare equal. */
+	shader->graph->finalize(scene,
+	                        svm_shader_has_bump(shader),
+	                        shader->has_integrator_dependency,
+	                        shader->displacement_method == DISPLACE_BOTH);
+
+	/* Entries were added before the tasks were started, so only do lookups
+	 * here to stay thread safe. */
+	CompiledShader& compiled = compiled_shaders_.find(shader)->second;
+	compiled.graph_hash = shader->graph->compute_hash();
+	/* Displacement method is not a part of the graph but affects the nodes. */
+	compiled.graph_hash += string_printf("-%d", (int)shader->displacement_method);
 }
 
 void SVMShaderManager::device_update_shader(Scene *scene,
                                             Shader *shader,
-                                            Progress *progress,
-                                            array<int4> *global_svm_nodes)
+                                            Progress *progress)
 {
 	if(progress->get_cancel()) {
 		return;
 	}
 	assert(shader->graph);
 
-	array<int4> svm_nodes;
+	CompiledShader& compiled = compiled_shaders_.find(shader)->second;
+	array<int4>& svm_nodes = compiled.svm_nodes;
+	svm_nodes.clear();
 	svm_nodes.push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
 
 	SVMCompiler::Summary summary;
 	SVMCompiler compiler(scene->shader_manager, scene->image_manager, scene->light_manager);
-	compiler.background = (shader == scene->default_background);
+	compiler.background = compiled.background;
 	compiler.compile(scene, shader, svm_nodes, 0, &summary);
 
 	VLOG(2) << "Compilation summary:\n"
 	        << "Shader name: " << shader->name << "\n"
 	        << summary.full_report();
-
-	nodes_lock_.lock();
-	if(shader->use_mis && shader->has_surface_emission) {
-		scene->light_manager->need_update = true;
-	}
-
-	/* The copy needs to be done inside the lock, if another thread resizes the array
-	 * while memcpy is running, it'll be copying into possibly invalid/freed ram.
-	 */
-	size_t global_nodes_size = global_svm_nodes->size();
-	global_svm_nodes->resize(global_nodes_size + svm_nodes.size());
-
-	/* Offset local SVM nodes to a global address space. */
-	int4& jump_node = (*global_svm_nodes)[shader->id];
-	jump_node.y = svm_nodes[0].y + global_nodes_size - 1;
-	jump_node.z = svm_nodes[0].z + global_nodes_size - 1;
-	jump_node.w = svm_nodes[0].w + global_nodes_size - 1;
-	/* Copy new nodes to global storage. */
-	memcpy(&(*global_svm_nodes)[global_nodes_size],
-	       &svm_nodes[1],
-	       sizeof(int4) * (svm_nodes.size() - 1));
-	nodes_lock_.unlock();
 }
 
 void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
@@ -104,22 +198,18 @@ void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene
 	/* determine which shaders are in use */
 	device_update_shaders_used(scene);
 
-	/* svm_nodes */
-	array<int4> svm_nodes;
-	size_t i;
-
-	for(i = 0; i < scene->shaders.size(); i++) {
-		svm_nodes.push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
-	}
+	/* determine which shaders need to be compiled */
+	vector<Shader*> compile_shaders;
+	device_update_compiled_shaders(scene, compile_shaders);
 
+	/* finalize and hash graphs of modified shaders */
 	TaskPool task_pool;
-	foreach(Shader *shader, scene->shaders) {
-		task_pool.push(function_bind(&SVMShaderManager::device_update_shader,
+	foreach(Shader *shader, compile_shaders) {
+		task_pool.push(function_bind(&SVMShaderManager::device_update_shader_hash,
 		                             this,
 		                             scene,
 		                             shader,
-		                             &progress,
-		                             &svm_nodes),
+		                             &progress),
 		               false);
 	}
 	task_pool.wait_work();
@@ -128,6 +218,95 @@ void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene
 		return;
 	}
 
+	/* Shaders with identical graphs share nodes of a single shader, either of
+	 * one compiled in a previous update or of the first one found here. */
+	map<string, Shader*> sources;
+	for(CompiledShaderMap::iterator it = compiled_shaders_.begin();
+	    it != compiled_shaders_.end();
+	    ++it)
+	{
+		const CompiledShader& compiled = it->second;
+		if(compiled.source == it->first) {
+			string key = string_printf("%s-%d-%d",
+			                           compiled.graph_hash.c_str(),
+			                           (int)compiled.background,
+			                           (int)compiled.used);
+			sources[key] = it->first;
+		}
+	}
+
+	vector<Shader*> shared_shaders;
+	foreach(Shader *shader, compile_shaders) {
+		CompiledShader& compiled = compiled_shaders_[shader];
+		string key = string_printf("%s-%d-%d",
+		                           compiled.graph_hash.c_str(),
+		                           (int)compiled.background,
+		                           (int)compiled.used);
+		map<string, Shader*>::iterator it = sources.find(key);
+		if(it != sources.end() && it->second != shader) {
+			compiled.source = it->second;
+			shared_shaders.push_back(shader);
+		}
+		else {
+			compiled.source = shader;
+			sources[key] = shader;
+			task_pool.push(function_bind(&SVMShaderManager::device_update_shader,
+			                             this,
+			                             scene,
+			                             shader,
+			                             &progress),
+			               false);
+		}
+	}
+	task_pool.wait_work();
+
+	if(progress.get_cancel()) {
+		return;
+	}
+
+	foreach(Shader *shader, shared_shaders) {
+		svm_shader_copy_flags(shader, compiled_shaders_[shader].source);
+	}
+
+	/* svm_nodes */
+	array<int4> svm_nodes;
+	size_t i;
+
+	for(i = 0; i < scene->shaders.size(); i++) {
+		svm_nodes.push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
+	}
+
+	/* Copy nodes of every source shader to global storage once, and offset
+	 * local SVM nodes to the global address space. */
+	map<Shader*, size_t> source_offsets;
+	foreach(Shader *shader, scene->shaders) {
+		if(shader->use_mis && shader->has_surface_emission) {
+			scene->light_manager->need_update = true;
+		}
+
+		Shader *source = compiled_shaders_[shader].source;
+		const array<int4>& local_nodes = compiled_shaders_[source].svm_nodes;
+
+		size_t global_nodes_size;
+		map<Shader*, size_t>::iterator it = source_offsets.find(source);
+		if(it == source_offsets.end()) {
+			global_nodes_size = svm_nodes.size();
+			source_offsets[source] = global_nodes_size;
+			svm_nodes.resize(global_nodes_size + local_nodes.size() - 1);
+			memcpy(&svm_nodes[global_nodes_size],
+			       &local_nodes[1],
+			       sizeof(int4) * (local_nodes.size() - 1));
+		}
+		else {
+			global_nodes_size = it->second;
+		}
+
+		int4& jump_node = svm_nodes[shader->id];
+		jump_node.y = local_nodes[0].y + global_nodes_size - 1;
+		jump_node.z = local_nodes[0].z + global_nodes_size - 1;
+		jump_node.w = local_nodes[0].w + global_nodes_size - 1;
+	}
+
 	dscene->svm_nodes.steal_data(svm_nodes);
 	dscene->svm_nodes.copy_to_device();
 
@@ -142,7 +321,10 @@ void SVMShaderManager::device_update(Device *device, DeviceScene *dscene, Scene
 
 	VLOG(1) << "Shader manager updated "
 	        << scene->shaders.size() << " shaders in "
-	        << time_dt() - start_time << " seconds.";
+	        << time_dt() - start_time << " seconds, "
+	        << compile_shaders.size() - shared_shaders.size() << " compiled, "
+	        << shared_shaders.size() << " shared, "
+	        << scene->shaders.size() - compile_shaders.size() << " cached.";
 }
 
 void SVMShaderManager::device_free(Device *device, DeviceScene *dscene, Scene *scene)
@@ -22,9 +22,11 @@
 #include "render/shader.h"
 
 #include "util/util_array.h"
+#include "util/util_map.h"
 #include "util/util_set.h"
 #include "util/util_string.h"
 #include "util/util_thread.h"
+#include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -50,13 +52,36 @@ public:
 	void device_free(Device *device, DeviceScene *dscene, Scene *scene);
 
 protected:
-	/* Lock used to synchronize threaded nodes compilation. */
-	thread_spin_lock nodes_lock_;
+	/* SVM nodes of a compiled shader, kept between updates so that unchanged
+	 * shaders are not compiled again, and shaders with identical graphs share
+	 * a single copy of the nodes. */
+	struct CompiledShader {
+		CompiledShader();
+
+		/* Hash of the finalized shader graph. */
+		string graph_hash;
+		/* Local SVM nodes, the first node is the jump node. */
+		array<int4> svm_nodes;
+		/* Settings which affect the generated nodes. */
+		bool background;
+		bool used;
+		/* Shader whose nodes are used. Image and IES slots referenced by the
+		 * nodes are owned by the graph of this shader, so they are only valid
+		 * for as long as it is not modified or removed. */
+		Shader *source;
+	};
+
+	typedef unordered_map<Shader*, CompiledShader> CompiledShaderMap;
+	CompiledShaderMap compiled_shaders_;
 
+	void device_update_compiled_shaders(Scene *scene,
+	                                    vector<Shader*>& compile_shaders);
+	void device_update_shader_hash(Scene *scene,
+	                               Shader *shader,
+	                               Progress *progress);
 	void device_update_shader(Scene *scene,
 	                          Shader *shader,
-	                          Progress *progress,
-	                          array<int4> *global_svm_nodes);
+	                          Progress *progress);
 };
 
 /* Graph Compiler */
@@ -102,9 +102,11 @@ TileManager::TileManager(bool progressive_, int num_samples_, int2 tile_size_, i
 	preserve_tile_device = preserve_tile_device_;
 	background = background_;
 	schedule_denoising = false;
+	denoise_after_render = false;
 
 	range_start_sample = 0;
 	range_num_samples = -1;
+	resume_sample = 0;
 
 	BufferParams buffer_params;
 	reset(buffer_params, 0);
@@ -147,10 +149,12 @@ void TileManager::reset(BufferParams& params_, int num_samples_)
 	set_samples(num_samples_);
 
 	state.buffer = BufferParams();
-	state.sample = range_start_sample - 1;
+	state.sample = get_first_sample() - 1;
 	state.num_tiles = 0;
 	state.num_samples = 0;
-	state.resolution_divider = get_divider(params.width, params.height, start_resolution);
+	/* No need for low resolution previews when continuing from existing samples. */
+	state.resolution_divider = (get_first_sample() != range_start_sample)?
+	        pixel_size: get_divider(params.width, params.height, start_resolution);
 	state.render_tiles.clear();
 	state.denoising_tiles.clear();
 	device_free();
@@ -462,6 +466,17 @@ bool TileManager::finish_tile(int index, bool &delete_tile)
 	}
 }
 
+void TileManager::skip_tile(int index)
+{
+	Tile& tile = state.tiles[index];
+
+	if(tile.device < state.render_tiles.size()) {
+		state.render_tiles[tile.device].remove(index);
+	}
+
+	tile.state = Tile::DONE;
+}
+
 bool TileManager::next_tile(Tile* &tile, int device)
 {
 	int logical_device = preserve_tile_device? device: 0;
@@ -469,7 +484,9 @@ bool TileManager::next_tile(Tile* &tile, int device)
 	if(logical_device >= state.render_tiles.size())
 		return false;
 
-	if(!state.denoising_tiles[logical_device].empty()) {
+	bool render_first = denoise_after_render && !state.render_tiles[logical_device].empty();
+
+	if(!render_first && !state.denoising_tiles[logical_device].empty()) {
 		int idx = state.denoising_tiles[logical_device].front();
 		state.denoising_tiles[logical_device].pop_front();
 		tile = &state.tiles[idx];
@@ -485,6 +502,27 @@ bool TileManager::next_tile(Tile* &tile, int device)
 	return true;
 }
 
+/* Returns whether tiles of the device that are still being rendered will make
+ * more tiles available for denoising once they are finished. */
+bool TileManager::has_pending_denoising(int device)
+{
+	if(progressive || !schedule_denoising) {
+		return false;
+	}
+
+	int logical_device = preserve_tile_device? device: 0;
+
+	foreach(Tile& tile, state.tiles) {
+		if(tile.device == logical_device &&
+		   (tile.state == Tile::RENDER || tile.state == Tile::RENDERED))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool TileManager::done()
 {
 	int end_sample = (range_num_samples == -1)
@@ -517,7 +555,7 @@ bool TileManager::next()
 
 		state.resolution_divider = pixel_size;
 
-		if(state.sample == range_start_sample) {
+		if(state.sample == get_first_sample()) {
 			set_tiles();
 		}
 		else {
@@ -528,6 +566,13 @@ bool TileManager::next()
 	return true;
 }
 
+int TileManager::get_first_sample()
+{
+	/* Tiles have their own sample ranges when not rendering progressively,
+	 * so only progressive rendering resumes at a common sample. */
+	return (progressive)? range_start_sample + resume_sample: range_start_sample;
+}
+
 int TileManager::get_num_effective_samples()
 {
 	return (range_num_samples == -1) ? num_samples
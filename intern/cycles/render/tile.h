@@ -97,7 +97,10 @@ public:
 	bool next();
 	bool next_tile(Tile* &tile, int device = 0);
 	bool finish_tile(int index, bool& delete_tile);
+	/* Remove a tile that is already complete from the tiles to be rendered. */
+	void skip_tile(int index);
 	bool done();
+	bool has_pending_denoising(int device = 0);
 
 	void set_tile_order(TileOrder tile_order_) { tile_order = tile_order_; }
 
@@ -112,11 +115,20 @@ public:
 	/* Get number of actual samples to render. */
 	int get_num_effective_samples();
 
+	/* Number of samples already in the buffers when progressive rendering
+	 * continues from a checkpoint, used on the next reset. */
+	int resume_sample;
+
 	/* Schedule tiles for denoising after they've been rendered. */
 	bool schedule_denoising;
+
+	/* Only hand out tiles for denoising once all tiles have been handed out for
+	 * rendering, so the whole frame is denoised at the end using all threads. */
+	bool denoise_after_render;
 protected:
 
 	void set_tiles();
+	int get_first_sample();
 
 	bool progressive;
 	int2 tile_size;
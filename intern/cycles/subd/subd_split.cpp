@@ -238,6 +238,13 @@ void DiagSplit::split_quad(Patch *patch, QuadDice::SubPatch *subpatch)
 	limit_edge_factors(sub_split, ef_split, 1 << params.max_level);
 
 	split(sub_split, ef_split);
+}
+
+void DiagSplit::dice_quads()
+{
+	if(subpatches_quad.size() == 0) {
+		return;
+	}
 
 	QuadDice dice(params);
 
@@ -51,7 +51,12 @@ public:
 	void dispatch(QuadDice::SubPatch& sub, QuadDice::EdgeFactors& ef);
 	void split(QuadDice::SubPatch& sub, QuadDice::EdgeFactors& ef, int depth=0);
 
+	/* Split a patch into subpatches, without dicing them yet. This only
+	 * evaluates the patch, so it can run in parallel for different patches
+	 * as long as each thread uses its own DiagSplit. */
 	void split_quad(Patch *patch, QuadDice::SubPatch *subpatch=NULL);
+	/* Dice all subpatches collected so far into the mesh, in order. */
+	void dice_quads();
 };
 
 CCL_NAMESPACE_END
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+#include "render_test_fixture.h"
+
+#include "device/device.h"
+#include "device/device_task.h"
+#include "render/buffers.h"
+#include "render/film.h"
+#include "util/util_function.h"
+#include "util/util_hash.h"
+#include "util/util_task.h"
+#include "util/util_thread.h"
+#include "util/util_time.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Denoises a single tile covering the whole frame, using feature passes that
+ * are generated with a fixed seed so every run denoises the same data. */
+class DenoiseFrame {
+public:
+	DenoiseFrame(Device *device, int width, int height, int samples)
+	: device(device), buffers(NULL), samples(samples), tile_taken(false)
+	{
+		params.width = params.full_width = width;
+		params.height = params.full_height = height;
+		params.full_x = params.full_y = 0;
+		Pass::add(PASS_COMBINED, params.passes);
+		params.denoising_data_pass = true;
+
+		buffers = new RenderBuffers(device);
+		buffers->reset(params);
+		fill_passes();
+	}
+
+	~DenoiseFrame()
+	{
+		delete buffers;
+	}
+
+	/* Runs the denoiser, returns the time it took in seconds. */
+	double run(vector<float> *result)
+	{
+		buffers->buffer.copy_to_device();
+		tile_taken = false;
+
+		DeviceTask task(DeviceTask::RENDER);
+		task.acquire_tile = function_bind(&DenoiseFrame::acquire_tile, this, _1, _2);
+		task.release_tile = function_bind(&DenoiseFrame::release_tile, this, _1);
+		task.map_neighbor_tiles = function_bind(&DenoiseFrame::map_neighbor_tiles, this, _1, _2);
+		task.unmap_neighbor_tiles = function_bind(&DenoiseFrame::unmap_neighbor_tiles, this, _1, _2);
+		task.get_cancel = function_bind(&DenoiseFrame::get_cancel, this);
+		task.need_finish_queue = false;
+		task.integrator_branched = false;
+		task.passes_size = params.get_passes_size();
+
+		task.denoising_radius = 8;
+		task.denoising_strength = 0.5f;
+		task.denoising_feature_strength = 0.5f;
+		task.denoising_relative_pca = false;
+		task.pass_stride = params.get_passes_size();
+		task.frame_stride = 0;
+		task.target_pass_stride = task.pass_stride;
+		task.pass_denoising_data = params.get_denoising_offset();
+		task.pass_denoising_clean = 0;
+		task.denoising_from_render = true;
+		task.denoising_do_filter = true;
+		task.denoising_write_passes = false;
+
+		double start_time = time_dt();
+		device->task_add(task);
+		device->task_wait();
+		double time = time_dt() - start_time;
+
+		buffers->copy_from_device();
+		result->assign(buffers->buffer.data(), buffers->buffer.data() + buffers->buffer.size());
+
+		return time;
+	}
+
+protected:
+	Device *device;
+	BufferParams params;
+	RenderBuffers *buffers;
+	int samples;
+
+	thread_mutex tile_mutex;
+	bool tile_taken;
+
+	float random(uint x, uint y, uint channel)
+	{
+		return hash_int_01(hash_int_2d(x, y) ^ (channel * 0x9E3779B9u));
+	}
+
+	/* Writes accumulated feature passes of a simple scene: a smooth gradient
+	 * with a hard edge and a shadowed region, plus per-pixel noise. */
+	void fill_passes()
+	{
+		int pass_stride = params.get_passes_size();
+		int offset = params.get_denoising_offset();
+		float *data = buffers->buffer.data();
+		float s = (float)samples;
+
+		for(int y = 0; y < params.height; y++) {
+			for(int x = 0; x < params.width; x++) {
+				float *pixel = data + (y*params.width + x)*pass_stride;
+				float *denoising = pixel + offset;
+
+				float fx = (float)x / params.width;
+				float fy = (float)y / params.height;
+				bool edge = (fx + 0.3f*fy) > 0.5f;
+				float visibility = (fy > 0.6f)? 0.2f: 1.0f;
+
+				float3 normal = edge? make_float3(0.0f, 0.0f, 1.0f): make_float3(0.6f, 0.0f, 0.8f);
+				float3 albedo = edge? make_float3(0.8f, 0.2f, 0.1f): make_float3(0.2f, 0.5f, 0.7f);
+				float depth = 2.0f + fx;
+
+				for(int c = 0; c < 3; c++) {
+					float n = 0.1f*(random(x, y, c) - 0.5f);
+					denoising[DENOISING_PASS_NORMAL + c] = s*(normal[c] + n);
+					denoising[DENOISING_PASS_NORMAL_VAR + c] = s*(normal[c]*normal[c] + 0.01f);
+					denoising[DENOISING_PASS_ALBEDO + c] = s*(albedo[c] + n);
+					denoising[DENOISING_PASS_ALBEDO_VAR + c] = s*(albedo[c]*albedo[c] + 0.01f);
+				}
+				denoising[DENOISING_PASS_DEPTH] = s*depth;
+				denoising[DENOISING_PASS_DEPTH_VAR] = s*(depth*depth + 0.01f);
+
+				for(int half = 0; half < 2; half++) {
+					float *shadow = denoising + ((half == 0)? DENOISING_PASS_SHADOW_A: DENOISING_PASS_SHADOW_B);
+					float v = visibility * (0.8f + 0.4f*random(x, y, 3 + half));
+					shadow[0] = 0.5f*s;
+					shadow[1] = 0.5f*s*v;
+					shadow[2] = 0.5f*s*(v*v + 0.05f);
+				}
+
+				for(int c = 0; c < 3; c++) {
+					float color = albedo[c] * visibility * (0.5f + fy);
+					float noisy = color * (0.5f + random(x, y, 5 + c));
+					pixel[c] = s*noisy;
+					denoising[DENOISING_PASS_COLOR + c] = s*noisy;
+					denoising[DENOISING_PASS_COLOR_VAR + c] = s*(noisy*noisy + 0.1f*color);
+				}
+				pixel[3] = s;
+			}
+		}
+	}
+
+	bool acquire_tile(Device * /*tile_device*/, RenderTile& rtile)
+	{
+		thread_scoped_lock tile_lock(tile_mutex);
+		if(tile_taken) {
+			return false;
+		}
+		tile_taken = true;
+
+		rtile.task = RenderTile::DENOISE;
+		rtile.x = rtile.y = 0;
+		rtile.w = params.width;
+		rtile.h = params.height;
+		rtile.start_sample = 0;
+		rtile.num_samples = samples;
+		rtile.sample = samples;
+		rtile.resolution = 1;
+		rtile.tile_index = 0;
+		rtile.buffer = buffers->buffer.device_pointer;
+		rtile.buffers = buffers;
+		params.get_offset_stride(rtile.offset, rtile.stride);
+		return true;
+	}
+
+	void release_tile(RenderTile& /*rtile*/)
+	{
+	}
+
+	void map_neighbor_tiles(RenderTile *tiles, Device * /*tile_device*/)
+	{
+		/* The frame has no neighbors, they are empty tiles on its border. */
+		for(int dy = -1, i = 0; dy <= 1; dy++) {
+			for(int dx = -1; dx <= 1; dx++, i++) {
+				if(i == 4) {
+					continue;
+				}
+				tiles[i].buffer = (device_ptr)NULL;
+				tiles[i].buffers = NULL;
+				tiles[i].x = (dx > 0)? params.width: 0;
+				tiles[i].y = (dy > 0)? params.height: 0;
+				tiles[i].w = tiles[i].h = 0;
+			}
+		}
+		tiles[9] = tiles[4];
+	}
+
+	void unmap_neighbor_tiles(RenderTile * /*tiles*/, Device * /*tile_device*/)
+	{
+	}
+
+	bool get_cancel()
+	{
+		return false;
+	}
+};
+
+}  // namespace
+
+class DeviceDenoising : public CPUDeviceTest
+{
+};
+
+/* The result must not depend on how many threads share the work. */
+TEST_F(DeviceDenoising, threads_deterministic)
+{
+	vector<float> single_thread, all_threads;
+
+	TaskScheduler::init(1);
+	reset_device();
+	{
+		DenoiseFrame frame(device, 96, 64, 16);
+		frame.run(&single_thread);
+	}
+	TaskScheduler::exit();
+
+	TaskScheduler::init(0);
+	reset_device();
+	{
+		DenoiseFrame frame(device, 96, 64, 16);
+		frame.run(&all_threads);
+	}
+	TaskScheduler::exit();
+
+	ASSERT_EQ(single_thread.size(), all_threads.size());
+	EXPECT_EQ(0, memcmp(&single_thread[0], &all_threads[0], sizeof(float)*single_thread.size()));
+}
+
+/* Benchmark of denoising a whole 1080p frame, run it with
+ * --gtest_also_run_disabled_tests. */
+TEST_F(DeviceDenoising, DISABLED_benchmark_whole_frame)
+{
+	const int num_threads[] = {1, 0};
+	vector<float> result;
+
+	for(int i = 0; i < 2; i++) {
+		TaskScheduler::init(num_threads[i]);
+		reset_device();
+		{
+			DenoiseFrame frame(device, 1920, 1080, 64);
+			double time = frame.run(&result);
+			printf("Denoised 1920x1080 frame with %d threads in %.3f seconds\n",
+			       TaskScheduler::num_threads(), time);
+		}
+		TaskScheduler::exit();
+	}
+}
+
+CCL_NAMESPACE_END
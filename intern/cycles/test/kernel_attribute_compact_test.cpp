@@ -0,0 +1,84 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "util/util_math.h"
+#include "util/util_types.h"
+
+#include "kernel/geom/geom_attribute_compact.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(kernel_attribute_compact, half_round_trip)
+{
+	/* Grid of texture coordinates in the [-1, 1] range. */
+	for(int i = -63; i <= 63; i++) {
+		for(int j = -63; j <= 63; j++) {
+			const float3 uv = make_float3(i * (1.0f / 64.0f) + 0.0013f,
+			                              j * (1.0f / 64.0f) - 0.0007f,
+			                              0.0f);
+			EXPECT_TRUE(attribute_half_is_precise(uv)) << uv.x << " " << uv.y;
+
+			const float3 decoded = attribute_half_decode(attribute_half_encode(uv));
+			EXPECT_NEAR(uv.x, decoded.x, ATTR_HALF_TOLERANCE);
+			EXPECT_NEAR(uv.y, decoded.y, ATTR_HALF_TOLERANCE);
+			EXPECT_EQ(0.0f, decoded.z);
+		}
+	}
+
+	/* Exact values are kept as they are. */
+	const float3 exact = make_float3(0.0f, -0.5f, 0.0f);
+	const float3 decoded = attribute_half_decode(attribute_half_encode(exact));
+	EXPECT_EQ(exact.x, decoded.x);
+	EXPECT_EQ(exact.y, decoded.y);
+}
+
+TEST(kernel_attribute_compact, half_fallback)
+{
+	/* Out of range coordinates, such as UDIM tiles, stay full floats. */
+	EXPECT_FALSE(attribute_half_is_precise(make_float3(2.5f, 0.5f, 0.0f)));
+	EXPECT_FALSE(attribute_half_is_precise(make_float3(0.5f, -3.0f, 0.0f)));
+	EXPECT_FALSE(attribute_half_is_precise(make_float3(1000.0f, 0.0f, 0.0f)));
+
+	/* Between 1 and 2 halfs are only 1/1024 apart, which loses too much. */
+	const float3 imprecise = make_float3(1.0f + 1.0f / 2048.0f, 0.25f, 0.0f);
+	EXPECT_FALSE(attribute_half_is_precise(imprecise));
+	const float3 decoded = attribute_half_decode(attribute_half_encode(imprecise));
+	EXPECT_GT(fabsf(decoded.x - imprecise.x), ATTR_HALF_TOLERANCE);
+
+	/* Unless they are represented exactly. */
+	EXPECT_TRUE(attribute_half_is_precise(make_float3(1.5f, 2.0f, 0.0f)));
+	EXPECT_TRUE(attribute_half_is_precise(make_float3(-2.0f, 1.0f, 0.0f)));
+}
+
+TEST(kernel_attribute_compact, octahedral_round_trip)
+{
+	const float3 normals[] = {make_float3(0.0f, 0.0f, 1.0f),
+	                          make_float3(0.0f, 0.0f, -1.0f),
+	                          make_float3(1.0f, 0.0f, 0.0f),
+	                          normalize(make_float3(0.3f, -0.7f, 0.2f)),
+	                          normalize(make_float3(-0.5f, 0.4f, -0.9f))};
+
+	for(size_t i = 0; i < sizeof(normals) / sizeof(*normals); i++) {
+		const float3 decoded = attribute_octahedral_decode(attribute_octahedral_encode(normals[i]));
+		EXPECT_NEAR(normals[i].x, decoded.x, 1e-4f);
+		EXPECT_NEAR(normals[i].y, decoded.y, 1e-4f);
+		EXPECT_NEAR(normals[i].z, decoded.z, 1e-4f);
+	}
+}
+
+CCL_NAMESPACE_END
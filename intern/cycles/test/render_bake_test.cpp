@@ -0,0 +1,134 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+#include "render_test_fixture.h"
+
+#include "render/bake.h"
+#include "render/mesh.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "util/util_function.h"
+#include "util/util_progress.h"
+#include "util/util_task.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* All pixels sample the center of the first triangle. */
+void populate_triangle_center(BakeData *data)
+{
+	float uv[2] = {1.0f/3.0f, 1.0f/3.0f};
+	for(size_t i = 0; i < data->size(); i++) {
+		data->set(i, 0, uv, 0.0f, 0.0f, 0.0f, 0.0f);
+	}
+}
+
+}  // namespace
+
+class RenderBake : public CPUDeviceTest
+{
+protected:
+	SceneParams scene_params;
+	Scene *scene;
+
+	virtual void SetUp()
+	{
+		TaskScheduler::init();
+		CPUDeviceTest::SetUp();
+		scene = new Scene(scene_params, device);
+	}
+
+	virtual void TearDown()
+	{
+		delete scene;
+		CPUDeviceTest::TearDown();
+		TaskScheduler::exit();
+	}
+
+	/* Flat shaded triangle with the given corners. */
+	void add_triangle_object(float3 a, float3 b, float3 c)
+	{
+		Mesh *mesh = new Mesh();
+		mesh->used_shaders.push_back(scene->default_surface);
+		mesh->reserve_mesh(3, 1);
+		mesh->add_vertex(a);
+		mesh->add_vertex(b);
+		mesh->add_vertex(c);
+		mesh->add_triangle(0, 1, 2, 0, false);
+		scene->meshes.push_back(mesh);
+
+		Object *object = new Object();
+		object->mesh = mesh;
+		object->tfm = transform_identity();
+		scene->objects.push_back(object);
+	}
+
+	BakeJob normal_job(int object, vector<float>& result)
+	{
+		BakeJob job;
+		job.object = object;
+		job.tri_offset = scene->objects[object]->mesh->tri_offset;
+		job.num_pixels = result.size() / 4;
+		job.shader_type = SHADER_EVAL_NORMAL;
+		job.populate = function_bind(&populate_triangle_center, _1);
+		job.result = &result[0];
+		return job;
+	}
+};
+
+/* Both jobs are baked in one call, pixels of each object must end up in the
+ * result of its own job. */
+TEST_F(RenderBake, two_jobs)
+{
+	/* Facing +Z and +Y. */
+	add_triangle_object(make_float3(0.0f, 0.0f, 0.0f),
+	                    make_float3(1.0f, 0.0f, 0.0f),
+	                    make_float3(0.0f, 1.0f, 0.0f));
+	add_triangle_object(make_float3(0.0f, 0.0f, 2.0f),
+	                    make_float3(0.0f, 0.0f, 3.0f),
+	                    make_float3(1.0f, 0.0f, 2.0f));
+
+	Progress progress;
+	scene->bake_manager->set_baking(true);
+	scene->device_update(device, progress);
+	ASSERT_FALSE(progress.get_error());
+
+	/* More pixels than fit in a device task, tasks span both jobs. */
+	scene->bake_manager->set_shader_limit(8, 8);
+	vector<float> result_z(100 * 4, -1.0f), result_y(30 * 4, -1.0f);
+	vector<BakeJob> jobs;
+	jobs.push_back(normal_job(0, result_z));
+	jobs.push_back(normal_job(1, result_y));
+
+	EXPECT_TRUE(scene->bake_manager->bake(device, &scene->dscene, scene, progress, jobs));
+	EXPECT_FALSE(scene->bake_manager->get_baking());
+
+	/* Normals are encoded as color = (normal + 1) / 2. */
+	for(size_t i = 0; i < result_z.size(); i += 4) {
+		EXPECT_NEAR(0.5f, result_z[i + 0], 1e-4f);
+		EXPECT_NEAR(0.5f, result_z[i + 1], 1e-4f);
+		EXPECT_NEAR(1.0f, result_z[i + 2], 1e-4f);
+	}
+	for(size_t i = 0; i < result_y.size(); i += 4) {
+		EXPECT_NEAR(0.5f, result_y[i + 0], 1e-4f);
+		EXPECT_NEAR(1.0f, result_y[i + 1], 1e-4f);
+		EXPECT_NEAR(0.5f, result_y[i + 2], 1e-4f);
+	}
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+#include "render_test_fixture.h"
+
+#include "device/device.h"
+#include "render/buffers.h"
+#include "render/checkpoint.h"
+#include "render/film.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+class CheckpointFrame {
+public:
+	CheckpointFrame(Device *device, int width, int height)
+	: buffers(NULL)
+	{
+		params.width = params.full_width = width;
+		params.height = params.full_height = height;
+		params.full_x = 10;
+		params.full_y = 20;
+		Pass::add(PASS_COMBINED, params.passes);
+
+		buffers = new RenderBuffers(device);
+		buffers->reset(params);
+	}
+
+	~CheckpointFrame()
+	{
+		delete buffers;
+	}
+
+	RenderTile tile(int x, int y, int w, int h)
+	{
+		RenderTile rtile;
+		rtile.x = params.full_x + x;
+		rtile.y = params.full_y + y;
+		rtile.w = w;
+		rtile.h = h;
+		rtile.buffers = buffers;
+		params.get_offset_stride(rtile.offset, rtile.stride);
+		return rtile;
+	}
+
+	void fill(float value)
+	{
+		float *data = buffers->buffer.data();
+		for(size_t i = 0; i < buffers->buffer.size(); i++) {
+			data[i] = value + (float)i;
+		}
+	}
+
+	BufferParams params;
+	RenderBuffers *buffers;
+};
+
+/* Writes the file with one 32 bit value replaced. */
+bool write_modified(const string& filepath, vector<uint8_t> data, int index, int value)
+{
+	memcpy(&data[index*sizeof(int)], &value, sizeof(int));
+	return path_write_binary(filepath, data);
+}
+
+}  // namespace
+
+class RenderCheckpointTest : public CPUDeviceTest
+{
+};
+
+TEST_F(RenderCheckpointTest, write_read_restore)
+{
+	CheckpointFrame frame(device, 16, 8);
+	string filepath = temp_filepath("checkpoint.ckpt");
+
+	RenderCheckpoint checkpoint;
+	checkpoint.reset(frame.params);
+	frame.fill(1.0f);
+	checkpoint.add_tile(frame.tile(0, 0, 8, 8), 32);
+	checkpoint.add_tile(frame.tile(8, 0, 8, 8), 32);
+	vector<float> expected(frame.buffers->buffer.data(),
+	                       frame.buffers->buffer.data() + frame.buffers->buffer.size());
+	ASSERT_TRUE(checkpoint.write(filepath));
+
+	RenderCheckpoint resume;
+	ASSERT_TRUE(resume.read(filepath));
+	EXPECT_TRUE(resume.matches(frame.params));
+
+	frame.fill(-1000.0f);
+	EXPECT_EQ(32, resume.restore_tile(frame.tile(0, 0, 16, 8)));
+	EXPECT_EQ(0, memcmp(&expected[0], frame.buffers->buffer.data(), sizeof(float)*expected.size()));
+}
+
+TEST_F(RenderCheckpointTest, partial_coverage)
+{
+	CheckpointFrame frame(device, 16, 8);
+
+	RenderCheckpoint checkpoint;
+	checkpoint.reset(frame.params);
+	frame.fill(1.0f);
+	checkpoint.add_tile(frame.tile(0, 0, 8, 8), 32);
+	checkpoint.add_tile(frame.tile(8, 0, 8, 4), 16);
+
+	EXPECT_EQ(32, checkpoint.get_sample(frame.params.full_x, frame.params.full_y, 8, 8));
+	EXPECT_EQ(16, checkpoint.get_sample(frame.params.full_x + 8, frame.params.full_y, 8, 4));
+	/* Mixed sample counts and missing pixels can't be restored. */
+	EXPECT_EQ(0, checkpoint.get_sample(frame.params.full_x, frame.params.full_y, 16, 4));
+	EXPECT_EQ(0, checkpoint.restore_tile(frame.tile(8, 0, 8, 8)));
+}
+
+TEST_F(RenderCheckpointTest, mismatched_params)
+{
+	CheckpointFrame frame(device, 16, 8);
+	RenderCheckpoint checkpoint;
+	checkpoint.reset(frame.params);
+
+	BufferParams params = frame.params;
+	params.width = 32;
+	EXPECT_FALSE(checkpoint.matches(params));
+
+	params = frame.params;
+	Pass::add(PASS_DEPTH, params.passes);
+	EXPECT_FALSE(checkpoint.matches(params));
+}
+
+/* Damaged files are rejected before allocating memory for their contents. */
+TEST_F(RenderCheckpointTest, invalid_files)
+{
+	CheckpointFrame frame(device, 16, 8);
+	string filepath = temp_filepath("checkpoint.ckpt");
+
+	RenderCheckpoint checkpoint;
+	checkpoint.reset(frame.params);
+	frame.fill(1.0f);
+	checkpoint.add_tile(frame.tile(0, 0, 8, 8), 32);
+	ASSERT_TRUE(checkpoint.write(filepath));
+
+	vector<uint8_t> data;
+	ASSERT_TRUE(path_read_binary(filepath, data));
+
+	/* Indices of the values in a file with a single pass and tile. */
+	const int num_passes = 7, pass_type = 8, num_tiles = 9;
+	const int tile_x = 10, tile_y = 11, tile_w = 12, tile_h = 13;
+	const int full_x = frame.params.full_x, full_y = frame.params.full_y;
+
+	RenderCheckpoint resume;
+	ASSERT_TRUE(resume.read(filepath));
+
+	ASSERT_TRUE(write_modified(filepath, data, num_passes, PASS_CATEGORY_LIGHT_END + 1));
+	EXPECT_FALSE(resume.read(filepath));
+	ASSERT_TRUE(write_modified(filepath, data, pass_type, PASS_CATEGORY_LIGHT_END + 1));
+	EXPECT_FALSE(resume.read(filepath));
+	ASSERT_TRUE(write_modified(filepath, data, num_tiles, 16*8 + 1));
+	EXPECT_FALSE(resume.read(filepath));
+	ASSERT_TRUE(write_modified(filepath, data, tile_x, full_x - 1));
+	EXPECT_FALSE(resume.read(filepath));
+	ASSERT_TRUE(write_modified(filepath, data, tile_y, full_y + 1));
+	EXPECT_FALSE(resume.read(filepath));
+	ASSERT_TRUE(write_modified(filepath, data, tile_w, 17));
+	EXPECT_FALSE(resume.read(filepath));
+	ASSERT_TRUE(write_modified(filepath, data, tile_h, 0x7fffffff));
+	EXPECT_FALSE(resume.read(filepath));
+	EXPECT_EQ(0, resume.get_sample(full_x, full_y, 8, 8));
+
+	/* Truncated tile data. */
+	data.resize(data.size() - sizeof(float));
+	ASSERT_TRUE(path_write_binary(filepath, data));
+	EXPECT_FALSE(resume.read(filepath));
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+#include "render_test_fixture.h"
+
+#include "render/graph.h"
+#include "render/integrator.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/scene_binary.h"
+#include "render/shader.h"
+
+CCL_NAMESPACE_BEGIN
+
+class RenderSceneBinary : public CPUDeviceTest
+{
+protected:
+	SceneParams scene_params;
+	vector<Scene*> scenes;
+
+	virtual void TearDown()
+	{
+		foreach(Scene *scene, scenes) {
+			delete scene;
+		}
+		CPUDeviceTest::TearDown();
+	}
+
+	Scene *create_scene()
+	{
+		scenes.push_back(new Scene(scene_params, device));
+		return scenes.back();
+	}
+
+	/* Single triangle mesh with a UV attribute. */
+	Mesh *add_triangle_mesh(Scene *scene, Shader *shader)
+	{
+		Mesh *mesh = new Mesh();
+		mesh->used_shaders.push_back(shader);
+		mesh->reserve_mesh(3, 1);
+		mesh->add_vertex(make_float3(0.0f, 0.0f, 0.0f));
+		mesh->add_vertex(make_float3(1.0f, 0.0f, 0.0f));
+		mesh->add_vertex(make_float3(0.0f, 1.0f, 0.0f));
+		mesh->add_triangle(0, 1, 2, 0, true);
+		Attribute *attr = mesh->attributes.add(ATTR_STD_UV, ustring("UVMap"));
+		float3 *uv = attr->data_float3();
+		uv[0] = make_float3(0.0f, 0.0f, 0.0f);
+		uv[1] = make_float3(1.0f, 0.0f, 0.0f);
+		uv[2] = make_float3(0.0f, 1.0f, 0.0f);
+		scene->meshes.push_back(mesh);
+		return mesh;
+	}
+};
+
+TEST_F(RenderSceneBinary, write_read)
+{
+	string filepath = temp_filepath("scene.cyb");
+	Scene *scene = create_scene();
+
+	scene->integrator->max_bounce = 3;
+
+	/* Shader with a single diffuse closure. */
+	Shader *shader = new Shader();
+	shader->name = ustring("diffuse");
+	ShaderGraph *graph = new ShaderGraph();
+	DiffuseBsdfNode *diffuse = new DiffuseBsdfNode();
+	diffuse->color = make_float3(0.2f, 0.4f, 0.6f);
+	graph->add(diffuse);
+	graph->connect(diffuse->output("BSDF"), graph->output()->input("Surface"));
+	shader->set_graph(graph);
+	scene->shaders.push_back(shader);
+
+	Mesh *mesh = add_triangle_mesh(scene, shader);
+
+	Object *object = new Object();
+	object->mesh = mesh;
+	object->tfm = transform_translate(1.0f, 2.0f, 3.0f);
+	scene->objects.push_back(object);
+
+	ASSERT_TRUE(scene_write_binary(scene, filepath));
+	EXPECT_TRUE(scene_is_binary(filepath));
+
+	Scene *other = create_scene();
+	size_t num_shaders = other->shaders.size();
+	ASSERT_TRUE(scene_read_binary(other, filepath));
+
+	EXPECT_EQ(3, other->integrator->max_bounce);
+
+	ASSERT_EQ(num_shaders + 1, other->shaders.size());
+	Shader *other_shader = other->shaders.back();
+	EXPECT_EQ(ustring("diffuse"), other_shader->name);
+	ShaderInput *surface = other_shader->graph->output()->input("Surface");
+	ASSERT_TRUE(surface->link != NULL);
+	ShaderNode *other_diffuse = surface->link->parent;
+	EXPECT_EQ(DiffuseBsdfNode::node_type, other_diffuse->type);
+	EXPECT_EQ(0.4f, ((DiffuseBsdfNode*)other_diffuse)->color.y);
+
+	ASSERT_EQ(1, other->meshes.size());
+	Mesh *other_mesh = other->meshes[0];
+	EXPECT_EQ(3, other_mesh->verts.size());
+	EXPECT_EQ(3, other_mesh->triangles.size());
+	ASSERT_EQ(1, other_mesh->used_shaders.size());
+	EXPECT_EQ(other_shader, other_mesh->used_shaders[0]);
+	Attribute *other_attr = other_mesh->attributes.find(ATTR_STD_UV);
+	ASSERT_TRUE(other_attr != NULL);
+	EXPECT_EQ(ustring("UVMap"), other_attr->name);
+	EXPECT_EQ(1.0f, other_attr->data_float3()[2].y);
+
+	ASSERT_EQ(1, other->objects.size());
+	EXPECT_EQ(other_mesh, other->objects[0]->mesh);
+	EXPECT_EQ(3.0f, other->objects[0]->tfm.z.w);
+}
+
+TEST_F(RenderSceneBinary, invalid_file)
+{
+	string filepath = temp_filepath("invalid.cyb");
+	vector<uint8_t> data(64, 0);
+	ASSERT_TRUE(path_write_binary(filepath, data));
+
+	EXPECT_FALSE(scene_is_binary(filepath));
+	EXPECT_FALSE(scene_read_binary(create_scene(), filepath));
+}
+
+/* Attribute data that doesn't match the mesh would be read out of bounds. */
+TEST_F(RenderSceneBinary, invalid_attribute_size)
+{
+	string filepath = temp_filepath("attribute_size.cyb");
+	Scene *scene = create_scene();
+	Mesh *mesh = add_triangle_mesh(scene, scene->default_surface);
+
+	Attribute *attr = mesh->attributes.find(ATTR_STD_UV);
+	attr->buffer.resize(attr->buffer.size() - attr->data_sizeof());
+	ASSERT_TRUE(scene_write_binary(scene, filepath));
+
+	EXPECT_FALSE(scene_read_binary(create_scene(), filepath));
+}
+
+TEST_F(RenderSceneBinary, invalid_attribute_type)
+{
+	string filepath = temp_filepath("attribute_type.cyb");
+	Scene *scene = create_scene();
+	Mesh *mesh = add_triangle_mesh(scene, scene->default_surface);
+
+	Attribute *attr = mesh->attributes.find(ATTR_STD_UV);
+	attr->type = TypeDesc(TypeDesc::FLOAT, TypeDesc::VEC3, TypeDesc::POINT, 1000);
+	ASSERT_TRUE(scene_write_binary(scene, filepath));
+
+	EXPECT_FALSE(scene_read_binary(create_scene(), filepath));
+}
+
+/* Indices into other mesh arrays are not bounds checked when rendering. */
+TEST_F(RenderSceneBinary, invalid_triangle_index)
+{
+	string filepath = temp_filepath("triangle_index.cyb");
+	Scene *scene = create_scene();
+	Mesh *mesh = add_triangle_mesh(scene, scene->default_surface);
+
+	mesh->triangles[2] = 3;
+	ASSERT_TRUE(scene_write_binary(scene, filepath));
+
+	EXPECT_FALSE(scene_read_binary(create_scene(), filepath));
+}
+
+TEST_F(RenderSceneBinary, invalid_shader_index)
+{
+	string filepath = temp_filepath("shader_index.cyb");
+	Scene *scene = create_scene();
+	Mesh *mesh = add_triangle_mesh(scene, scene->default_surface);
+
+	mesh->shader[0] = 1;
+	ASSERT_TRUE(scene_write_binary(scene, filepath));
+
+	EXPECT_FALSE(scene_read_binary(create_scene(), filepath));
+}
+
+TEST_F(RenderSceneBinary, invalid_subd_corner)
+{
+	string filepath = temp_filepath("subd_corner.cyb");
+	Scene *scene = create_scene();
+	Mesh *mesh = add_triangle_mesh(scene, scene->default_surface);
+
+	int corners[3] = {0, 1, 2};
+	mesh->subdivision_type = Mesh::SUBDIVISION_LINEAR;
+	mesh->reserve_subd_faces(1, 0, 3);
+	mesh->add_subd_face(corners, 3, 0, true);
+	ASSERT_TRUE(scene_write_binary(scene, filepath));
+
+	/* The valid mesh is read back. */
+	ASSERT_TRUE(scene_read_binary(create_scene(), filepath));
+
+	mesh->subd_faces[0].num_corners = 4;
+	ASSERT_TRUE(scene_write_binary(scene, filepath));
+
+	EXPECT_FALSE(scene_read_binary(create_scene(), filepath));
+}
+
+CCL_NAMESPACE_END
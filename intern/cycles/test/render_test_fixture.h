@@ -0,0 +1,93 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __RENDER_TEST_FIXTURE_H__
+#define __RENDER_TEST_FIXTURE_H__
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+#include "util/util_foreach.h"
+#include "util/util_path.h"
+#include "util/util_profiling.h"
+#include "util/util_stats.h"
+#include "util/util_string.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Fixture for tests running on the CPU device. Files written by the test go
+ * to the temporary directory and are removed after the test. */
+class CPUDeviceTest : public testing::Test
+{
+protected:
+	Stats stats;
+	Profiler profiler;
+	Device *device;
+
+	CPUDeviceTest()
+	        : testing::Test(),
+	          device(NULL)
+	{
+	}
+
+	virtual void SetUp()
+	{
+		reset_device();
+		ASSERT_TRUE(device != NULL);
+	}
+
+	virtual void TearDown()
+	{
+		foreach(const string& filepath, temp_files) {
+			path_remove(filepath);
+		}
+		delete device;
+	}
+
+	/* Create the device again, it uses as many threads as the task scheduler
+	 * has when it is created. */
+	void reset_device()
+	{
+		delete device;
+		device = NULL;
+
+		vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK_CPU);
+		if(!devices.empty()) {
+			device = Device::create(devices[0], stats, profiler, true);
+		}
+	}
+
+	/* Unique path in the temporary directory, removed after the test. */
+	string temp_filepath(const string& filename)
+	{
+		const testing::TestInfo *info = testing::UnitTest::GetInstance()->current_test_info();
+		string filepath = path_join(testing::internal::TempDir(),
+		                            string_printf("cycles_%s_%s_%s",
+		                                          info->test_case_name(),
+		                                          info->name(),
+		                                          filename.c_str()));
+		temp_files.push_back(filepath);
+		return filepath;
+	}
+
+private:
+	vector<string> temp_files;
+};
+
+CCL_NAMESPACE_END
+
+#endif  /* __RENDER_TEST_FIXTURE_H__ */
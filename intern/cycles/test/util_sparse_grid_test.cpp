@@ -0,0 +1,67 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "util/util_sparse_grid.h"
+
+CCL_NAMESPACE_BEGIN
+
+TEST(util_sparse_grid, sparse_lookup)
+{
+	const size_t width = 37, height = 20, depth = 19;
+	vector<float> voxels(width * height * depth, 0.0f);
+	voxels[0] = 1.0f;
+	voxels[(10 * height + 5) * width + 36] = 2.0f;
+	voxels[(18 * height + 19) * width + 20] = 3.0f;
+
+	array<float> sparse_grid;
+	size_t grid_info_offset = 0;
+	EXPECT_TRUE(create_sparse_grid(&voxels[0],
+	                               width, height, depth,
+	                               &sparse_grid,
+	                               &grid_info_offset));
+	EXPECT_LT(sparse_grid.size(), voxels.size());
+	EXPECT_EQ(grid_info_offset, 4 * TEX_SPARSE_TILE_VOXELS);
+
+	const int *tile_indices = (const int*)(sparse_grid.data() + grid_info_offset);
+	for(size_t z = 0; z < depth; z++) {
+		for(size_t y = 0; y < height; y++) {
+			for(size_t x = 0; x < width; x++) {
+				const size_t index = sparse_grid_voxel_index(tile_indices,
+				                                             x, y, z,
+				                                             width, height);
+				EXPECT_EQ(sparse_grid[index], voxels[(z * height + y) * width + x]);
+			}
+		}
+	}
+}
+
+TEST(util_sparse_grid, dense_fallback)
+{
+	const size_t width = 16, height = 16, depth = 16;
+	vector<float> voxels(width * height * depth, 1.0f);
+
+	array<float> sparse_grid;
+	size_t grid_info_offset = 0;
+	EXPECT_FALSE(create_sparse_grid(&voxels[0],
+	                                width, height, depth,
+	                                &sparse_grid,
+	                                &grid_info_offset));
+	EXPECT_EQ(sparse_grid.size(), 0u);
+}
+
+CCL_NAMESPACE_END
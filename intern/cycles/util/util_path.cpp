@@ -768,6 +768,15 @@ bool path_remove(const string& path)
 	return remove(path.c_str()) == 0;
 }
 
+bool path_rename(const string& from, const string& to)
+{
+#ifdef _WIN32
+	/* Unlike on POSIX the target is not replaced, so remove it first. */
+	remove(to.c_str());
+#endif
+	return rename(from.c_str(), to.c_str()) == 0;
+}
+
 struct SourceReplaceState {
 	typedef map<string, string> ProcessedMapping;
 	/* Base director for all relative include headers. */
@@ -64,6 +64,7 @@ bool path_read_text(const string& path, string& text);
 
 /* File manipulation. */
 bool path_remove(const string& path);
+bool path_rename(const string& from, const string& to);
 
 /* source code utility */
 string path_source_replace_includes(const string& source,
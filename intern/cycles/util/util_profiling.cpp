@@ -52,11 +52,15 @@ void Profiler::run()
 				if(((cur_event >= PROFILING_SHADER_EVAL ) && (cur_event <= PROFILING_SUBSURFACE)) ||
 				   ((cur_event >= PROFILING_CLOSURE_EVAL) && (cur_event <= PROFILING_CLOSURE_VOLUME_SAMPLE))) {
 					shader_samples[cur_shader]++;
+					shader_event_samples[cur_shader*PROFILING_NUM_EVENTS + cur_event]++;
 				}
 			}
 
 			if(cur_object >= 0 && cur_object < object_samples.size()) {
 				object_samples[cur_object]++;
+				if(cur_event < PROFILING_NUM_EVENTS) {
+					object_event_samples[cur_object*PROFILING_NUM_EVENTS + cur_event]++;
+				}
 			}
 		}
 		lock.unlock();
@@ -84,6 +88,8 @@ void Profiler::reset(int num_shaders, int num_objects)
 	event_samples.assign(PROFILING_NUM_EVENTS, 0);
 	shader_samples.assign(num_shaders, 0);
 	object_samples.assign(num_objects, 0);
+	shader_event_samples.assign(num_shaders*PROFILING_NUM_EVENTS, 0);
+	object_event_samples.assign(num_objects*PROFILING_NUM_EVENTS, 0);
 
 	if(running) {
 		start();
@@ -175,4 +181,16 @@ bool Profiler::get_object(int object, uint64_t &samples, uint64_t &hits)
 	return true;
 }
 
+uint64_t Profiler::get_shader_event(int shader, ProfilingEvent event)
+{
+	assert(worker == NULL);
+	return shader_event_samples[shader*PROFILING_NUM_EVENTS + event];
+}
+
+uint64_t Profiler::get_object_event(int object, ProfilingEvent event)
+{
+	assert(worker == NULL);
+	return object_event_samples[object*PROFILING_NUM_EVENTS + event];
+}
+
 CCL_NAMESPACE_END
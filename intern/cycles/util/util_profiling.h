@@ -105,6 +105,10 @@ public:
 	bool get_shader(int shader, uint64_t &samples, uint64_t &hits);
 	bool get_object(int object, uint64_t &samples, uint64_t &hits);
 
+	/* Samples of a shader or object that were taken during the given event. */
+	uint64_t get_shader_event(int shader, ProfilingEvent event);
+	uint64_t get_object_event(int object, ProfilingEvent event);
+
 protected:
 	void run();
 
@@ -115,6 +119,12 @@ protected:
 	vector<uint64_t> shader_samples;
 	vector<uint64_t> object_samples;
 
+	/* Same as above, but additionally split up by ProfilingEvent, to tell
+	 * what part of the kernel a shader or object spent its time in.
+	 * Indexed by shader/object ID * PROFILING_NUM_EVENTS + event. */
+	vector<uint64_t> shader_event_samples;
+	vector<uint64_t> object_event_samples;
+
 	/* Tracks the total amounts every object/shader was hit.
 	 * Used to evaluate relative cost, written by the render thread.
 	 * Indexed by the shader and object IDs that the kernel also uses
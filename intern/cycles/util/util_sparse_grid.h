@@ -0,0 +1,151 @@
+/*
+ * Copyright 2011-2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_SPARSE_GRID_H__
+#define __UTIL_SPARSE_GRID_H__
+
+#include "util/util_array.h"
+#include "util/util_texture.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+/* Sparse Grid
+ *
+ * Sparse storage of 3D image textures, for volumes which are mostly empty.
+ * Voxels are stored in tiles of TEX_SPARSE_TILE_SIZE^3 voxels, followed by a
+ * table with the tile index of every tile of the dense grid. Tiles in which
+ * all voxels are zero are not stored, their entries in the table refer to the
+ * first tile which contains only zeros. That way lookups need no branching.
+ *
+ * Tiles at the upper bounds of the grid are only partially covered by
+ * voxels, the remaining voxels of those tiles are zero. */
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of tiles along an axis of given dense resolution. */
+inline size_t sparse_grid_num_tiles(size_t size)
+{
+	return (size + TEX_SPARSE_TILE_SIZE - 1) >> TEX_SPARSE_TILE_SHIFT;
+}
+
+/* Index of the tile which contains given voxel, in the tile index table. */
+inline size_t sparse_grid_tile_index(int x, int y, int z, size_t width, size_t height)
+{
+	const size_t tiles_x = sparse_grid_num_tiles(width);
+	const size_t tiles_y = sparse_grid_num_tiles(height);
+	return (x >> TEX_SPARSE_TILE_SHIFT) +
+	       tiles_x * ((y >> TEX_SPARSE_TILE_SHIFT) +
+	                  tiles_y * (z >> TEX_SPARSE_TILE_SHIFT));
+}
+
+/* Index of the voxel in the sparse voxel data. */
+inline size_t sparse_grid_voxel_index(const int *tile_indices,
+                                      int x, int y, int z,
+                                      size_t width, size_t height)
+{
+	const int tile = tile_indices[sparse_grid_tile_index(x, y, z, width, height)];
+	return (size_t)tile * TEX_SPARSE_TILE_VOXELS +
+	       (x & TEX_SPARSE_TILE_MASK) +
+	       ((y & TEX_SPARSE_TILE_MASK) << TEX_SPARSE_TILE_SHIFT) +
+	       ((z & TEX_SPARSE_TILE_MASK) << (2 * TEX_SPARSE_TILE_SHIFT));
+}
+
+template<typename T>
+inline bool sparse_grid_voxel_is_zero(const T& voxel)
+{
+	const unsigned char *bytes = (const unsigned char*)&voxel;
+	for(size_t i = 0; i < sizeof(T); i++) {
+		if(bytes[i] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Convert dense voxels to a sparse grid.
+ *
+ * The tile index table is stored at the end of the sparse grid, starting at
+ * element grid_info_offset. Returns false without modifying sparse_grid if
+ * the sparse grid would not use less memory than the dense voxels. */
+template<typename T>
+bool create_sparse_grid(const T *voxels,
+                        const size_t width,
+                        const size_t height,
+                        const size_t depth,
+                        array<T> *sparse_grid,
+                        size_t *grid_info_offset)
+{
+	const size_t tiles_x = sparse_grid_num_tiles(width);
+	const size_t tiles_y = sparse_grid_num_tiles(height);
+	const size_t tiles_z = sparse_grid_num_tiles(depth);
+	const size_t num_tiles = tiles_x * tiles_y * tiles_z;
+
+	/* Find tiles with at least one non-zero voxel. */
+	vector<int> tile_indices(num_tiles, 0);
+	int num_active_tiles = 0;
+
+	for(size_t z = 0; z < depth; z++) {
+		for(size_t y = 0; y < height; y++) {
+			const T *row = voxels + (z * height + y) * width;
+			for(size_t x = 0; x < width; x++) {
+				if(!sparse_grid_voxel_is_zero(row[x])) {
+					int& tile = tile_indices[sparse_grid_tile_index(x, y, z, width, height)];
+					if(tile == 0) {
+						tile = ++num_active_tiles;
+					}
+					/* Skip to the next tile along the row. */
+					x |= TEX_SPARSE_TILE_MASK;
+				}
+			}
+		}
+	}
+
+	/* Tile index table is padded to whole elements. */
+	const size_t num_voxels = (size_t)(num_active_tiles + 1) * TEX_SPARSE_TILE_VOXELS;
+	const size_t num_index_elements = (num_tiles * sizeof(int) + sizeof(T) - 1) / sizeof(T);
+
+	if(num_voxels + num_index_elements >= width * height * depth) {
+		return false;
+	}
+
+	sparse_grid->resize(num_voxels + num_index_elements);
+	memset((void*)sparse_grid->data(), 0, sizeof(T) * sparse_grid->size());
+
+	for(size_t z = 0; z < depth; z++) {
+		for(size_t y = 0; y < height; y++) {
+			const T *row = voxels + (z * height + y) * width;
+			for(size_t x = 0; x < width; x++) {
+				const size_t index = sparse_grid_voxel_index(&tile_indices[0],
+				                                             x, y, z,
+				                                             width, height);
+				if(index >= TEX_SPARSE_TILE_VOXELS) {
+					(*sparse_grid)[index] = row[x];
+				}
+			}
+		}
+	}
+
+	memcpy((void*)(sparse_grid->data() + num_voxels),
+	       &tile_indices[0],
+	       sizeof(int) * num_tiles);
+	*grid_info_offset = num_voxels;
+
+	return true;
+}
+
+CCL_NAMESPACE_END
+
+#endif  /* __UTIL_SPARSE_GRID_H__ */
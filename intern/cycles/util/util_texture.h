@@ -31,6 +31,13 @@ CCL_NAMESPACE_BEGIN
 /* Texture type. */
 #define kernel_tex_type(tex) (tex & IMAGE_DATA_TYPE_MASK)
 
+/* Sparse 3D textures, stored in tiles of TEX_SPARSE_TILE_SIZE^3 voxels,
+ * see util_sparse_grid.h for the memory layout. */
+#define TEX_SPARSE_TILE_SHIFT 3
+#define TEX_SPARSE_TILE_SIZE (1 << TEX_SPARSE_TILE_SHIFT)
+#define TEX_SPARSE_TILE_MASK (TEX_SPARSE_TILE_SIZE - 1)
+#define TEX_SPARSE_TILE_VOXELS (TEX_SPARSE_TILE_SIZE * TEX_SPARSE_TILE_SIZE * TEX_SPARSE_TILE_SIZE)
+
 /* Interpolation types for textures
  * cuda also use texture space to store other objects */
 typedef enum InterpolationType {
@@ -79,6 +86,8 @@ typedef enum ExtensionType {
 typedef struct TextureInfo {
 	/* Pointer, offset or texture depending on device. */
 	uint64_t data;
+	/* Pointer to tile index table of sparse 3D textures, zero when dense. */
+	uint64_t grid_info;
 	/* Buffer number for OpenCL. */
 	uint cl_buffer;
 	/* Interpolation and extension type. */
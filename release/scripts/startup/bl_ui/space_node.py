@@ -512,13 +512,18 @@ class NODE_PT_quality(bpy.types.Panel):
         col = layout.column()
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
+        col.prop(tree, "proxy_size")
         col.prop(tree, "chunk_size")
 
         col = layout.column()
         col.prop(tree, "use_opencl")
         col.prop(tree, "use_groupnode_buffer")
         col.prop(tree, "use_two_pass")
+        col.prop(tree, "use_area_execution")
+        col.prop(tree, "use_half_float")
+        col.prop(tree, "cache_limit")
         col.prop(tree, "use_viewer_border")
+        col.prop(tree, "use_viewer_region")
 
 
 class NODE_UL_interface_sockets(bpy.types.UIList):
@@ -675,6 +675,8 @@ class USERPREF_PT_system_memory(PreferencePanel):
         flow = layout.grid_flow(row_major=False, columns=0, even_columns=True, even_rows=False, align=False)
 
         flow.prop(system, "memory_cache_limit", text="Sequencer Cache Limit")
+        flow.prop(system, "disk_cache_limit", text="Disk Cache Limit")
+        flow.prop(system, "prefetch_frames", text="Sequencer Prefetch Frames")
         flow.prop(system, "scrollback", text="Console Scrollback Lines")
 
         layout.separator()
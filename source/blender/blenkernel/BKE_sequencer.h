@@ -100,6 +100,9 @@ typedef struct SeqRenderData {
 	bool is_proxy_render;
 	int view_id;
 
+	/* set when rendering a copy of the scene ahead of the playhead, see seqprefetch.c */
+	struct SeqPrefetchJob *prefetch_job;
+
 	/* special case for OpenGL render */
 	struct GPUOffScreen *gpu_offscreen;
 	struct GPUFX *gpu_fx;
@@ -184,10 +187,8 @@ struct SeqEffectHandle {
  * ********************************************************************** */
 
 struct ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int chanshown);
-struct ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown);
 struct ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra, struct Sequence *seq);
 struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context, float cfra, int chan_shown, struct ListBase *seqbasep);
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chan_shown);
 
 /* **********************************************************************
  * sequencer.c
@@ -205,6 +206,7 @@ void BKE_sequencer_pixel_from_sequencer_space_v4(struct Scene *scene, float pixe
 struct Editing  *BKE_sequencer_editing_get(struct Scene *scene, bool alloc);
 struct Editing  *BKE_sequencer_editing_ensure(struct Scene *scene);
 void             BKE_sequencer_editing_free(struct Scene *scene, const bool do_id_user);
+void             BKE_sequencer_editing_free_ex(struct Scene *scene, const bool do_id_user, const bool do_cache);
 
 void             BKE_sequencer_sort(struct Scene *scene);
 
@@ -242,7 +244,8 @@ struct StripElem *BKE_sequencer_give_stripelem(struct Sequence *seq, int cfra);
 void BKE_sequencer_update_changed_seq_and_deps(struct Scene *scene, struct Sequence *changed_seq, int len_change, int ibuf_change);
 bool BKE_sequencer_input_have_to_preprocess(const SeqRenderData *context, struct Sequence *seq, float cfra);
 
-void BKE_sequencer_proxy_rebuild_context(struct Main *bmain, struct Depsgraph *depsgraph, struct Scene *scene, struct Sequence *seq, struct GSet *file_list, ListBase *queue);
+void BKE_sequencer_proxy_rebuild_context(struct Main *bmain, struct Depsgraph *depsgraph, struct Scene *scene, struct Sequence *seq, struct GSet *file_list, ListBase *queue, int num_threads);
+void BKE_sequencer_timecode_rebuild_context(struct Main *bmain, struct Depsgraph *depsgraph, struct Scene *scene, struct Sequence *seq, struct GSet *file_list, ListBase *queue, int num_threads);
 void BKE_sequencer_proxy_rebuild(struct SeqIndexBuildContext *context, short *stop, short *do_update, float *progress);
 void BKE_sequencer_proxy_rebuild_finish(struct SeqIndexBuildContext *context, bool stop);
 
@@ -280,6 +283,22 @@ void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, struct S
 void BKE_sequencer_preprocessed_cache_cleanup(void);
 void BKE_sequencer_preprocessed_cache_cleanup_sequence(struct Sequence *seq);
 
+/* **********************************************************************
+ * seqprefetch.c
+ *
+ * Sequencer rendering of frames ahead of the playhead
+ * ********************************************************************** */
+
+void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, int chanshown);
+void BKE_sequencer_prefetch_stop(struct Scene *scene);
+void BKE_sequencer_prefetch_stop_all(void);
+
+/* used by the cache to store prefetched buffers for the original strips */
+struct Sequence *BKE_sequencer_prefetch_get_original_sequence(const SeqRenderData *context, struct Sequence *seq);
+const SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context);
+void BKE_sequencer_prefetch_cache_full(const SeqRenderData *context);
+bool BKE_sequencer_prefetch_need_stop(const SeqRenderData *context);
+
 /* **********************************************************************
  * seqeffects.c
  *
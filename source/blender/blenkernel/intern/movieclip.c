@@ -610,6 +610,7 @@ static bool put_imbuf_cache(MovieClip *clip,
 		                                     moviecache_getprioritydata,
 		                                     moviecache_getitempriority,
 		                                     moviecache_prioritydeleter);
+		IMB_moviecache_set_disk_spill(moviecache, true);
 
 		clip->cache->moviecache = moviecache;
 		clip->cache->sequence_offset = -1;
@@ -4144,6 +4144,60 @@ void psys_get_dupli_texture(ParticleSystem *psys, ParticleSettings *part,
 	psys_particle_on_emitter(psmd, part->from, pa->num, pa->num_dmcache, pa->fuv, pa->foffset, loc, 0, 0, 0, orco);
 }
 
+/**
+ * Get the cached path keys of a hair particle in object space of the emitter,
+ * for render engines exporting hair without going through RNA per key.
+ * Parents come first, followed by children, matching the particle numbers
+ * used by the RNA co_hair() function.
+ *
+ * Only reads the path cache, so it can be called from multiple threads.
+ *
+ * \return The number of keys written to \a r_co, at most \a max_keys.
+ */
+int psys_hair_path_keys_get(const ParticleSystem *psys, int particle_no, int max_keys, float (*r_co)[3])
+{
+	const ParticleSettings *part = psys->part;
+	ParticleCacheKey *cache;
+	int totpart = psys->totcached;
+	int totchild = psys->totchildcache;
+	int num_keys;
+
+	if (part == NULL || psys->particles == NULL || psys->pathcache == NULL) {
+		return 0;
+	}
+
+	if (ELEM(part->ren_as, PART_DRAW_OB, PART_DRAW_GR, PART_DRAW_NOT)) {
+		return 0;
+	}
+
+	/* can happen for disconnected/global hair */
+	if (part->type == PART_HAIR && !psys->childcache) {
+		totchild = 0;
+	}
+
+	if (particle_no < 0) {
+		return 0;
+	}
+	else if (particle_no < totpart) {
+		cache = psys->pathcache[particle_no];
+	}
+	else if (particle_no < totpart + totchild) {
+		cache = psys->childcache[particle_no - totpart];
+	}
+	else {
+		return 0;
+	}
+
+	num_keys = min_ii(max_ii(cache->segments, 0) + 1, max_keys);
+
+	for (int k = 0; k < num_keys; k++) {
+		copy_v3_v3(r_co[k], cache[k].co);
+		mul_m4_v3(psys->imat, r_co[k]);
+	}
+
+	return num_keys;
+}
+
 void psys_get_dupli_path_transform(ParticleSimulationData *sim, ParticleData *pa, ChildParticle *cpa, ParticleCacheKey *cache, float mat[4][4], float *scale)
 {
 	Object *ob = sim->ob;
@@ -33,6 +33,7 @@
 #include "IMB_imbuf_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 
 #include "BKE_sequencer.h"
 #include "BKE_scene.h"
@@ -62,6 +63,10 @@ typedef struct SeqPreprocessCache {
 static struct MovieCache *moviecache = NULL;
 static struct SeqPreprocessCache *preprocess_cache = NULL;
 
+/* strips are rendered from several threads, the preprocessed cache is not used by the prefetch thread */
+static ThreadMutex cache_lock = BLI_MUTEX_INITIALIZER;
+static ThreadMutex preprocess_cache_lock = BLI_MUTEX_INITIALIZER;
+
 static void preprocessed_cache_destruct(void);
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
@@ -116,18 +121,39 @@ static bool seqcache_hashcmp(const void *a_, const void *b_)
 
 void BKE_sequencer_cache_destruct(void)
 {
+	BKE_sequencer_prefetch_stop_all();
+
 	if (moviecache)
 		IMB_moviecache_free(moviecache);
 
 	preprocessed_cache_destruct();
 }
 
+/* sequencer frames are the most expensive to recreate, keep them longer than other
+ * cached buffers and write them to disk instead of freeing them. The writing happens
+ * after cache_lock is released, so other threads can use the cache meanwhile. */
+static struct MovieCache *seqcache_create(void)
+{
+	struct MovieCache *cache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+
+	IMB_moviecache_set_cache_priority(cache, IMB_MOVIECACHE_PRIORITY_HIGH);
+	IMB_moviecache_set_disk_spill(cache, true);
+	IMB_moviecache_set_defer_spill_flush(cache, true);
+
+	return cache;
+}
+
 void BKE_sequencer_cache_cleanup(void)
 {
+	/* prefetching would fill the cache with frames rendered before the change */
+	BKE_sequencer_prefetch_stop_all();
+
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache) {
 		IMB_moviecache_free(moviecache);
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		moviecache = seqcache_create();
 	}
+	BLI_mutex_unlock(&cache_lock);
 
 	BKE_sequencer_preprocessed_cache_cleanup();
 }
@@ -142,47 +168,85 @@ static bool seqcache_key_check_seq(ImBuf *UNUSED(ibuf), void *userkey, void *use
 
 void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
 {
+	BLI_mutex_lock(&cache_lock);
 	if (moviecache)
 		IMB_moviecache_cleanup(moviecache, seqcache_key_check_seq, seq);
+	BLI_mutex_unlock(&cache_lock);
+}
+
+/* buffers rendered by the prefetch job are stored for the original strips and context */
+static bool seqcache_key_init(SeqCacheKey *key, const SeqRenderData *context, Sequence *seq, float cfra,
+                              eSeqStripElemIBuf type)
+{
+	key->cfra = cfra - seq->start;
+	key->type = type;
+
+	if (context->prefetch_job) {
+		key->seq = BKE_sequencer_prefetch_get_original_sequence(context, seq);
+		key->context = *BKE_sequencer_prefetch_get_original_context(context);
+	}
+	else {
+		key->seq = seq;
+		key->context = *context;
+	}
+
+	return key->seq != NULL;
 }
 
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
 {
+	ImBuf *ibuf = NULL;
+
 	if (moviecache && seq) {
 		SeqCacheKey key;
 
-		key.seq = seq;
-		key.context = *context;
-		key.cfra = cfra - seq->start;
-		key.type = type;
+		if (seqcache_key_init(&key, context, seq, cfra, type)) {
+			BLI_mutex_lock(&cache_lock);
+			ibuf = IMB_moviecache_get(moviecache, &key);
+			BLI_mutex_unlock(&cache_lock);
 
-		return IMB_moviecache_get(moviecache, &key);
+			IMB_moviecache_spill_flush();
+		}
 	}
 
-	return NULL;
+	return ibuf;
 }
 
 void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *i)
 {
 	SeqCacheKey key;
 
-	if (i == NULL || context->skip_cache) {
+	/* buffers of a stopped prefetch job are incomplete */
+	if (i == NULL || context->skip_cache || BKE_sequencer_prefetch_need_stop(context)) {
 		return;
 	}
 
+	if (!seqcache_key_init(&key, context, seq, cfra, type)) {
+		return;
+	}
+
+	BLI_mutex_lock(&cache_lock);
+
 	if (!moviecache) {
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		moviecache = seqcache_create();
 	}
 
-	key.seq = seq;
-	key.context = *context;
-	key.cfra = cfra - seq->start;
-	key.type = type;
+	if (context->prefetch_job) {
+		/* frames ahead of the playhead must not push out the ones being played */
+		if (!IMB_moviecache_put_if_possible(moviecache, &key, i)) {
+			BKE_sequencer_prefetch_cache_full(context);
+		}
+	}
+	else {
+		IMB_moviecache_put(moviecache, &key, i);
+	}
 
-	IMB_moviecache_put(moviecache, &key, i);
+	BLI_mutex_unlock(&cache_lock);
+
+	IMB_moviecache_spill_flush();
 }
 
-void BKE_sequencer_preprocessed_cache_cleanup(void)
+static void preprocessed_cache_cleanup(void)
 {
 	SeqPreprocessCacheElem *elem;
 
@@ -197,12 +261,19 @@ void BKE_sequencer_preprocessed_cache_cleanup(void)
 	BLI_listbase_clear(&preprocess_cache->elems);
 }
 
+void BKE_sequencer_preprocessed_cache_cleanup(void)
+{
+	BLI_mutex_lock(&preprocess_cache_lock);
+	preprocessed_cache_cleanup();
+	BLI_mutex_unlock(&preprocess_cache_lock);
+}
+
 static void preprocessed_cache_destruct(void)
 {
 	if (!preprocess_cache)
 		return;
 
-	BKE_sequencer_preprocessed_cache_cleanup();
+	preprocessed_cache_cleanup();
 
 	MEM_freeN(preprocess_cache);
 	preprocess_cache = NULL;
@@ -212,39 +283,51 @@ ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, Sequen
 {
 	SeqPreprocessCacheElem *elem;
 
-	if (!preprocess_cache)
-		return NULL;
+	ImBuf *ibuf = NULL;
 
-	if (preprocess_cache->cfra != cfra)
+	if (context->prefetch_job)
 		return NULL;
 
-	for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
-		if (elem->seq != seq)
-			continue;
+	BLI_mutex_lock(&preprocess_cache_lock);
+
+	if (preprocess_cache && preprocess_cache->cfra == cfra) {
+		for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
+			if (elem->seq != seq)
+				continue;
 
-		if (elem->type != type)
-			continue;
+			if (elem->type != type)
+				continue;
 
-		if (seq_cmp_render_data(&elem->context, context) != 0)
-			continue;
+			if (seq_cmp_render_data(&elem->context, context) != 0)
+				continue;
 
-		IMB_refImBuf(elem->ibuf);
-		return elem->ibuf;
+			IMB_refImBuf(elem->ibuf);
+			ibuf = elem->ibuf;
+			break;
+		}
 	}
 
-	return NULL;
+	BLI_mutex_unlock(&preprocess_cache_lock);
+
+	return ibuf;
 }
 
 void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *ibuf)
 {
 	SeqPreprocessCacheElem *elem;
 
+	/* only holds the frame drawn last, which the prefetch thread would keep replacing */
+	if (context->prefetch_job)
+		return;
+
+	BLI_mutex_lock(&preprocess_cache_lock);
+
 	if (!preprocess_cache) {
 		preprocess_cache = MEM_callocN(sizeof(SeqPreprocessCache), "sequencer preprocessed cache");
 	}
 	else {
 		if (preprocess_cache->cfra != cfra)
-			BKE_sequencer_preprocessed_cache_cleanup();
+			preprocessed_cache_cleanup();
 	}
 
 	elem = MEM_callocN(sizeof(SeqPreprocessCacheElem), "sequencer preprocessed cache element");
@@ -259,6 +342,8 @@ void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence
 	IMB_refImBuf(ibuf);
 
 	BLI_addtail(&preprocess_cache->elems, elem);
+
+	BLI_mutex_unlock(&preprocess_cache_lock);
 }
 
 void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
@@ -268,6 +353,8 @@ void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
 	if (!preprocess_cache)
 		return;
 
+	BLI_mutex_lock(&preprocess_cache_lock);
+
 	for (elem = preprocess_cache->elems.first; elem; elem = elem_next) {
 		elem_next = elem->next;
 
@@ -277,4 +364,6 @@ void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
 			BLI_freelinkN(&preprocess_cache->elems, elem);
 		}
 	}
+
+	BLI_mutex_unlock(&preprocess_cache_lock);
 }
@@ -0,0 +1,419 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file \ingroup bke
+ *
+ * Rendering of sequencer frames ahead of the playhead.
+ *
+ * Every scene that is played back gets a job with a copy of the scene which is rendered on a
+ * worker thread, so the strips can be edited while the job runs. The cache stores the buffers
+ * of the copy for the original strips, so playback finds them. Editing strips stops the job, the
+ * frame being rendered is abandoned and not cached. The next drawn frame restarts the job with a
+ * new copy of the strips, the rest of the copied scene is kept.
+ *
+ * Several previews of one scene share its job and copy, it renders for the context of one preview
+ * at a time and switches to another one when it's done with its frames.
+ */
+
+#include <stddef.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#include "BKE_animsys.h"
+#include "BKE_global.h"
+#include "BKE_library.h"
+#include "BKE_sequencer.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+typedef struct SeqPrefetchJob {
+	struct SeqPrefetchJob *next, *prev;
+
+	/* original scene, the cache keys and the job list refer to it */
+	Scene *scene;
+	/* copy of the scene which is rendered */
+	Scene *scene_eval;
+	/* strip of the copy -> original strip */
+	GHash *seq_map;
+
+	/* context of the original scene, used for the cache keys */
+	SeqRenderData context;
+	/* context rendering the copy */
+	SeqRenderData context_eval;
+	int chanshown;
+
+	ListBase threads;
+
+	/* lock for the frame range and state below */
+	ThreadMutex lock;
+	int cfra_playhead;
+	int cfra_next;
+	bool running;
+	bool cache_full;
+	bool stop;
+
+	/* strips were edited since they were copied, only accessed from the main thread */
+	bool outdated;
+} SeqPrefetchJob;
+
+/* only accessed from the main thread */
+static ListBase prefetch_jobs = {NULL, NULL};
+
+static void *seq_prefetch_frames(void *job_v);
+
+/* ******** Scene copy ******** */
+
+static void seq_prefetch_map_strips(SeqPrefetchJob *job, ListBase *seqbase, ListBase *seqbase_eval)
+{
+	Sequence *seq, *seq_eval;
+
+	/* the copy has the strips in the same order */
+	for (seq = seqbase->first, seq_eval = seqbase_eval->first;
+	     seq && seq_eval;
+	     seq = seq->next, seq_eval = seq_eval->next)
+	{
+		BLI_ghash_insert(job->seq_map, seq_eval, seq);
+
+		/* preview shows the contents of the meta strip being edited */
+		if (job->scene->ed->seqbasep == &seq->seqbase) {
+			job->scene_eval->ed->seqbasep = &seq_eval->seqbase;
+		}
+
+		seq_prefetch_map_strips(job, &seq->seqbase, &seq_eval->seqbase);
+	}
+}
+
+/* Render for another context of the scene, the thread must not be running. */
+static void seq_prefetch_job_set_context(SeqPrefetchJob *job, const SeqRenderData *context, int chanshown)
+{
+	job->context = *context;
+	job->context_eval = *context;
+	job->context_eval.scene = job->scene_eval;
+	/* only used for scene strips, which are not prefetched */
+	job->context_eval.depsgraph = NULL;
+	job->context_eval.prefetch_job = job;
+	job->chanshown = chanshown;
+
+	/* frames cached for this context before are found in the cache again */
+	job->cfra_playhead = 0;
+	job->cfra_next = 0;
+	job->cache_full = false;
+}
+
+static SeqPrefetchJob *seq_prefetch_job_create(const SeqRenderData *context, int chanshown)
+{
+	SeqPrefetchJob *job = MEM_callocN(sizeof(SeqPrefetchJob), "sequencer prefetch job");
+
+	job->scene = context->scene;
+	BKE_id_copy_ex(NULL, &job->scene->id, (ID **)&job->scene_eval, LIB_ID_COPY_LOCALIZE);
+
+	job->seq_map = BLI_ghash_ptr_new("sequencer prefetch strips");
+	seq_prefetch_map_strips(job, &job->scene->ed->seqbase, &job->scene_eval->ed->seqbase);
+
+	seq_prefetch_job_set_context(job, context, chanshown);
+
+	BLI_mutex_init(&job->lock);
+	BLI_threadpool_init(&job->threads, seq_prefetch_frames, 1);
+
+	BLI_addtail(&prefetch_jobs, job);
+
+	return job;
+}
+
+/* Replace the strips of the copy by the edited ones, the thread must not be running. */
+static void seq_prefetch_job_update_strips(SeqPrefetchJob *job)
+{
+	Scene *scene_eval = job->scene_eval;
+
+	BLI_ghash_clear(job->seq_map, NULL, NULL);
+	BKE_sequencer_editing_free_ex(scene_eval, false, false);
+
+	/* same as the copy of the sequencer data in BKE_scene_copy_data */
+	scene_eval->ed = MEM_callocN(sizeof(*scene_eval->ed), __func__);
+	scene_eval->ed->seqbasep = &scene_eval->ed->seqbase;
+	BKE_sequence_base_dupli_recursive(
+	        job->scene, scene_eval, &scene_eval->ed->seqbase, &job->scene->ed->seqbase,
+	        SEQ_DUPE_ALL, LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_USER_REFCOUNT);
+	seq_prefetch_map_strips(job, &job->scene->ed->seqbase, &scene_eval->ed->seqbase);
+
+	/* frames rendered before the edit were removed from the cache, start over */
+	job->cfra_playhead = 0;
+	job->cfra_next = 0;
+	job->cache_full = false;
+	job->outdated = false;
+}
+
+static void seq_prefetch_job_stop(SeqPrefetchJob *job)
+{
+	BLI_mutex_lock(&job->lock);
+	job->stop = true;
+	BLI_mutex_unlock(&job->lock);
+
+	/* rendering checks the flag, see BKE_sequencer_prefetch_need_stop,
+	 * so this only waits until the current strip is decoded */
+	BLI_threadpool_remove(&job->threads, job);
+
+	job->stop = false;
+	job->running = false;
+}
+
+static void seq_prefetch_job_free(SeqPrefetchJob *job)
+{
+	seq_prefetch_job_stop(job);
+	BLI_threadpool_end(&job->threads);
+	BLI_mutex_end(&job->lock);
+
+	BLI_ghash_free(job->seq_map, NULL, NULL);
+
+	/* strips of the copy are not in the cache, don't clear it */
+	BKE_sequencer_editing_free_ex(job->scene_eval, false, false);
+	BKE_id_free_ex(NULL, job->scene_eval, LIB_ID_FREE_NO_MAIN | LIB_ID_FREE_NO_USER_REFCOUNT | LIB_ID_FREE_NO_DEG_TAG |
+	               LIB_ID_FREE_NO_UI_USER, false);
+
+	BLI_remlink(&prefetch_jobs, job);
+	MEM_freeN(job);
+}
+
+static SeqPrefetchJob *seq_prefetch_job_get(Scene *scene)
+{
+	SeqPrefetchJob *job;
+
+	for (job = prefetch_jobs.first; job; job = job->next) {
+		if (job->scene == scene) {
+			return job;
+		}
+	}
+
+	return NULL;
+}
+
+static bool seq_prefetch_context_equal(const SeqRenderData *a, const SeqRenderData *b)
+{
+	return ((a->bmain == b->bmain) &&
+	        (a->rectx == b->rectx) &&
+	        (a->recty == b->recty) &&
+	        (a->preview_render_size == b->preview_render_size) &&
+	        (a->motion_blur_samples == b->motion_blur_samples) &&
+	        (a->motion_blur_shutter == b->motion_blur_shutter) &&
+	        (a->view_id == b->view_id));
+}
+
+/* ******** Rendering ******** */
+
+/* Scene strips change the state of their scene and render with OpenGL, movie clips share the
+ * clip cache and text strips the fonts with the main thread, frames using them are skipped. */
+static bool seq_prefetch_frame_is_supported(ListBase *seqbase, int cfra)
+{
+	Sequence *seq;
+
+	for (seq = seqbase->first; seq; seq = seq->next) {
+		if (seq->startdisp > cfra || seq->enddisp <= cfra) {
+			continue;
+		}
+
+		if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_TEXT)) {
+			return false;
+		}
+
+		if (seq->type == SEQ_TYPE_META && !seq_prefetch_frame_is_supported(&seq->seqbase, cfra)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void *seq_prefetch_frames(void *job_v)
+{
+	SeqPrefetchJob *job = job_v;
+	Scene *scene = job->scene_eval;
+
+	for (;;) {
+		ImBuf *ibuf;
+		int cfra;
+
+		BLI_mutex_lock(&job->lock);
+		if (job->stop || job->cache_full || job->cfra_next > job->cfra_playhead + U.prefetchframes) {
+			job->running = false;
+			BLI_mutex_unlock(&job->lock);
+			break;
+		}
+		cfra = job->cfra_next++;
+		BLI_mutex_unlock(&job->lock);
+
+		if (!seq_prefetch_frame_is_supported(&scene->ed->seqbase, cfra)) {
+			continue;
+		}
+
+		/* the original strips are animated by the depsgraph of the window, the copy isn't */
+		scene->r.cfra = cfra;
+		BKE_animsys_evaluate_animdata(NULL, NULL, &scene->id, scene->adt, (float)cfra, ADT_RECALC_ANIM);
+
+		/* buffers are stored in the cache while rendering */
+		ibuf = BKE_sequencer_give_ibuf(&job->context_eval, (float)cfra, job->chanshown);
+		if (ibuf) {
+			IMB_freeImBuf(ibuf);
+		}
+	}
+
+	return NULL;
+}
+
+/* ******** Public API ******** */
+
+/**
+ * Render the frames after \a cfra in the background, up to #UserDef.prefetchframes frames
+ * or until the cache is full. Called from the main thread when a frame is drawn.
+ */
+void BKE_sequencer_prefetch_start(const SeqRenderData *context, float cfra, int chanshown)
+{
+	SeqPrefetchJob *job;
+	const int frame = (int)cfra;
+	bool start_thread;
+
+	if (U.prefetchframes <= 0 || G.is_rendering || context->for_render || context->is_proxy_render ||
+	    context->scene->ed == NULL)
+	{
+		return;
+	}
+
+	job = seq_prefetch_job_get(context->scene);
+
+	if (job == NULL) {
+		job = seq_prefetch_job_create(context, chanshown);
+	}
+	else if (job->chanshown != chanshown || !seq_prefetch_context_equal(&job->context, context)) {
+		bool running;
+
+		BLI_mutex_lock(&job->lock);
+		running = job->running;
+		BLI_mutex_unlock(&job->lock);
+
+		/* Previews drawing the scene with different sizes or channels, and the views of a stereo
+		 * preview, alternate on every redraw. Rather than abandoning the frame being rendered for
+		 * one of them, the running range is finished before the job takes the other context. */
+		if (running) {
+			return;
+		}
+		seq_prefetch_job_set_context(job, context, chanshown);
+	}
+
+	if (job->outdated) {
+		seq_prefetch_job_update_strips(job);
+	}
+
+	BLI_mutex_lock(&job->lock);
+
+	if (frame != job->cfra_playhead) {
+		/* playback frees older frames, try again */
+		job->cache_full = false;
+	}
+	/* frames before the playhead are not needed anymore */
+	if (frame < job->cfra_playhead || frame >= job->cfra_next) {
+		job->cfra_next = frame + 1;
+	}
+	job->cfra_playhead = frame;
+
+	start_thread = !job->running && !job->cache_full && job->cfra_next <= frame + U.prefetchframes;
+	if (start_thread) {
+		job->running = true;
+	}
+
+	BLI_mutex_unlock(&job->lock);
+
+	if (start_thread) {
+		/* join the thread which rendered the previous range */
+		BLI_threadpool_remove(&job->threads, job);
+		BLI_threadpool_insert(&job->threads, job);
+	}
+}
+
+/* Stop prefetching for a scene whose strips are edited, the copy gets outdated. */
+void BKE_sequencer_prefetch_stop(Scene *scene)
+{
+	SeqPrefetchJob *job;
+
+	if (!BLI_thread_is_main()) {
+		return;
+	}
+
+	job = seq_prefetch_job_get(scene);
+	if (job) {
+		seq_prefetch_job_stop(job);
+		job->outdated = true;
+	}
+}
+
+void BKE_sequencer_prefetch_stop_all(void)
+{
+	if (!BLI_thread_is_main()) {
+		return;
+	}
+
+	while (prefetch_jobs.first) {
+		seq_prefetch_job_free(prefetch_jobs.first);
+	}
+}
+
+Sequence *BKE_sequencer_prefetch_get_original_sequence(const SeqRenderData *context, Sequence *seq)
+{
+	return BLI_ghash_lookup(context->prefetch_job->seq_map, seq);
+}
+
+const SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context)
+{
+	return &context->prefetch_job->context;
+}
+
+/**
+ * Check whether the frame being rendered is abandoned, rendering then skips the remaining strips
+ * and the incomplete buffers are not cached. Always false when not rendering for a prefetch job.
+ */
+bool BKE_sequencer_prefetch_need_stop(const SeqRenderData *context)
+{
+	SeqPrefetchJob *job = context->prefetch_job;
+	bool stop;
+
+	if (job == NULL) {
+		return false;
+	}
+
+	BLI_mutex_lock(&job->lock);
+	stop = job->stop;
+	BLI_mutex_unlock(&job->lock);
+
+	return stop;
+}
+
+void BKE_sequencer_prefetch_cache_full(const SeqRenderData *context)
+{
+	SeqPrefetchJob *job = context->prefetch_job;
+
+	BLI_mutex_lock(&job->lock);
+	job->cache_full = true;
+	BLI_mutex_unlock(&job->lock);
+}
@@ -45,6 +45,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -76,8 +77,6 @@
 
 #include "RE_pipeline.h"
 
-#include <pthread.h>
-
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_colormanagement.h"
@@ -444,6 +443,12 @@ Editing *BKE_sequencer_editing_ensure(Scene *scene)
 }
 
 void BKE_sequencer_editing_free(Scene *scene, const bool do_id_user)
+{
+	BKE_sequencer_editing_free_ex(scene, do_id_user, true);
+}
+
+/* do_cache is false for copies of scenes whose strips never got cached, e.g. the prefetch copy */
+void BKE_sequencer_editing_free_ex(Scene *scene, const bool do_id_user, const bool do_cache)
 {
 	Editing *ed = scene->ed;
 	Sequence *seq;
@@ -452,7 +457,9 @@ void BKE_sequencer_editing_free(Scene *scene, const bool do_id_user)
 		return;
 
 	/* this may not be the active scene!, could be smarter about this */
-	BKE_sequencer_cache_cleanup();
+	if (do_cache) {
+		BKE_sequencer_cache_cleanup();
+	}
 
 	SEQ_BEGIN (ed, seq)
 	{
@@ -592,6 +599,7 @@ void BKE_sequencer_new_render_data(
 	r_context->skip_cache = false;
 	r_context->is_proxy_render = false;
 	r_context->view_id = 0;
+	r_context->prefetch_job = NULL;
 	r_context->gpu_offscreen = NULL;
 	r_context->gpu_samples = (scene->r.mode & R_OSA) ? scene->r.osa : 0;
 	r_context->gpu_full_samples = (r_context->gpu_samples) && (scene->r.scemode & R_FULL_SAMPLE);
@@ -1829,7 +1837,7 @@ static void seq_proxy_build_frame(
 		ibuf = IMB_dupImBuf(ibuf_tmp);
 		IMB_metadata_copy(ibuf, ibuf_tmp);
 		IMB_freeImBuf(ibuf_tmp);
-		IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
+		IMB_resampleImBuf(ibuf, rectx, recty, IMB_RESAMPLE_MITCHELL);
 	}
 	else {
 		ibuf = ibuf_tmp;
@@ -1931,24 +1939,16 @@ static int seq_proxy_context_count(Sequence *seq, Scene *scene)
 	return num_views;
 }
 
-void BKE_sequencer_proxy_rebuild_context(
-        Main *bmain, Depsgraph *depsgraph, Scene *scene,
-        Sequence *seq, struct GSet *file_list, ListBase *queue)
+static void seq_index_rebuild_context(
+        Main *bmain, Depsgraph *depsgraph, Scene *scene, Sequence *seq,
+        int tc_flags, int size_flags, int quality, bool overwrite,
+        struct GSet *file_list, ListBase *queue, int num_threads)
 {
 	SeqIndexBuildContext *context;
 	Sequence *nseq;
-	LinkData *link;
 	int num_files;
 	int i;
 
-	if (!seq->strip || !seq->strip->proxy) {
-		return;
-	}
-
-	if (!(seq->flag & SEQ_USE_PROXY)) {
-		return;
-	}
-
 	num_files = seq_proxy_context_count(seq, scene);
 
 	for (i = 0; i < num_files; i++) {
@@ -1959,10 +1959,10 @@ void BKE_sequencer_proxy_rebuild_context(
 
 		nseq = BKE_sequence_dupli_recursive(scene, scene, NULL, seq, 0);
 
-		context->tc_flags   = nseq->strip->proxy->build_tc_flags;
-		context->size_flags = nseq->strip->proxy->build_size_flags;
-		context->quality    = nseq->strip->proxy->quality;
-		context->overwrite = (nseq->strip->proxy->build_flags & SEQ_PROXY_SKIP_EXISTING) == 0;
+		context->tc_flags   = tc_flags;
+		context->size_flags = size_flags;
+		context->quality    = quality;
+		context->overwrite  = overwrite;
 
 		context->bmain = bmain;
 		context->depsgraph = depsgraph;
@@ -1972,9 +1972,6 @@ void BKE_sequencer_proxy_rebuild_context(
 
 		context->view_id = i; /* only for images */
 
-		link = BLI_genericNodeN(context);
-		BLI_addtail(queue, link);
-
 		if (nseq->type == SEQ_TYPE_MOVIE) {
 			StripAnim *sanim;
 
@@ -1984,10 +1981,63 @@ void BKE_sequencer_proxy_rebuild_context(
 			if (sanim->anim) {
 				context->index_context = IMB_anim_index_rebuild_context(sanim->anim,
 				        context->tc_flags, context->size_flags, context->quality,
-				        context->overwrite, file_list);
+				        context->overwrite, file_list, num_threads);
+			}
+
+			/* all files exist already */
+			if (context->index_context == NULL) {
+				BKE_sequencer_proxy_rebuild_finish(context, true);
+				continue;
 			}
 		}
+
+		BLI_addtail(queue, BLI_genericNodeN(context));
+	}
+}
+
+/**
+ * Add the contexts building the proxies of a strip to \a queue.
+ * \param num_threads: Threads decoding each movie, 0 for the default.
+ */
+void BKE_sequencer_proxy_rebuild_context(
+        Main *bmain, Depsgraph *depsgraph, Scene *scene,
+        Sequence *seq, struct GSet *file_list, ListBase *queue, int num_threads)
+{
+	StripProxy *proxy;
+
+	if (!seq->strip || !seq->strip->proxy) {
+		return;
+	}
+
+	if (!(seq->flag & SEQ_USE_PROXY)) {
+		return;
+	}
+
+	proxy = seq->strip->proxy;
+
+	seq_index_rebuild_context(
+	        bmain, depsgraph, scene, seq,
+	        proxy->build_tc_flags, proxy->build_size_flags, proxy->quality,
+	        (proxy->build_flags & SEQ_PROXY_SKIP_EXISTING) == 0,
+	        file_list, queue, num_threads);
+}
+
+/**
+ * Build the record run index of a movie strip when it doesn't exist yet. Seeking uses it
+ * to find the key frame of a frame, also when the strip doesn't use a timecode.
+ */
+void BKE_sequencer_timecode_rebuild_context(
+        Main *bmain, Depsgraph *depsgraph, Scene *scene,
+        Sequence *seq, struct GSet *file_list, ListBase *queue, int num_threads)
+{
+	if (seq->type != SEQ_TYPE_MOVIE || !seq->strip) {
+		return;
 	}
+
+	seq_index_rebuild_context(
+	        bmain, depsgraph, scene, seq,
+	        IMB_TC_RECORD_RUN, IMB_PROXY_NONE, 0, false,
+	        file_list, queue, num_threads);
 }
 
 void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context, short *stop, short *do_update, float *progress)
@@ -2569,7 +2619,7 @@ static ImBuf *input_preprocess(const SeqRenderData *context, Sequence *seq, floa
 
 	if (ibuf->x != context->rectx || ibuf->y != context->recty) {
 		if (scene->r.mode & R_OSA) {
-			IMB_scaleImBuf(ibuf, (short)context->rectx, (short)context->recty);
+			IMB_resampleImBuf(ibuf, context->rectx, context->recty, IMB_RESAMPLE_MITCHELL);
 		}
 		else {
 			IMB_scalefastImBuf(ibuf, (short)context->rectx, (short)context->recty);
@@ -3611,7 +3661,7 @@ static ImBuf *seq_render_strip(
 					is_proxy_image = (ibuf != NULL);
 				}
 
-				if (ibuf == NULL)
+				if (ibuf == NULL && !BKE_sequencer_prefetch_need_stop(context))
 					ibuf = do_render_strip_uncached(context, state, seq, cfra);
 
 				if (ibuf) {
@@ -3633,6 +3683,13 @@ static ImBuf *seq_render_strip(
 		 */
 	}
 
+	/* the prefetch job was stopped, finish the frame with empty buffers which are not cached */
+	if (ibuf && BKE_sequencer_prefetch_need_stop(context)) {
+		IMB_freeImBuf(ibuf);
+		ibuf = NULL;
+		use_preprocess = false;
+	}
+
 	if (ibuf == NULL) {
 		ibuf = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
 		sequencer_imbuf_assign_spaces(context->scene, ibuf);
@@ -3713,13 +3770,109 @@ static ImBuf *seq_render_strip_stack_apply_effect(const SeqRenderData *context,
 	return out;
 }
 
+/* Strips can be rendered concurrently when none of them reads from a strip another one reads
+ * from (anims and effect data aren't thread safe), and none of them renders other channels or
+ * uses data shared with the main thread. */
+static bool seq_render_strip_add_used(Sequence *seq, GSet *used)
+{
+	Sequence *seq_child;
+	SequenceModifierData *smd;
+
+	if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_TEXT,
+	         SEQ_TYPE_ADJUSTMENT, SEQ_TYPE_MULTICAM))
+	{
+		return false;
+	}
+
+	if (!BLI_gset_add(used, seq)) {
+		return false;
+	}
+
+	if ((seq->seq1 && !seq_render_strip_add_used(seq->seq1, used)) ||
+	    (seq->seq2 && !seq_render_strip_add_used(seq->seq2, used)) ||
+	    (seq->seq3 && !seq_render_strip_add_used(seq->seq3, used)))
+	{
+		return false;
+	}
+
+	for (seq_child = seq->seqbase.first; seq_child; seq_child = seq_child->next) {
+		if (!seq_render_strip_add_used(seq_child, used)) {
+			return false;
+		}
+	}
+
+	for (smd = seq->modifiers.first; smd; smd = smd->next) {
+		if (smd->mask_sequence && !seq_render_strip_add_used(smd->mask_sequence, used)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+typedef struct RenderStackInputsData {
+	const SeqRenderData *context;
+	SeqRenderState *state;
+	Sequence **seq_arr;
+	ImBuf **inputs;
+	const int *indices;
+	float cfra;
+} RenderStackInputsData;
+
+static void seq_render_strip_stack_input(void *__restrict userdata, const int iter,
+                                         const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	RenderStackInputsData *data = userdata;
+	const int i = data->indices[iter];
+
+	data->inputs[i] = seq_render_strip(data->context, data->state, data->seq_arr[i], data->cfra);
+}
+
+/* render the strips with render_input set into inputs, the others are set to NULL */
+static void seq_render_strip_stack_inputs(
+        const SeqRenderData *context, SeqRenderState *state, Sequence **seq_arr,
+        const bool *render_input, ImBuf **inputs, int count, float cfra)
+{
+	RenderStackInputsData data;
+	ParallelRangeSettings settings;
+	int indices[MAXSEQ + 1];
+	int tot = 0, i;
+	bool use_threading = true;
+	GSet *used = BLI_gset_ptr_new(__func__);
+
+	for (i = 0; i < count; i++) {
+		inputs[i] = NULL;
+
+		if (render_input[i]) {
+			indices[tot++] = i;
+			use_threading = use_threading && seq_render_strip_add_used(seq_arr[i], used);
+		}
+	}
+
+	BLI_gset_free(used, NULL);
+
+	data.context = context;
+	data.state = state;
+	data.seq_arr = seq_arr;
+	data.inputs = inputs;
+	data.indices = indices;
+	data.cfra = cfra;
+
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = use_threading && (tot > 1);
+	BLI_task_parallel_range(0, tot, &data, seq_render_strip_stack_input, &settings);
+}
+
 static ImBuf *seq_render_strip_stack(
         const SeqRenderData *context, SeqRenderState *state, ListBase *seqbasep,
         float cfra, int chanshown)
 {
 	Sequence *seq_arr[MAXSEQ + 1];
+	ImBuf *inputs[MAXSEQ + 1];
+	bool render_input[MAXSEQ + 1];
 	int count;
-	int i;
+	int i, base;
+	int base_early_out = EARLY_NO_INPUT;
 	ImBuf *out = NULL;
 
 	count = get_shown_sequences(seqbasep, cfra, chanshown, (Sequence **)&seq_arr);
@@ -3790,8 +3943,8 @@ static ImBuf *seq_render_strip_stack(
 		return out;
 	}
 
+	/* find the lowest strip the result depends on, without rendering anything yet */
 	for (i = count - 1; i >= 0; i--) {
-		int early_out;
 		Sequence *seq = seq_arr[i];
 
 		out = BKE_sequencer_cache_get(context, seq, cfra, SEQ_STRIPELEM_IBUF_COMP);
@@ -3800,37 +3953,53 @@ static ImBuf *seq_render_strip_stack(
 			break;
 		}
 		if (seq->blend_mode == SEQ_BLEND_REPLACE) {
-			out = seq_render_strip(context, state, seq, cfra);
+			base_early_out = EARLY_NO_INPUT;
 			break;
 		}
 
-		early_out = seq_get_early_out_for_blend_mode(seq);
+		base_early_out = seq_get_early_out_for_blend_mode(seq);
+
+		if (ELEM(base_early_out, EARLY_NO_INPUT, EARLY_USE_INPUT_2) || i == 0) {
+			break;
+		}
+	}
 
-		switch (early_out) {
+	/* the inputs of the stack are decoded and preprocessed concurrently,
+	 * the blending below only starts once all of them are ready */
+	for (base = i; i < count; i++) {
+		if (i == base) {
+			render_input[i] = (out == NULL && base_early_out != EARLY_USE_INPUT_1);
+		}
+		else {
+			render_input[i] = (seq_get_early_out_for_blend_mode(seq_arr[i]) == EARLY_DO_EFFECT);
+		}
+	}
+
+	seq_render_strip_stack_inputs(context, state, seq_arr + base, render_input + base, inputs + base,
+	                              count - base, cfra);
+
+	i = base;
+
+	if (out == NULL) {
+		switch (base_early_out) {
 			case EARLY_NO_INPUT:
 			case EARLY_USE_INPUT_2:
-				out = seq_render_strip(context, state, seq, cfra);
+				out = inputs[i];
 				break;
 			case EARLY_USE_INPUT_1:
-				if (i == 0) {
-					out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-				}
+				out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
 				break;
 			case EARLY_DO_EFFECT:
-				if (i == 0) {
-					ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-					ImBuf *ibuf2 = seq_render_strip(context, state, seq, cfra);
-
-					out = seq_render_strip_stack_apply_effect(context, seq, cfra, ibuf1, ibuf2);
+			{
+				ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
+				ImBuf *ibuf2 = inputs[i];
 
-					IMB_freeImBuf(ibuf1);
-					IMB_freeImBuf(ibuf2);
-				}
+				out = seq_render_strip_stack_apply_effect(context, seq_arr[i], cfra, ibuf1, ibuf2);
 
+				IMB_freeImBuf(ibuf1);
+				IMB_freeImBuf(ibuf2);
 				break;
-		}
-		if (out) {
-			break;
+			}
 		}
 	}
 
@@ -3841,9 +4010,12 @@ static ImBuf *seq_render_strip_stack(
 	for (; i < count; i++) {
 		Sequence *seq = seq_arr[i];
 
-		if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
+		if (render_input[i] && BKE_sequencer_prefetch_need_stop(context)) {
+			IMB_freeImBuf(inputs[i]);
+		}
+		else if (render_input[i]) {
 			ImBuf *ibuf1 = out;
-			ImBuf *ibuf2 = seq_render_strip(context, state, seq, cfra);
+			ImBuf *ibuf2 = inputs[i];
 
 			out = seq_render_strip_stack_apply_effect(context, seq, cfra, ibuf1, ibuf2);
 
@@ -3901,158 +4073,6 @@ ImBuf *BKE_sequencer_give_ibuf_direct(const SeqRenderData *context, float cfra,
 	return seq_render_strip(context, &state, seq, cfra);
 }
 
-/* *********************** threading api ******************* */
-
-static ListBase running_threads;
-static ListBase prefetch_wait;
-static ListBase prefetch_done;
-
-static pthread_mutex_t queue_lock          = PTHREAD_MUTEX_INITIALIZER;
-static pthread_mutex_t wakeup_lock         = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t wakeup_cond          = PTHREAD_COND_INITIALIZER;
-
-//static pthread_mutex_t prefetch_ready_lock = PTHREAD_MUTEX_INITIALIZER;
-//static pthread_cond_t  prefetch_ready_cond = PTHREAD_COND_INITIALIZER;
-
-static pthread_mutex_t frame_done_lock     = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t frame_done_cond      = PTHREAD_COND_INITIALIZER;
-
-static volatile bool seq_thread_shutdown = true;
-static volatile int seq_last_given_monoton_cfra = 0;
-static int monoton_cfra = 0;
-
-typedef struct PrefetchThread {
-	struct PrefetchThread *next, *prev;
-
-	Scene *scene;
-	struct PrefetchQueueElem *current;
-	pthread_t pthread;
-	int running;
-
-} PrefetchThread;
-
-typedef struct PrefetchQueueElem {
-	struct PrefetchQueueElem *next, *prev;
-
-	int rectx;
-	int recty;
-	float cfra;
-	int chanshown;
-	int preview_render_size;
-
-	int monoton_cfra;
-
-	ImBuf *ibuf;
-} PrefetchQueueElem;
-
-void BKE_sequencer_give_ibuf_prefetch_request(const SeqRenderData *context, float cfra, int chanshown)
-{
-	PrefetchQueueElem *e;
-	if (seq_thread_shutdown) {
-		return;
-	}
-
-	e = MEM_callocN(sizeof(PrefetchQueueElem), "prefetch_queue_elem");
-	e->rectx = context->rectx;
-	e->recty = context->recty;
-	e->cfra = cfra;
-	e->chanshown = chanshown;
-	e->preview_render_size = context->preview_render_size;
-	e->monoton_cfra = monoton_cfra++;
-
-	pthread_mutex_lock(&queue_lock);
-	BLI_addtail(&prefetch_wait, e);
-	pthread_mutex_unlock(&queue_lock);
-
-	pthread_mutex_lock(&wakeup_lock);
-	pthread_cond_signal(&wakeup_cond);
-	pthread_mutex_unlock(&wakeup_lock);
-}
-
-ImBuf *BKE_sequencer_give_ibuf_threaded(const SeqRenderData *context, float cfra, int chanshown)
-{
-	PrefetchQueueElem *e = NULL;
-	bool found_something = false;
-
-	if (seq_thread_shutdown) {
-		return BKE_sequencer_give_ibuf(context, cfra, chanshown);
-	}
-
-	while (!e) {
-		bool success = false;
-		pthread_mutex_lock(&queue_lock);
-
-		for (e = prefetch_done.first; e; e = e->next) {
-			if (cfra == e->cfra &&
-			    chanshown == e->chanshown &&
-			    context->rectx == e->rectx &&
-			    context->recty == e->recty &&
-			    context->preview_render_size == e->preview_render_size)
-			{
-				success = true;
-				found_something = true;
-				break;
-			}
-		}
-
-		if (!e) {
-			for (e = prefetch_wait.first; e; e = e->next) {
-				if (cfra == e->cfra &&
-				    chanshown == e->chanshown &&
-				    context->rectx == e->rectx &&
-				    context->recty == e->recty &&
-				    context->preview_render_size == e->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
-		}
-
-		if (!e) {
-			PrefetchThread *tslot;
-
-			for (tslot = running_threads.first;
-			     tslot;
-			     tslot = tslot->next)
-			{
-				if (tslot->current &&
-				    cfra == tslot->current->cfra &&
-				    chanshown == tslot->current->chanshown &&
-				    context->rectx == tslot->current->rectx &&
-				    context->recty == tslot->current->recty &&
-				    context->preview_render_size == tslot->current->preview_render_size)
-				{
-					found_something = true;
-					break;
-				}
-			}
-		}
-
-		/* e->ibuf is unrefed by render thread on next round. */
-
-		if (e) {
-			seq_last_given_monoton_cfra = e->monoton_cfra;
-		}
-
-		pthread_mutex_unlock(&queue_lock);
-
-		if (!success) {
-			e = NULL;
-
-			if (!found_something) {
-				fprintf(stderr, "SEQ-THREAD: Requested frame not in queue ???\n");
-				break;
-			}
-			pthread_mutex_lock(&frame_done_lock);
-			pthread_cond_wait(&frame_done_cond, &frame_done_lock);
-			pthread_mutex_unlock(&frame_done_lock);
-		}
-	}
-
-	return e ? e->ibuf : NULL;
-}
-
 /* check whether sequence cur depends on seq */
 bool BKE_sequence_check_depend(Sequence *seq, Sequence *cur)
 {
@@ -4102,6 +4122,9 @@ static void sequence_invalidate_cache(Scene *scene, Sequence *seq, bool invalida
 {
 	Editing *ed = scene->ed;
 
+	/* the prefetch copy of the scene doesn't have the changes */
+	BKE_sequencer_prefetch_stop(scene);
+
 	/* invalidate cache for current sequence */
 	if (invalidate_self) {
 		/* Animation structure holds some buffers inside,
@@ -960,6 +960,8 @@ TrackingImageAccessor *tracking_image_accessor_new(MovieClip *clips[MAX_ACCESSOR
 	                                        sizeof(AccessCacheKey),
 	                                        accesscache_hashhash,
 	                                        accesscache_hashcmp);
+	/* frames are also in the clip cache, give memory to it first */
+	IMB_moviecache_set_cache_priority(accessor->cache, IMB_MOVIECACHE_PRIORITY_LOW);
 
 	memcpy(accessor->clips, clips, num_clips * sizeof(MovieClip *));
 	accessor->num_clips = num_clips;
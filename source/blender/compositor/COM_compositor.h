@@ -80,11 +80,12 @@ extern "C" {
  * All NodeOperation has a setting for their render-priority, but only for output NodeOperation these have effect.
  * In ExecutionSystem.execute all priorities are checked. For every priority the ExecutionGroup's are check if the
  * priority do match.
- * When match the ExecutionGroup will be executed (this happens in serial)
+ * When match the ExecutionGroup will be executed. The ExecutionGroup's of the same priority are
+ * scheduled together, so chunks of independent ExecutionGroup's are calculated at the same time.
  *
  * \see ExecutionSystem.execute control of the Render priority
  * \see NodeOperation.getRenderPriority receive the render priority
- * \see ExecutionGroup.execute the main loop to execute a whole ExecutionGroup
+ * \see ExecutionSystem.executeGroups the main loop to execute the output ExecutionGroup's
  *
  * \section order Chunk order
  *
@@ -103,7 +104,8 @@ extern "C" {
  *  - [@ref ChunkExecutionState.COM_ES_SCHEDULED]: All dependencies are met, chunk is scheduled, but not finished
  *  - [@ref ChunkExecutionState.COM_ES_EXECUTED]: Chunk is finished
  *
- * \see ExecutionGroup.execute
+ * \see ExecutionGroup.beginExecution
+ * \see ExecutionGroup.scheduleChunks
  * \see ViewerOperation.getChunkOrder
  * \see OrderOfChunks
  *
@@ -148,7 +150,7 @@ extern "C" {
  * +-------------------------+        | (B)            |                           | (A)            |
  *            O                       +----------------+                           +----------------+
  *            O                                |                                            |
- *            O       ExecutionGroup.execute   |                                            |
+ *            O ExecutionGroup.scheduleChunks  |                                            |
  *            O------------------------------->O                                            |
  *            .                                O                                            |
  *            .                                O-------\                                    |
@@ -200,7 +202,7 @@ extern "C" {
  *
  * </pre>
  *
- * \see ExecutionGroup.execute Execute a complete ExecutionGroup. Halts until finished or breaked by user
+ * \see ExecutionGroup.scheduleChunks Schedule the next chunks of an ExecutionGroup. Called until finished or breaked by user
  * \see ExecutionGroup.scheduleChunkWhenPossible Tries to schedule a single chunk,
  * checks if all input data is available. Can trigger dependent chunks to be calculated
  * \see ExecutionGroup.scheduleAreaWhenPossible Tries to schedule an area. This can be multiple chunks
@@ -219,9 +221,11 @@ extern "C" {
  *
  * \subsection multithread Multi threaded
  * Default the work-scheduler will place all work as WorkPackage in a queue.
- * For every CPUcore a working thread is created. These working threads will ask the WorkScheduler if there is work
- * for a specific Device.
- * the work-scheduler will find work for the device and the device will be asked to execute the WorkPackage
+ * For every CPUcore a working thread is created, every working thread has its own queue.
+ * A WorkPackage is added to the queue of the least busy thread that calculated the nearest chunk last.
+ * A thread takes the WorkPackage nearest to its last chunk from its queue, so the input buffers it reads
+ * are still in its cache. When its queue is empty it takes work from the queue of the busiest thread.
+ * the device of the thread will be asked to execute the WorkPackage
  *
  * \subsection singlethread Single threaded
  * For debugging reasons the multi-threading can be disabled. This is done by changing the COM_CURRENT_THREADING_MODEL
@@ -323,7 +327,7 @@ void COM_deinitialize(void);
  * \brief Clear all compositor caches. (Compositor system will still remain available).
  * To deinitialize the compositor use the COM_deinitialize method.
  */
-// void COM_clearCaches(void); // NOT YET WRITTEN
+void COM_clearCaches(void);
 
 #ifdef __cplusplus
 }
@@ -29,6 +29,8 @@ CompositorContext::CompositorContext()
 	this->m_fastCalculation = false;
 	this->m_viewSettings = NULL;
 	this->m_displaySettings = NULL;
+	this->m_bufferMemory = 0;
+	this->m_bufferMemorySaved = 0;
 }
 
 int CompositorContext::getFramenumber() const
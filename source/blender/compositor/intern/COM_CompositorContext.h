@@ -87,6 +87,12 @@ private:
 	 */
 	const char *m_viewName;
 
+	/**
+	 * \brief memory used by the buffers between ExecutionGroup's and the part saved by half float storage
+	 */
+	size_t m_bufferMemory;
+	size_t m_bufferMemorySaved;
+
 public:
 	/**
 	 * \brief constructor initializes the context with default values.
@@ -196,6 +202,28 @@ public:
 	void setFastCalculation(bool fastCalculation) {this->m_fastCalculation = fastCalculation;}
 	bool isFastCalculation() const { return this->m_fastCalculation; }
 	bool isGroupnodeBufferEnabled() const { return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0; }
+
+	/**
+	 * \brief scale of the resolution of images and render layers compared to their full resolution
+	 * \note proxies are only used when editing
+	 */
+	float getProxyScale() const {
+		const short proxy_size = this->getbNodeTree()->proxy_size;
+		return (this->m_rendering || proxy_size <= 1) ? 1.0f : 1.0f / proxy_size;
+	}
+
+	/**
+	 * \brief store color buffers as half floats?
+	 * \note OpenCL devices read the float data of buffers, so it's disabled with OpenCL
+	 */
+	bool isHalfFloatEnabled() const { return (this->getbNodeTree()->flag & NTREE_COM_HALF_FLOAT) != 0 && !this->m_hasActiveOpenCLDevices; }
+
+	/**
+	 * \brief set the memory used by buffers, reported in the stats
+	 */
+	void setBufferMemory(size_t memory, size_t saved) { this->m_bufferMemory = memory; this->m_bufferMemorySaved = saved; }
+	size_t getBufferMemory() const { return this->m_bufferMemory; }
+	size_t getBufferMemorySaved() const { return this->m_bufferMemorySaved; }
 };
 
 
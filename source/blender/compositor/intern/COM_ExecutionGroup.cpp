@@ -59,6 +59,9 @@ ExecutionGroup::ExecutionGroup()
 	this->m_chunksFinished = 0;
 	BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
 	this->m_executionStartTime = 0;
+	this->m_chunkOrder = NULL;
+	this->m_chunkOrderStart = 0;
+	this->m_memoryStats[0] = '\0';
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -177,19 +180,26 @@ void ExecutionGroup::determineNumberOfChunks()
 /**
  * this method is called for the top execution groups. containing the compositor node or the preview node or the viewer node)
  */
-void ExecutionGroup::execute(ExecutionSystem *graph)
+bool ExecutionGroup::beginExecution(ExecutionSystem *graph)
 {
 	const CompositorContext &context = graph->getContext();
 	const bNodeTree *bTree = context.getbNodeTree();
-	if (this->m_width == 0 || this->m_height == 0) {return; } /// \note: break out... no pixels to calculate.
-	if (bTree->test_break && bTree->test_break(bTree->tbh)) {return; } /// \note: early break out for blur and preview nodes
-	if (this->m_numberOfChunks == 0) {return; } /// \note: early break out
+	if (this->m_width == 0 || this->m_height == 0) {return false; } /// \note: break out... no pixels to calculate.
+	if (bTree->test_break && bTree->test_break(bTree->tbh)) {return false; } /// \note: early break out for blur and preview nodes
+	if (this->m_numberOfChunks == 0) {return false; } /// \note: early break out
 	unsigned int chunkNumber;
 
 	this->m_executionStartTime = PIL_check_seconds_timer();
 
 	this->m_chunksFinished = 0;
 	this->m_bTree = bTree;
+	this->m_memoryStats[0] = '\0';
+	if (context.getBufferMemorySaved() > 0) {
+		char memory[15], saved[15];
+		BLI_str_format_byte_unit(memory, context.getBufferMemory(), false);
+		BLI_str_format_byte_unit(saved, context.getBufferMemorySaved(), false);
+		BLI_snprintf(this->m_memoryStats, sizeof(this->m_memoryStats), IFACE_(" | Buffers %s (%s saved)"), memory, saved);
+	}
 	unsigned int index;
 	unsigned int *chunkOrder = (unsigned int *)MEM_mallocN(sizeof(unsigned int) * this->m_numberOfChunks, __func__);
 
@@ -300,50 +310,68 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 	DebugInfo::execution_group_started(this);
 	DebugInfo::graphviz(graph);
 
-	bool breaked = false;
-	bool finished = false;
-	unsigned int startIndex = 0;
+	this->m_chunkOrder = chunkOrder;
+	this->m_chunkOrderStart = 0;
+	return true;
+}
+
+bool ExecutionGroup::scheduleChunks(ExecutionSystem *graph)
+{
+	bool startEvaluated = false;
+	bool finished = true;
+	int numberEvaluated = 0;
 	const int maxNumberEvaluated = BLI_system_thread_count() * 2;
 
-	while (!finished && !breaked) {
-		bool startEvaluated = false;
-		finished = true;
-		int numberEvaluated = 0;
-
-		for (index = startIndex; index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated; index++) {
-			chunkNumber = chunkOrder[index];
-			int yChunk = chunkNumber / this->m_numberOfXChunks;
-			int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
-			const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
-			if (state == COM_ES_NOT_SCHEDULED) {
-				scheduleChunkWhenPossible(graph, xChunk, yChunk);
-				finished = false;
-				startEvaluated = true;
-				numberEvaluated++;
-
-				if (bTree->update_draw)
-					bTree->update_draw(bTree->udh);
-			}
-			else if (state == COM_ES_SCHEDULED) {
-				finished = false;
-				startEvaluated = true;
-				numberEvaluated++;
-			}
-			else if (state == COM_ES_EXECUTED && !startEvaluated) {
-				startIndex = index + 1;
-			}
+	for (unsigned int index = this->m_chunkOrderStart; index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated; index++) {
+		const unsigned int chunkNumber = this->m_chunkOrder[index];
+		int yChunk = chunkNumber / this->m_numberOfXChunks;
+		int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
+		const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
+		if (state == COM_ES_NOT_SCHEDULED) {
+			scheduleChunkWhenPossible(graph, xChunk, yChunk);
+			finished = false;
+			startEvaluated = true;
+			numberEvaluated++;
+
+			if (this->m_bTree->update_draw)
+				this->m_bTree->update_draw(this->m_bTree->udh);
 		}
-
-		WorkScheduler::finish();
-
-		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
-			breaked = true;
+		else if (state == COM_ES_SCHEDULED) {
+			finished = false;
+			startEvaluated = true;
+			numberEvaluated++;
+		}
+		else if (state == COM_ES_EXECUTED && !startEvaluated) {
+			this->m_chunkOrderStart = index + 1;
 		}
 	}
+	return finished;
+}
+
+void ExecutionGroup::endExecution(ExecutionSystem *graph)
+{
 	DebugInfo::execution_group_finished(this);
 	DebugInfo::graphviz(graph);
 
-	MEM_freeN(chunkOrder);
+	MEM_freeN(this->m_chunkOrder);
+	this->m_chunkOrder = NULL;
+}
+
+void ExecutionGroup::setExecuted()
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+	}
+}
+
+bool ExecutionGroup::isExecuted() const
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return false;
+		}
+	}
+	return true;
 }
 
 MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
@@ -399,9 +427,10 @@ void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memo
 		this->m_bTree->progress(this->m_bTree->prh, progress);
 
 		char buf[128];
-		BLI_snprintf(buf, sizeof(buf), IFACE_("Compositing | Tile %u-%u"),
+		BLI_snprintf(buf, sizeof(buf), IFACE_("Compositing | Tile %u-%u%s"),
 		             this->m_chunksFinished,
-		             this->m_numberOfChunks);
+		             this->m_numberOfChunks,
+		             this->m_memoryStats);
 		this->m_bTree->stats_draw(this->m_bTree->sdh, buf);
 	}
 }
@@ -570,6 +599,19 @@ void ExecutionGroup::setViewerBorder(float xmin, float xmax, float ymin, float y
 	}
 }
 
+void ExecutionGroup::setViewerRegion(float xmin, float xmax, float ymin, float ymax)
+{
+	NodeOperation *operation = this->getOutputOperation();
+
+	if (operation->isViewerOperation()) {
+		rcti region;
+		BLI_rcti_init(&region, floorf(xmin * this->m_width), ceilf(xmax * this->m_width),
+		              floorf(ymin * this->m_height), ceilf(ymax * this->m_height));
+		/* empty when the viewer is not visible at all */
+		BLI_rcti_isect(&this->m_viewerBorder, &region, &this->m_viewerBorder);
+	}
+}
+
 void ExecutionGroup::setRenderBorder(float xmin, float xmax, float ymin, float ymax)
 {
 	NodeOperation *operation = this->getOutputOperation();
@@ -174,6 +174,21 @@ private:
 	 */
 	double m_executionStartTime;
 
+	/**
+	 * \brief the order in which the chunks are scheduled during execution
+	 */
+	unsigned int *m_chunkOrder;
+
+	/**
+	 * \brief index in m_chunkOrder before which all chunks are executed
+	 */
+	unsigned int m_chunkOrderStart;
+
+	/**
+	 * \brief memory used by buffers, shown in the stats after the tile progress
+	 */
+	char m_memoryStats[64];
+
 	// methods
 	/**
 	 * \brief check whether parameter operation can be added to the execution group
@@ -294,6 +309,12 @@ public:
 	 */
 	unsigned int getHeight() const { return m_height; }
 
+	/**
+	 * \brief get the number of chunks, only those inside the viewer border when it is set
+	 * \note valid after initExecution
+	 */
+	unsigned int getNumberOfChunks() const { return m_numberOfChunks; }
+
 	/**
 	 * \brief does this ExecutionGroup contains a complex NodeOperation
 	 */
@@ -357,20 +378,43 @@ public:
 
 
 	/**
-	 * \brief schedule an ExecutionGroup
-	 * \note this method will return when all chunks have been calculated, or the execution has breaked (by user)
+	 * \brief prepare the execution of an output ExecutionGroup
+	 * \note returns false when there is nothing to calculate or the execution has breaked (by user)
 	 *
-	 * first the order of the chunks will be determined. This is determined by finding the ViewerOperation and get the relevant information from it.
+	 * the order of the chunks will be determined. This is determined by finding the ViewerOperation and get the relevant information from it.
 	 *   - ChunkOrdering
 	 *   - CenterX
 	 *   - CenterY
 	 *
-	 * After determining the order of the chunks the chunks will be scheduled
-	 *
 	 * \see ViewerOperation
+	 * \see scheduleChunks
 	 * \param system:
 	 */
-	void execute(ExecutionSystem *system);
+	bool beginExecution(ExecutionSystem *system);
+
+	/**
+	 * \brief schedule the next chunks in chunk order
+	 * \note does not wait for the scheduled chunks, the ExecutionSystem calls this for all output
+	 * \note groups every time a chunk has been calculated.
+	 * \return true when all chunks have been calculated
+	 */
+	bool scheduleChunks(ExecutionSystem *system);
+
+	/**
+	 * \brief release the resources of beginExecution
+	 */
+	void endExecution(ExecutionSystem *system);
+
+	/**
+	 * \brief mark all chunks as executed, so they will not be scheduled
+	 * \note used when the output buffer is restored from the ResultCache
+	 */
+	void setExecuted();
+
+	/**
+	 * \brief have all chunks of this ExecutionGroup been executed
+	 */
+	bool isExecuted() const;
 
 	/**
 	 * \brief this method determines the MemoryProxy's where this execution group depends on.
@@ -407,6 +451,12 @@ public:
 	 */
 	void setViewerBorder(float xmin, float xmax, float ymin, float ymax);
 
+	/**
+	 * \brief limit the viewer operation to the region visible in the backdrop
+	 * \note all the coordinates are assumed to be in normalized space, call after setViewerBorder
+	 */
+	void setViewerRegion(float xmin, float xmax, float ymin, float ymax);
+
 	void setRenderBorder(float xmin, float xmax, float ymin, float ymax);
 
 	/* allow the DebugInfo class to look at internals */
@@ -16,6 +16,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <set>
+
 #include "COM_ExecutionSystem.h"
 
 #include "PIL_time.h"
@@ -32,6 +34,8 @@ extern "C" {
 #include "COM_ExecutionGroup.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_Debug.h"
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -73,6 +77,10 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editin
 	bool use_viewer_border = (editingtree->flag & NTREE_VIEWER_BORDER) &&
 	                         viewer_border->xmin < viewer_border->xmax &&
 	                         viewer_border->ymin < viewer_border->ymax;
+	rctf *viewer_region = &editingtree->viewer_region;
+	bool use_viewer_region = !rendering && (editingtree->flag & NTREE_COM_VIEWER_REGION) &&
+	                         viewer_region->xmin < viewer_region->xmax &&
+	                         viewer_region->ymin < viewer_region->ymax;
 
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | Determining resolution"));
 
@@ -96,6 +104,11 @@ ExecutionSystem::ExecutionSystem(RenderData *rd, Scene *scene, bNodeTree *editin
 			executionGroup->setViewerBorder(viewer_border->xmin, viewer_border->xmax,
 			                                viewer_border->ymin, viewer_border->ymax);
 		}
+
+		if (use_viewer_region) {
+			executionGroup->setViewerRegion(viewer_region->xmin, viewer_region->xmax,
+			                                viewer_region->ymin, viewer_region->ymax);
+		}
 	}
 
 //	DebugInfo::graphviz(this);
@@ -140,6 +153,8 @@ void ExecutionSystem::execute()
 	}
 	unsigned int index;
 
+	determineHalfFloatBuffers();
+
 	// First allocale all write buffer
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -148,6 +163,7 @@ void ExecutionSystem::execute()
 			operation->initExecution();
 		}
 	}
+	updateBufferMemoryStats();
 	// Connect read buffers to their write buffers
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -170,6 +186,8 @@ void ExecutionSystem::execute()
 		executionGroup->initExecution();
 	}
 
+	ResultCache::restore(this);
+
 	WorkScheduler::start(this->m_context);
 
 	executeGroups(COM_PRIORITY_HIGH);
@@ -181,6 +199,8 @@ void ExecutionSystem::execute()
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	ResultCache::store(this);
+
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | De-initializing execution"));
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -192,15 +212,95 @@ void ExecutionSystem::execute()
 	}
 }
 
+void ExecutionSystem::determineHalfFloatBuffers()
+{
+	const bool useHalfFloat = this->m_context.isHalfFloatEnabled();
+	std::set<MemoryProxy *> floatProxies;
+	unsigned int index;
+
+	for (index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (!operation->isComplex()) {
+			continue;
+		}
+		for (unsigned int socket = 0; socket < operation->getNumberOfInputSockets(); socket++) {
+			NodeOperationOutput *link = operation->getInputSocket(socket)->getLink();
+			if (link && link->getOperation().isReadBufferOperation()) {
+				ReadBufferOperation *readOperation = (ReadBufferOperation *)&link->getOperation();
+				floatProxies.insert(readOperation->getMemoryProxy());
+			}
+		}
+	}
+
+	for (index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isWriteBufferOperation()) {
+			MemoryProxy *proxy = ((WriteBufferOperation *)operation)->getMemoryProxy();
+			proxy->setHalfFloat(useHalfFloat &&
+			                    proxy->getDataType() == COM_DT_COLOR &&
+			                    floatProxies.find(proxy) == floatProxies.end());
+		}
+	}
+}
+
+void ExecutionSystem::updateBufferMemoryStats()
+{
+	size_t memory = 0;
+	size_t saved = 0;
+	for (unsigned int index = 0; index < this->m_operations.size(); index++) {
+		NodeOperation *operation = this->m_operations[index];
+		if (operation->isWriteBufferOperation()) {
+			MemoryBuffer *buffer = ((WriteBufferOperation *)operation)->getMemoryProxy()->getBuffer();
+			memory += buffer->getMemorySize();
+			if (buffer->isHalfFloat()) {
+				/* same size as the half floats it stores */
+				saved += buffer->getMemorySize();
+			}
+		}
+	}
+	this->m_context.setBufferMemory(memory, saved);
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
+	const bNodeTree *bTree = this->m_context.getbNodeTree();
 	unsigned int index;
 	vector<ExecutionGroup *> executionGroups;
+	vector<ExecutionGroup *> activeGroups;
 	this->findOutputExecutionGroup(&executionGroups, priority);
 
 	for (index = 0; index < executionGroups.size(); index++) {
 		ExecutionGroup *group = executionGroups[index];
-		group->execute(this);
+		if (group->beginExecution(this)) {
+			activeGroups.push_back(group);
+		}
+	}
+
+	/* the output groups are scheduled together, so independent groups keep all threads busy */
+	bool breaked = false;
+	while (!activeGroups.empty() && !breaked) {
+		for (index = 0; index < activeGroups.size(); ) {
+			ExecutionGroup *group = activeGroups[index];
+			if (group->scheduleChunks(this)) {
+				group->endExecution(this);
+				activeGroups.erase(activeGroups.begin() + index);
+			}
+			else {
+				index++;
+			}
+		}
+
+		if (!activeGroups.empty()) {
+			WorkScheduler::waitForProgress();
+		}
+
+		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+			breaked = true;
+		}
+	}
+
+	for (index = 0; index < activeGroups.size(); index++) {
+		activeGroups[index]->endExecution(this);
 	}
 }
 
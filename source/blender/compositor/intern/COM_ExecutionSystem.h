@@ -170,9 +170,26 @@ public:
 	 */
 	const CompositorContext &getContext() const { return this->m_context; }
 
+	/**
+	 * \brief get the execution groups of this system
+	 */
+	const Groups &getExecutionGroups() const { return this->m_groups; }
+
 private:
 	void executeGroups(CompositorPriority priority);
 
+	/**
+	 * \brief choose the color buffers that are stored as half floats.
+	 * Buffers read by complex operations are kept as float, these operations access the float data directly.
+	 * \see MemoryProxy.setHalfFloat
+	 */
+	void determineHalfFloatBuffers();
+
+	/**
+	 * \brief store the memory used by the buffers in the context, for the stats
+	 */
+	void updateBufferMemoryStats();
+
 	/* allow the DebugInfo class to look at internals */
 	friend class DebugInfo;
 
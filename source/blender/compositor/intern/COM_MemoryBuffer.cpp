@@ -58,7 +58,14 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
 	this->m_memoryProxy = memoryProxy;
 	this->m_chunkNumber = chunkNumber;
 	this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
-	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	if (memoryProxy->isHalfFloat()) {
+		this->m_buffer = NULL;
+		this->m_halfBuffer = (unsigned short *)MEM_mallocN_aligned(sizeof(unsigned short) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	}
+	else {
+		this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+		this->m_halfBuffer = NULL;
+	}
 	this->m_state = COM_MB_ALLOCATED;
 	this->m_datatype = memoryProxy->getDataType();
 }
@@ -72,6 +79,7 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
 	this->m_chunkNumber = -1;
 	this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
 	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	this->m_halfBuffer = NULL;
 	this->m_state = COM_MB_TEMPORARILY;
 	this->m_datatype = memoryProxy->getDataType();
 }
@@ -85,23 +93,72 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
 	this->m_chunkNumber = -1;
 	this->m_num_channels = determine_num_channels(dataType);
 	this->m_buffer = (float *)MEM_mallocN_aligned(sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
+	this->m_halfBuffer = NULL;
 	this->m_state = COM_MB_TEMPORARILY;
 	this->m_datatype = dataType;
 }
 MemoryBuffer *MemoryBuffer::duplicate()
 {
 	MemoryBuffer *result = new MemoryBuffer(this->m_memoryProxy, &this->m_rect);
-	memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+	if (this->m_halfBuffer) {
+		result->copyContentFrom(this);
+	}
+	else {
+		memcpy(result->m_buffer, this->m_buffer, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+	}
 	return result;
 }
+
+size_t MemoryBuffer::getMemorySize()
+{
+	const size_t elementSize = this->m_halfBuffer ? sizeof(unsigned short) : sizeof(float);
+	return elementSize * this->determineBufferSize() * this->m_num_channels;
+}
+
 void MemoryBuffer::clear()
 {
-	memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
+	if (this->m_halfBuffer) {
+		memset(this->m_halfBuffer, 0, this->getMemorySize());
+	}
+	else {
+		memset(this->m_buffer, 0, this->getMemorySize());
+	}
+}
+
+void MemoryBuffer::fill(const rcti *area, const float *value)
+{
+	const int num_channels = this->m_num_channels;
+	if (this->m_halfBuffer) {
+		unsigned short halfValue[4];
+		for (int c = 0; c < num_channels; c++) {
+			halfValue[c] = floatToHalf(value[c]);
+		}
+		for (int y = area->ymin; y < area->ymax; y++) {
+			unsigned short *out = &this->m_halfBuffer[((y - m_rect.ymin) * this->m_width + (area->xmin - m_rect.xmin)) * num_channels];
+			for (int x = area->xmin; x < area->xmax; x++) {
+				for (int c = 0; c < num_channels; c++) {
+					out[c] = halfValue[c];
+				}
+				out += num_channels;
+			}
+		}
+		return;
+	}
+	for (int y = area->ymin; y < area->ymax; y++) {
+		float *out = this->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++) {
+			for (int c = 0; c < num_channels; c++) {
+				out[c] = value[c];
+			}
+			out += num_channels;
+		}
+	}
 }
 
 
 float MemoryBuffer::getMaximumValue()
 {
+	BLI_assert(this->m_buffer);
 	float result = this->m_buffer[0];
 	const unsigned int size = this->determineBufferSize();
 	unsigned int i;
@@ -144,6 +201,10 @@ MemoryBuffer::~MemoryBuffer()
 		MEM_freeN(this->m_buffer);
 		this->m_buffer = NULL;
 	}
+	if (this->m_halfBuffer) {
+		MEM_freeN(this->m_halfBuffer);
+		this->m_halfBuffer = NULL;
+	}
 }
 
 void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
@@ -161,10 +222,28 @@ void MemoryBuffer::copyContentFrom(MemoryBuffer *otherBuffer)
 	int otherOffset;
 
 
+	const unsigned int rowLength = (maxX - minX) * this->m_num_channels;
+	unsigned int i;
+
 	for (otherY = minY; otherY < maxY; otherY++) {
 		otherOffset = ((otherY - otherBuffer->m_rect.ymin) * otherBuffer->m_width + minX - otherBuffer->m_rect.xmin) * this->m_num_channels;
 		offset = ((otherY - this->m_rect.ymin) * this->m_width + minX - this->m_rect.xmin) * this->m_num_channels;
-		memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], (maxX - minX) * this->m_num_channels * sizeof(float));
+		if (this->m_halfBuffer && otherBuffer->m_halfBuffer) {
+			memcpy(&this->m_halfBuffer[offset], &otherBuffer->m_halfBuffer[otherOffset], rowLength * sizeof(unsigned short));
+		}
+		else if (this->m_halfBuffer) {
+			for (i = 0; i < rowLength; i++) {
+				this->m_halfBuffer[offset + i] = floatToHalf(otherBuffer->m_buffer[otherOffset + i]);
+			}
+		}
+		else if (otherBuffer->m_halfBuffer) {
+			for (i = 0; i < rowLength; i++) {
+				this->m_buffer[offset + i] = halfToFloat(otherBuffer->m_halfBuffer[otherOffset + i]);
+			}
+		}
+		else {
+			memcpy(&this->m_buffer[offset], &otherBuffer->m_buffer[otherOffset], rowLength * sizeof(float));
+		}
 	}
 }
 
@@ -174,7 +253,14 @@ void MemoryBuffer::writePixel(int x, int y, const float color[4])
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
 		const int offset = (this->m_width * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
-		memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
+		if (this->m_halfBuffer) {
+			for (int i = 0; i < this->m_num_channels; i++) {
+				this->m_halfBuffer[offset + i] = floatToHalf(color[i]);
+			}
+		}
+		else {
+			memcpy(&this->m_buffer[offset], color, sizeof(float) * this->m_num_channels);
+		}
 	}
 }
 
@@ -184,6 +270,12 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 	    y >= this->m_rect.ymin && y < this->m_rect.ymax)
 	{
 		const int offset = (this->m_width * (y - this->m_rect.ymin) + x - this->m_rect.xmin) * this->m_num_channels;
+		if (this->m_halfBuffer) {
+			for (int i = 0; i < this->m_num_channels; i++) {
+				this->m_halfBuffer[offset + i] = floatToHalf(halfToFloat(this->m_halfBuffer[offset + i]) + color[i]);
+			}
+			return;
+		}
 		float *dst = &this->m_buffer[offset];
 		const float *src = color;
 		for (int i = 0; i < this->m_num_channels ; i++, dst++, src++) {
@@ -192,6 +284,52 @@ void MemoryBuffer::addPixel(int x, int y, const float color[4])
 	}
 }
 
+/* same as BLI_bilinear_interpolation_wrap_fl, converting the half floats of the four samples */
+void MemoryBuffer::readBilinearHalf(float *result, float u, float v, bool wrap_x, bool wrap_y)
+{
+	const int width = this->m_width;
+	const int height = this->m_height;
+	const int num_channels = this->m_num_channels;
+	int x1 = (int)floorf(u);
+	int x2 = (int)ceilf(u);
+	int y1 = (int)floorf(v);
+	int y2 = (int)ceilf(v);
+
+	if (wrap_x) {
+		if (x1 < 0) x1 = width - 1;
+		if (x2 >= width) x2 = 0;
+	}
+	else if (x2 < 0 || x1 >= width) {
+		copy_vn_fl(result, num_channels, 0.0f);
+		return;
+	}
+
+	if (wrap_y) {
+		if (y1 < 0) y1 = height - 1;
+		if (y2 >= height) y2 = 0;
+	}
+	else if (y2 < 0 || y1 >= height) {
+		copy_vn_fl(result, num_channels, 0.0f);
+		return;
+	}
+
+	/* sample including outside of edges of image */
+	const unsigned short empty[4] = {0, 0, 0, 0};
+	const unsigned short *row1 = (x1 < 0 || y1 < 0) ? empty : &this->m_halfBuffer[(width * y1 + x1) * num_channels];
+	const unsigned short *row2 = (x1 < 0 || y2 > height - 1) ? empty : &this->m_halfBuffer[(width * y2 + x1) * num_channels];
+	const unsigned short *row3 = (x2 > width - 1 || y1 < 0) ? empty : &this->m_halfBuffer[(width * y1 + x2) * num_channels];
+	const unsigned short *row4 = (x2 > width - 1 || y2 > height - 1) ? empty : &this->m_halfBuffer[(width * y2 + x2) * num_channels];
+
+	const float a = u - floorf(u);
+	const float b = v - floorf(v);
+	const float a_b = a * b, ma_b = (1.0f - a) * b, a_mb = a * (1.0f - b), ma_mb = (1.0f - a) * (1.0f - b);
+
+	for (int i = 0; i < num_channels; i++) {
+		result[i] = ma_mb * halfToFloat(row1[i]) + a_mb * halfToFloat(row3[i]) +
+		            ma_b * halfToFloat(row2[i]) + a_b * halfToFloat(row4[i]);
+	}
+}
+
 static void read_ewa_pixel_sampled(void *userdata, int x, int y, float result[4])
 {
 	MemoryBuffer *buffer = (MemoryBuffer *) userdata;
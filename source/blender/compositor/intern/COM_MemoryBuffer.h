@@ -88,6 +88,12 @@ private:
 	 */
 	float *m_buffer;
 
+	/**
+	 * \brief the data stored as half floats, used instead of m_buffer to save memory
+	 * \see MemoryProxy.setHalfFloat
+	 */
+	unsigned short *m_halfBuffer;
+
 	/**
 	 * \brief the number of channels of a single value in the buffer.
 	 * For value buffers this is 1, vector 3 and color 4
@@ -128,9 +134,75 @@ public:
 	/**
 	 * \brief get the data of this MemoryBuffer
 	 * \note buffer should already be available in memory
+	 * \note NULL for half float buffers, these can only be accessed with read and write methods
 	 */
 	float *getBuffer() { return this->m_buffer; }
 
+	/**
+	 * \brief is the data of this MemoryBuffer stored as half floats
+	 */
+	bool isHalfFloat() const { return this->m_halfBuffer != NULL; }
+
+	/**
+	 * \brief get the size of the data of this MemoryBuffer in bytes
+	 */
+	size_t getMemorySize();
+
+	static inline float halfToFloat(unsigned short h)
+	{
+		union { unsigned int i; float f; } result;
+		const unsigned int sign = (unsigned int)(h & 0x8000) << 16;
+		const unsigned int exponent = (h >> 10) & 0x1f;
+		const unsigned int mantissa = h & 0x3ff;
+		if (exponent == 0) {
+			/* zero and denormals */
+			result.f = (float)mantissa * (1.0f / 16777216.0f);
+			result.i |= sign;
+		}
+		else if (exponent == 31) {
+			/* infinity and nan */
+			result.i = sign | 0x7f800000 | (mantissa << 13);
+		}
+		else {
+			result.i = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+		return result.f;
+	}
+
+	static inline unsigned short floatToHalf(float f)
+	{
+		union { float f; unsigned int i; } value;
+		value.f = f;
+		const unsigned short sign = (value.i >> 16) & 0x8000;
+		const unsigned int bits = value.i & 0x7fffffff;
+		if (bits >= 0x7f800000) {
+			/* infinity and nan */
+			return sign | 0x7c00 | (bits > 0x7f800000 ? 0x200 : 0);
+		}
+		if (bits >= 0x477ff000) {
+			/* too large, clamped to the largest half so bright pixels don't become infinite */
+			return sign | 0x7bff;
+		}
+		if (bits < 0x38800000) {
+			/* denormals, rounded to nearest */
+			value.i = bits;
+			return sign | (unsigned short)(value.f * 16777216.0f + 0.5f);
+		}
+		/* rebias the exponent and round the mantissa to nearest even */
+		return sign | (unsigned short)((bits - 0x38000000 + 0xfff + ((bits >> 13) & 1)) >> 13);
+	}
+
+	/**
+	 * \brief get the data of the pixel at x, y in image space
+	 * \note the pixel must be inside the rect of this MemoryBuffer
+	 */
+	inline float *getElem(int x, int y)
+	{
+		BLI_assert(this->m_buffer);
+		BLI_assert(x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax);
+		return &this->m_buffer[((y - m_rect.ymin) * this->m_width + (x - m_rect.xmin)) * this->m_num_channels];
+	}
+
 	/**
 	 * \brief after execution the state will be set to available by calling this method
 	 */
@@ -218,8 +290,7 @@ public:
 			int v = y;
 			this->wrap_pixel(u, v, extend_x, extend_y);
 			const int offset = (this->m_width * y + x) * this->m_num_channels;
-			float *buffer = &this->m_buffer[offset];
-			memcpy(result, buffer, sizeof(float) * this->m_num_channels);
+			readOffset(result, offset);
 		}
 	}
 
@@ -242,8 +313,7 @@ public:
 		BLI_assert((int)(MEM_allocN_len(this->m_buffer) / sizeof(*this->m_buffer)) ==
 		           (int)(this->determineBufferSize() * COM_NUMBER_OF_CHANNELS));
 #endif
-		float *buffer = &this->m_buffer[offset];
-		memcpy(result, buffer, sizeof(float) * this->m_num_channels);
+		readOffset(result, offset);
 	}
 
 	void writePixel(int x, int y, const float color[4]);
@@ -261,6 +331,10 @@ public:
 			copy_vn_fl(result, this->m_num_channels, 0.0f);
 			return;
 		}
+		if (this->m_halfBuffer) {
+			readBilinearHalf(result, u, v, extend_x == COM_MB_REPEAT, extend_y == COM_MB_REPEAT);
+			return;
+		}
 		BLI_bilinear_interpolation_wrap_fl(
 		        this->m_buffer, result, this->m_width, this->m_height, this->m_num_channels, u, v,
 		        extend_x == COM_MB_REPEAT, extend_y == COM_MB_REPEAT);
@@ -302,6 +376,13 @@ public:
 	 */
 	void clear();
 
+	/**
+	 * \brief set all pixels of an area to the same value
+	 * \param area: area in image space, must be inside the rect of this MemoryBuffer
+	 * \param value: a value with the number of channels of this MemoryBuffer
+	 */
+	void fill(const rcti *area, const float *value);
+
 	MemoryBuffer *duplicate();
 
 	float getMaximumValue();
@@ -309,6 +390,21 @@ public:
 private:
 	unsigned int determineBufferSize();
 
+	inline void readOffset(float *result, int offset)
+	{
+		if (this->m_halfBuffer) {
+			const unsigned short *buffer = &this->m_halfBuffer[offset];
+			for (unsigned int i = 0; i < this->m_num_channels; i++) {
+				result[i] = halfToFloat(buffer[i]);
+			}
+		}
+		else {
+			memcpy(result, &this->m_buffer[offset], sizeof(float) * this->m_num_channels);
+		}
+	}
+
+	void readBilinearHalf(float *result, float u, float v, bool wrap_x, bool wrap_y);
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryBuffer")
 #endif
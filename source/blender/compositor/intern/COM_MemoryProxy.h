@@ -64,6 +64,11 @@ private:
 	 */
 	DataType m_datatype;
 
+	/**
+	 * \brief store the buffer as half floats
+	 */
+	bool m_halfFloat;
+
 public:
 	MemoryProxy(DataType type);
 
@@ -107,6 +112,14 @@ public:
 
 	inline DataType getDataType() { return this->m_datatype; }
 
+	/**
+	 * \brief store the buffer as half floats, halving the memory used
+	 * \note only for buffers that are not read directly by complex operations or OpenCL
+	 * \see ExecutionSystem.determineHalfFloatBuffers
+	 */
+	void setHalfFloat(bool halfFloat) { this->m_halfFloat = halfFloat; }
+	bool isHalfFloat() const { return this->m_halfFloat; }
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("COM:MemoryProxy")
 #endif
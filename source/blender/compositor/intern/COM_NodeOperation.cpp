@@ -18,6 +18,7 @@
 
 #include <typeinfo>
 #include <stdio.h>
+#include <vector>
 
 #include "COM_defines.h"
 #include "COM_ExecutionSystem.h"
@@ -36,7 +37,11 @@ NodeOperation::NodeOperation()
 	this->m_height = 0;
 	this->m_isResolutionSet = false;
 	this->m_openCL = false;
+	this->m_areaExecution = false;
 	this->m_btree = NULL;
+	this->m_bnode = NULL;
+	this->m_bnodeOutputIndex = -1;
+	this->m_bnodeOperationIndex = 0;
 }
 
 NodeOperation::~NodeOperation()
@@ -133,6 +138,62 @@ void NodeOperation::deinitExecution()
 {
 	/* pass */
 }
+
+void NodeOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer ** /*inputs*/)
+{
+	const int num_channels = output->get_num_channels();
+	float color[4];
+
+	for (int y = area->ymin; y < area->ymax; y++) {
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++) {
+			this->readSampled(color, x, y, COM_PS_NEAREST);
+			memcpy(out, color, sizeof(float) * num_channels);
+			out += num_channels;
+		}
+	}
+}
+
+void NodeOperation::renderArea(MemoryBuffer *output, rcti *area)
+{
+	if (!this->canExecuteArea()) {
+		NodeOperation::executeArea(output, area, NULL);
+		return;
+	}
+
+	const unsigned int num_inputs = this->getNumberOfInputSockets();
+	std::vector<MemoryBuffer *> inputs(num_inputs, (MemoryBuffer *)NULL);
+
+	for (unsigned int index = 0; index < num_inputs; index++) {
+		NodeOperation *input = this->getInputOperation(index);
+		if (input == NULL) {
+			continue;
+		}
+
+		if (this->isComplex()) {
+			/* complex operations read from the buffer of the whole input */
+			if (input->isReadBufferOperation()) {
+				inputs[index] = (MemoryBuffer *)input->initializeTileData(area);
+			}
+		}
+		else {
+			rcti inputArea;
+			if (this->determineAreaOfInput(index, area, &inputArea)) {
+				inputs[index] = new MemoryBuffer(this->getInputSocket(index)->getDataType(), &inputArea);
+				input->renderArea(inputs[index], &inputArea);
+			}
+		}
+	}
+
+	this->executeArea(output, area, (num_inputs) ? &inputs[0] : NULL);
+
+	if (!this->isComplex()) {
+		for (unsigned int index = 0; index < num_inputs; index++) {
+			delete inputs[index];
+		}
+	}
+}
+
 SocketReader *NodeOperation::getInputSocketReader(unsigned int inputSocketIndex)
 {
 	return this->getInputSocket(inputSocketIndex)->getReader();
@@ -101,6 +101,12 @@ private:
 	 */
 	bool m_openCL;
 
+	/**
+	 * \brief can this operation calculate whole areas at once
+	 * \see NodeOperation.executeArea
+	 */
+	bool m_areaExecution;
+
 	/**
 	 * \brief mutex reference for very special node initializations
 	 * \note only use when you really know what you are doing.
@@ -117,6 +123,24 @@ private:
 	 */
 	const bNodeTree *m_btree;
 
+	/**
+	 * \brief the editor node this operation was created for, NULL for operations added by the builder
+	 * \see ResultCache
+	 */
+	const bNode *m_bnode;
+
+	/**
+	 * \brief index of the m_bnode output this operation is mapped to, -1 when it isn't mapped
+	 * \see ResultCache
+	 */
+	int m_bnodeOutputIndex;
+
+	/**
+	 * \brief index of this operation among the operations created for m_bnode
+	 * \see ResultCache
+	 */
+	unsigned int m_bnodeOperationIndex;
+
 	/**
 	 * \brief set to truth when resolution for this operation is set
 	 */
@@ -162,6 +186,21 @@ public:
 	virtual int isSingleThreaded() { return false; }
 
 	void setbNodeTree(const bNodeTree *tree) { this->m_btree = tree; }
+	void setbNode(const bNode *node) { this->m_bnode = node; }
+	const bNode *getbNode() const { return this->m_bnode; }
+	void setbNodeOutputIndex(int index) { this->m_bnodeOutputIndex = index; }
+	int getbNodeOutputIndex() const { return this->m_bnodeOutputIndex; }
+	void setbNodeOperationIndex(unsigned int index) { this->m_bnodeOperationIndex = index; }
+	unsigned int getbNodeOperationIndex() const { return this->m_bnodeOperationIndex; }
+
+	/**
+	 * \brief add the parameters that are not settings of the bNode to the cache key
+	 *
+	 * Operations with parameters set by the converter from other data than the bNode settings
+	 * must hash them, so siblings created for the same node get different keys.
+	 * \see ResultCache::hash
+	 */
+	virtual void hashParams(uint64_t & /*key*/) const {}
 	virtual void initExecution();
 
 	/**
@@ -210,6 +249,39 @@ public:
 	                           MemoryBuffer ** /*inputMemoryBuffers*/,
 	                           list<cl_mem> * /*clMemToCleanUp*/,
 	                           list<cl_kernel> * /*clKernelsToCleanUp*/) {}
+
+	/**
+	 * \brief calculate all pixels of an area at once, when area execution is enabled
+	 * \ingroup execution
+	 * \note only called with input buffers for operations that support area execution,
+	 * the default implementation reads the inputs pixel by pixel.
+	 * \param output: the buffer to write to, its rect contains the area
+	 * \param area: the pixels to calculate
+	 * \param inputs: per input socket a buffer containing the area of that input,
+	 * see determineAreaOfInput. For complex operations this is the whole buffer of the
+	 * connected ReadBufferOperation instead.
+	 */
+	virtual void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
+	/**
+	 * \brief determine the area of an input needed to calculate an area of the output
+	 * \ingroup execution
+	 * \return false when the input is not read by executeArea
+	 */
+	virtual bool determineAreaOfInput(unsigned int /*inputSocketIndex*/, rcti *area, rcti *r_inputArea)
+	{
+		*r_inputArea = *area;
+		return true;
+	}
+
+	/**
+	 * \brief calculate an area of this operation into output
+	 * \ingroup execution
+	 * Inputs are calculated for the whole area first when this operation supports area
+	 * execution, otherwise this falls back to reading them pixel by pixel.
+	 */
+	void renderArea(MemoryBuffer *output, rcti *area);
+
 	virtual void deinitExecution();
 
 	bool isResolutionSet() {
@@ -285,6 +357,12 @@ public:
 	 */
 	bool isOpenCL() const { return this->m_openCL; }
 
+	/**
+	 * \brief can this NodeOperation calculate whole areas at once
+	 * \see NodeOperation.executeArea
+	 */
+	virtual bool canExecuteArea() { return this->m_areaExecution; }
+
 	virtual bool isViewerOperation() const { return false; }
 	virtual bool isPreviewOperation() const { return false; }
 	virtual bool isFileOutputOperation() const { return false; }
@@ -296,6 +374,13 @@ public:
 		return this->m_btree->test_break(this->m_btree->tbh);
 	}
 
+	/**
+	 * \brief is area execution enabled for the node tree
+	 */
+	inline bool useAreaExecution() const {
+		return (this->m_btree->flag & NTREE_COM_AREA_EXECUTION) != 0;
+	}
+
 	inline void updateDraw() {
 		if (this->m_btree->update_draw)
 			this->m_btree->update_draw(this->m_btree->udh);
@@ -329,6 +414,11 @@ protected:
 	 */
 	void setOpenCL(bool openCL) { this->m_openCL = openCL; }
 
+	/**
+	 * \brief set if this NodeOperation implements executeArea
+	 */
+	void setAreaExecution(bool areaExecution) { this->m_areaExecution = areaExecution; }
+
 	/* allow the DebugInfo class to look at internals */
 	friend class DebugInfo;
 
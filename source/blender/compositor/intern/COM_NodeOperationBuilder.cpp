@@ -34,6 +34,7 @@ extern "C" {
 #include "COM_SetColorOperation.h"
 #include "COM_SocketProxyOperation.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ScaleOperation.h"
 #include "COM_WriteBufferOperation.h"
 #include "COM_ViewerOperation.h"
 
@@ -42,6 +43,7 @@ extern "C" {
 NodeOperationBuilder::NodeOperationBuilder(const CompositorContext *context, bNodeTree *b_nodetree) :
     m_context(context),
     m_current_node(NULL),
+    m_current_node_operations(0),
     m_active_viewer(NULL)
 {
 	m_graph.from_bNodeTree(*context, b_nodetree);
@@ -60,6 +62,7 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 		Node *node = (Node *)m_graph.nodes()[index];
 
 		m_current_node = node;
+		m_current_node_operations = 0;
 
 		DebugInfo::node_to_operations(node);
 		node->convertToOperations(converter, *m_context);
@@ -104,6 +107,8 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
 	add_datatype_conversions();
 
+	add_proxy_scale_operations();
+
 	determineResolutions();
 
 	/* surround complex ops with read/write buffer */
@@ -127,6 +132,10 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
 void NodeOperationBuilder::addOperation(NodeOperation *operation)
 {
+	if (m_current_node) {
+		operation->setbNode(m_current_node->getbNode());
+		operation->setbNodeOperationIndex(m_current_node_operations++);
+	}
 	m_operations.push_back(operation);
 }
 
@@ -148,6 +157,16 @@ void NodeOperationBuilder::mapOutputSocket(NodeOutput *node_socket, NodeOperatio
 	BLI_assert(node_socket->getNode() == m_current_node);
 
 	m_output_map[node_socket] = operation_socket;
+
+	NodeOperation &operation = operation_socket->getOperation();
+	if (operation.getbNode() == m_current_node->getbNode() && operation.getbNodeOutputIndex() == -1) {
+		for (unsigned int index = 0; index < m_current_node->getNumberOfOutputSockets(); index++) {
+			if (m_current_node->getOutputSocket(index) == node_socket) {
+				operation.setbNodeOutputIndex(index);
+				break;
+			}
+		}
+	}
 }
 
 void NodeOperationBuilder::addLink(NodeOperationOutput *from, NodeOperationInput *to)
@@ -387,6 +406,59 @@ void NodeOperationBuilder::resolve_proxies()
 	}
 }
 
+void NodeOperationBuilder::add_proxy_scale_operations()
+{
+	const float scale = m_context->getProxyScale();
+	if (scale >= 1.0f)
+		return;
+
+	/* operations are added to m_operations below */
+	Operations operations = m_operations;
+	for (Operations::const_iterator it = operations.begin(); it != operations.end(); ++it) {
+		NodeOperation *op = *it;
+
+		if (op->getNumberOfInputSockets() == 0) {
+			/* only sources with a resolution of their own (images, render layers, movie clips),
+			 * sources using the preferred resolution get the scaled resolution already */
+			unsigned int resolution[2] = {0, 0};
+			unsigned int preferredResolution[2] = {0, 0};
+			op->determineResolution(resolution, preferredResolution);
+			if (resolution[0] <= 1 || resolution[1] <= 1)
+				continue;
+
+			for (unsigned int index = 0; index < op->getNumberOfOutputSockets(); index++) {
+				NodeOperationOutput *output = op->getOutputSocket(index);
+				OpInputs targets = cache_output_links(output);
+				if (targets.empty())
+					continue;
+
+				ProxyScaleOperation *scale_op = new ProxyScaleOperation(output->getDataType(), scale);
+				addOperation(scale_op);
+				addLink(output, scale_op->getInputSocket(0));
+				for (OpInputs::const_iterator it_target = targets.begin(); it_target != targets.end(); ++it_target) {
+					removeInputLink(*it_target);
+					addLink(scale_op->getOutputSocket(), *it_target);
+				}
+			}
+		}
+		else if (op->isOutputOperation(m_context->isRendering()) && !op->isPreviewOperation()) {
+			/* viewers and the composite output keep the full resolution */
+			for (unsigned int index = 0; index < op->getNumberOfInputSockets(); index++) {
+				NodeOperationInput *input = op->getInputSocket(index);
+				if (!input->isConnected())
+					continue;
+
+				NodeOperationOutput *from = input->getLink();
+				ProxyScaleOperation *scale_op = new ProxyScaleOperation(input->getDataType(), 1.0f / scale);
+				addOperation(scale_op);
+				removeInputLink(input);
+				addLink(from, scale_op->getInputSocket(0));
+				addLink(scale_op->getOutputSocket(), input);
+			}
+		}
+	}
+}
+
 void NodeOperationBuilder::determineResolutions()
 {
 	/* determine all resolutions of the operations (Width/Height) */
@@ -84,6 +84,8 @@ private:
 	OutputSocketMap m_output_map;
 
 	Node *m_current_node;
+	/** Number of operations added for m_current_node */
+	unsigned int m_current_node_operations;
 
 	/** Operation that will be writing to the viewer image
 	 *  Only one operation can occupy this place at a time,
@@ -134,6 +136,9 @@ protected:
 	/** Replace proxy operations with direct links */
 	void resolve_proxies();
 
+	/** Scale sources to the edit resolution and outputs back to full resolution */
+	void add_proxy_scale_operations();
+
 	/** Calculate resolution for each operation */
 	void determineResolutions();
 
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2019, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <list>
+#include <map>
+#include <string.h>
+#include <typeinfo>
+
+#include "COM_ResultCache.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#  include "BLI_threads.h"
+#  include "DNA_color_types.h"
+#  include "DNA_ID.h"
+#  include "DNA_node_types.h"
+#  include "DNA_scene_types.h"
+#  include "BKE_node.h"
+}
+
+typedef uint64_t CacheKey;
+
+/** keys of the cached buffers, least recently used first */
+typedef std::list<CacheKey> CacheUsage;
+
+typedef struct CacheEntry {
+	MemoryBuffer *buffer;
+	size_t size;
+	/** position of the key in s_usage */
+	CacheUsage::iterator usage;
+} CacheEntry;
+
+typedef struct OperationKey {
+	bool valid;
+	CacheKey key;
+} OperationKey;
+
+typedef std::map<CacheKey, CacheEntry> CacheEntries;
+typedef std::map<const NodeOperation *, OperationKey> OperationKeys;
+
+static ThreadMutex s_cacheMutex = BLI_MUTEX_INITIALIZER;
+static CacheEntries s_entries;
+static CacheUsage s_usage;
+static size_t s_cacheSize = 0;
+
+/* ******** Key calculation ******** */
+
+/* 64 bit FNV-1a */
+static void hash_data(CacheKey &key, const void *data, size_t size)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	for (size_t i = 0; i < size; i++) {
+		key ^= bytes[i];
+		key *= 1099511628211ULL;
+	}
+}
+
+static void hash_string(CacheKey &key, const char *str)
+{
+	hash_data(key, str, strlen(str) + 1);
+}
+
+template<typename T> static void hash_value(CacheKey &key, const T &value)
+{
+	hash_data(key, &value, sizeof(value));
+}
+
+static void hash_allocated(CacheKey &key, const void *data)
+{
+	if (data) {
+		hash_data(key, data, MEM_allocN_len(data));
+	}
+}
+
+/* CurveMapping contains pointers to the curve points, only hash the values */
+static void hash_curvemapping(CacheKey &key, const CurveMapping *cumap)
+{
+	hash_value(key, cumap->flag);
+	hash_value(key, cumap->cur);
+	hash_value(key, cumap->preset);
+	hash_value(key, cumap->clipr);
+	hash_value(key, cumap->black);
+	hash_value(key, cumap->white);
+	hash_value(key, cumap->tone);
+	for (int i = 0; i < CM_TOT; i++) {
+		const CurveMap *cuma = &cumap->cm[i];
+		hash_value(key, cuma->totpoint);
+		hash_value(key, cuma->flag);
+		hash_value(key, cuma->ext_in);
+		hash_value(key, cuma->ext_out);
+		if (cuma->curve) {
+			hash_data(key, cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+		}
+	}
+}
+
+/**
+ * Hash the settings of a node.
+ * Returns false when the result of the node depends on data outside of the node tree
+ * that can change without the node changing.
+ */
+static bool hash_node(CacheKey &key, const bNode *node)
+{
+	hash_value(key, node->type);
+	hash_string(key, node->idname);
+	hash_value(key, node->custom1);
+	hash_value(key, node->custom2);
+	hash_value(key, node->custom3);
+	hash_value(key, node->custom4);
+
+	if (node->id) {
+		/* render layers are invalidated by COM_clearCaches when rendering,
+		 * images, movie clips, masks and textures can be edited in place */
+		if (GS(node->id->name) != ID_SCE) {
+			return false;
+		}
+		hash_value(key, node->id);
+	}
+
+	switch (node->type) {
+		case CMP_NODE_TIME:
+		case CMP_NODE_CURVE_VEC:
+		case CMP_NODE_CURVE_RGB:
+		case CMP_NODE_HUECORRECT:
+			hash_curvemapping(key, (const CurveMapping *)node->storage);
+			break;
+		case CMP_NODE_DEFOCUS:
+			/* the Z buffer is converted with the lens and focus distance of the scene camera */
+			if (!((const NodeDefocus *)node->storage)->no_zbuf) {
+				return false;
+			}
+			hash_allocated(key, node->storage);
+			break;
+		case CMP_NODE_CRYPTOMATTE:
+		{
+			const NodeCryptomatte *data = (const NodeCryptomatte *)node->storage;
+			hash_value(key, data->add);
+			hash_value(key, data->remove);
+			if (data->matte_id) {
+				hash_string(key, data->matte_id);
+			}
+			break;
+		}
+		default:
+			if (node->storage && node->typeinfo->storagename[0] == '\0') {
+				/* storage that isn't a DNA struct can't be hashed */
+				return false;
+			}
+			hash_allocated(key, node->storage);
+			break;
+	}
+
+	for (const bNodeSocket *sock = (const bNodeSocket *)node->inputs.first; sock; sock = sock->next) {
+		hash_allocated(key, sock->default_value);
+	}
+	return true;
+}
+
+static OperationKey operation_key(OperationKeys &keys, const CacheKey contextKey, NodeOperation *operation)
+{
+	OperationKeys::const_iterator it = keys.find(operation);
+	if (it != keys.end()) {
+		return it->second;
+	}
+
+	OperationKey result;
+	result.valid = true;
+	result.key = contextKey;
+	hash_string(result.key, typeid(*operation).name());
+	hash_value(result.key, operation->getWidth());
+	hash_value(result.key, operation->getHeight());
+
+	if (operation->getbNode()) {
+		result.valid = hash_node(result.key, operation->getbNode());
+		/* siblings of the same type are told apart by the node output they are mapped to,
+		 * the order the converter added them in and the parameters it set */
+		hash_value(result.key, operation->getbNodeOutputIndex());
+		hash_value(result.key, operation->getbNodeOperationIndex());
+	}
+	operation->hashParams(result.key);
+
+	if (result.valid && operation->isSetOperation()) {
+		/* constants for unlinked sockets have no node, their value can come from the
+		 * socket of the node or of the group node around it */
+		float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		operation->readSampled(value, 0.0f, 0.0f, COM_PS_NEAREST);
+		hash_value(result.key, value);
+	}
+
+	if (operation->isReadBufferOperation()) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+		NodeOperation *writeOperation = readOperation->getMemoryProxy()->getWriteBufferOperation();
+		OperationKey input = operation_key(keys, contextKey, writeOperation);
+		result.valid = result.valid && input.valid;
+		hash_value(result.key, input.key);
+	}
+
+	for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+		NodeOperationOutput *link = operation->getInputSocket(index)->getLink();
+		if (link) {
+			OperationKey input = operation_key(keys, contextKey, &link->getOperation());
+			result.valid = result.valid && input.valid;
+			hash_value(result.key, input.key);
+		}
+		else {
+			hash_value(result.key, index);
+		}
+	}
+
+	keys[operation] = result;
+	return result;
+}
+
+static CacheKey context_key(const CompositorContext &context)
+{
+	CacheKey key = 14695981039346656037ULL;
+	hash_value(key, context.getQuality());
+	hash_value(key, context.getHasActiveOpenCLDevices());
+	hash_value(key, context.getFramenumber());
+	hash_string(key, context.getViewName());
+	hash_value(key, context.isHalfFloatEnabled());
+	hash_value(key, context.getProxyScale());
+
+	/* render size and border used by nodes when they are converted to operations */
+	const RenderData *rd = context.getRenderData();
+	if (rd) {
+		hash_value(key, rd->xsch);
+		hash_value(key, rd->ysch);
+		hash_value(key, rd->size);
+		hash_value(key, rd->mode & (R_BORDER | R_CROP));
+		hash_value(key, rd->scemode & (R_FULL_SAMPLE | R_MULTIVIEW));
+		hash_value(key, rd->border);
+	}
+	return key;
+}
+
+static size_t get_limit(ExecutionSystem *system)
+{
+	const CompositorContext &context = system->getContext();
+	if (context.isRendering() || context.isFastCalculation()) {
+		return 0;
+	}
+	return (size_t)max_ii(context.getbNodeTree()->cache_limit, 0) * 1024 * 1024;
+}
+
+/* ******** Cache ******** */
+
+static void free_entry(CacheEntries::iterator it)
+{
+	s_cacheSize -= it->second.size;
+	s_usage.erase(it->second.usage);
+	delete it->second.buffer;
+	s_entries.erase(it);
+}
+
+static void free_unused_entries(size_t limit)
+{
+	while (s_cacheSize > limit) {
+		free_entry(s_entries.find(s_usage.front()));
+	}
+}
+
+void ResultCache::restore(ExecutionSystem *system)
+{
+	const size_t limit = get_limit(system);
+	if (limit == 0) {
+		/* free the memory when the cache got disabled */
+		if (system->getContext().getbNodeTree()->cache_limit <= 0) {
+			clear();
+		}
+		return;
+	}
+
+	BLI_mutex_lock(&s_cacheMutex);
+
+	OperationKeys keys;
+	const CacheKey contextKey = context_key(system->getContext());
+	const ExecutionSystem::Groups &groups = system->getExecutionGroups();
+	for (unsigned int index = 0; index < groups.size(); index++) {
+		ExecutionGroup *group = groups[index];
+		NodeOperation *operation = group->getOutputOperation();
+		if (!operation->isWriteBufferOperation()) {
+			continue;
+		}
+
+		OperationKey key = operation_key(keys, contextKey, operation);
+		if (!key.valid) {
+			continue;
+		}
+		CacheEntries::iterator it = s_entries.find(key.key);
+		if (it == s_entries.end()) {
+			continue;
+		}
+
+		MemoryBuffer *buffer = ((WriteBufferOperation *)operation)->getMemoryProxy()->getBuffer();
+		MemoryBuffer *cached = it->second.buffer;
+		if (BLI_rcti_compare(buffer->getRect(), cached->getRect()) &&
+		    buffer->get_num_channels() == cached->get_num_channels())
+		{
+			buffer->copyContentFrom(cached);
+			group->setExecuted();
+			s_usage.splice(s_usage.end(), s_usage, it->second.usage);
+		}
+	}
+
+	BLI_mutex_unlock(&s_cacheMutex);
+}
+
+void ResultCache::store(ExecutionSystem *system)
+{
+	const size_t limit = get_limit(system);
+	const bNodeTree *tree = system->getContext().getbNodeTree();
+	if (limit == 0 || tree->test_break(tree->tbh)) {
+		return;
+	}
+
+	BLI_mutex_lock(&s_cacheMutex);
+
+	OperationKeys keys;
+	const CacheKey contextKey = context_key(system->getContext());
+	const ExecutionSystem::Groups &groups = system->getExecutionGroups();
+	for (unsigned int index = 0; index < groups.size(); index++) {
+		ExecutionGroup *group = groups[index];
+		NodeOperation *operation = group->getOutputOperation();
+		if (!operation->isWriteBufferOperation() || !group->isExecuted()) {
+			continue;
+		}
+
+		OperationKey key = operation_key(keys, contextKey, operation);
+		if (!key.valid || s_entries.find(key.key) != s_entries.end()) {
+			continue;
+		}
+
+		MemoryProxy *proxy = ((WriteBufferOperation *)operation)->getMemoryProxy();
+		MemoryBuffer *buffer = proxy->getBuffer();
+		/* half float buffers are cached as float */
+		const size_t size = sizeof(float) * buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels();
+		if (size == 0 || size > limit) {
+			continue;
+		}
+
+		CacheEntry entry;
+		entry.buffer = new MemoryBuffer(proxy->getDataType(), buffer->getRect());
+		entry.size = size;
+		entry.usage = s_usage.insert(s_usage.end(), key.key);
+		entry.buffer->copyContentFrom(buffer);
+		s_entries[key.key] = entry;
+		s_cacheSize += size;
+	}
+
+	free_unused_entries(limit);
+
+	BLI_mutex_unlock(&s_cacheMutex);
+}
+
+bool ResultCache::calculateKey(const CompositorContext &context, NodeOperation *operation, uint64_t *r_key)
+{
+	OperationKeys keys;
+	OperationKey key = operation_key(keys, context_key(context), operation);
+	*r_key = key.key;
+	return key.valid;
+}
+
+void ResultCache::hash(uint64_t &key, const void *data, size_t size)
+{
+	hash_data(key, data, size);
+}
+
+void ResultCache::clear()
+{
+	BLI_mutex_lock(&s_cacheMutex);
+	while (!s_entries.empty()) {
+		free_entry(s_entries.begin());
+	}
+	BLI_mutex_unlock(&s_cacheMutex);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2019, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __COM_RESULTCACHE_H__
+#define __COM_RESULTCACHE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+class CompositorContext;
+class ExecutionSystem;
+class NodeOperation;
+
+/**
+ * \brief cache of ExecutionGroup results between executions of the compositor
+ * \ingroup Memory
+ *
+ * The output buffer of every ExecutionGroup that writes to a MemoryProxy is kept with a key.
+ * The key hashes the operations of the group, the settings of the nodes they were created for
+ * and the keys of the groups it reads from. When a node is changed only the groups that depend
+ * on it get a new key, the other groups are restored from the cache and are not scheduled.
+ *
+ * The cache is only used while editing, bNodeTree.cache_limit sets its memory budget.
+ */
+class ResultCache {
+public:
+	/**
+	 * \brief restore the output buffers of groups that are in the cache
+	 * \note call after the ExecutionGroup's and WriteBufferOperation's are initialized
+	 */
+	static void restore(ExecutionSystem *system);
+
+	/**
+	 * \brief store the output buffers of all completely executed groups
+	 * \note call before the ExecutionGroup's are deinitialized
+	 */
+	static void store(ExecutionSystem *system);
+
+	/**
+	 * \brief calculate the key the result of an operation is cached with
+	 * \return false when the result of the operation can't be cached
+	 */
+	static bool calculateKey(const CompositorContext &context, NodeOperation *operation, uint64_t *r_key);
+
+	/**
+	 * \brief add data to a key, used by NodeOperation::hashParams
+	 */
+	static void hash(uint64_t &key, const void *data, size_t size);
+
+	/**
+	 * \brief free all cached buffers
+	 */
+	static void clear();
+};
+
+#endif  /* __COM_RESULTCACHE_H__ */
@@ -16,6 +16,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <deque>
 #include <list>
 #include <stdio.h>
 
@@ -30,6 +31,8 @@
 #include "MEM_guardedalloc.h"
 
 #include "PIL_time.h"
+#include "BLI_math.h"
+#include "BLI_rect.h"
 #include "BLI_threads.h"
 
 #include "BKE_global.h"
@@ -53,8 +56,34 @@ static ThreadLocal(CPUDevice *) g_thread_device;
 /// \brief list of all thread for every CPUDevice in cpudevices a thread exists
 static ListBase g_cputhreads;
 static bool g_cpuInitialized = false;
-/// \brief all scheduled work for the cpu
-static ThreadQueue *g_cpuqueue;
+
+/// \brief a scheduled WorkPackage with the center of its chunk in normalized coordinates
+typedef struct QueuedWorkPackage {
+	WorkPackage *package;
+	float co[2];
+} QueuedWorkPackage;
+
+/// \brief scheduled work of a single cpu thread, other threads take work from it when they run out
+typedef struct CPUQueue {
+	std::deque<QueuedWorkPackage> packages;
+	/// \brief center of the last chunk executed by the thread
+	float co[2];
+	bool hasExecuted;
+} CPUQueue;
+
+/// \brief all scheduled work for the cpu, one queue for every CPUDevice
+static vector<CPUQueue> g_cpuqueues;
+static bool g_cpuStopping = false;
+/// \brief guards the cpu queues and the counters below
+static ThreadMutex g_mutex = BLI_MUTEX_INITIALIZER;
+/// \brief signaled when work is added to the cpu queues
+static ThreadCondition g_workCondition;
+/// \brief signaled when a WorkPackage has been executed
+static ThreadCondition g_finishCondition;
+static unsigned int g_numScheduled = 0;
+static unsigned int g_numFinished = 0;
+/// \brief value of g_numFinished when waitForProgress returned last
+static unsigned int g_numWaited = 0;
 static ThreadQueue *g_gpuqueue;
 #ifdef COM_OPENCL_ENABLED
 static cl_context g_context;
@@ -72,15 +101,114 @@ static bool g_openclInitialized = false;
 #endif
 
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+static float distance_squared(const float a[2], const float b[2])
+{
+	const float dx = a[0] - b[0];
+	const float dy = a[1] - b[1];
+	return dx * dx + dy * dy;
+}
+
+/**
+ * Take the WorkPackage for a cpu thread: the package nearest to the last chunk of the thread
+ * from its own queue, or from the queue with the most work when its own queue is empty.
+ * \note g_mutex must be locked
+ */
+static WorkPackage *cpu_queue_pop(unsigned int threadIndex)
+{
+	CPUQueue &queue = g_cpuqueues[threadIndex];
+	CPUQueue *source = &queue;
+	if (source->packages.empty()) {
+		for (unsigned int index = 0; index < g_cpuqueues.size(); index++) {
+			if (g_cpuqueues[index].packages.size() > source->packages.size()) {
+				source = &g_cpuqueues[index];
+			}
+		}
+		if (source->packages.empty()) {
+			return NULL;
+		}
+	}
+
+	/* without a previous chunk the packages are taken in the order they were scheduled */
+	std::deque<QueuedWorkPackage>::iterator best = source->packages.begin();
+	if (queue.hasExecuted) {
+		float bestDistance = distance_squared(best->co, queue.co);
+		for (std::deque<QueuedWorkPackage>::iterator it = best + 1; it != source->packages.end(); ++it) {
+			const float distance = distance_squared(it->co, queue.co);
+			if (distance < bestDistance) {
+				best = it;
+				bestDistance = distance;
+			}
+		}
+	}
+
+	WorkPackage *package = best->package;
+	copy_v2_v2(queue.co, best->co);
+	queue.hasExecuted = true;
+	source->packages.erase(best);
+	return package;
+}
+
+/**
+ * Add a WorkPackage to the queue with the least work,
+ * of the queues with the same amount of work the one whose thread executed the nearest chunk last.
+ * \note g_mutex must be locked
+ */
+static void cpu_queue_push(WorkPackage *package)
+{
+	ExecutionGroup *group = package->getExecutionGroup();
+	QueuedWorkPackage queued;
+	rcti rect;
+	group->determineChunkRect(&rect, package->getChunkNumber());
+	queued.package = package;
+	queued.co[0] = BLI_rcti_cent_x_fl(&rect) / max_ii(group->getWidth(), 1);
+	queued.co[1] = BLI_rcti_cent_y_fl(&rect) / max_ii(group->getHeight(), 1);
+
+	CPUQueue *target = NULL;
+	float targetDistance = 0.0f;
+	for (unsigned int index = 0; index < g_cpuqueues.size(); index++) {
+		CPUQueue *queue = &g_cpuqueues[index];
+		const float distance = queue->hasExecuted ? distance_squared(queue->co, queued.co) : 0.0f;
+		if (target == NULL ||
+		    queue->packages.size() < target->packages.size() ||
+		    (queue->packages.size() == target->packages.size() && distance < targetDistance))
+		{
+			target = queue;
+			targetDistance = distance;
+		}
+	}
+	target->packages.push_back(queued);
+}
+
+/* \note g_mutex must be locked */
+static void package_finished()
+{
+	g_numFinished++;
+	BLI_condition_notify_all(&g_finishCondition);
+}
+
 void *WorkScheduler::thread_execute_cpu(void *data)
 {
 	CPUDevice *device = (CPUDevice *)data;
-	WorkPackage *work;
 	BLI_thread_local_set(g_thread_device, device);
-	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_cpuqueue))) {
-		device->execute(work);
-		delete work;
+
+	BLI_mutex_lock(&g_mutex);
+	while (true) {
+		WorkPackage *work = cpu_queue_pop(device->thread_id());
+		if (work) {
+			BLI_mutex_unlock(&g_mutex);
+			device->execute(work);
+			delete work;
+			BLI_mutex_lock(&g_mutex);
+			package_finished();
+		}
+		else if (g_cpuStopping) {
+			break;
+		}
+		else {
+			BLI_condition_wait(&g_workCondition, &g_mutex);
+		}
 	}
+	BLI_mutex_unlock(&g_mutex);
 
 	return NULL;
 }
@@ -93,6 +221,9 @@ void *WorkScheduler::thread_execute_gpu(void *data)
 	while ((work = (WorkPackage *)BLI_thread_queue_pop(g_gpuqueue))) {
 		device->execute(work);
 		delete work;
+		BLI_mutex_lock(&g_mutex);
+		package_finished();
+		BLI_mutex_unlock(&g_mutex);
 	}
 
 	return NULL;
@@ -109,16 +240,21 @@ void WorkScheduler::schedule(ExecutionGroup *group, int chunkNumber)
 	device.execute(package);
 	delete package;
 #elif COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	BLI_mutex_lock(&g_mutex);
+	g_numScheduled++;
 #ifdef COM_OPENCL_ENABLED
 	if (group->isOpenCL() && g_openclActive) {
 		BLI_thread_queue_push(g_gpuqueue, package);
 	}
 	else {
-		BLI_thread_queue_push(g_cpuqueue, package);
+		cpu_queue_push(package);
+		BLI_condition_notify_one(&g_workCondition);
 	}
 #else
-	BLI_thread_queue_push(g_cpuqueue, package);
+	cpu_queue_push(package);
+	BLI_condition_notify_one(&g_workCondition);
 #endif
+	BLI_mutex_unlock(&g_mutex);
 #endif
 }
 
@@ -126,7 +262,17 @@ void WorkScheduler::start(CompositorContext &context)
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
 	unsigned int index;
-	g_cpuqueue = BLI_thread_queue_init();
+	g_numScheduled = 0;
+	g_numFinished = 0;
+	g_numWaited = 0;
+	g_cpuStopping = false;
+	g_cpuqueues.clear();
+	g_cpuqueues.resize(g_cpudevices.size());
+	for (index = 0; index < g_cpuqueues.size(); index++) {
+		g_cpuqueues[index].hasExecuted = false;
+	}
+	BLI_condition_init(&g_workCondition);
+	BLI_condition_init(&g_finishCondition);
 	BLI_threadpool_init(&g_cputhreads, thread_execute_cpu, g_cpudevices.size());
 	for (index = 0; index < g_cpudevices.size(); index++) {
 		Device *device = g_cpudevices[index];
@@ -151,26 +297,36 @@ void WorkScheduler::start(CompositorContext &context)
 void WorkScheduler::finish()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-#ifdef COM_OPENCL_ENABLED
-	if (g_openclActive) {
-		BLI_thread_queue_wait_finish(g_gpuqueue);
-		BLI_thread_queue_wait_finish(g_cpuqueue);
-	}
-	else {
-		BLI_thread_queue_wait_finish(g_cpuqueue);
+	BLI_mutex_lock(&g_mutex);
+	while (g_numFinished != g_numScheduled) {
+		BLI_condition_wait(&g_finishCondition, &g_mutex);
 	}
-#else
-	BLI_thread_queue_wait_finish(cpuqueue);
+	g_numWaited = g_numFinished;
+	BLI_mutex_unlock(&g_mutex);
 #endif
+}
+void WorkScheduler::waitForProgress()
+{
+#if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
+	BLI_mutex_lock(&g_mutex);
+	while (g_numFinished == g_numWaited && g_numFinished != g_numScheduled) {
+		BLI_condition_wait(&g_finishCondition, &g_mutex);
+	}
+	g_numWaited = g_numFinished;
+	BLI_mutex_unlock(&g_mutex);
 #endif
 }
 void WorkScheduler::stop()
 {
 #if COM_CURRENT_THREADING_MODEL == COM_TM_QUEUE
-	BLI_thread_queue_nowait(g_cpuqueue);
+	BLI_mutex_lock(&g_mutex);
+	g_cpuStopping = true;
+	BLI_condition_notify_all(&g_workCondition);
+	BLI_mutex_unlock(&g_mutex);
 	BLI_threadpool_end(&g_cputhreads);
-	BLI_thread_queue_free(g_cpuqueue);
-	g_cpuqueue = NULL;
+	BLI_condition_end(&g_workCondition);
+	BLI_condition_end(&g_finishCondition);
+	g_cpuqueues.clear();
 #ifdef COM_OPENCL_ENABLED
 	if (g_openclActive) {
 		BLI_thread_queue_nowait(g_gpuqueue);
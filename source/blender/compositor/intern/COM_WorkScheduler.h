@@ -56,7 +56,7 @@ public:
 	 * An execution group schedules a chunk in the WorkScheduler
 	 * when ExecutionGroup.isOpenCL is set the work will be handled by a OpenCLDevice
 	 * otherwise the work is scheduled for an CPUDevice
-	 * \see ExecutionGroup.execute
+	 * \see ExecutionGroup.scheduleChunks
 	 * \param group: the execution group
 	 * \param chunkNumber: the number of the chunk in the group to be executed
 	 */
@@ -101,6 +101,12 @@ public:
 	 */
 	static void finish();
 
+	/**
+	 * \brief wait until a WorkPackage has been executed since the last call.
+	 * returns directly when all work is completed.
+	 */
+	static void waitForProgress();
+
 	/**
 	 * \brief Are there OpenCL capable GPU devices initialized?
 	 * the result of this method is stored in the CompositorContext
@@ -37,7 +37,8 @@ BlurNode::BlurNode(bNode *editorNode) : Node(editorNode)
 void BlurNode::convertToOperations(NodeConverter &converter, const CompositorContext &context) const
 {
 	bNode *editorNode = this->getbNode();
-	NodeBlurData *data = (NodeBlurData *)editorNode->storage;
+	NodeBlurData proxy_data = *(NodeBlurData *)editorNode->storage;
+	NodeBlurData *data = &proxy_data;
 	NodeInput *inputSizeSocket = this->getInputSocket(1);
 	bool connectedSizeSocket = inputSizeSocket->isLinked();
 
@@ -45,6 +46,13 @@ void BlurNode::convertToOperations(NodeConverter &converter, const CompositorCon
 	const bool extend_bounds = (editorNode->custom1 & CMP_NODEFLAG_BLUR_EXTEND_BOUNDS) != 0;
 
 	CompositorQuality quality = context.getQuality();
+
+	if (!data->relative && context.getProxyScale() != 1.0f) {
+		/* sizes are in full resolution pixels */
+		const float scale = context.getProxyScale();
+		data->sizex = (data->sizex > 0) ? max_ii((int)(data->sizex * scale + 0.5f), 1) : 0;
+		data->sizey = (data->sizey > 0) ? max_ii((int)(data->sizey * scale + 0.5f), 1) : 0;
+	}
 	NodeOperation *input_operation = NULL, *output_operation = NULL;
 
 	if (data->filtertype == R_FILTER_FAST_GAUSS) {
@@ -39,12 +39,17 @@ void TranslateNode::convertToOperations(NodeConverter &converter, const Composit
 	NodeOutput *outputSocket = this->getOutputSocket(0);
 
 	TranslateOperation *operation = new TranslateOperation();
+	const float scale = context.getProxyScale();
 	if (data->relative) {
 		const RenderData *rd = context.getRenderData();
 		float fx = rd->xsch * rd->size / 100.0f;
 		float fy = rd->ysch * rd->size / 100.0f;
 
-		operation->setFactorXY(fx, fy);
+		operation->setFactorXY(fx * scale, fy * scale);
+	}
+	else if (scale != 1.0f) {
+		/* offsets are in full resolution pixels */
+		operation->setFactorXY(scale, scale);
 	}
 
 	converter.addOperation(operation);
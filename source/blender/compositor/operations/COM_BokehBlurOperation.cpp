@@ -18,7 +18,9 @@
 
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
+#include "COM_FFTConvolution.h"
 #include "COM_OpenCLDevice.h"
+#include "MEM_guardedalloc.h"
 
 extern "C" {
 #  include "RE_pipeline.h"
@@ -41,6 +43,22 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 	this->m_inputBoundingBoxReader = NULL;
 
 	this->m_extend_bounds = false;
+	this->m_fftResult = NULL;
+}
+
+/* from this radius on the whole image is convolved in the frequency domain,
+ * the cost of the spatial path grows with the square of the radius */
+#define BOKEH_FFT_MIN_RADIUS 16
+
+/**
+ * The FFT path convolves the whole input, it is only used when the size is known so
+ * determineDependingAreaOfInterest requests the whole input for it.
+ */
+bool BokehBlurOperation::useFFT() const
+{
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	const int pixelSize = this->m_size * max_dim / 100.0f;
+	return this->m_sizeavailable && pixelSize >= BOKEH_FFT_MIN_RADIUS;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -49,7 +67,11 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
 	if (!this->m_sizeavailable) {
 		updateSize();
 	}
-	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	MemoryBuffer *buffer = (MemoryBuffer *)getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_fftResult == NULL && useFFT()) {
+		const float max_dim = max(this->getWidth(), this->getHeight());
+		calculateFFT(buffer, this->m_size * max_dim / 100.0f);
+	}
 	unlockMutex();
 	return buffer;
 }
@@ -69,9 +91,84 @@ void BokehBlurOperation::initExecution()
 	this->m_bokehMidX = width / 2.0f;
 	this->m_bokehMidY = height / 2.0f;
 	this->m_bokehDimension = dimension / 2.0f;
+	this->m_fftResult = NULL;
 	QualityStepHelper::initExecution(COM_QH_INCREASE);
 }
 
+/**
+ * Convolve the whole input with the bokeh image at once.
+ * The result matches the spatial path: the kernel has the same samples of the bokeh image,
+ * including the samples skipped by the quality step, and every pixel is divided by the sum
+ * of the kernel weights that fall inside the input.
+ */
+void BokehBlurOperation::calculateFFT(MemoryBuffer *inputBuffer, int pixelSize)
+{
+	const int size = 2 * pixelSize + 1;
+	const int width = inputBuffer->getWidth();
+	const int height = inputBuffer->getHeight();
+	const float m = this->m_bokehDimension / pixelSize;
+	const int step = getStep();
+	rcti kernelRect;
+	float bokeh[4];
+
+	/* the spatial path samples offsets -pixelSize .. pixelSize - 1 every step pixels, convolution
+	 * mirrors the kernel so the first row and column stay empty */
+	BLI_rcti_init(&kernelRect, 0, size, 0, size);
+	MemoryBuffer *kernel = new MemoryBuffer(COM_DT_COLOR, &kernelRect);
+	kernel->clear();
+	for (int y = 1; y < size; y++) {
+		if ((2 * pixelSize - y) % step != 0) {
+			continue;
+		}
+		for (int x = 1; x < size; x++) {
+			if ((2 * pixelSize - x) % step != 0) {
+				continue;
+			}
+			float u = this->m_bokehMidX + (x - pixelSize) * m;
+			float v = this->m_bokehMidY + (y - pixelSize) * m;
+			this->m_inputBokehProgram->readSampled(bokeh, u, v, COM_PS_NEAREST);
+			kernel->writePixel(x, y, bokeh);
+		}
+	}
+
+	this->m_fftResult = new MemoryBuffer(COM_DT_COLOR, inputBuffer->getRect());
+	FFTConvolution::convolve(this->m_fftResult->getBuffer(), inputBuffer, kernel, COM_NUM_CHANNELS_COLOR);
+
+	/* summed area table of the kernel, to get the weight of the part inside the input */
+	const int stride = size + 1;
+	double *table = (double *)MEM_callocN(sizeof(double) * stride * stride * COM_NUM_CHANNELS_COLOR, __func__);
+	float *kernelBuffer = kernel->getBuffer();
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			for (int ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+				double *sat = &table[ch * stride * stride];
+				sat[(y + 1) * stride + x + 1] = kernelBuffer[(y * size + x) * COM_NUM_CHANNELS_COLOR + ch] +
+				                                sat[y * stride + x + 1] + sat[(y + 1) * stride + x] - sat[y * stride + x];
+			}
+		}
+	}
+	delete kernel;
+
+	/* kernel element (kx, ky) reads input pixel (x + pixelSize - kx, y + pixelSize - ky) */
+	float *result = this->m_fftResult->getBuffer();
+	for (int y = 0; y < height; y++) {
+		const int ky0 = max_ii(y + pixelSize - height + 1, 0);
+		const int ky1 = min_ii(y + pixelSize + 1, size);
+		for (int x = 0; x < width; x++) {
+			const int kx0 = max_ii(x + pixelSize - width + 1, 0);
+			const int kx1 = min_ii(x + pixelSize + 1, size);
+			for (int ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+				const double *sat = &table[ch * stride * stride];
+				const double weight = sat[ky1 * stride + kx1] - sat[ky0 * stride + kx1] -
+				                      sat[ky1 * stride + kx0] + sat[ky0 * stride + kx0];
+				result[ch] = (weight > 0.0) ? (float)(result[ch] / weight) : 0.0f;
+			}
+			result += COM_NUM_CHANNELS_COLOR;
+		}
+	}
+	MEM_freeN(table);
+}
+
 void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
 	float color_accum[4];
@@ -79,7 +176,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 	float bokeh[4];
 
 	this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-	if (tempBoundingBox[0] > 0.0f) {
+	if (tempBoundingBox[0] > 0.0f && this->m_fftResult) {
+		this->m_fftResult->read(output, x, y);
+	}
+	else if (tempBoundingBox[0] > 0.0f) {
 		float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 		float *buffer = inputBuffer->getBuffer();
@@ -135,6 +235,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 void BokehBlurOperation::deinitExecution()
 {
 	deinitMutex();
+	if (this->m_fftResult) {
+		delete this->m_fftResult;
+		this->m_fftResult = NULL;
+	}
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
@@ -146,18 +250,19 @@ bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBuffe
 	rcti bokehInput;
 	const float max_dim = max(this->getWidth(), this->getHeight());
 
-	if (this->m_sizeavailable) {
+	if (!this->m_sizeavailable || useFFT()) {
+		/* the FFT path reads the whole input, which can't be ruled out before the size is known */
+		newInput.xmax = this->getWidth();
+		newInput.xmin = 0;
+		newInput.ymax = this->getHeight();
+		newInput.ymin = 0;
+	}
+	else {
 		newInput.xmax = input->xmax + (this->m_size * max_dim / 100.0f);
 		newInput.xmin = input->xmin - (this->m_size * max_dim / 100.0f);
 		newInput.ymax = input->ymax + (this->m_size * max_dim / 100.0f);
 		newInput.ymin = input->ymin - (this->m_size * max_dim / 100.0f);
 	}
-	else {
-		newInput.xmax = input->xmax + (10.0f * max_dim / 100.0f);
-		newInput.xmin = input->xmin - (10.0f * max_dim / 100.0f);
-		newInput.ymax = input->ymax + (10.0f * max_dim / 100.0f);
-		newInput.ymin = input->ymin - (10.0f * max_dim / 100.0f);
-	}
 
 	NodeOperation *operation = getInputOperation(1);
 	bokehInput.xmax = operation->getWidth();
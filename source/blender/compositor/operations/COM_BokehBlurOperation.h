@@ -34,6 +34,13 @@ private:
 	float m_bokehMidY;
 	float m_bokehDimension;
 	bool m_extend_bounds;
+
+	/**
+	 * \brief result of the whole image when it's convolved with FFTConvolution
+	 */
+	MemoryBuffer *m_fftResult;
+	bool useFFT() const;
+	void calculateFFT(MemoryBuffer *inputBuffer, int pixelSize);
 public:
 	BokehBlurOperation();
 
@@ -127,6 +127,39 @@ void CompositorOperation::deinitExecution()
 }
 
 
+void CompositorOperation::executeRegionArea(rcti *rect)
+{
+	const int width = this->getWidth();
+	MemoryBuffer image(COM_DT_COLOR, rect);
+	MemoryBuffer alpha(COM_DT_VALUE, rect);
+	MemoryBuffer depth(COM_DT_VALUE, rect);
+
+	this->getInputOperation(0)->renderArea(&image, rect);
+	if (this->m_useAlphaInput) {
+		this->getInputOperation(1)->renderArea(&alpha, rect);
+	}
+	this->getInputOperation(2)->renderArea(&depth, rect);
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const int offset = y * width + rect->xmin;
+		const int length = BLI_rcti_size_x(rect);
+		float *out = this->m_outputBuffer + offset * COM_NUM_CHANNELS_COLOR;
+
+		memcpy(out, image.getElem(rect->xmin, y), sizeof(float) * COM_NUM_CHANNELS_COLOR * length);
+		if (this->m_useAlphaInput) {
+			const float *in_alpha = alpha.getElem(rect->xmin, y);
+			for (int x = 0; x < length; x++) {
+				out[x * COM_NUM_CHANNELS_COLOR + 3] = in_alpha[x];
+			}
+		}
+		memcpy(this->m_depthBuffer + offset, depth.getElem(rect->xmin, y), sizeof(float) * length);
+
+		if (isBreaked()) {
+			break;
+		}
+	}
+}
+
 void CompositorOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 {
 	float color[8]; // 7 is enough
@@ -134,6 +167,10 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 	float *zbuffer = this->m_depthBuffer;
 
 	if (!buffer) return;
+	if (this->useAreaExecution()) {
+		this->executeRegionArea(rect);
+		return;
+	}
 	int x1 = rect->xmin;
 	int y1 = rect->ymin;
 	int x2 = rect->xmax;
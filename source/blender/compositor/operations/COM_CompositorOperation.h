@@ -79,6 +79,11 @@ private:
 	 * \brief View name, used for multiview
 	 */
 	const char *m_viewName;
+
+	/**
+	 * \brief executeRegion for area execution, calculates the inputs for the whole rect at once
+	 */
+	void executeRegionArea(rcti *rect);
 public:
 	CompositorOperation();
 	bool isActiveCompositorOutput() const { return this->m_active; }
@@ -17,6 +17,7 @@
  */
 
 #include "COM_ConvertOperation.h"
+#include "COM_ResultCache.h"
 
 extern "C" {
 #include "IMB_colormanagement.h"
@@ -44,6 +45,7 @@ ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperat
 {
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setAreaExecution(true);
 }
 
 void ConvertValueToColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -54,6 +56,18 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4], float x,
 	output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 1, out += 4) {
+			out[0] = out[1] = out[2] = in[0];
+			out[3] = 1.0f;
+		}
+	}
+}
+
 
 /* ******** Color to Value ******** */
 
@@ -61,6 +75,7 @@ ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperat
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setAreaExecution(true);
 }
 
 void ConvertColorToValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -70,6 +85,17 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4], float x,
 	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 4, out += 1) {
+			out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+		}
+	}
+}
+
 
 /* ******** Color to BW ******** */
 
@@ -77,6 +103,7 @@ ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setAreaExecution(true);
 }
 
 void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -86,6 +113,17 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, fl
 	output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 4, out += 1) {
+			out[0] = IMB_colormanagement_get_luminance(in);
+		}
+	}
+}
+
 
 /* ******** Color to Vector ******** */
 
@@ -93,6 +131,7 @@ ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOper
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_VECTOR);
+	this->setAreaExecution(true);
 }
 
 void ConvertColorToVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -101,6 +140,17 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4], float x
 	this->m_inputOperation->readSampled(color, x, y, sampler);
 	copy_v3_v3(output, color);}
 
+void ConvertColorToVectorOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 4, out += 3) {
+			copy_v3_v3(out, in);
+		}
+	}
+}
+
 
 /* ******** Value to Vector ******** */
 
@@ -108,6 +158,7 @@ ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOper
 {
 	this->addInputSocket(COM_DT_VALUE);
 	this->addOutputSocket(COM_DT_VECTOR);
+	this->setAreaExecution(true);
 }
 
 void ConvertValueToVectorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -117,6 +168,17 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4], float x
 	output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 1, out += 3) {
+			out[0] = out[1] = out[2] = in[0];
+		}
+	}
+}
+
 
 /* ******** Vector to Color ******** */
 
@@ -124,6 +186,7 @@ ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOper
 {
 	this->addInputSocket(COM_DT_VECTOR);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setAreaExecution(true);
 }
 
 void ConvertVectorToColorOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -132,6 +195,18 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4], float x
 	output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 3, out += 4) {
+			copy_v3_v3(out, in);
+			out[3] = 1.0f;
+		}
+	}
+}
+
 
 /* ******** Vector to Value ******** */
 
@@ -139,6 +214,7 @@ ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOper
 {
 	this->addInputSocket(COM_DT_VECTOR);
 	this->addOutputSocket(COM_DT_VALUE);
+	this->setAreaExecution(true);
 }
 
 void ConvertVectorToValueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -148,6 +224,17 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4], float x
 	output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 3, out += 1) {
+			out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+		}
+	}
+}
+
 
 /* ******** RGB to YCC ******** */
 
@@ -302,6 +389,7 @@ ConvertPremulToStraightOperation::ConvertPremulToStraightOperation() : ConvertBa
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setAreaExecution(true);
 }
 
 void ConvertPremulToStraightOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -323,6 +411,24 @@ void ConvertPremulToStraightOperation::executePixelSampled(float output[4], floa
 	output[3] = alpha;
 }
 
+void ConvertPremulToStraightOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 4, out += 4) {
+			const float alpha = in[3];
+			if (fabsf(alpha) < 1e-5f) {
+				zero_v3(out);
+			}
+			else {
+				mul_v3_v3fl(out, in, 1.0f / alpha);
+			}
+			out[3] = alpha;
+		}
+	}
+}
+
 
 /* ******** Straight to Premul ******** */
 
@@ -330,6 +436,7 @@ ConvertStraightToPremulOperation::ConvertStraightToPremulOperation() : ConvertBa
 {
 	this->addInputSocket(COM_DT_COLOR);
 	this->addOutputSocket(COM_DT_COLOR);
+	this->setAreaExecution(true);
 }
 
 void ConvertStraightToPremulOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -346,6 +453,18 @@ void ConvertStraightToPremulOperation::executePixelSampled(float output[4], floa
 	output[3] = alpha;
 }
 
+void ConvertStraightToPremulOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 4, out += 4) {
+			mul_v3_v3fl(out, in, in[3]);
+			out[3] = in[3];
+		}
+	}
+}
+
 
 /* ******** Separate Channels ******** */
 
@@ -373,6 +492,11 @@ void SeparateChannelOperation::executePixelSampled(float output[4], float x, flo
 	output[0] = input[this->m_channel];
 }
 
+void SeparateChannelOperation::hashParams(uint64_t &key) const
+{
+	ResultCache::hash(key, &this->m_channel, sizeof(this->m_channel));
+}
+
 
 /* ******** Combine Channels ******** */
 
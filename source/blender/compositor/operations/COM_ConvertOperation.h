@@ -39,6 +39,7 @@ public:
 	ConvertValueToColorOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -47,6 +48,7 @@ public:
 	ConvertColorToValueOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -55,6 +57,7 @@ public:
 	ConvertColorToBWOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -63,6 +66,7 @@ public:
 	ConvertColorToVectorOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -71,6 +75,7 @@ public:
 	ConvertValueToVectorOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -79,6 +84,7 @@ public:
 	ConvertVectorToColorOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -87,6 +93,7 @@ public:
 	ConvertVectorToValueOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -155,6 +162,7 @@ public:
 	ConvertPremulToStraightOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -163,6 +171,7 @@ public:
 	ConvertStraightToPremulOperation();
 
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
 };
 
 
@@ -178,6 +187,7 @@ public:
 	void deinitExecution();
 
 	void setChannel(int channel) { this->m_channel = channel; }
+	void hashParams(uint64_t &key) const;
 };
 
 
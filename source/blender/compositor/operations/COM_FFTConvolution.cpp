@@ -0,0 +1,400 @@
+/*
+ * Copyright 2019, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include "COM_FFTConvolution.h"
+#include "COM_MemoryBuffer.h"
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#  include "BLI_math.h"
+#  include "BLI_task.h"
+#  include "BLI_utildefines.h"
+}
+
+/*
+ *  2D Fast Hartley Transform, used for convolution
+ */
+
+typedef float fREAL;
+
+// returns next highest power of 2 of x, as well it's log2 in L2
+static unsigned int nextPow2(unsigned int x, unsigned int *L2)
+{
+	unsigned int pw, x_notpow2 = x & (x - 1);
+	*L2 = 0;
+	while (x >>= 1) ++(*L2);
+	pw = 1 << (*L2);
+	if (x_notpow2) { (*L2)++;  pw <<= 1; }
+	return pw;
+}
+
+//------------------------------------------------------------------------------
+
+// from FXT library by Joerg Arndt, faster in order bitreversal
+// use: r = revbin_upd(r, h) where h = N>>1
+static unsigned int revbin_upd(unsigned int r, unsigned int h)
+{
+	while (!((r ^= h) & h)) h >>= 1;
+	return r;
+}
+//------------------------------------------------------------------------------
+static void FHT(fREAL *data, unsigned int M, unsigned int inverse)
+{
+	double tt, fc, dc, fs, ds, a = M_PI;
+	fREAL t1, t2;
+	int n2, bd, bl, istep, k, len = 1 << M, n = 1;
+
+	int i, j = 0;
+	unsigned int Nh = len >> 1;
+	for (i = 1; i < (len - 1); ++i) {
+		j = revbin_upd(j, Nh);
+		if (j > i) {
+			t1 = data[i];
+			data[i] = data[j];
+			data[j] = t1;
+		}
+	}
+
+	do {
+		fREAL *data_n = &data[n];
+
+		istep = n << 1;
+		for (k = 0; k < len; k += istep) {
+			t1 = data_n[k];
+			data_n[k] = data[k] - t1;
+			data[k] += t1;
+		}
+
+		n2 = n >> 1;
+		if (n > 2) {
+			fc = dc = cos(a);
+			fs = ds = sqrt(1.0 - fc * fc); //sin(a);
+			bd = n - 2;
+			for (bl = 1; bl < n2; bl++) {
+				fREAL *data_nbd = &data_n[bd];
+				fREAL *data_bd = &data[bd];
+				for (k = bl; k < len; k += istep) {
+					t1 = fc * (double)data_n[k] + fs * (double)data_nbd[k];
+					t2 = fs * (double)data_n[k] - fc * (double)data_nbd[k];
+					data_n[k] = data[k] - t1;
+					data_nbd[k] = data_bd[k] - t2;
+					data[k] += t1;
+					data_bd[k] += t2;
+				}
+				tt = fc * dc - fs * ds;
+				fs = fs * dc + fc * ds;
+				fc = tt;
+				bd -= 2;
+			}
+		}
+
+		if (n > 1) {
+			for (k = n2; k < len; k += istep) {
+				t1 = data_n[k];
+				data_n[k] = data[k] - t1;
+				data[k] += t1;
+			}
+		}
+
+		n = istep;
+		a *= 0.5;
+	} while (n < len);
+
+	if (inverse) {
+		fREAL sc = (fREAL)1 / (fREAL)len;
+		for (k = 0; k < len; ++k)
+			data[k] *= sc;
+	}
+}
+//------------------------------------------------------------------------------
+/* 2D Fast Hartley Transform, Mx/My -> log2 of width/height,
+ * nzp -> the row where zero pad data starts,
+ * inverse -> see above */
+static void FHT2D(fREAL *data, unsigned int Mx, unsigned int My,
+                  unsigned int nzp, unsigned int inverse)
+{
+	unsigned int i, j, Nx, Ny, maxy;
+
+	Nx = 1 << Mx;
+	Ny = 1 << My;
+
+	// rows (forward transform skips 0 pad data)
+	maxy = inverse ? Ny : nzp;
+	for (j = 0; j < maxy; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// transpose data
+	if (Nx == Ny) {  // square
+		for (j = 0; j < Ny; ++j)
+			for (i = j + 1; i < Nx; ++i) {
+				unsigned int op = i + (j << Mx), np = j + (i << My);
+				SWAP(fREAL, data[op], data[np]);
+			}
+	}
+	else {  // rectangular
+		unsigned int k, Nym = Ny - 1, stm = 1 << (Mx + My);
+		for (i = 0; stm > 0; i++) {
+#define PRED(k) (((k & Nym) << Mx) + (k >> My))
+			for (j = PRED(i); j > i; j = PRED(j)) ;
+			if (j < i) continue;
+			for (k = i, j = PRED(i); j != i; k = j, j = PRED(j), stm--) {
+				SWAP(fREAL, data[j], data[k]);
+			}
+#undef PRED
+			stm--;
+		}
+	}
+
+	SWAP(unsigned int, Nx, Ny);
+	SWAP(unsigned int, Mx, My);
+
+	// now columns == transposed rows
+	for (j = 0; j < Ny; ++j)
+		FHT(&data[Nx * j], Mx, inverse);
+
+	// finalize
+	for (j = 0; j <= (Ny >> 1); j++) {
+		unsigned int jm = (Ny - j) & (Ny - 1);
+		unsigned int ji = j << Mx;
+		unsigned int jmi = jm << Mx;
+		for (i = 0; i <= (Nx >> 1); i++) {
+			unsigned int im = (Nx - i) & (Nx - 1);
+			fREAL A = data[ji + i];
+			fREAL B = data[jmi + i];
+			fREAL C = data[ji + im];
+			fREAL D = data[jmi + im];
+			fREAL E = (fREAL)0.5 * ((A + D) - (B + C));
+			data[ji + i] = A - E;
+			data[jmi + i] = B + E;
+			data[ji + im] = C + E;
+			data[jmi + im] = D - E;
+		}
+	}
+
+}
+
+//------------------------------------------------------------------------------
+
+/* 2D convolution calc, d1 *= d2, M/N - > log2 of width/height */
+static void fht_convolve(fREAL *d1, fREAL *d2, unsigned int M, unsigned int N)
+{
+	fREAL a, b;
+	unsigned int i, j, k, L, mj, mL;
+	unsigned int m = 1 << M, n = 1 << N;
+	unsigned int m2 = 1 << (M - 1), n2 = 1 << (N - 1);
+	unsigned int mn2 = m << (N - 1);
+
+	d1[0] *= d2[0];
+	d1[mn2] *= d2[mn2];
+	d1[m2] *= d2[m2];
+	d1[m2 + mn2] *= d2[m2 + mn2];
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		a = d1[i] * d2[i] - d1[k] * d2[k];
+		b = d1[k] * d2[i] + d1[i] * d2[k];
+		d1[i] = (b + a) * (fREAL)0.5;
+		d1[k] = (b - a) * (fREAL)0.5;
+		a = d1[i + mn2] * d2[i + mn2] - d1[k + mn2] * d2[k + mn2];
+		b = d1[k + mn2] * d2[i + mn2] + d1[i + mn2] * d2[k + mn2];
+		d1[i + mn2] = (b + a) * (fREAL)0.5;
+		d1[k + mn2] = (b - a) * (fREAL)0.5;
+	}
+	for (j = 1; j < n2; j++) {
+		L = n - j;
+		mj = j << M;
+		mL = L << M;
+		a = d1[mj] * d2[mj] - d1[mL] * d2[mL];
+		b = d1[mL] * d2[mj] + d1[mj] * d2[mL];
+		d1[mj] = (b + a) * (fREAL)0.5;
+		d1[mL] = (b - a) * (fREAL)0.5;
+		a = d1[m2 + mj] * d2[m2 + mj] - d1[m2 + mL] * d2[m2 + mL];
+		b = d1[m2 + mL] * d2[m2 + mj] + d1[m2 + mj] * d2[m2 + mL];
+		d1[m2 + mj] = (b + a) * (fREAL)0.5;
+		d1[m2 + mL] = (b - a) * (fREAL)0.5;
+	}
+	for (i = 1; i < m2; i++) {
+		k = m - i;
+		for (j = 1; j < n2; j++) {
+			L = n - j;
+			mj = j << M;
+			mL = L << M;
+			a = d1[i + mj] * d2[i + mj] - d1[k + mL] * d2[k + mL];
+			b = d1[k + mL] * d2[i + mj] + d1[i + mj] * d2[k + mL];
+			d1[i + mj] = (b + a) * (fREAL)0.5;
+			d1[k + mL] = (b - a) * (fREAL)0.5;
+			a = d1[i + mL] * d2[i + mL] - d1[k + mj] * d2[k + mj];
+			b = d1[k + mj] * d2[i + mL] + d1[i + mL] * d2[k + mj];
+			d1[i + mL] = (b + a) * (fREAL)0.5;
+			d1[k + mj] = (b - a) * (fREAL)0.5;
+		}
+	}
+}
+
+
+/* largest transform size that is chosen to make the blocks bigger,
+ * the data of one channel takes 2 * size^2 floats */
+#define MAX_TRANSFORM_SIZE 2048
+
+/**
+ * Choose the transform size for one dimension.
+ * The smallest size fits the kernel and one pixel of the image, bigger sizes fit more image
+ * pixels per block. Pick the size with the lowest transform cost per image pixel.
+ */
+static unsigned int transform_size(unsigned int kernelSize, unsigned int imageSize, unsigned int *L2)
+{
+	unsigned int size = nextPow2(max_ii(2 * kernelSize - 1, 4), L2);
+	float cost = (float)(size * (*L2)) / (float)(size + 1 - kernelSize);
+
+	for (unsigned int next = size * 2, log2 = *L2 + 1;
+	     next <= MAX_TRANSFORM_SIZE && next / 2 < imageSize + kernelSize - 1;
+	     next *= 2, log2++)
+	{
+		const float next_cost = (float)(next * log2) / (float)(next + 1 - kernelSize);
+		if (next_cost < cost) {
+			size = next;
+			cost = next_cost;
+			*L2 = log2;
+		}
+	}
+	return size;
+}
+
+typedef struct ConvolveData {
+	float *dst;
+	const float *image;
+	const float *kernel;
+	int imageWidth, imageHeight;
+	int kernelWidth, kernelHeight;
+	unsigned int w2, h2, log2_w, log2_h;
+} ConvolveData;
+
+/* convolve one channel, channels use separate transform buffers and output floats
+ * so they can run in parallel */
+static void convolve_channel(void *__restrict userdata,
+                             const int ch,
+                             const ParallelRangeTLS *__restrict /*tls*/)
+{
+	const ConvolveData *cd = (const ConvolveData *)userdata;
+	const unsigned int w2 = cd->w2, h2 = cd->h2;
+	const int hw = cd->kernelWidth >> 1;
+	const int hh = cd->kernelHeight >> 1;
+	const int xbsz = (w2 + 1) - cd->kernelWidth;
+	const int ybsz = (h2 + 1) - cd->kernelHeight;
+	const int nxb = (cd->imageWidth + xbsz - 1) / xbsz;
+	const int nyb = (cd->imageHeight + ybsz - 1) / ybsz;
+	fREAL *data1, *data2, *fp;
+	int x, y;
+
+	data1 = (fREAL *)MEM_callocN(w2 * h2 * sizeof(fREAL), "convolve_fast FHT data1");
+	data2 = (fREAL *)MEM_mallocN(w2 * h2 * sizeof(fREAL), "convolve_fast FHT data2");
+
+	/* kernel, only transformed once and re-used for every block */
+	for (y = 0; y < cd->kernelHeight; y++) {
+		const float *colp = &cd->kernel[y * cd->kernelWidth * COM_NUM_CHANNELS_COLOR + ch];
+		fp = &data1[y * w2];
+		for (x = 0; x < cd->kernelWidth; x++) {
+			fp[x] = colp[x * COM_NUM_CHANNELS_COLOR];
+		}
+	}
+	FHT2D(data1, cd->log2_w, cd->log2_h, cd->kernelHeight, 0);
+
+	/* block add-overlap */
+	for (int ybl = 0; ybl < nyb; ybl++) {
+		for (int xbl = 0; xbl < nxb; xbl++) {
+			const int xofs = xbl * xbsz, yofs = ybl * ybsz;
+			const int xlen = min_ii(xbsz, cd->imageWidth - xofs);
+			const int ylen = min_ii(ybsz, cd->imageHeight - yofs);
+
+			memset(data2, 0, w2 * h2 * sizeof(fREAL));
+			for (y = 0; y < ylen; y++) {
+				const float *colp = &cd->image[((yofs + y) * cd->imageWidth + xofs) * COM_NUM_CHANNELS_COLOR + ch];
+				fp = &data2[y * w2];
+				for (x = 0; x < xlen; x++) {
+					fp[x] = colp[x * COM_NUM_CHANNELS_COLOR];
+				}
+			}
+
+			/* forward FHT, rows after ylen are zero */
+			FHT2D(data2, cd->log2_w, cd->log2_h, ylen, 0);
+
+			/* FHT2D transposed data, row/col now swapped
+			 * convolve & inverse FHT */
+			fht_convolve(data2, data1, cd->log2_h, cd->log2_w);
+			FHT2D(data2, cd->log2_h, cd->log2_w, 0, 1);
+			/* data again transposed, so in order again */
+
+			/* overlap-add result */
+			for (y = 0; y < (int)h2; y++) {
+				const int yy = yofs + y - hh;
+				if ((yy < 0) || (yy >= cd->imageHeight)) continue;
+				fp = &data2[y * w2];
+				float *colp = &cd->dst[yy * cd->imageWidth * COM_NUM_CHANNELS_COLOR + ch];
+				for (x = 0; x < (int)w2; x++) {
+					const int xx = xofs + x - hw;
+					if ((xx < 0) || (xx >= cd->imageWidth)) continue;
+					colp[xx * COM_NUM_CHANNELS_COLOR] += fp[x];
+				}
+			}
+		}
+	}
+
+	MEM_freeN(data2);
+	MEM_freeN(data1);
+}
+
+void FFTConvolution::convolve(float *dst, MemoryBuffer *image, MemoryBuffer *kernel, int numChannels)
+{
+	ConvolveData cd;
+	cd.dst = dst;
+	cd.image = image->getBuffer();
+	cd.kernel = kernel->getBuffer();
+	cd.imageWidth = image->getWidth();
+	cd.imageHeight = image->getHeight();
+	cd.kernelWidth = kernel->getWidth();
+	cd.kernelHeight = kernel->getHeight();
+	cd.w2 = transform_size(cd.kernelWidth, cd.imageWidth, &cd.log2_w);
+	cd.h2 = transform_size(cd.kernelHeight, cd.imageHeight, &cd.log2_h);
+
+	memset(dst, 0, sizeof(float) * cd.imageWidth * cd.imageHeight * COM_NUM_CHANNELS_COLOR);
+
+	ParallelRangeSettings settings;
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.use_threading = (numChannels > 1);
+	BLI_task_parallel_range(0, numChannels, &cd, convolve_channel, &settings);
+}
+
+void FFTConvolution::normalize(MemoryBuffer *kernel, int numChannels)
+{
+	const int size = kernel->getWidth() * kernel->getHeight();
+	float *buffer = kernel->getBuffer();
+
+	for (int ch = 0; ch < numChannels; ch++) {
+		float sum = 0.0f;
+		for (int i = 0; i < size; i++) {
+			sum += buffer[i * COM_NUM_CHANNELS_COLOR + ch];
+		}
+		if (sum != 0.0f) {
+			const float fac = 1.0f / sum;
+			for (int i = 0; i < size; i++) {
+				buffer[i * COM_NUM_CHANNELS_COLOR + ch] *= fac;
+			}
+		}
+	}
+}
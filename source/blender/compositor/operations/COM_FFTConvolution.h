@@ -0,0 +1,49 @@
+/*
+ * Copyright 2019, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __COM_FFTCONVOLUTION_H__
+#define __COM_FFTCONVOLUTION_H__
+
+class MemoryBuffer;
+
+/**
+ * \brief convolution of a color image with a color kernel using the 2D Fast Hartley Transform
+ *
+ * The image is split in blocks that are transformed separately and added together
+ * (overlap-add), so the transform size depends on the kernel size and not on the image size.
+ * The kernel is centered at (width / 2, height / 2) and can have any size.
+ */
+class FFTConvolution {
+public:
+	/**
+	 * \brief convolve the first numChannels channels of image with kernel
+	 * \param dst: output with the size of image in COM_NUM_CHANNELS_COLOR layout,
+	 * channels that aren't convolved are set to zero
+	 * \param image: COM_DT_COLOR buffer to convolve
+	 * \param kernel: COM_DT_COLOR buffer with the kernel
+	 * \param numChannels: number of channels to convolve (1-4)
+	 */
+	static void convolve(float *dst, MemoryBuffer *image, MemoryBuffer *kernel, int numChannels);
+
+	/**
+	 * \brief scale the first numChannels channels of kernel so every channel sums to one
+	 */
+	static void normalize(MemoryBuffer *kernel, int numChannels);
+};
+
+#endif
@@ -26,6 +26,7 @@ GammaOperation::GammaOperation() : NodeOperation()
 	this->addOutputSocket(COM_DT_COLOR);
 	this->m_inputProgram = NULL;
 	this->m_inputGammaProgram = NULL;
+	this->setAreaExecution(true);
 }
 void GammaOperation::initExecution()
 {
@@ -49,6 +50,22 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
 	output[3] = inputValue[3];
 }
 
+void GammaOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *in = inputs[0]->getElem(area->xmin, y);
+		const float *gamma = inputs[1]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, in += 4, gamma += 1, out += 4) {
+			/* check for negative to avoid nan's */
+			out[0] = in[0] > 0.0f ? powf(in[0], gamma[0]) : in[0];
+			out[1] = in[1] > 0.0f ? powf(in[1], gamma[0]) : in[1];
+			out[2] = in[2] > 0.0f ? powf(in[2], gamma[0]) : in[2];
+			out[3] = in[3];
+		}
+	}
+}
+
 void GammaOperation::deinitExecution()
 {
 	this->m_inputProgram = NULL;
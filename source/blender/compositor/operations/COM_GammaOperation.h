@@ -37,6 +37,11 @@ public:
 	 */
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+	/**
+	 * calculate an area row by row
+	 */
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
 	/**
 	 * Initialize the execution
 	 */
@@ -32,6 +32,7 @@ GaussianXBlurOperation::GaussianXBlurOperation() : BlurBaseOperation(COM_DT_COLO
 	this->m_gausstab_sse = NULL;
 #endif
 	this->m_filtersize = 0;
+	this->setAreaExecution(true);
 }
 
 void *GaussianXBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -119,6 +120,60 @@ void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *d
 	mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianXBlurOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer ** /*inputs*/)
+{
+	MemoryBuffer *inputBuffer = (MemoryBuffer *)this->initializeTileData(area);
+	const rcti &rect = *inputBuffer->getRect();
+	const int bufferwidth = inputBuffer->getWidth();
+	const int step = getStep();
+	const int offsetadd = getOffsetAdd();
+
+	/* all taps of the kernel are used when the window lies inside the input,
+	 * summed in the same order as executePixel */
+	float full_multiplier_accum = 0.0f;
+	for (int index = 0; index <= 2 * this->m_filtersize; index += step) {
+		full_multiplier_accum += this->m_gausstab[index];
+	}
+	const float full_multiplier = 1.0f / full_multiplier_accum;
+
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const int ny = max_ii(y, rect.ymin);
+		const float *row = inputBuffer->getBuffer() + (ny - rect.ymin) * bufferwidth * COM_NUM_CHANNELS_COLOR;
+		float *out = output->getElem(area->xmin, y);
+
+		for (int x = area->xmin; x < area->xmax; x++, out += COM_NUM_CHANNELS_COLOR) {
+			const int xmin = max_ii(x - this->m_filtersize,     rect.xmin);
+			const int xmax = min_ii(x + this->m_filtersize + 1, rect.xmax);
+			const bool clipped = (xmin != x - this->m_filtersize || xmax != x + this->m_filtersize + 1);
+			const float *in = row + (xmin - rect.xmin) * COM_NUM_CHANNELS_COLOR;
+			float multiplier_accum = 0.0f;
+
+#ifdef __SSE2__
+			__m128 accum_r = _mm_setzero_ps();
+			for (int nx = xmin, index = (xmin - x) + this->m_filtersize; nx < xmax; nx += step, index += step) {
+				accum_r = _mm_add_ps(accum_r, _mm_mul_ps(_mm_load_ps(in), this->m_gausstab_sse[index]));
+				if (clipped) {
+					multiplier_accum += this->m_gausstab[index];
+				}
+				in += offsetadd;
+			}
+			const float multiplier = clipped ? 1.0f / multiplier_accum : full_multiplier;
+			_mm_storeu_ps(out, _mm_mul_ps(accum_r, _mm_set1_ps(multiplier)));
+#else
+			float color_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			for (int nx = xmin, index = (xmin - x) + this->m_filtersize; nx < xmax; nx += step, index += step) {
+				madd_v4_v4fl(color_accum, in, this->m_gausstab[index]);
+				if (clipped) {
+					multiplier_accum += this->m_gausstab[index];
+				}
+				in += offsetadd;
+			}
+			mul_v4_v4fl(out, color_accum, clipped ? 1.0f / multiplier_accum : full_multiplier);
+#endif
+		}
+	}
+}
+
 void GaussianXBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer, cl_mem clOutputBuffer,
                                            MemoryBuffer **inputMemoryBuffers, list<cl_mem> *clMemToCleanUp,
@@ -37,6 +37,11 @@ public:
 	 */
 	void executePixel(float output[4], int x, int y, void *data);
 
+	/**
+	 * \brief blur a whole area without going through read for every pixel
+	 */
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
 	void executeOpenCL(OpenCLDevice *device,
 	                   MemoryBuffer *outputMemoryBuffer, cl_mem clOutputBuffer,
 	                   MemoryBuffer **inputMemoryBuffers, list<cl_mem> *clMemToCleanUp,
@@ -32,6 +32,7 @@ GaussianYBlurOperation::GaussianYBlurOperation() : BlurBaseOperation(COM_DT_COLO
 	this->m_gausstab_sse = NULL;
 #endif
 	this->m_filtersize = 0;
+	this->setAreaExecution(true);
 }
 
 void *GaussianYBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -121,6 +122,54 @@ void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *d
 	mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianYBlurOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer ** /*inputs*/)
+{
+	MemoryBuffer *inputBuffer = (MemoryBuffer *)this->initializeTileData(area);
+	const rcti &rect = *inputBuffer->getRect();
+	const int bufferwidth = inputBuffer->getWidth();
+	const int step = getStep();
+	const int width = BLI_rcti_size_x(area);
+
+	/* columns of the area clamped to the input like executePixel does */
+	const int xmin = min_ii(max_ii(area->xmin, rect.xmin), rect.xmax - 1);
+	const int xoffset = xmin - area->xmin;
+
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const int ymin = max_ii(y - this->m_filtersize,     rect.ymin);
+		const int ymax = min_ii(y + this->m_filtersize + 1, rect.ymax);
+		float *out = output->getElem(area->xmin, y);
+		float multiplier_accum = 0.0f;
+
+		memset(out, 0, sizeof(float) * COM_NUM_CHANNELS_COLOR * width);
+
+		/* accumulate whole input rows so the inner loop walks contiguous memory */
+		for (int ny = ymin; ny < ymax; ny += step) {
+			const int index = (ny - y) + this->m_filtersize;
+			const float *row = inputBuffer->getBuffer() +
+			                   ((ny - rect.ymin) * bufferwidth + (xmin - rect.xmin)) * COM_NUM_CHANNELS_COLOR;
+			const float *in = row;
+			float *accum = out;
+			multiplier_accum += this->m_gausstab[index];
+
+			for (int x = 0; x < width; x++, accum += COM_NUM_CHANNELS_COLOR) {
+#ifdef __SSE2__
+				_mm_storeu_ps(accum, _mm_add_ps(_mm_loadu_ps(accum), _mm_mul_ps(_mm_load_ps(in), this->m_gausstab_sse[index])));
+#else
+				madd_v4_v4fl(accum, in, this->m_gausstab[index]);
+#endif
+				if (x >= xoffset && x + area->xmin < rect.xmax - 1) {
+					in += COM_NUM_CHANNELS_COLOR;
+				}
+			}
+		}
+
+		const float multiplier = 1.0f / multiplier_accum;
+		for (int x = 0; x < width * COM_NUM_CHANNELS_COLOR; x++) {
+			out[x] *= multiplier;
+		}
+	}
+}
+
 void GaussianYBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer, cl_mem clOutputBuffer,
                                            MemoryBuffer **inputMemoryBuffers, list<cl_mem> *clMemToCleanUp,
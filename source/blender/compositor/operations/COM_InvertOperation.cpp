@@ -28,6 +28,7 @@ InvertOperation::InvertOperation() : NodeOperation()
 	this->m_color = true;
 	this->m_alpha = false;
 	setResolutionInputSocketIndex(1);
+	this->setAreaExecution(true);
 }
 void InvertOperation::initExecution()
 {
@@ -61,6 +62,32 @@ void InvertOperation::executePixelSampled(float output[4], float x, float y, Pix
 
 }
 
+void InvertOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	for (int y = area->ymin; y < area->ymax; y++) {
+		const float *value = inputs[0]->getElem(area->xmin, y);
+		const float *in = inputs[1]->getElem(area->xmin, y);
+		float *out = output->getElem(area->xmin, y);
+		for (int x = area->xmin; x < area->xmax; x++, value += 1, in += 4, out += 4) {
+			const float invertedValue = 1.0f - value[0];
+
+			if (this->m_color) {
+				out[0] = (1.0f - in[0]) * value[0] + in[0] * invertedValue;
+				out[1] = (1.0f - in[1]) * value[0] + in[1] * invertedValue;
+				out[2] = (1.0f - in[2]) * value[0] + in[2] * invertedValue;
+			}
+			else {
+				copy_v3_v3(out, in);
+			}
+
+			if (this->m_alpha)
+				out[3] = (1.0f - in[3]) * value[0] + in[3] * invertedValue;
+			else
+				out[3] = in[3];
+		}
+	}
+}
+
 void InvertOperation::deinitExecution()
 {
 	this->m_inputValueProgram = NULL;
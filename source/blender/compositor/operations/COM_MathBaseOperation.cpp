@@ -68,6 +68,17 @@ void MathBaseOperation::clampIfNeeded(float *color)
 	}
 }
 
+void MathBaseOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	const int length = BLI_rcti_size_x(area);
+	for (int y = area->ymin; y < area->ymax; y++) {
+		this->executeRow(output->getElem(area->xmin, y),
+		                 inputs[0]->getElem(area->xmin, y),
+		                 inputs[1]->getElem(area->xmin, y),
+		                 length);
+	}
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -81,6 +92,14 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
 	clampIfNeeded(output);
 }
 
+void MathAddOperation::executeRow(float *output, const float *value1, const float *value2, int length)
+{
+	for (int i = 0; i < length; i++) {
+		output[i] = value1[i] + value2[i];
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -94,6 +113,14 @@ void MathSubtractOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeRow(float *output, const float *value1, const float *value2, int length)
+{
+	for (int i = 0; i < length; i++) {
+		output[i] = value1[i] - value2[i];
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -107,6 +134,14 @@ void MathMultiplyOperation::executePixelSampled(float output[4], float x, float
 	clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeRow(float *output, const float *value1, const float *value2, int length)
+{
+	for (int i = 0; i < length; i++) {
+		output[i] = value1[i] * value2[i];
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathDivideOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -123,6 +158,15 @@ void MathDivideOperation::executePixelSampled(float output[4], float x, float y,
 	clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeRow(float *output, const float *value1, const float *value2, int length)
+{
+	for (int i = 0; i < length; i++) {
+		/* We don't want to divide by zero. */
+		output[i] = (value2[i] == 0.0f) ? 0.0f : value1[i] / value2[i];
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathSineOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -261,6 +305,14 @@ void MathMinimumOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeRow(float *output, const float *value1, const float *value2, int length)
+{
+	for (int i = 0; i < length; i++) {
+		output[i] = min(value1[i], value2[i]);
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
@@ -274,6 +326,14 @@ void MathMaximumOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeRow(float *output, const float *value1, const float *value2, int length)
+{
+	for (int i = 0; i < length; i++) {
+		output[i] = max(value1[i], value2[i]);
+		clampIfNeeded(&output[i]);
+	}
+}
+
 void MathRoundOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
 	float inputValue1[4];
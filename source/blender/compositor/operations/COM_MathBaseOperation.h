@@ -63,28 +63,42 @@ public:
 	 */
 	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
+	/**
+	 * calculate an area row by row using executeRow
+	 */
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
+	/**
+	 * calculate a row of values, only called for operations that enable area execution
+	 */
+	virtual void executeRow(float * /*output*/, const float * /*value1*/, const float * /*value2*/, int /*length*/) {}
+
 	void setUseClamp(bool value) { this->m_useClamp = value; }
 };
 
 class MathAddOperation : public MathBaseOperation {
 public:
-	MathAddOperation() : MathBaseOperation() {}
+	MathAddOperation() : MathBaseOperation() { this->setAreaExecution(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value1, const float *value2, int length);
 };
 class MathSubtractOperation : public MathBaseOperation {
 public:
-	MathSubtractOperation() : MathBaseOperation() {}
+	MathSubtractOperation() : MathBaseOperation() { this->setAreaExecution(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value1, const float *value2, int length);
 };
 class MathMultiplyOperation : public MathBaseOperation {
 public:
-	MathMultiplyOperation() : MathBaseOperation() {}
+	MathMultiplyOperation() : MathBaseOperation() { this->setAreaExecution(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value1, const float *value2, int length);
 };
 class MathDivideOperation : public MathBaseOperation {
 public:
-	MathDivideOperation() : MathBaseOperation() {}
+	MathDivideOperation() : MathBaseOperation() { this->setAreaExecution(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value1, const float *value2, int length);
 };
 class MathSineOperation : public MathBaseOperation {
 public:
@@ -129,13 +143,15 @@ public:
 };
 class MathMinimumOperation : public MathBaseOperation {
 public:
-	MathMinimumOperation() : MathBaseOperation() {}
+	MathMinimumOperation() : MathBaseOperation() { this->setAreaExecution(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value1, const float *value2, int length);
 };
 class MathMaximumOperation : public MathBaseOperation {
 public:
-	MathMaximumOperation() : MathBaseOperation() {}
+	MathMaximumOperation() : MathBaseOperation() { this->setAreaExecution(true); }
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value1, const float *value2, int length);
 };
 class MathRoundOperation : public MathBaseOperation {
 public:
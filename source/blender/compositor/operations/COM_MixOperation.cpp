@@ -65,6 +65,33 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
 	output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	const int length = BLI_rcti_size_x(area);
+	for (int y = area->ymin; y < area->ymax; y++) {
+		this->executeRow(output->getElem(area->xmin, y),
+		                 inputs[0]->getElem(area->xmin, y),
+		                 inputs[1]->getElem(area->xmin, y),
+		                 inputs[2]->getElem(area->xmin, y),
+		                 length);
+	}
+}
+
+void MixBaseOperation::executeRow(float *output, const float *value, const float *color1, const float *color2, int length)
+{
+	for (int i = 0; i < length; i++, output += 4, color1 += 4, color2 += 4) {
+		float fac = value[i];
+		if (this->useValueAlphaMultiply()) {
+			fac *= color2[3];
+		}
+		float facm = 1.0f - fac;
+		output[0] = facm * color1[0] + fac * color2[0];
+		output[1] = facm * color1[1] + fac * color2[1];
+		output[2] = facm * color1[2] + fac * color2[2];
+		output[3] = color1[3];
+	}
+}
+
 void MixBaseOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	NodeOperationInput *socket;
@@ -100,7 +127,7 @@ void MixBaseOperation::deinitExecution()
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setAreaExecution(true);
 }
 
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -125,11 +152,27 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::executeRow(float *output, const float *value, const float *color1, const float *color2, int length)
+{
+	for (int i = 0; i < length; i++, output += 4, color1 += 4, color2 += 4) {
+		float fac = value[i];
+		if (this->useValueAlphaMultiply()) {
+			fac *= color2[3];
+		}
+		output[0] = color1[0] + fac * color2[0];
+		output[1] = color1[1] + fac * color2[1];
+		output[2] = color1[2] + fac * color2[2];
+		output[3] = color1[3];
+
+		clampIfNeeded(output);
+	}
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setAreaExecution(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -156,6 +199,23 @@ void MixBlendOperation::executePixelSampled(float output[4], float x, float y, P
 	clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeRow(float *output, const float *value, const float *color1, const float *color2, int length)
+{
+	for (int i = 0; i < length; i++, output += 4, color1 += 4, color2 += 4) {
+		float fac = value[i];
+		if (this->useValueAlphaMultiply()) {
+			fac *= color2[3];
+		}
+		float facm = 1.0f - fac;
+		output[0] = facm * color1[0] + fac * color2[0];
+		output[1] = facm * color1[1] + fac * color2[1];
+		output[2] = facm * color1[2] + fac * color2[2];
+		output[3] = color1[3];
+
+		clampIfNeeded(output);
+	}
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -593,7 +653,7 @@ void MixLinearLightOperation::executePixelSampled(float output[4], float x, floa
 
 MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setAreaExecution(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -619,6 +679,23 @@ void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeRow(float *output, const float *value, const float *color1, const float *color2, int length)
+{
+	for (int i = 0; i < length; i++, output += 4, color1 += 4, color2 += 4) {
+		float fac = value[i];
+		if (this->useValueAlphaMultiply()) {
+			fac *= color2[3];
+		}
+		float facm = 1.0f - fac;
+		output[0] = color1[0] * (facm + fac * color2[0]);
+		output[1] = color1[1] * (facm + fac * color2[1]);
+		output[2] = color1[2] * (facm + fac * color2[2]);
+		output[3] = color1[3];
+
+		clampIfNeeded(output);
+	}
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -777,7 +854,7 @@ void MixSoftLightOperation::executePixelSampled(float output[4], float x, float
 
 MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
 {
-	/* pass */
+	this->setAreaExecution(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -802,6 +879,22 @@ void MixSubtractOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeRow(float *output, const float *value, const float *color1, const float *color2, int length)
+{
+	for (int i = 0; i < length; i++, output += 4, color1 += 4, color2 += 4) {
+		float fac = value[i];
+		if (this->useValueAlphaMultiply()) {
+			fac *= color2[3];
+		}
+		output[0] = color1[0] - fac * color2[0];
+		output[1] = color1[1] - fac * color2[1];
+		output[2] = color1[2] - fac * color2[2];
+		output[3] = color1[3];
+
+		clampIfNeeded(output);
+	}
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
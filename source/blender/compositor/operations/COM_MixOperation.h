@@ -70,6 +70,16 @@ public:
 
 	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
 
+	/**
+	 * calculate an area row by row using executeRow
+	 */
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
+	/**
+	 * mix a row of pixels, only called for operations that enable area execution
+	 */
+	virtual void executeRow(float *output, const float *value, const float *color1, const float *color2, int length);
+
 
 	void setUseValueAlphaMultiply(const bool value) { this->m_valueAlphaMultiply = value; }
 	inline bool useValueAlphaMultiply() { return this->m_valueAlphaMultiply; }
@@ -80,12 +90,14 @@ class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixBurnOperation : public MixBaseOperation {
@@ -152,6 +164,7 @@ class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -182,6 +195,7 @@ class MixSubtractOperation : public MixBaseOperation {
 public:
 	MixSubtractOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRow(float *output, const float *value, const float *color1, const float *color2, int length);
 };
 
 class MixValueOperation : public MixBaseOperation {
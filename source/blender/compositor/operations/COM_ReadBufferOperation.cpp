@@ -26,6 +26,7 @@ ReadBufferOperation::ReadBufferOperation(DataType datatype) : NodeOperation()
 	this->m_single_value = false;
 	this->m_offset = 0;
 	this->m_buffer = NULL;
+	this->setAreaExecution(true);
 }
 
 void *ReadBufferOperation::initializeTileData(rcti * /*rect*/)
@@ -70,6 +71,43 @@ void ReadBufferOperation::executePixelSampled(float output[4], float x, float y,
 	}
 }
 
+void ReadBufferOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer ** /*inputs*/)
+{
+	if (m_single_value) {
+		/* write buffer has a single value stored at (0,0) */
+		float value[4];
+		m_buffer->read(value, 0, 0);
+		output->fill(area, value);
+		return;
+	}
+
+	/* copy the part of each row that overlaps the buffer, pixels outside are zero */
+	const rcti *rect = m_buffer->getRect();
+	const int num_channels = output->get_num_channels();
+	const int xmin = max_ii(area->xmin, rect->xmin);
+	const int xmax = min_ii(area->xmax, rect->xmax);
+
+	for (int y = area->ymin; y < area->ymax; y++) {
+		float *out = output->getElem(area->xmin, y);
+		if (y < rect->ymin || y >= rect->ymax || xmin >= xmax) {
+			memset(out, 0, sizeof(float) * num_channels * BLI_rcti_size_x(area));
+			continue;
+		}
+
+		memset(out, 0, sizeof(float) * num_channels * (xmin - area->xmin));
+		if (m_buffer->isHalfFloat()) {
+			for (int x = xmin; x < xmax; x++) {
+				m_buffer->read(out + (x - area->xmin) * num_channels, x, y);
+			}
+		}
+		else {
+			memcpy(out + (xmin - area->xmin) * num_channels, m_buffer->getElem(xmin, y),
+			       sizeof(float) * num_channels * (xmax - xmin));
+		}
+		memset(out + (xmax - area->xmin) * num_channels, 0, sizeof(float) * num_channels * (area->xmax - xmax));
+	}
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4], float x, float y, PixelSampler sampler,
                                              MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
 {
@@ -17,6 +17,7 @@
  */
 
 #include "COM_RenderLayersProg.h"
+#include "COM_ResultCache.h"
 
 #include "BLI_listbase.h"
 #include "BKE_scene.h"
@@ -172,6 +173,14 @@ void RenderLayersProg::deinitExecution()
 	this->m_inputBuffer = NULL;
 }
 
+/* the scene and view are hashed with the node and the context */
+void RenderLayersProg::hashParams(uint64_t &key) const
+{
+	ResultCache::hash(key, this->m_passName.c_str(), this->m_passName.size() + 1);
+	ResultCache::hash(key, &this->m_layerId, sizeof(this->m_layerId));
+	ResultCache::hash(key, &this->m_elementsize, sizeof(this->m_elementsize));
+}
+
 void RenderLayersProg::determineResolution(unsigned int resolution[2], unsigned int /*preferredResolution*/[2])
 {
 	Scene *sce = this->getScene();
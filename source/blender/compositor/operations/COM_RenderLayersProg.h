@@ -99,6 +99,7 @@ public:
 	void initExecution();
 	void deinitExecution();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void hashParams(uint64_t &key) const;
 };
 
 class RenderLayersAOOperation : public RenderLayersProg {
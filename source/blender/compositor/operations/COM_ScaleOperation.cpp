@@ -300,3 +300,57 @@ void ScaleFixedSizeOperation::determineResolution(unsigned int resolution[2], un
 	resolution[0] = this->m_newWidth;
 	resolution[1] = this->m_newHeight;
 }
+
+
+ProxyScaleOperation::ProxyScaleOperation(DataType datatype, float scale) : NodeOperation()
+{
+	this->addInputSocket(datatype, COM_SC_NO_RESIZE);
+	this->addOutputSocket(datatype);
+	this->setResolutionInputSocketIndex(0);
+	this->m_inputOperation = NULL;
+	this->m_scale = scale;
+}
+
+void ProxyScaleOperation::initExecution()
+{
+	this->m_inputOperation = this->getInputSocketReader(0);
+}
+
+void ProxyScaleOperation::deinitExecution()
+{
+	this->m_inputOperation = NULL;
+}
+
+void ProxyScaleOperation::executePixelSampled(float output[4], float x, float y, PixelSampler /*sampler*/)
+{
+	/* sample at the center of the pixel, flooring by the nearest sampler picks the covering input pixel.
+	 * Coordinates are not whole pixels when the output is scaled back up without a buffer in between. */
+	this->m_inputOperation->readSampled(output,
+	                                    (floorf(x) + 0.5f) / this->m_scale,
+	                                    (floorf(y) + 0.5f) / this->m_scale,
+	                                    COM_PS_NEAREST);
+}
+
+bool ProxyScaleOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
+{
+	rcti newInput;
+
+	newInput.xmin = input->xmin / this->m_scale;
+	newInput.xmax = input->xmax / this->m_scale + 1;
+	newInput.ymin = input->ymin / this->m_scale;
+	newInput.ymax = input->ymax / this->m_scale + 1;
+
+	return NodeOperation::determineDependingAreaOfInterest(&newInput, readOperation, output);
+}
+
+void ProxyScaleOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
+{
+	unsigned int inputPreferredResolution[2];
+	inputPreferredResolution[0] = preferredResolution[0] / this->m_scale + 0.5f;
+	inputPreferredResolution[1] = preferredResolution[1] / this->m_scale + 0.5f;
+	NodeOperation::determineResolution(resolution, inputPreferredResolution);
+	if (resolution[0] != 0 && resolution[1] != 0) {
+		resolution[0] = max_ii((int)(resolution[0] * this->m_scale + 0.5f), 1);
+		resolution[1] = max_ii((int)(resolution[1] * this->m_scale + 0.5f), 1);
+	}
+}
@@ -97,4 +97,26 @@ public:
 	void setOffset(float x, float y) { this->m_offsetX = x; this->m_offsetY = y; }
 };
 
+/**
+ * \brief scales the resolution of its input by a fixed factor
+ *
+ * Used for the edit resolution of the compositor: sources are scaled down and the inputs
+ * of the outputs are scaled back up. Nearest sampling keeps ID and cryptomatte passes intact.
+ * \see CompositorContext.getProxyScale
+ */
+class ProxyScaleOperation : public NodeOperation {
+private:
+	SocketReader *m_inputOperation;
+	float m_scale;
+
+public:
+	ProxyScaleOperation(DataType datatype, float scale);
+	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
+	void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
+	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+	void initExecution();
+	void deinitExecution();
+};
+
 #endif
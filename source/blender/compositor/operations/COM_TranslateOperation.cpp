@@ -31,6 +31,7 @@ TranslateOperation::TranslateOperation() : NodeOperation()
 	this->m_isDeltaSet = false;
 	this->m_factorX = 1.0f;
 	this->m_factorY = 1.0f;
+	this->setAreaExecution(true);
 }
 void TranslateOperation::initExecution()
 {
@@ -57,6 +58,43 @@ void TranslateOperation::executePixelSampled(float output[4], float x, float y,
 	this->m_inputOperation->readSampled(output, originalXPos, originalYPos, COM_PS_BILINEAR);
 }
 
+bool TranslateOperation::canExecuteArea()
+{
+	if (!NodeOperation::canExecuteArea()) {
+		return false;
+	}
+
+	ensureDelta();
+
+	/* bilinear sampling at whole pixel offsets reads the input pixels unchanged */
+	const float deltaX = this->getDeltaX();
+	const float deltaY = this->getDeltaY();
+	return (deltaX == floorf(deltaX) && deltaY == floorf(deltaY));
+}
+
+bool TranslateOperation::determineAreaOfInput(unsigned int inputSocketIndex, rcti *area, rcti *r_inputArea)
+{
+	if (inputSocketIndex != 0) {
+		/* the delta is read once by ensureDelta */
+		return false;
+	}
+
+	*r_inputArea = *area;
+	BLI_rcti_translate(r_inputArea, -(int)this->getDeltaX(), -(int)this->getDeltaY());
+	return true;
+}
+
+void TranslateOperation::executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+	const int deltaX = (int)this->getDeltaX();
+	const int deltaY = (int)this->getDeltaY();
+	const size_t row_size = sizeof(float) * COM_NUM_CHANNELS_COLOR * BLI_rcti_size_x(area);
+
+	for (int y = area->ymin; y < area->ymax; y++) {
+		memcpy(output->getElem(area->xmin, y), inputs[0]->getElem(area->xmin - deltaX, y - deltaY), row_size);
+	}
+}
+
 bool TranslateOperation::determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output)
 {
 	rcti newInput;
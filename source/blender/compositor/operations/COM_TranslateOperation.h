@@ -36,6 +36,13 @@ public:
 	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+	/**
+	 * \brief areas can only be copied directly when translating by whole pixels
+	 */
+	bool canExecuteArea();
+	bool determineAreaOfInput(unsigned int inputSocketIndex, rcti *area, rcti *r_inputArea);
+	void executeArea(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
 	void initExecution();
 	void deinitExecution();
 
@@ -73,6 +73,7 @@ public:
 
 private:
 	void updateImage(rcti *rect);
+	void executeRegionArea(rcti *rect);
 	void initImage();
 };
 #endif
@@ -56,9 +56,18 @@ void WriteBufferOperation::deinitExecution()
 void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 {
 	MemoryBuffer *memoryBuffer = this->m_memoryProxy->getBuffer();
-	float *buffer = memoryBuffer->getBuffer();
-	const int num_channels = memoryBuffer->get_num_channels();
-	if (this->m_input->isComplex()) {
+	/* half float buffers are calculated in a float buffer of the chunk and converted afterwards */
+	MemoryBuffer *outputBuffer = memoryBuffer;
+	if (memoryBuffer->isHalfFloat()) {
+		outputBuffer = new MemoryBuffer(this->m_memoryProxy->getDataType(), rect);
+	}
+	const int num_channels = outputBuffer->get_num_channels();
+	if (this->useAreaExecution() && (!this->m_input->isComplex() || this->m_input->canExecuteArea())) {
+		/* calculate the whole region at once, operations without area support
+		 * fall back to pixel by pixel inside renderArea */
+		this->m_input->renderArea(outputBuffer, rect);
+	}
+	else if (this->m_input->isComplex()) {
 		void *data = this->m_input->initializeTileData(rect);
 		int x1 = rect->xmin;
 		int y1 = rect->ymin;
@@ -68,10 +77,10 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
 		int y;
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
+			float *buffer = outputBuffer->getElem(x1, y);
 			for (x = x1; x < x2; x++) {
-				this->m_input->read(&(buffer[offset4]), x, y, data);
-				offset4 += num_channels;
+				this->m_input->read(buffer, x, y, data);
+				buffer += num_channels;
 			}
 			if (isBreaked()) {
 				breaked = true;
@@ -93,16 +102,20 @@ void WriteBufferOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/
 		int y;
 		bool breaked = false;
 		for (y = y1; y < y2 && (!breaked); y++) {
-			int offset4 = (y * memoryBuffer->getWidth() + x1) * num_channels;
+			float *buffer = outputBuffer->getElem(x1, y);
 			for (x = x1; x < x2; x++) {
-				this->m_input->readSampled(&(buffer[offset4]), x, y, COM_PS_NEAREST);
-				offset4 += num_channels;
+				this->m_input->readSampled(buffer, x, y, COM_PS_NEAREST);
+				buffer += num_channels;
 			}
 			if (isBreaked()) {
 				breaked = true;
 			}
 		}
 	}
+	if (outputBuffer != memoryBuffer) {
+		memoryBuffer->copyContentFrom(outputBuffer);
+		delete outputBuffer;
+	}
 	memoryBuffer->setCreatedState();
 }
 
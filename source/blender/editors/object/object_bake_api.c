@@ -634,66 +634,43 @@ static Mesh *bake_mesh_new_from_object(Depsgraph *depsgraph, Main *bmain, Scene
 	return me;
 }
 
-static int bake(
-        Render *re, Main *bmain, Scene *scene, ViewLayer *view_layer, Object *ob_low, ListBase *selected_objects,
-        ReportList *reports,
-        const eScenePassType pass_type, const int pass_filter, const int margin,
-        const eBakeSaveMode save_mode, const bool is_clear, const bool is_split_materials,
-        const bool is_automatic_name, const bool is_selected_to_active, const bool is_cage,
-        const float cage_extrusion, const int normal_space, const eBakeNormalSwizzle normal_swizzle[],
-        const char *custom_cage, const char *filepath, const int width, const int height,
-        const char *identifier, ScrArea *sa, const char *uv_layer)
-{
-	/* We build a depsgraph for the baking,
-	 * so we don't need to change the original data to adjust visibility and modifiers. */
-	Depsgraph *depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_RENDER);
-	DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
-
-	int op_result = OPERATOR_CANCELLED;
-	bool ok = false;
-
-	Object *ob_cage = NULL;
-	Object *ob_cage_eval = NULL;
-	Object *ob_low_eval = NULL;
-
-	BakeHighPolyData *highpoly = NULL;
-	int tot_highpoly = 0;
-
-	Mesh *me_low = NULL;
-	Mesh *me_cage = NULL;
-
-	MultiresModifierData *mmd_low = NULL;
-	int mmd_flags_low = 0;
-
-	float *result = NULL;
-
-	BakePixel *pixel_array_low = NULL;
-	BakePixel *pixel_array_high = NULL;
+/* An object baked into its own images, from itself or from the selected objects. */
+typedef struct BakeLowPolyData {
+	Object *ob;
+	Object *ob_eval;
+	Mesh *me;
+	/* mesh casting the rays to the selected objects */
+	Mesh *me_cage;
 
-	const bool is_save_internal = (save_mode == R_BAKE_SAVE_INTERNAL);
-	const bool is_noncolor = is_noncolor_pass(pass_type);
-	const int depth = RE_pass_depth(pass_type);
+	BakeHighPolyData *highpoly;
+	int tot_highpoly;
 
-	BakeImages bake_images = {NULL};
+	MultiresModifierData *mmd;
+	int mmd_flags;
 
+	BakeImages bake_images;
 	size_t num_pixels;
-	int tot_materials;
-
-	RE_bake_engine_set_engine_parameters(re, bmain, scene);
-
-	if (!RE_bake_has_engine(re)) {
-		BKE_report(reports, RPT_ERROR, "Current render engine does not support baking");
-		goto cleanup;
-	}
-
-	tot_materials = ob_low->totcol;
+	BakePixel *pixel_array_low;
+	BakePixel *pixel_array_high;
+	float *result;
+} BakeLowPolyData;
+
+/* Find the images of the object and the number of pixels to bake. */
+static bool bake_lowpoly_init_images(
+        Main *bmain, BakeLowPolyData *low, ReportList *reports,
+        const bool is_save_internal, const bool is_split_materials,
+        const int width, const int height, const char *uv_layer)
+{
+	Object *ob_low = low->ob;
+	BakeImages *bake_images = &low->bake_images;
+	int tot_materials = ob_low->totcol;
 
 	if (uv_layer && uv_layer[0] != '\0') {
 		Mesh *me = (Mesh *)ob_low->data;
 		if (CustomData_get_named_layer(&me->ldata, CD_MLOOPUV, uv_layer) == -1) {
 			BKE_reportf(reports, RPT_ERROR,
 			            "No UV layer named \"%s\" found in the object \"%s\"", uv_layer, ob_low->id.name + 2);
-			goto cleanup;
+			return false;
 		}
 	}
 
@@ -702,13 +679,13 @@ static int bake(
 			BKE_report(reports, RPT_ERROR,
 			           "No active image found, add a material or bake to an external file");
 
-			goto cleanup;
+			return false;
 		}
 		else if (is_split_materials) {
 			BKE_report(reports, RPT_ERROR,
 			           "No active image found, add a material or bake without the Split Materials option");
 
-			goto cleanup;
+			return false;
 		}
 		else {
 			/* baking externally without splitting materials */
@@ -717,49 +694,329 @@ static int bake(
 	}
 
 	/* we overallocate in case there is more materials than images */
-	bake_images.data = MEM_mallocN(sizeof(BakeImage) * tot_materials, "bake images dimensions (width, height, offset)");
-	bake_images.lookup = MEM_mallocN(sizeof(int) * tot_materials, "bake images lookup (from material to BakeImage)");
+	bake_images->data = MEM_mallocN(sizeof(BakeImage) * tot_materials, "bake images dimensions (width, height, offset)");
+	bake_images->lookup = MEM_mallocN(sizeof(int) * tot_materials, "bake images lookup (from material to BakeImage)");
 
-	build_image_lookup(bmain, ob_low, &bake_images);
+	build_image_lookup(bmain, ob_low, bake_images);
 
 	if (is_save_internal) {
-		num_pixels = initialize_internal_images(&bake_images, reports);
+		low->num_pixels = initialize_internal_images(bake_images, reports);
 
-		if (num_pixels == 0) {
-			goto cleanup;
+		if (low->num_pixels == 0) {
+			return false;
 		}
 	}
 	else {
 		/* when saving externally always use the size specified in the UI */
 
-		num_pixels = (size_t)width * (size_t)height * bake_images.size;
+		low->num_pixels = (size_t)width * (size_t)height * bake_images->size;
 
-		for (int i = 0; i < bake_images.size; i++) {
-			bake_images.data[i].width = width;
-			bake_images.data[i].height = height;
-			bake_images.data[i].offset = (is_split_materials ? num_pixels : 0);
-			bake_images.data[i].image = NULL;
+		for (int i = 0; i < bake_images->size; i++) {
+			bake_images->data[i].width = width;
+			bake_images->data[i].height = height;
+			bake_images->data[i].offset = (is_split_materials ? low->num_pixels : 0);
+			bake_images->data[i].image = NULL;
 		}
 
 		if (!is_split_materials) {
 			/* saving a single image */
 			for (int i = 0; i < tot_materials; i++) {
-				bake_images.lookup[i] = 0;
+				bake_images->lookup[i] = 0;
+			}
+		}
+	}
+
+	return true;
+}
+
+/* Convert the normals of an object and save its images. */
+static int bake_lowpoly_write(
+        BakeLowPolyData *low, Depsgraph *depsgraph, Main *bmain, Scene *scene, ReportList *reports,
+        const eScenePassType pass_type, const int margin,
+        const bool is_save_internal, const bool is_clear, const bool is_split_materials,
+        const bool is_automatic_name, const bool is_selected_to_active,
+        const int normal_space, const eBakeNormalSwizzle normal_swizzle[],
+        const char *filepath, const char *identifier, ScrArea *sa, const char *uv_layer)
+{
+	int op_result = OPERATOR_CANCELLED;
+	bool ok;
+
+	const bool is_noncolor = is_noncolor_pass(pass_type);
+	const int depth = RE_pass_depth(pass_type);
+
+	/* normal space conversion
+	 * the normals are expected to be in world space, +X +Y +Z */
+	if (pass_type == SCE_PASS_NORMAL) {
+		switch (normal_space) {
+			case R_BAKE_SPACE_WORLD:
+			{
+				/* Cycles internal format */
+				if ((normal_swizzle[0] == R_BAKE_POSX) &&
+				    (normal_swizzle[1] == R_BAKE_POSY) &&
+				    (normal_swizzle[2] == R_BAKE_POSZ))
+				{
+					break;
+				}
+				else {
+					RE_bake_normal_world_to_world(low->pixel_array_low, low->num_pixels,  depth, low->result, normal_swizzle);
+				}
+				break;
+			}
+			case R_BAKE_SPACE_OBJECT:
+			{
+				RE_bake_normal_world_to_object(low->pixel_array_low, low->num_pixels, depth, low->result, low->ob_eval, normal_swizzle);
+				break;
+			}
+			case R_BAKE_SPACE_TANGENT:
+			{
+				if (is_selected_to_active) {
+					RE_bake_normal_world_to_tangent(low->pixel_array_low, low->num_pixels, depth, low->result, low->me, normal_swizzle, low->ob_eval->obmat);
+				}
+				else {
+					/* from multiresolution */
+					Mesh *me_nores = NULL;
+					ModifierData *md = NULL;
+					int mode;
+
+					BKE_object_eval_reset(low->ob_eval);
+					md = modifiers_findByType(low->ob_eval, eModifierType_Multires);
+
+					if (md) {
+						mode = md->mode;
+						md->mode &= ~eModifierMode_Render;
+					}
+
+					/* Evaluate modifiers again. */
+					me_nores = BKE_mesh_new_from_object(depsgraph, bmain, scene, low->ob_eval, true, false);
+					RE_bake_pixels_populate(me_nores, low->pixel_array_low, low->num_pixels, &low->bake_images, uv_layer);
+
+					RE_bake_normal_world_to_tangent(low->pixel_array_low, low->num_pixels, depth, low->result, me_nores, normal_swizzle, low->ob_eval->obmat);
+					BKE_id_free(bmain, me_nores);
+
+					if (md)
+						md->mode = mode;
+				}
+				break;
 			}
+			default:
+				break;
+		}
+	}
+
+	/* save the results */
+	for (int i = 0; i < low->bake_images.size; i++) {
+		BakeImage *bk_image = &low->bake_images.data[i];
+
+		if (is_save_internal) {
+			ok = write_internal_bake_pixels(
+			         bk_image->image,
+			         low->pixel_array_low + bk_image->offset,
+			         low->result + bk_image->offset * depth,
+			         bk_image->width, bk_image->height,
+			         margin, is_clear, is_noncolor);
+
+			/* might be read by UI to set active image for display */
+			bake_update_image(sa, bk_image->image);
+
+			if (!ok) {
+				BKE_reportf(reports, RPT_ERROR,
+				           "Problem saving the bake map internally for object \"%s\"", low->ob->id.name + 2);
+				op_result = OPERATOR_CANCELLED;
+			}
+			else {
+				BKE_report(reports, RPT_INFO,
+				           "Baking map saved to internal image, save it externally or pack it");
+				op_result = OPERATOR_FINISHED;
+			}
+		}
+		/* save externally */
+		else {
+			BakeData *bake = &scene->r.bake;
+			char name[FILE_MAX];
+
+			BKE_image_path_from_imtype(name, filepath, BKE_main_blendfile_path(bmain),
+			                           0, bake->im_format.imtype, true, false, NULL);
+
+			if (is_automatic_name) {
+				BLI_path_suffix(name, FILE_MAX, low->ob->id.name + 2, "_");
+				BLI_path_suffix(name, FILE_MAX, identifier, "_");
+			}
+
+			if (is_split_materials) {
+				if (bk_image->image) {
+					BLI_path_suffix(name, FILE_MAX, bk_image->image->id.name + 2, "_");
+				}
+				else {
+					if (low->ob_eval->mat[i]) {
+						BLI_path_suffix(name, FILE_MAX, low->ob_eval->mat[i]->id.name + 2, "_");
+					}
+					else if (low->me->mat[i]) {
+						BLI_path_suffix(name, FILE_MAX, low->me->mat[i]->id.name + 2, "_");
+					}
+					else {
+						/* if everything else fails, use the material index */
+						char tmp[5];
+						sprintf(tmp, "%d", i % 1000);
+						BLI_path_suffix(name, FILE_MAX, tmp, "_");
+					}
+				}
+			}
+
+			/* save it externally */
+			ok = write_external_bake_pixels(
+			        name,
+			        low->pixel_array_low + bk_image->offset,
+			        low->result + bk_image->offset * depth,
+			        bk_image->width, bk_image->height,
+			        margin, &bake->im_format, is_noncolor);
+
+			if (!ok) {
+				BKE_reportf(reports, RPT_ERROR, "Problem saving baked map in \"%s\"", name);
+				op_result = OPERATOR_CANCELLED;
+			}
+			else {
+				BKE_reportf(reports, RPT_INFO, "Baking map written to \"%s\"", name);
+				op_result = OPERATOR_FINISHED;
+			}
+
+			if (!is_split_materials) {
+				break;
+			}
+		}
+	}
+
+	if (is_save_internal)
+		refresh_images(&low->bake_images);
+
+	return op_result;
+}
+
+static void bake_lowpoly_free(Main *bmain, BakeLowPolyData *low)
+{
+	if (low->highpoly) {
+		int i;
+		for (i = 0; i < low->tot_highpoly; i++) {
+			if (low->highpoly[i].me)
+				BKE_id_free(bmain, low->highpoly[i].me);
+		}
+		MEM_freeN(low->highpoly);
+	}
+
+	if (low->mmd)
+		low->mmd->flags = low->mmd_flags;
+
+	if (low->pixel_array_low)
+		MEM_freeN(low->pixel_array_low);
+
+	if (low->pixel_array_high)
+		MEM_freeN(low->pixel_array_high);
+
+	if (low->bake_images.data)
+		MEM_freeN(low->bake_images.data);
+
+	if (low->bake_images.lookup)
+		MEM_freeN(low->bake_images.lookup);
+
+	if (low->result)
+		MEM_freeN(low->result);
+
+	if (low->me)
+		BKE_id_free(bmain, low->me);
+
+	if (low->me_cage)
+		BKE_id_free(bmain, low->me_cage);
+}
+
+static void bake_job_init(
+        BakeJob *job, Object *ob, const int object_id, const BakePixel pixel_array[], const size_t num_pixels,
+        const int depth, const eScenePassType pass_type, const int pass_filter, float result[])
+{
+	job->object = ob;
+	job->object_id = object_id;
+	job->pixel_array = pixel_array;
+	job->num_pixels = (int)num_pixels;
+	job->depth = depth;
+	job->pass_type = pass_type;
+	job->pass_filter = pass_filter;
+	job->result = result;
+}
+
+/**
+ * Bake the active object from the selected ones, or every selected object from itself.
+ * The engine gets all objects at once, so it only has to sync the scene a single time.
+ */
+static int bake(
+        Render *re, Main *bmain, Scene *scene, ViewLayer *view_layer, Object *ob_active, ListBase *selected_objects,
+        ReportList *reports,
+        const eScenePassType pass_type, const int pass_filter, const int margin,
+        const eBakeSaveMode save_mode, const bool is_clear, const bool is_split_materials,
+        const bool is_automatic_name, const bool is_selected_to_active, const bool is_cage,
+        const float cage_extrusion, const int normal_space, const eBakeNormalSwizzle normal_swizzle[],
+        const char *custom_cage, const char *filepath, const int width, const int height,
+        const char *identifier, ScrArea *sa, const char *uv_layer)
+{
+	/* We build a depsgraph for the baking,
+	 * so we don't need to change the original data to adjust visibility and modifiers. */
+	Depsgraph *depsgraph = DEG_graph_new(scene, view_layer, DAG_EVAL_RENDER);
+	DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+
+	int op_result = OPERATOR_CANCELLED;
+	bool ok = false;
+
+	Object *ob_cage = NULL;
+	Object *ob_cage_eval = NULL;
+
+	BakeLowPolyData *lowpoly = NULL;
+	int tot_lowpoly = 0;
+
+	BakeJob *jobs = NULL;
+	int tot_jobs = 0;
+
+	const bool is_save_internal = (save_mode == R_BAKE_SAVE_INTERNAL);
+	const int depth = RE_pass_depth(pass_type);
+	int i;
+
+	RE_bake_engine_set_engine_parameters(re, bmain, scene);
+
+	if (!RE_bake_has_engine(re)) {
+		BKE_report(reports, RPT_ERROR, "Current render engine does not support baking");
+		goto cleanup;
+	}
+
+	if (is_selected_to_active) {
+		tot_lowpoly = 1;
+		lowpoly = MEM_callocN(sizeof(BakeLowPolyData), "bake low poly objects");
+		lowpoly[0].ob = ob_active;
+	}
+	else {
+		CollectionPointerLink *link;
+
+		tot_lowpoly = BLI_listbase_count(selected_objects);
+		lowpoly = MEM_callocN(sizeof(BakeLowPolyData) * tot_lowpoly, "bake low poly objects");
+
+		for (link = selected_objects->first, i = 0; link; link = link->next, i++) {
+			lowpoly[i].ob = link->ptr.data;
+		}
+	}
+
+	for (i = 0; i < tot_lowpoly; i++) {
+		if (!bake_lowpoly_init_images(bmain, &lowpoly[i], reports, is_save_internal, is_split_materials,
+		                              width, height, uv_layer))
+		{
+			goto cleanup;
 		}
 	}
 
 	if (is_selected_to_active) {
 		CollectionPointerLink *link;
-		tot_highpoly = 0;
 
 		for (link = selected_objects->first; link; link = link->next) {
 			Object *ob_iter = link->ptr.data;
 
-			if (ob_iter == ob_low)
+			if (ob_iter == ob_active)
 				continue;
 
-			tot_highpoly ++;
+			lowpoly[0].tot_highpoly++;
 		}
 
 		if (is_cage && custom_cage[0] != '\0') {
@@ -777,39 +1034,50 @@ static int bake(
 		}
 	}
 
-	pixel_array_low = MEM_mallocN(sizeof(BakePixel) * num_pixels, "bake pixels low poly");
-	pixel_array_high = MEM_mallocN(sizeof(BakePixel) * num_pixels, "bake pixels high poly");
-	result = MEM_callocN(sizeof(float) * depth * num_pixels, "bake return pixels");
+	for (i = 0; i < tot_lowpoly; i++) {
+		BakeLowPolyData *low = &lowpoly[i];
 
-	/* for multires bake, use linear UV subdivision to match low res UVs */
-	if (pass_type == SCE_PASS_NORMAL && normal_space == R_BAKE_SPACE_TANGENT && !is_selected_to_active) {
-		mmd_low = (MultiresModifierData *) modifiers_findByType(ob_low, eModifierType_Multires);
-		if (mmd_low) {
-			mmd_flags_low = mmd_low->flags;
-			mmd_low->uv_smooth = SUBSURF_UV_SMOOTH_NONE;
+		low->pixel_array_low = MEM_mallocN(sizeof(BakePixel) * low->num_pixels, "bake pixels low poly");
+		if (is_selected_to_active) {
+			low->pixel_array_high = MEM_mallocN(sizeof(BakePixel) * low->num_pixels, "bake pixels high poly");
+		}
+		low->result = MEM_callocN(sizeof(float) * depth * low->num_pixels, "bake return pixels");
+
+		/* for multires bake, use linear UV subdivision to match low res UVs */
+		if (pass_type == SCE_PASS_NORMAL && normal_space == R_BAKE_SPACE_TANGENT && !is_selected_to_active) {
+			low->mmd = (MultiresModifierData *) modifiers_findByType(low->ob, eModifierType_Multires);
+			if (low->mmd) {
+				low->mmd_flags = low->mmd->flags;
+				low->mmd->uv_smooth = SUBSURF_UV_SMOOTH_NONE;
+			}
 		}
 	}
 
 	/* Make sure depsgraph is up to date. */
 	BKE_scene_graph_update_tagged(depsgraph, bmain);
-	ob_low_eval = DEG_get_evaluated_object(depsgraph, ob_low);
 
-	/* get the mesh as it arrives in the renderer */
-	me_low = bake_mesh_new_from_object(depsgraph, bmain, scene, ob_low_eval);
+	for (i = 0; i < tot_lowpoly; i++) {
+		BakeLowPolyData *low = &lowpoly[i];
+
+		low->ob_eval = DEG_get_evaluated_object(depsgraph, low->ob);
+
+		/* get the mesh as it arrives in the renderer */
+		low->me = bake_mesh_new_from_object(depsgraph, bmain, scene, low->ob_eval);
 
-	/* populate the pixel array with the face data */
-	if ((is_selected_to_active && (ob_cage == NULL) && is_cage) == false)
-		RE_bake_pixels_populate(me_low, pixel_array_low, num_pixels, &bake_images, uv_layer);
-	/* else populate the pixel array with the 'cage' mesh (the smooth version of the mesh)  */
+		/* populate the pixel array with the face data */
+		if ((is_selected_to_active && (ob_cage == NULL) && is_cage) == false)
+			RE_bake_pixels_populate(low->me, low->pixel_array_low, low->num_pixels, &low->bake_images, uv_layer);
+		/* else populate the pixel array with the 'cage' mesh (the smooth version of the mesh)  */
+	}
 
 	if (is_selected_to_active) {
+		BakeLowPolyData *low = &lowpoly[0];
 		CollectionPointerLink *link;
-		int i = 0;
 
 		/* prepare cage mesh */
 		if (ob_cage) {
-			me_cage = bake_mesh_new_from_object(depsgraph, bmain, scene, ob_cage_eval);
-			if ((me_low->totpoly != me_cage->totpoly) || (me_low->totloop != me_cage->totloop)) {
+			low->me_cage = bake_mesh_new_from_object(depsgraph, bmain, scene, ob_cage_eval);
+			if ((low->me->totpoly != low->me_cage->totpoly) || (low->me->totloop != low->me_cage->totloop)) {
 				BKE_report(reports, RPT_ERROR,
 				           "Invalid cage object, the cage mesh must have the same number "
 				           "of faces as the active object");
@@ -817,9 +1085,9 @@ static int bake(
 			}
 		}
 		else if (is_cage) {
-			BKE_object_eval_reset(ob_low_eval);
+			BKE_object_eval_reset(low->ob_eval);
 
-			ModifierData *md = ob_low_eval->modifiers.first;
+			ModifierData *md = low->ob_eval->modifiers.first;
 			while (md) {
 				ModifierData *md_next = md->next;
 
@@ -830,267 +1098,124 @@ static int bake(
 				 * the eventual edge split.*/
 
 				if (md->type == eModifierType_EdgeSplit) {
-					BLI_remlink(&ob_low_eval->modifiers, md);
+					BLI_remlink(&low->ob_eval->modifiers, md);
 					modifier_free(md);
 				}
 				md = md_next;
 			}
 
-			me_cage = bake_mesh_new_from_object(depsgraph, bmain, scene, ob_low_eval);
-			RE_bake_pixels_populate(me_cage, pixel_array_low, num_pixels, &bake_images, uv_layer);
+			low->me_cage = bake_mesh_new_from_object(depsgraph, bmain, scene, low->ob_eval);
+			RE_bake_pixels_populate(low->me_cage, low->pixel_array_low, low->num_pixels, &low->bake_images, uv_layer);
 		}
 
-		highpoly = MEM_callocN(sizeof(BakeHighPolyData) * tot_highpoly, "bake high poly objects");
+		low->highpoly = MEM_callocN(sizeof(BakeHighPolyData) * low->tot_highpoly, "bake high poly objects");
 
 		/* populate highpoly array */
+		i = 0;
 		for (link = selected_objects->first; link; link = link->next) {
 			Object *ob_iter = link->ptr.data;
+			BakeHighPolyData *highpoly;
 
-			if (ob_iter == ob_low)
+			if (ob_iter == ob_active)
 				continue;
 
 			/* initialize highpoly_data */
-			highpoly[i].ob = ob_iter;
-			highpoly[i].ob_eval = DEG_get_evaluated_object(depsgraph, ob_iter);
-			highpoly[i].ob_eval->restrictflag &= ~OB_RESTRICT_RENDER;
-			highpoly[i].ob_eval->base_flag |= (BASE_VISIBLE | BASE_ENABLED_RENDER);
-			highpoly[i].me = bake_mesh_new_from_object(depsgraph, bmain, scene, highpoly[i].ob_eval);
+			highpoly = &low->highpoly[i];
+			highpoly->ob = ob_iter;
+			highpoly->ob_eval = DEG_get_evaluated_object(depsgraph, ob_iter);
+			highpoly->ob_eval->restrictflag &= ~OB_RESTRICT_RENDER;
+			highpoly->ob_eval->base_flag |= (BASE_VISIBLE | BASE_ENABLED_RENDER);
+			highpoly->me = bake_mesh_new_from_object(depsgraph, bmain, scene, highpoly->ob_eval);
 
 			/* lowpoly to highpoly transformation matrix */
-			copy_m4_m4(highpoly[i].obmat, highpoly[i].ob->obmat);
-			invert_m4_m4(highpoly[i].imat, highpoly[i].obmat);
+			copy_m4_m4(highpoly->obmat, highpoly->ob->obmat);
+			invert_m4_m4(highpoly->imat, highpoly->obmat);
 
-			highpoly[i].is_flip_object = is_negative_m4(highpoly[i].ob->obmat);
+			highpoly->is_flip_object = is_negative_m4(highpoly->ob->obmat);
 
 			i++;
 		}
 
-		BLI_assert(i == tot_highpoly);
+		BLI_assert(i == low->tot_highpoly);
 
 
 		if (ob_cage != NULL) {
 			ob_cage_eval->restrictflag |= OB_RESTRICT_RENDER;
 			ob_cage_eval->base_flag &= ~(BASE_VISIBLE | BASE_ENABLED_RENDER);
 		}
-		ob_low_eval->restrictflag |= OB_RESTRICT_RENDER;
-		ob_low_eval->base_flag &= ~(BASE_VISIBLE | BASE_ENABLED_RENDER);
+		low->ob_eval->restrictflag |= OB_RESTRICT_RENDER;
+		low->ob_eval->base_flag &= ~(BASE_VISIBLE | BASE_ENABLED_RENDER);
 
 		/* populate the pixel arrays with the corresponding face data for each high poly object */
 		if (!RE_bake_pixels_populate_from_objects(
-		            me_low, pixel_array_low, pixel_array_high, highpoly, tot_highpoly, num_pixels, ob_cage != NULL,
-		            cage_extrusion, ob_low_eval->obmat, (ob_cage ? ob_cage->obmat : ob_low_eval->obmat), me_cage))
+		            low->me, low->pixel_array_low, low->pixel_array_high, low->highpoly, low->tot_highpoly,
+		            low->num_pixels, ob_cage != NULL, cage_extrusion, low->ob_eval->obmat,
+		            (ob_cage ? ob_cage->obmat : low->ob_eval->obmat), low->me_cage))
 		{
 			BKE_report(reports, RPT_ERROR, "Error handling selected objects");
 			goto cleanup;
 		}
 
-		/* the baking itself */
-		for (i = 0; i < tot_highpoly; i++) {
-			ok = RE_bake_engine(re, depsgraph, highpoly[i].ob, i, pixel_array_high,
-			                    num_pixels, depth, pass_type, pass_filter, result);
-			if (!ok) {
-				BKE_reportf(reports, RPT_ERROR, "Error baking from object \"%s\"", highpoly[i].ob->id.name + 2);
-				goto cleanup;
-			}
+		/* every selected object is baked into the pixels of the active one */
+		tot_jobs = low->tot_highpoly;
+		jobs = MEM_callocN(sizeof(BakeJob) * tot_jobs, "bake jobs");
+
+		for (i = 0; i < tot_jobs; i++) {
+			bake_job_init(&jobs[i], low->highpoly[i].ob, i, low->pixel_array_high, low->num_pixels,
+			              depth, pass_type, pass_filter, low->result);
 		}
 	}
 	else {
 		/* If low poly is not renderable it should have failed long ago. */
-		BLI_assert((ob_low_eval->restrictflag & OB_RESTRICT_RENDER) == 0);
+		tot_jobs = tot_lowpoly;
+		jobs = MEM_callocN(sizeof(BakeJob) * tot_jobs, "bake jobs");
 
-		if (RE_bake_has_engine(re)) {
-			ok = RE_bake_engine(re, depsgraph, ob_low_eval, 0, pixel_array_low, num_pixels, depth, pass_type, pass_filter, result);
-		}
-		else {
-			BKE_report(reports, RPT_ERROR, "Current render engine does not support baking");
-			goto cleanup;
+		for (i = 0; i < tot_jobs; i++) {
+			BLI_assert((lowpoly[i].ob_eval->restrictflag & OB_RESTRICT_RENDER) == 0);
+			bake_job_init(&jobs[i], lowpoly[i].ob_eval, 0, lowpoly[i].pixel_array_low, lowpoly[i].num_pixels,
+			              depth, pass_type, pass_filter, lowpoly[i].result);
 		}
 	}
 
-	/* normal space conversion
-	 * the normals are expected to be in world space, +X +Y +Z */
-	if (ok && pass_type == SCE_PASS_NORMAL) {
-		switch (normal_space) {
-			case R_BAKE_SPACE_WORLD:
-			{
-				/* Cycles internal format */
-				if ((normal_swizzle[0] == R_BAKE_POSX) &&
-				    (normal_swizzle[1] == R_BAKE_POSY) &&
-				    (normal_swizzle[2] == R_BAKE_POSZ))
-				{
-					break;
-				}
-				else {
-					RE_bake_normal_world_to_world(pixel_array_low, num_pixels,  depth, result, normal_swizzle);
-				}
-				break;
-			}
-			case R_BAKE_SPACE_OBJECT:
-			{
-				RE_bake_normal_world_to_object(pixel_array_low, num_pixels, depth, result, ob_low_eval, normal_swizzle);
-				break;
-			}
-			case R_BAKE_SPACE_TANGENT:
-			{
-				if (is_selected_to_active) {
-					RE_bake_normal_world_to_tangent(pixel_array_low, num_pixels, depth, result, me_low, normal_swizzle, ob_low_eval->obmat);
-				}
-				else {
-					/* from multiresolution */
-					Mesh *me_nores = NULL;
-					ModifierData *md = NULL;
-					int mode;
-
-					BKE_object_eval_reset(ob_low_eval);
-					md = modifiers_findByType(ob_low_eval, eModifierType_Multires);
-
-					if (md) {
-						mode = md->mode;
-						md->mode &= ~eModifierMode_Render;
-					}
-
-					/* Evaluate modifiers again. */
-					me_nores = BKE_mesh_new_from_object(depsgraph, bmain, scene, ob_low_eval, true, false);
-					RE_bake_pixels_populate(me_nores, pixel_array_low, num_pixels, &bake_images, uv_layer);
-
-					RE_bake_normal_world_to_tangent(pixel_array_low, num_pixels, depth, result, me_nores, normal_swizzle, ob_low_eval->obmat);
-					BKE_id_free(bmain, me_nores);
-
-					if (md)
-						md->mode = mode;
-				}
-				break;
-			}
-			default:
-				break;
-		}
+	for (i = 0; i < tot_jobs - 1; i++) {
+		jobs[i].next = &jobs[i + 1];
 	}
 
+	/* the baking itself */
+	ok = (tot_jobs == 0) || RE_bake_engine_jobs(re, depsgraph, jobs);
+
 	if (!ok) {
-		BKE_reportf(reports, RPT_ERROR, "Problem baking object \"%s\"", ob_low->id.name + 2);
-		op_result = OPERATOR_CANCELLED;
+		for (i = 0; i < tot_lowpoly; i++) {
+			BKE_reportf(reports, RPT_ERROR, "Problem baking object \"%s\"", lowpoly[i].ob->id.name + 2);
+		}
+		goto cleanup;
 	}
-	else {
-		/* save the results */
-		for (int i = 0; i < bake_images.size; i++) {
-			BakeImage *bk_image = &bake_images.data[i];
-
-			if (is_save_internal) {
-				ok = write_internal_bake_pixels(
-				         bk_image->image,
-				         pixel_array_low + bk_image->offset,
-				         result + bk_image->offset * depth,
-				         bk_image->width, bk_image->height,
-				         margin, is_clear, is_noncolor);
-
-				/* might be read by UI to set active image for display */
-				bake_update_image(sa, bk_image->image);
-
-				if (!ok) {
-					BKE_reportf(reports, RPT_ERROR,
-					           "Problem saving the bake map internally for object \"%s\"", ob_low->id.name + 2);
-					op_result = OPERATOR_CANCELLED;
-				}
-				else {
-					BKE_report(reports, RPT_INFO,
-					           "Baking map saved to internal image, save it externally or pack it");
-					op_result = OPERATOR_FINISHED;
-				}
-			}
-			/* save externally */
-			else {
-				BakeData *bake = &scene->r.bake;
-				char name[FILE_MAX];
-
-				BKE_image_path_from_imtype(name, filepath, BKE_main_blendfile_path(bmain),
-				                           0, bake->im_format.imtype, true, false, NULL);
-
-				if (is_automatic_name) {
-					BLI_path_suffix(name, FILE_MAX, ob_low->id.name + 2, "_");
-					BLI_path_suffix(name, FILE_MAX, identifier, "_");
-				}
-
-				if (is_split_materials) {
-					if (bk_image->image) {
-						BLI_path_suffix(name, FILE_MAX, bk_image->image->id.name + 2, "_");
-					}
-					else {
-						if (ob_low_eval->mat[i]) {
-							BLI_path_suffix(name, FILE_MAX, ob_low_eval->mat[i]->id.name + 2, "_");
-						}
-						else if (me_low->mat[i]) {
-							BLI_path_suffix(name, FILE_MAX, me_low->mat[i]->id.name + 2, "_");
-						}
-						else {
-							/* if everything else fails, use the material index */
-							char tmp[5];
-							sprintf(tmp, "%d", i % 1000);
-							BLI_path_suffix(name, FILE_MAX, tmp, "_");
-						}
-					}
-				}
 
-				/* save it externally */
-				ok = write_external_bake_pixels(
-				        name,
-				        pixel_array_low + bk_image->offset,
-				        result + bk_image->offset * depth,
-				        bk_image->width, bk_image->height,
-				        margin, &bake->im_format, is_noncolor);
-
-				if (!ok) {
-					BKE_reportf(reports, RPT_ERROR, "Problem saving baked map in \"%s\"", name);
-					op_result = OPERATOR_CANCELLED;
-				}
-				else {
-					BKE_reportf(reports, RPT_INFO, "Baking map written to \"%s\"", name);
-					op_result = OPERATOR_FINISHED;
-				}
+	op_result = OPERATOR_FINISHED;
 
-				if (!is_split_materials) {
-					break;
-				}
-			}
+	for (i = 0; i < tot_lowpoly; i++) {
+		/* clearing the images is only done by the bake when they aren't shared between objects */
+		if (bake_lowpoly_write(
+		        &lowpoly[i], depsgraph, bmain, scene, reports, pass_type, margin,
+		        is_save_internal, is_clear && (tot_lowpoly == 1), is_split_materials,
+		        is_automatic_name, is_selected_to_active, normal_space, normal_swizzle,
+		        filepath, identifier, sa, uv_layer) == OPERATOR_CANCELLED)
+		{
+			op_result = OPERATOR_CANCELLED;
 		}
 	}
 
-	if (is_save_internal)
-		refresh_images(&bake_images);
-
 cleanup:
 
-	if (highpoly) {
-		int i;
-		for (i = 0; i < tot_highpoly; i++) {
-			if (highpoly[i].me)
-				BKE_id_free(bmain, highpoly[i].me);
+	if (lowpoly) {
+		for (i = 0; i < tot_lowpoly; i++) {
+			bake_lowpoly_free(bmain, &lowpoly[i]);
 		}
-		MEM_freeN(highpoly);
+		MEM_freeN(lowpoly);
 	}
 
-	if (mmd_low)
-		mmd_low->flags = mmd_flags_low;
-
-	if (pixel_array_low)
-		MEM_freeN(pixel_array_low);
-
-	if (pixel_array_high)
-		MEM_freeN(pixel_array_high);
-
-	if (bake_images.data)
-		MEM_freeN(bake_images.data);
-
-	if (bake_images.lookup)
-		MEM_freeN(bake_images.lookup);
-
-	if (result)
-		MEM_freeN(result);
-
-	if (me_low)
-		BKE_id_free(bmain, me_low);
-
-	if (me_cage)
-		BKE_id_free(bmain, me_cage);
+	if (jobs)
+		MEM_freeN(jobs);
 
 	DEG_graph_free(depsgraph);
 
@@ -1186,29 +1311,13 @@ static int bake_exec(bContext *C, wmOperator *op)
 
 	RE_SetReports(re, bkr.reports);
 
-	if (bkr.is_selected_to_active) {
-		result = bake(
-		        bkr.render, bkr.main, bkr.scene, bkr.view_layer, bkr.ob, &bkr.selected_objects, bkr.reports,
-		        bkr.pass_type, bkr.pass_filter, bkr.margin, bkr.save_mode,
-		        bkr.is_clear, bkr.is_split_materials, bkr.is_automatic_name, true, bkr.is_cage,
-		        bkr.cage_extrusion, bkr.normal_space, bkr.normal_swizzle,
-		        bkr.custom_cage, bkr.filepath, bkr.width, bkr.height, bkr.identifier, bkr.sa,
-		        bkr.uv_layer);
-	}
-	else {
-		CollectionPointerLink *link;
-		const bool is_clear = bkr.is_clear && BLI_listbase_is_single(&bkr.selected_objects);
-		for (link = bkr.selected_objects.first; link; link = link->next) {
-			Object *ob_iter = link->ptr.data;
-			result = bake(
-			        bkr.render, bkr.main, bkr.scene, bkr.view_layer, ob_iter, NULL, bkr.reports,
-			        bkr.pass_type, bkr.pass_filter, bkr.margin, bkr.save_mode,
-			        is_clear, bkr.is_split_materials, bkr.is_automatic_name, false, bkr.is_cage,
-			        bkr.cage_extrusion, bkr.normal_space, bkr.normal_swizzle,
-			        bkr.custom_cage, bkr.filepath, bkr.width, bkr.height, bkr.identifier, bkr.sa,
-			        bkr.uv_layer);
-		}
-	}
+	result = bake(
+	        bkr.render, bkr.main, bkr.scene, bkr.view_layer, bkr.ob, &bkr.selected_objects, bkr.reports,
+	        bkr.pass_type, bkr.pass_filter, bkr.margin, bkr.save_mode,
+	        bkr.is_clear, bkr.is_split_materials, bkr.is_automatic_name, bkr.is_selected_to_active, bkr.is_cage,
+	        bkr.cage_extrusion, bkr.normal_space, bkr.normal_swizzle,
+	        bkr.custom_cage, bkr.filepath, bkr.width, bkr.height, bkr.identifier, bkr.sa,
+	        bkr.uv_layer);
 
 	RE_SetReports(re, NULL);
 
@@ -1244,32 +1353,13 @@ static void bake_startjob(void *bkv, short *UNUSED(stop), short *do_update, floa
 		bake_images_clear(bkr->main, is_tangent);
 	}
 
-	if (bkr->is_selected_to_active) {
-		bkr->result = bake(
-		        bkr->render, bkr->main, bkr->scene, bkr->view_layer, bkr->ob, &bkr->selected_objects, bkr->reports,
-		        bkr->pass_type, bkr->pass_filter, bkr->margin, bkr->save_mode,
-		        bkr->is_clear, bkr->is_split_materials, bkr->is_automatic_name, true, bkr->is_cage,
-		        bkr->cage_extrusion, bkr->normal_space, bkr->normal_swizzle,
-		        bkr->custom_cage, bkr->filepath, bkr->width, bkr->height, bkr->identifier, bkr->sa,
-		        bkr->uv_layer);
-	}
-	else {
-		CollectionPointerLink *link;
-		const bool is_clear = bkr->is_clear && BLI_listbase_is_single(&bkr->selected_objects);
-		for (link = bkr->selected_objects.first; link; link = link->next) {
-			Object *ob_iter = link->ptr.data;
-			bkr->result = bake(
-			        bkr->render, bkr->main, bkr->scene, bkr->view_layer, ob_iter, NULL, bkr->reports,
-			        bkr->pass_type, bkr->pass_filter, bkr->margin, bkr->save_mode,
-			        is_clear, bkr->is_split_materials, bkr->is_automatic_name, false, bkr->is_cage,
-			        bkr->cage_extrusion, bkr->normal_space, bkr->normal_swizzle,
-			        bkr->custom_cage, bkr->filepath, bkr->width, bkr->height, bkr->identifier, bkr->sa,
-			        bkr->uv_layer);
-
-			if (bkr->result == OPERATOR_CANCELLED)
-				return;
-		}
-	}
+	bkr->result = bake(
+	        bkr->render, bkr->main, bkr->scene, bkr->view_layer, bkr->ob, &bkr->selected_objects, bkr->reports,
+	        bkr->pass_type, bkr->pass_filter, bkr->margin, bkr->save_mode,
+	        bkr->is_clear, bkr->is_split_materials, bkr->is_automatic_name, bkr->is_selected_to_active, bkr->is_cage,
+	        bkr->cage_extrusion, bkr->normal_space, bkr->normal_swizzle,
+	        bkr->custom_cage, bkr->filepath, bkr->width, bkr->height, bkr->identifier, bkr->sa,
+	        bkr->uv_layer);
 
 	RE_SetReports(bkr->render, NULL);
 }
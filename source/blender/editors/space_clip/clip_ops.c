@@ -1345,7 +1345,7 @@ static int clip_rebuild_proxy_exec(bContext *C, wmOperator *UNUSED(op))
 	if (clip->anim) {
 		pj->index_context = IMB_anim_index_rebuild_context(clip->anim, clip->proxy.build_tc_flag,
 		                                                   clip->proxy.build_size_flag, clip->proxy.quality,
-		                                                   true, NULL);
+		                                                   true, NULL, 0);
 	}
 
 	WM_jobs_customdata_set(wm_job, pj, proxy_freejob);
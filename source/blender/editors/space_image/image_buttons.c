@@ -1084,6 +1084,10 @@ void uiTemplateImageSettings(uiLayout *layout, PointerRNA *imfptr, bool color_ma
 		uiItemR(col, imfptr, "exr_codec", 0, NULL, ICON_NONE);
 	}
 
+	if (is_render_out && imf->imtype == R_IMF_IMTYPE_MULTILAYER) {
+		uiItemR(col, imfptr, "use_exr_tiles", 0, NULL, ICON_NONE);
+	}
+
 	if (BKE_imtype_supports_zbuf(imf->imtype)) {
 		uiItemR(col, imfptr, "use_zbuffer", 0, NULL, ICON_NONE);
 	}
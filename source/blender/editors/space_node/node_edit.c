@@ -39,6 +39,7 @@
 #include "BKE_node.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
+#include "BKE_screen.h"
 
 #include "DEG_depsgraph.h"
 
@@ -87,6 +88,8 @@ typedef struct CompoJob {
 	short *do_update;
 	float *progress;
 	int recalc_flags;
+	/* part of the viewer visible in the backdrop */
+	rctf viewer_region;
 } CompoJob;
 
 static void compo_tag_output_nodes(bNodeTree *nodetree, int recalc_flags)
@@ -140,6 +143,42 @@ static int compo_get_recalc_flags(const bContext *C)
 	return recalc_flags;
 }
 
+/* part of the viewer image that is visible in the backdrop, in normalized coordinates */
+static bool compo_get_viewer_region(const bContext *C, bNodeTree *nodetree, rctf *r_region)
+{
+	SpaceNode *snode = CTX_wm_space_node(C);
+	ScrArea *sa = CTX_wm_area(C);
+	ARegion *ar;
+	Image *ima;
+	ImBuf *ibuf;
+	void *lock;
+	bool found = false;
+
+	if (!(nodetree->flag & NTREE_COM_VIEWER_REGION) || !snode || !sa || !(snode->flag & SNODE_BACKDRAW))
+		return false;
+
+	ar = BKE_area_find_region_type(sa, RGN_TYPE_WINDOW);
+	if (ar == NULL)
+		return false;
+
+	ima = BKE_image_verify_viewer(CTX_data_main(C), IMA_TYPE_COMPOSITE, "Viewer Node");
+	ibuf = BKE_image_acquire_ibuf(ima, NULL, &lock);
+
+	/* same mapping as the backdrop drawing and sampling */
+	if (ibuf && ibuf->x > 0 && ibuf->y > 0) {
+		const float bufx = ibuf->x * snode->zoom;
+		const float bufy = ibuf->y * snode->zoom;
+		r_region->xmin = (-0.5f * ar->winx - snode->xof) / bufx + 0.5f;
+		r_region->xmax = (0.5f * ar->winx - snode->xof) / bufx + 0.5f;
+		r_region->ymin = (-0.5f * ar->winy - snode->yof) / bufy + 0.5f;
+		r_region->ymax = (0.5f * ar->winy - snode->yof) / bufy + 0.5f;
+		found = true;
+	}
+
+	BKE_image_release_ibuf(ima, ibuf, lock);
+	return found;
+}
+
 /* called by compo, only to check job 'stop' value */
 static int compo_breakjob(void *cjv)
 {
@@ -187,6 +226,7 @@ static void compo_initjob(void *cjv)
 	CompoJob *cj = cjv;
 
 	cj->localtree = ntreeLocalize(cj->ntree);
+	cj->localtree->viewer_region = cj->viewer_region;
 
 	if (cj->recalc_flags)
 		compo_tag_output_nodes(cj->localtree, cj->recalc_flags);
@@ -282,6 +322,9 @@ void ED_node_composite_job(const bContext *C, struct bNodeTree *nodetree, Scene
 	cj->scene = scene;
 	cj->ntree = nodetree;
 	cj->recalc_flags = compo_get_recalc_flags(C);
+	if (!compo_get_viewer_region(C, nodetree, &cj->viewer_region)) {
+		BLI_rctf_init(&cj->viewer_region, 0.0f, 1.0f, 0.0f, 1.0f);
+	}
 
 	/* setup job */
 	WM_jobs_customdata_set(wm_job, cj, compo_freejob);
@@ -475,6 +518,7 @@ void ED_node_composit_default(const bContext *C, struct Scene *sce)
 	sce->nodetree = ntreeAddTree(NULL, "Compositing Nodetree", ntreeType_Composite->idname);
 
 	sce->nodetree->chunksize = 256;
+	sce->nodetree->cache_limit = 1024;
 	sce->nodetree->edit_quality = NTREE_QUALITY_HIGH;
 	sce->nodetree->render_quality = NTREE_QUALITY_HIGH;
 
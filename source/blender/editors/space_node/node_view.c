@@ -187,6 +187,14 @@ void NODE_OT_view_selected(wmOperatorType *ot)
 
 /* **************** Background Image Operators ************** */
 
+/* only the visible part of the viewer is calculated, update it for the new view */
+static void snode_bg_view_changed(bContext *C, SpaceNode *snode)
+{
+	if (snode->nodetree && (snode->nodetree->flag & NTREE_COM_VIEWER_REGION)) {
+		ED_area_tag_refresh(CTX_wm_area(C));
+	}
+}
+
 typedef struct NodeViewMove {
 	int mvalo[2];
 	int xmin, ymin, xmax, ymax;
@@ -221,6 +229,7 @@ static int snode_bg_viewmove_modal(bContext *C, wmOperator *op, const wmEvent *e
 			if (event->val == KM_RELEASE) {
 				MEM_freeN(nvm);
 				op->customdata = NULL;
+				snode_bg_view_changed(C, snode);
 				return OPERATOR_FINISHED;
 			}
 			break;
@@ -299,6 +308,7 @@ static int backimage_zoom_exec(bContext *C, wmOperator *op)
 	snode->zoom *= fac;
 	ED_region_tag_redraw(ar);
 	WM_main_add_notifier(NC_NODE | ND_DISPLAY, NULL);
+	snode_bg_view_changed(C, snode);
 
 	return OPERATOR_FINISHED;
 }
@@ -358,6 +368,7 @@ static int backimage_fit_exec(bContext *C, wmOperator *UNUSED(op))
 
 	ED_region_tag_redraw(ar);
 	WM_main_add_notifier(NC_NODE | ND_DISPLAY, NULL);
+	snode_bg_view_changed(C, snode);
 
 	return OPERATOR_FINISHED;
 }
@@ -38,6 +38,7 @@
 
 
 #include "BKE_context.h"
+#include "BKE_global.h"
 #include "BKE_library.h"
 #include "BKE_main.h"
 #include "BKE_mask.h"
@@ -643,7 +644,14 @@ static bool sequencer_add_draw_check_prop(PointerRNA *UNUSED(ptr), PropertyRNA *
 /* add movie operator */
 static int sequencer_add_movie_strip_exec(bContext *C, wmOperator *op)
 {
-	return sequencer_add_generic_strip_exec(C, op, BKE_sequencer_add_movie_strip);
+	int ret = sequencer_add_generic_strip_exec(C, op, BKE_sequencer_add_movie_strip);
+
+	/* the added strips are selected, build the index used for seeking in their movies */
+	if (ret == OPERATOR_FINISHED && !G.background) {
+		seq_proxy_build_job(C, true);
+	}
+
+	return ret;
 }
 
 static int sequencer_add_movie_strip_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(event))
@@ -926,12 +926,14 @@ ImBuf *sequencer_ibuf_get(
 	 */
 	G.is_break = false;
 
-	if (special_seq_update)
+	if (special_seq_update) {
 		ibuf = BKE_sequencer_give_ibuf_direct(&context, cfra + frame_ofs, special_seq_update);
-	else if (!U.prefetchframes) // XXX || (G.f & G_PLAYANIM) == 0) {
+	}
+	else {
 		ibuf = BKE_sequencer_give_ibuf(&context, cfra + frame_ofs, sseq->chanshown);
-	else
-		ibuf = BKE_sequencer_give_ibuf_threaded(&context, cfra + frame_ofs, sseq->chanshown);
+		/* render the next frames while this one is shown */
+		BKE_sequencer_prefetch_start(&context, cfra + frame_ofs, sseq->chanshown);
+	}
 
 	/* restore state so real rendering would be canceled (if needed) */
 	G.is_break = is_break;
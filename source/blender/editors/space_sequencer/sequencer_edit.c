@@ -30,11 +30,14 @@
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
 #include "BLI_math.h"
+#include "BLI_threads.h"
 #include "BLI_timecode.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
 
+#include "PIL_time.h"
+
 #include "DNA_scene_types.h"
 #include "DNA_sound_types.h"
 
@@ -140,22 +143,110 @@ static void proxy_freejob(void *pjv)
 	MEM_freeN(pj);
 }
 
+/* a strip built by one of the threads of the job */
+typedef struct ProxyJobTask {
+	struct ProxyJobTask *next, *prev;
+
+	struct SeqIndexBuildContext *context;
+	short *stop;
+	short do_update;
+	float progress;
+	/* set by the thread when it is done */
+	bool ready;
+} ProxyJobTask;
+
+static void *proxy_task_run(void *task_v)
+{
+	ProxyJobTask *task = task_v;
+
+	BKE_sequencer_proxy_rebuild(task->context, task->stop, &task->do_update, &task->progress);
+
+	task->progress = 1.0f;
+	task->ready = true;
+
+	return NULL;
+}
+
+/* Strips built at once by the job. Every strip also encodes its proxy sizes on their own threads,
+ * so only a part of the system threads builds strips. */
+static int proxy_job_tot_strip_thread(void)
+{
+	return max_ii(1, BLI_system_thread_count() / 4);
+}
+
+/* The system threads are shared by the decoders of the strips built at once. */
+static int proxy_job_tot_decode_thread(void)
+{
+	return max_ii(1, BLI_system_thread_count() / proxy_job_tot_strip_thread());
+}
+
 /* only this runs inside thread */
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
 	ProxyJob *pj = pjv;
-	LinkData *link;
+	ListBase threads, tasks = {NULL, NULL};
+	LinkData *link, *last_link = NULL;
+	ProxyJobTask *task;
+	const int tot_thread = proxy_job_tot_strip_thread();
+	int tot_running = 0;
+
+	BLI_threadpool_init(&threads, proxy_task_run, tot_thread);
+
+	for (;;) {
+		float tot_progress = 0.0f;
+		int tot_task = 0;
+
+		/* strips can be added to the queue while the job runs */
+		link = last_link ? last_link->next : pj->queue.first;
+
+		if (link && tot_running < tot_thread && !*stop) {
+			task = MEM_callocN(sizeof(ProxyJobTask), "proxy job task");
+			task->context = link->data;
+			task->stop = stop;
+			BLI_addtail(&tasks, task);
+
+			BLI_threadpool_insert(&threads, task);
+			tot_running++;
+			last_link = link;
+			continue;
+		}
+
+		for (task = tasks.first; task; task = task->next) {
+			if (task->ready && task->context) {
+				BLI_threadpool_remove(&threads, task);
+				/* finished, only counts for the progress now */
+				task->context = NULL;
+				tot_running--;
+			}
 
-	for (link = pj->queue.first; link; link = link->next) {
-		struct SeqIndexBuildContext *context = link->data;
+			tot_progress += task->progress;
+			tot_task++;
 
-		BKE_sequencer_proxy_rebuild(context, stop, do_update, progress);
+			if (task->do_update) {
+				task->do_update = false;
+				*do_update = true;
+			}
+		}
 
-		if (*stop) {
-			pj->stop = 1;
-			fprintf(stderr,  "Canceling proxy rebuild on users request...\n");
+		if (tot_running == 0 && (link == NULL || *stop)) {
 			break;
 		}
+
+		/* strips that are not started yet */
+		for (link = last_link->next; link; link = link->next) {
+			tot_task++;
+		}
+		*progress = tot_progress / tot_task;
+
+		PIL_sleep_ms(50);
+	}
+
+	BLI_threadpool_end(&threads);
+	BLI_freelistN(&tasks);
+
+	if (*stop) {
+		pj->stop = 1;
+		fprintf(stderr,  "Canceling proxy rebuild on users request...\n");
 	}
 }
 
@@ -174,21 +265,49 @@ static void proxy_endjob(void *pjv)
 	WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, pj->scene);
 }
 
-static void seq_proxy_build_job(const bContext *C)
+/**
+ * Build proxies and timecode indices of the selected strips in a job.
+ * With \a timecodes_only the record run index of movies is built when missing.
+ */
+void seq_proxy_build_job(const bContext *C, bool timecodes_only)
 {
 	wmJob *wm_job;
 	ProxyJob *pj;
+	Main *bmain = CTX_data_main(C);
 	struct Depsgraph *depsgraph = CTX_data_depsgraph(C);
 	Scene *scene = CTX_data_scene(C);
 	Editing *ed = BKE_sequencer_editing_get(scene, false);
 	ScrArea *sa = CTX_wm_area(C);
 	Sequence *seq;
 	GSet *file_list;
+	ListBase queue = {NULL, NULL};
+	const int tot_decode_thread = proxy_job_tot_decode_thread();
 
 	if (ed == NULL) {
 		return;
 	}
 
+	file_list = BLI_gset_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, "file list");
+	SEQP_BEGIN (ed, seq)
+	{
+		if ((seq->flag & SELECT)) {
+			if (timecodes_only) {
+				BKE_sequencer_timecode_rebuild_context(bmain, depsgraph, scene, seq, file_list, &queue,
+				                                       tot_decode_thread);
+			}
+			else {
+				BKE_sequencer_proxy_rebuild_context(bmain, depsgraph, scene, seq, file_list, &queue,
+				                                    tot_decode_thread);
+			}
+		}
+	} SEQ_END;
+
+	BLI_gset_free(file_list, MEM_freeN);
+
+	if (BLI_listbase_is_empty(&queue)) {
+		return;
+	}
+
 	wm_job = WM_jobs_get(CTX_wm_manager(C), CTX_wm_window(C), sa, "Building Proxies",
 	                     WM_JOB_PROGRESS, WM_JOB_TYPE_SEQ_BUILD_PROXY);
 
@@ -199,22 +318,14 @@ static void seq_proxy_build_job(const bContext *C)
 
 		pj->depsgraph = depsgraph;
 		pj->scene = scene;
-		pj->main = CTX_data_main(C);
+		pj->main = bmain;
 
 		WM_jobs_customdata_set(wm_job, pj, proxy_freejob);
 		WM_jobs_timer(wm_job, 0.1, NC_SCENE | ND_SEQUENCER, NC_SCENE | ND_SEQUENCER);
 		WM_jobs_callbacks(wm_job, proxy_startjob, NULL, NULL, proxy_endjob);
 	}
 
-	file_list = BLI_gset_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, "file list");
-	SEQP_BEGIN (ed, seq)
-	{
-		if ((seq->flag & SELECT)) {
-			BKE_sequencer_proxy_rebuild_context(pj->main, pj->depsgraph, pj->scene, seq, file_list, &pj->queue);
-		}
-	} SEQ_END;
-
-	BLI_gset_free(file_list, MEM_freeN);
+	BLI_movelisttolist(&pj->queue, &queue);
 
 	if (!WM_jobs_is_running(wm_job)) {
 		G.is_break = false;
@@ -3451,7 +3562,7 @@ void SEQUENCER_OT_view_ghost_border(wmOperatorType *ot)
 static int sequencer_rebuild_proxy_invoke(bContext *C, wmOperator *UNUSED(op),
                                           const wmEvent *UNUSED(event))
 {
-	seq_proxy_build_job(C);
+	seq_proxy_build_job(C, false);
 
 	return OPERATOR_FINISHED;
 }
@@ -3479,7 +3590,7 @@ static int sequencer_rebuild_proxy_exec(bContext *C, wmOperator *UNUSED(op))
 			short stop = 0, do_update;
 			float progress;
 
-			BKE_sequencer_proxy_rebuild_context(bmain, depsgraph, scene, seq, file_list, &queue);
+			BKE_sequencer_proxy_rebuild_context(bmain, depsgraph, scene, seq, file_list, &queue, 0);
 
 			for (link = queue.first; link; link = link->next) {
 				struct SeqIndexBuildContext *context = link->data;
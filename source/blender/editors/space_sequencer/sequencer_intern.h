@@ -65,6 +65,7 @@ struct Sequence *find_nearest_seq(struct Scene *scene, struct View2D *v2d, int *
 struct Sequence *find_neighboring_sequence(struct Scene *scene, struct Sequence *test, int lr, int sel);
 void recurs_sel_seq(struct Sequence *seqm);
 int seq_effect_find_selected(struct Scene *scene, struct Sequence *activeseq, int type, struct Sequence **selseq1, struct Sequence **selseq2, struct Sequence **selseq3, const char **error_str);
+void seq_proxy_build_job(const struct bContext *C, bool timecodes_only);
 
 /* operator helpers */
 bool sequencer_edit_poll(struct bContext *C);
@@ -261,10 +261,12 @@ IMB_Proxy_Size IMB_anim_proxy_get_existing(struct anim *anim);
 
 struct IndexBuildContext;
 
-/* prepare context for proxies/imecodes builder */
+/* prepare context for proxies/imecodes builder,
+ * num_threads is the number of threads decoding the movie, 0 for the default */
 struct IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecode_Type tcs_in_use,
                                                          IMB_Proxy_Size proxy_sizes_in_use, int quality,
-                                                         const bool overwite, struct GSet *file_list);
+                                                         const bool overwite, struct GSet *file_list,
+                                                         int num_threads);
 
 /* will rebuild all used indices and proxies at once */
 void IMB_anim_index_rebuild(struct IndexBuildContext *context,
@@ -383,6 +385,17 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum IMB_Resample_Filter {
+	IMB_RESAMPLE_MITCHELL = 0,
+	IMB_RESAMPLE_LANCZOS = 1,
+} IMB_Resample_Filter;
+
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_resampleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, IMB_Resample_Filter filter);
+
 /**
  *
  * \attention Defined in writeimage.c
@@ -44,6 +44,23 @@ void IMB_moviecache_destruct(void);
 
 struct MovieCache *IMB_moviecache_create(const char *name, int keysize, GHashHashFP hashfp, GHashCmpFP cmpfp);
 void IMB_moviecache_set_getdata_callback(struct MovieCache *cache, MovieCacheGetKeyDataFP getdatafp);
+/* priority of a cache relative to other caches, items of lower priority caches are freed first */
+enum {
+	IMB_MOVIECACHE_PRIORITY_LOW    = -1,
+	IMB_MOVIECACHE_PRIORITY_NORMAL =  0,
+	IMB_MOVIECACHE_PRIORITY_HIGH   =  1,
+};
+
+void IMB_moviecache_set_cache_priority(struct MovieCache *cache, int priority);
+/* Write pixels of buffers freed by the memory limit to the temp directory instead of dropping them,
+ * iterators and the cleanup callback get NULL buffers for items which are on disk. */
+void IMB_moviecache_set_disk_spill(struct MovieCache *cache, bool use_disk_spill);
+void IMB_moviecache_set_disk_limit(size_t limit);
+/* Putting and getting buffers writes the ones the memory limit freed to disk. Owners which call
+ * those with a lock of their own held defer this and call IMB_moviecache_spill_flush after
+ * releasing it, so other threads don't wait on the disk. */
+void IMB_moviecache_set_defer_spill_flush(struct MovieCache *cache, bool defer_spill_flush);
+void IMB_moviecache_spill_flush(void);
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
                                           MovieCachePriorityDeleterFP prioritydeleterfp);
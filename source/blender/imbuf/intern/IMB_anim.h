@@ -81,10 +81,25 @@
 
 #define MAXNUMSTREAMS       50
 
+/* decoded frames kept per movie for seeking back */
+#define FFMPEG_FRAME_WINDOW_MAX     16
+/* decoder threads per movie, more don't speed up decoding */
+#define FFMPEG_DECODE_THREADS_MAX   16
+
 struct IDProperty;
 struct _AviMovie;
 struct anim_index;
 
+#ifdef WITH_FFMPEG
+struct anim_frame {
+	/* converted frame, or NULL when it was only decoded while scanning */
+	struct ImBuf *ibuf;
+	/* decoded frame, converted on the first fetch */
+	struct AVFrame *frame;
+	int64_t pts;
+};
+#endif
+
 struct anim {
 	int ib_flags;
 	int curtype;
@@ -137,6 +152,12 @@ struct anim {
 	int64_t last_pts;
 	int64_t next_pts;
 	AVPacket next_packet;
+
+	/* ring buffer of recently decoded frames, the decoder itself stays at curposition */
+	struct anim_frame frame_window[FFMPEG_FRAME_WINDOW_MAX];
+	int frame_window_size;
+	int frame_window_len;
+	int frame_window_oldest;
 #endif
 
 	char index_dir[768];
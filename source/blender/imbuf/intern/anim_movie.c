@@ -54,8 +54,10 @@
 #endif
 
 #include "BLI_utildefines.h"
+#include "BLI_math_base.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -459,6 +461,9 @@ static ImBuf *avi_fetchibuf(struct anim *anim, int position)
 
 #ifdef WITH_FFMPEG
 
+/* memory used for the decoded frame window of a movie */
+#define FFMPEG_FRAME_WINDOW_MEMORY (128 * 1024 * 1024)
+
 BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
 {
 	return (anim->x & 31) != 0;
@@ -528,6 +533,10 @@ static int startffmpeg(struct anim *anim)
 
 	pCodecCtx->workaround_bugs = 1;
 
+	/* decode several frames at once for codecs supporting it, slices of a frame otherwise */
+	pCodecCtx->thread_count = min_ii(BLI_system_thread_count(), FFMPEG_DECODE_THREADS_MAX);
+	pCodecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
 	if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
 		avformat_close_input(&pFormatCtx);
 		return -1;
@@ -581,6 +590,10 @@ static int startffmpeg(struct anim *anim)
 	anim->next_pts = -1;
 	anim->next_packet.stream_index = -1;
 
+	anim->frame_window_size = min_ii(FFMPEG_FRAME_WINDOW_MAX, (int)(FFMPEG_FRAME_WINDOW_MEMORY / anim->framesize));
+	anim->frame_window_len = 0;
+	anim->frame_window_oldest = 0;
+
 	anim->pFrame = av_frame_alloc();
 	anim->pFrameComplete = false;
 	anim->pFrameDeinterlaced = av_frame_alloc();
@@ -680,22 +693,17 @@ static int startffmpeg(struct anim *anim)
 	return (0);
 }
 
-/* postprocess the image in anim->pFrame and do color conversion
+/* postprocess the decoded image in frame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf, returns false when there was no frame to convert
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static bool ffmpeg_postprocess_frame(struct anim *anim, AVFrame *frame, ImBuf *ibuf)
 {
-	AVFrame *input = anim->pFrame;
-	ImBuf *ibuf = anim->last_frame;
+	AVFrame *input = frame;
 	int filter_y = 0;
 
-	if (!anim->pFrameComplete) {
-		return;
-	}
-
 	/* This means the data wasnt read properly,
 	 * this check stops crashing */
 	if (input->data[0] == 0 && input->data[1] == 0 &&
@@ -703,11 +711,11 @@ static void ffmpeg_postprocess(struct anim *anim)
 	{
 		fprintf(stderr, "ffmpeg_fetchibuf: "
 		        "data not read properly...\n");
-		return;
+		return false;
 	}
 
 	av_log(anim->pFormatCtx, AV_LOG_DEBUG,
-	       "  POSTPROC: anim->pFrame planes: %p %p %p %p\n",
+	       "  POSTPROC: frame planes: %p %p %p %p\n",
 	       input->data[0], input->data[1], input->data[2],
 	       input->data[3]);
 
@@ -717,7 +725,7 @@ static void ffmpeg_postprocess(struct anim *anim)
 		        (AVPicture *)
 		        anim->pFrameDeinterlaced,
 		        (const AVPicture *)
-		        anim->pFrame,
+		        frame,
 		        anim->pCodecCtx->pix_fmt,
 		        anim->pCodecCtx->width,
 		        anim->pCodecCtx->height) < 0)
@@ -811,6 +819,167 @@ static void ffmpeg_postprocess(struct anim *anim)
 	if (filter_y) {
 		IMB_filtery(ibuf);
 	}
+
+	return true;
+}
+
+/* postprocess the image in anim->pFrame */
+static bool ffmpeg_postprocess(struct anim *anim, ImBuf *ibuf)
+{
+	if (!anim->pFrameComplete) {
+		return false;
+	}
+
+	return ffmpeg_postprocess_frame(anim, anim->pFrame, ibuf);
+}
+
+/* ******** Decoded frame window ******** */
+
+/* Frames decoded while scanning towards a seek target and the fetched frames are kept,
+ * so scrubbing backwards within the window doesn't seek and decode the GOP again.
+ * Scanned frames are only converted to RGBA when they are fetched. */
+
+static void ffmpeg_frame_window_free_decoded(struct anim_frame *frame)
+{
+	if (frame->frame) {
+		MEM_freeN(frame->frame->data[0]);
+		av_frame_free(&frame->frame);
+	}
+}
+
+static void ffmpeg_frame_window_clear(struct anim_frame *frame)
+{
+	if (frame->ibuf) {
+		IMB_freeImBuf(frame->ibuf);
+		frame->ibuf = NULL;
+	}
+	ffmpeg_frame_window_free_decoded(frame);
+}
+
+/* The decoder reuses the buffers of anim->pFrame, the planes are copied. */
+static AVFrame *ffmpeg_frame_window_copy_decoded(struct anim *anim)
+{
+	AVCodecContext *codec_ctx = anim->pCodecCtx;
+	AVFrame *frame = av_frame_alloc();
+
+	if (frame == NULL) {
+		return NULL;
+	}
+
+	avpicture_fill((AVPicture *)frame,
+	               MEM_mallocN(avpicture_get_size(codec_ctx->pix_fmt, codec_ctx->width, codec_ctx->height),
+	                           "ffmpeg frame window"),
+	               codec_ctx->pix_fmt, codec_ctx->width, codec_ctx->height);
+	av_picture_copy((AVPicture *)frame, (const AVPicture *)anim->pFrame,
+	                codec_ctx->pix_fmt, codec_ctx->width, codec_ctx->height);
+
+	return frame;
+}
+
+/* The cleared entry for pts, replacing the oldest one when the window is full. */
+static struct anim_frame *ffmpeg_frame_window_entry(struct anim *anim, int64_t pts)
+{
+	struct anim_frame *frame = NULL;
+	int i;
+
+	if (anim->frame_window_size == 0) {
+		return NULL;
+	}
+
+	/* decoded again after a seek */
+	for (i = 0; i < anim->frame_window_len; i++) {
+		if (anim->frame_window[i].pts == pts) {
+			frame = &anim->frame_window[i];
+			break;
+		}
+	}
+
+	if (frame == NULL) {
+		if (anim->frame_window_len < anim->frame_window_size) {
+			frame = &anim->frame_window[anim->frame_window_len++];
+		}
+		else {
+			frame = &anim->frame_window[anim->frame_window_oldest];
+			anim->frame_window_oldest = (anim->frame_window_oldest + 1) % anim->frame_window_size;
+		}
+	}
+
+	ffmpeg_frame_window_clear(frame);
+	frame->pts = pts;
+
+	return frame;
+}
+
+static void ffmpeg_frame_window_add(struct anim *anim, ImBuf *ibuf, int64_t pts)
+{
+	struct anim_frame *frame = ffmpeg_frame_window_entry(anim, pts);
+
+	/* the fetched buffer is handed out, callers may change it */
+	if (frame) {
+		frame->ibuf = IMB_dupImBuf(ibuf);
+	}
+}
+
+/* The frame scanning to pts_to_search would return: the first one presented at or after it. */
+static ImBuf *ffmpeg_frame_window_find(struct anim *anim, int64_t pts_to_search, double pts_step)
+{
+	int i;
+
+	for (i = 0; i < anim->frame_window_len; i++) {
+		struct anim_frame *frame = &anim->frame_window[i];
+
+		if (frame->ibuf == NULL && frame->frame == NULL) {
+			continue;
+		}
+
+		if (frame->pts >= pts_to_search && frame->pts - pts_to_search < pts_step) {
+			if (frame->ibuf == NULL) {
+				frame->ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+				frame->ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+
+				if (!ffmpeg_postprocess_frame(anim, frame->frame, frame->ibuf)) {
+					ffmpeg_frame_window_clear(frame);
+					return NULL;
+				}
+
+				ffmpeg_frame_window_free_decoded(frame);
+			}
+
+			/* a copy, so changes of the caller don't show up when the frame is fetched again */
+			return IMB_dupImBuf(frame->ibuf);
+		}
+	}
+
+	return NULL;
+}
+
+static void ffmpeg_frame_window_free(struct anim *anim)
+{
+	int i;
+
+	for (i = 0; i < anim->frame_window_len; i++) {
+		ffmpeg_frame_window_clear(&anim->frame_window[i]);
+	}
+
+	anim->frame_window_len = 0;
+	anim->frame_window_oldest = 0;
+}
+
+/* Keep the frame in anim->pFrame when it is close enough to the frame being searched. */
+static void ffmpeg_frame_window_add_decoded(struct anim *anim, int64_t pts_to_search, double pts_step)
+{
+	struct anim_frame *frame;
+
+	if (!anim->pFrameComplete || anim->next_pts == -1 ||
+	    pts_to_search - anim->next_pts >= anim->frame_window_size * pts_step)
+	{
+		return;
+	}
+
+	frame = ffmpeg_frame_window_entry(anim, anim->next_pts);
+	if (frame) {
+		frame->frame = ffmpeg_frame_window_copy_decoded(anim);
+	}
 }
 
 /* decode one video frame also considering the packet read into next_packet */
@@ -917,7 +1086,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 }
 
 static void ffmpeg_decode_video_frame_scan(
-        struct anim *anim, int64_t pts_to_search)
+        struct anim *anim, int64_t pts_to_search, double pts_step)
 {
 	/* there seem to exist *very* silly GOP lengths out in the wild... */
 	int count = 1000;
@@ -932,6 +1101,7 @@ static void ffmpeg_decode_video_frame_scan(
 		       AV_LOG_DEBUG,
 		       "  WHILE: pts=%lld in search of %lld\n",
 		       (long long int)anim->next_pts, (long long int)pts_to_search);
+		ffmpeg_frame_window_add_decoded(anim, pts_to_search, pts_step);
 		if (!ffmpeg_decode_video_frame(anim)) {
 			break;
 		}
@@ -1000,9 +1170,12 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	int64_t pts_to_search = 0;
 	double frame_rate;
 	double pts_time_base;
+	double pts_step;
 	long long st_time;
 	struct anim_index *tc_index = 0;
+	struct anim_index *seek_index = 0;
 	AVStream *v_st;
+	ImBuf *ibuf;
 	int new_frame_index = 0; /* To quiet gcc barking... */
 	int old_frame_index = 0; /* To quiet gcc barking... */
 
@@ -1020,6 +1193,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 
 	st_time = anim->pFormatCtx->start_time;
 	pts_time_base = av_q2d(v_st->time_base);
+	pts_step = 1.0 / (pts_time_base * frame_rate);
 
 	if (tc_index) {
 		new_frame_index = IMB_indexer_get_frame_index(
@@ -1028,6 +1202,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		        tc_index, anim->curposition);
 		pts_to_search = IMB_indexer_get_pts(
 		        tc_index, new_frame_index);
+		seek_index = tc_index;
 	}
 	else {
 		pts_to_search = (long long)
@@ -1037,6 +1212,19 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		if (st_time != AV_NOPTS_VALUE) {
 			pts_to_search += st_time / pts_time_base / AV_TIME_BASE;
 		}
+
+		/* the record run index has the seek position of every frame,
+		 * use it when it was built instead of guessing with preseek */
+		seek_index = IMB_anim_open_index(anim, IMB_TC_RECORD_RUN);
+		if (seek_index && seek_index->num_entries > 0) {
+			new_frame_index = IMB_indexer_get_frame_index_from_pts(
+			        seek_index, pts_to_search);
+			old_frame_index = IMB_indexer_get_frame_index_from_pts(
+			        seek_index, anim->last_pts);
+		}
+		else {
+			seek_index = NULL;
+		}
 	}
 
 	av_log(anim->pFormatCtx, AV_LOG_DEBUG,
@@ -1056,37 +1244,46 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		return anim->last_frame;
 	}
 
+	/* decoded before, the decoder stays where it is */
+	ibuf = ffmpeg_frame_window_find(anim, pts_to_search, pts_step);
+	if (ibuf) {
+		av_log(anim->pFormatCtx, AV_LOG_DEBUG,
+		       "FETCH: frame window hit: pts=%lld\n",
+		       (long long int)pts_to_search);
+		return ibuf;
+	}
+
 	if (position > anim->curposition + 1 &&
 	    anim->preseek &&
-	    !tc_index &&
+	    !seek_index &&
 	    position - (anim->curposition + 1) < anim->preseek)
 	{
 		av_log(anim->pFormatCtx, AV_LOG_DEBUG,
 		       "FETCH: within preseek interval (no index)\n");
 
-		ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+		ffmpeg_decode_video_frame_scan(anim, pts_to_search, pts_step);
 	}
-	else if (tc_index &&
-	         IMB_indexer_can_scan(tc_index, old_frame_index,
+	else if (seek_index &&
+	         IMB_indexer_can_scan(seek_index, old_frame_index,
 	                              new_frame_index))
 	{
 		av_log(anim->pFormatCtx, AV_LOG_DEBUG,
 		       "FETCH: within preseek interval "
 		       "(index tells us)\n");
 
-		ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+		ffmpeg_decode_video_frame_scan(anim, pts_to_search, pts_step);
 	}
 	else if (position != anim->curposition + 1) {
 		long long pos;
 		int ret;
 
-		if (tc_index) {
+		if (seek_index) {
 			unsigned long long dts;
 
 			pos = IMB_indexer_get_seek_pos(
-			    tc_index, new_frame_index);
+			    seek_index, new_frame_index);
 			dts = IMB_indexer_get_seek_pos_dts(
-			    tc_index, new_frame_index);
+			    seek_index, new_frame_index);
 
 			av_log(anim->pFormatCtx, AV_LOG_DEBUG,
 			       "TC INDEX seek pos = %lld\n", pos);
@@ -1153,7 +1350,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		/* memset(anim->pFrame, ...) ?? */
 
 		if (ret >= 0) {
-			ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+			ffmpeg_decode_video_frame_scan(anim, pts_to_search, pts_step);
 		}
 	}
 	else if (position == 0 && anim->curposition == -1) {
@@ -1169,7 +1366,9 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
 	anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
 
-	ffmpeg_postprocess(anim);
+	if (ffmpeg_postprocess(anim, anim->last_frame)) {
+		ffmpeg_frame_window_add(anim, anim->last_frame, anim->next_pts);
+	}
 
 	anim->last_pts = anim->next_pts;
 
@@ -1213,6 +1412,7 @@ static void free_anim_ffmpeg(struct anim *anim)
 
 		sws_freeContext(anim->img_convert_ctx);
 		IMB_freeImBuf(anim->last_frame);
+		ffmpeg_frame_window_free(anim);
 		if (anim->next_packet.stream_index != -1) {
 			av_free_packet(&anim->next_packet);
 		}
@@ -1357,9 +1557,8 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim, int position,
 #endif
 #ifdef WITH_FFMPEG
 		case ANIM_FFMPEG:
+			/* sets curposition to the frame the decoder is at */
 			ibuf = ffmpeg_fetchibuf(anim, position, tc);
-			if (ibuf)
-				anim->curposition = position;
 			filter_y = 0; /* done internally */
 			break;
 #endif
@@ -1367,7 +1566,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim, int position,
 
 	if (ibuf) {
 		if (filter_y) IMB_filtery(ibuf);
-		BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+		BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
 
 	}
 	return(ibuf);
@@ -47,6 +47,7 @@
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_rect.h"
+#include "BLI_task.h"
 
 #include "BKE_appdir.h"
 #include "BKE_colortools.h"
@@ -59,6 +60,10 @@
 
 #include <ocio_capi.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /*********************** Global declarations *************************/
 
 #define DISPLAY_BUFFER_CHANNELS 4
@@ -95,12 +100,18 @@ static float imbuf_linear_srgb_to_xyz[3][3] = {{0.0f}};
  */
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
+typedef struct DisplayLUT DisplayLUT;
+
 typedef struct ColormanageProcessor {
 	OCIO_ConstProcessorRcPtr *processor;
 	CurveMapping *curve_mapping;
 	bool is_data_result;
+	/* baked processor, used instead of the OCIO processor when set */
+	DisplayLUT *display_lut;
 } ColormanageProcessor;
 
+static void display_lut_free_cached(void);
+
 static struct global_glsl_state {
 	/* Actual processor used for GLSL baked LUTs. */
 	OCIO_ConstProcessorRcPtr *processor;
@@ -274,6 +285,8 @@ static struct MovieCache *colormanage_moviecache_ensure(ImBuf *ibuf)
 
 		moviecache = IMB_moviecache_create("colormanage cache", sizeof(ColormanageCacheKey),
 		                                   colormanage_hashhash, colormanage_hashcmp);
+		/* display buffers are cheap to recompute from the buffer they belong to */
+		IMB_moviecache_set_cache_priority(moviecache, IMB_MOVIECACHE_PRIORITY_LOW);
 
 		ibuf->colormanage_cache->moviecache = moviecache;
 	}
@@ -613,6 +626,8 @@ static void colormanage_free_config(void)
 	BLI_freelistN(&global_looks);
 	global_tot_looks = 0;
 
+	display_lut_free_cached();
+
 	OCIO_exit();
 }
 
@@ -1267,6 +1282,254 @@ const char *IMB_colormanagement_get_rect_colorspace(ImBuf *ibuf)
 	}
 }
 
+/*********************** Baked display transform routines *************************/
+
+/* Display transforms of large buffers are done with a 3D LUT baked from the OCIO processor,
+ * like the GLSL display path does. The LUT is sampled in a log2 shaper space so both dark
+ * values and highlights get enough resolution. It's only used when the result is converted
+ * to bytes, where the interpolation error is at most one or two quantization steps. */
+
+#define DISPLAY_LUT_SIZE 64
+/* shaper(x) = log2(x / DISPLAY_LUT_SHAPER_OFFSET + 1), normalized to the range up to DISPLAY_LUT_SHAPER_MAX */
+#define DISPLAY_LUT_SHAPER_OFFSET (1.0f / 1024.0f)
+#define DISPLAY_LUT_SHAPER_MAX 1024.0f
+/* buffers smaller than this are faster to transform with the OCIO processor directly */
+#define DISPLAY_LUT_MIN_PIXELS (512 * 512)
+
+struct DisplayLUT {
+	int users;
+
+	/* settings of the baked processor for comparison */
+	char look[MAX_COLORSPACE_NAME];
+	char view[MAX_COLORSPACE_NAME];
+	char display[MAX_COLORSPACE_NAME];
+	float exposure, gamma;
+
+	float shaper_scale;
+	/* RGB and padding, so an entry can be loaded at once */
+	float (*table)[4];
+};
+
+/* LUT of the last used view settings, protected by processor_lock */
+static DisplayLUT *global_display_lut = NULL;
+
+typedef struct DisplayLUTBakeData {
+	DisplayLUT *lut;
+	OCIO_ConstProcessorRcPtr *processor;
+} DisplayLUTBakeData;
+
+BLI_INLINE float display_lut_shaper(const DisplayLUT *lut, float value)
+{
+	/* also catches NaN */
+	if (!(value > 0.0f)) {
+		return 0.0f;
+	}
+	const float coord = log2f(value * (1.0f / DISPLAY_LUT_SHAPER_OFFSET) + 1.0f) * lut->shaper_scale;
+	return min_ff(coord, (float)(DISPLAY_LUT_SIZE - 1));
+}
+
+static void display_lut_bake_slice(void *__restrict userdata,
+                                   const int z,
+                                   const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	DisplayLUTBakeData *data = userdata;
+	DisplayLUT *lut = data->lut;
+	const int size = DISPLAY_LUT_SIZE;
+	float (*slice)[4] = lut->table + (size_t)z * size * size;
+	float values[DISPLAY_LUT_SIZE];
+	OCIO_PackedImageDesc *img;
+
+	/* inverse of the shaper at the grid points */
+	for (int i = 0; i < size; i++) {
+		values[i] = (exp2f(i / lut->shaper_scale) - 1.0f) * DISPLAY_LUT_SHAPER_OFFSET;
+	}
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			float *entry = slice[y * size + x];
+			entry[0] = values[x];
+			entry[1] = values[y];
+			entry[2] = values[z];
+			entry[3] = 1.0f;
+		}
+	}
+
+	img = OCIO_createOCIO_PackedImageDesc((float *)slice, size, size, 4, sizeof(float),
+	                                      4 * sizeof(float), 4 * sizeof(float) * size);
+	OCIO_processorApply(data->processor, img);
+	OCIO_PackedImageDescRelease(img);
+}
+
+/* call with processor_lock locked */
+static void display_lut_unref(DisplayLUT *lut)
+{
+	lut->users--;
+	if (lut->users == 0) {
+		MEM_freeN(lut->table);
+		MEM_freeN(lut);
+	}
+}
+
+static void display_lut_release(DisplayLUT *lut)
+{
+	BLI_mutex_lock(&processor_lock);
+	display_lut_unref(lut);
+	BLI_mutex_unlock(&processor_lock);
+}
+
+static void display_lut_free_cached(void)
+{
+	if (global_display_lut) {
+		display_lut_release(global_display_lut);
+		global_display_lut = NULL;
+	}
+}
+
+/* Get the LUT of the display processor, baking it when the view settings changed
+ * and allow_bake is set. */
+static DisplayLUT *display_lut_acquire(OCIO_ConstProcessorRcPtr *processor,
+                                       const ColorManagedViewSettings *view_settings,
+                                       const ColorManagedDisplaySettings *display_settings,
+                                       bool allow_bake)
+{
+	DisplayLUT *lut;
+
+	BLI_mutex_lock(&processor_lock);
+
+	lut = global_display_lut;
+	if (lut == NULL ||
+	    !STREQ(lut->look, view_settings->look) ||
+	    !STREQ(lut->view, view_settings->view_transform) ||
+	    !STREQ(lut->display, display_settings->display_device) ||
+	    lut->exposure != view_settings->exposure ||
+	    lut->gamma != view_settings->gamma)
+	{
+		const int size = DISPLAY_LUT_SIZE;
+		DisplayLUTBakeData data;
+		ParallelRangeSettings settings;
+
+		if (!allow_bake) {
+			BLI_mutex_unlock(&processor_lock);
+			return NULL;
+		}
+
+		if (lut) {
+			display_lut_unref(lut);
+		}
+
+		lut = MEM_callocN(sizeof(DisplayLUT), "display transform LUT");
+		lut->users = 1;
+		STRNCPY(lut->look, view_settings->look);
+		STRNCPY(lut->view, view_settings->view_transform);
+		STRNCPY(lut->display, display_settings->display_device);
+		lut->exposure = view_settings->exposure;
+		lut->gamma = view_settings->gamma;
+		lut->shaper_scale = (size - 1) / log2f(DISPLAY_LUT_SHAPER_MAX / DISPLAY_LUT_SHAPER_OFFSET + 1.0f);
+		lut->table = MEM_mallocN_aligned(sizeof(float[4]) * size * size * size, 16, "display transform LUT table");
+
+		data.lut = lut;
+		data.processor = processor;
+		BLI_parallel_range_settings_defaults(&settings);
+		BLI_task_parallel_range(0, size, &data, display_lut_bake_slice, &settings);
+
+		global_display_lut = lut;
+	}
+
+	lut->users++;
+
+	BLI_mutex_unlock(&processor_lock);
+
+	return lut;
+}
+
+BLI_INLINE void display_lut_apply_v3(const DisplayLUT *lut, float pixel[3])
+{
+	const int size = DISPLAY_LUT_SIZE;
+	const size_t stride_y = size;
+	const size_t stride_z = (size_t)size * size;
+	float frac[3];
+	int index[3];
+
+	for (int i = 0; i < 3; i++) {
+		const float coord = display_lut_shaper(lut, pixel[i]);
+		index[i] = min_ii((int)coord, size - 2);
+		frac[i] = coord - index[i];
+	}
+
+	const float (*p)[4] = (const float (*)[4])lut->table +
+	                      index[2] * stride_z + index[1] * stride_y + index[0];
+
+#ifdef __SSE2__
+	/* trilinear interpolation of all channels at once */
+	const __m128 fx = _mm_set1_ps(frac[0]);
+	const __m128 fy = _mm_set1_ps(frac[1]);
+	const __m128 fz = _mm_set1_ps(frac[2]);
+#  define LERP(a, b, f) _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f))
+	const __m128 c00 = LERP(_mm_load_ps(p[0]), _mm_load_ps(p[1]), fx);
+	const __m128 c10 = LERP(_mm_load_ps(p[stride_y]), _mm_load_ps(p[stride_y + 1]), fx);
+	const __m128 c01 = LERP(_mm_load_ps(p[stride_z]), _mm_load_ps(p[stride_z + 1]), fx);
+	const __m128 c11 = LERP(_mm_load_ps(p[stride_z + stride_y]), _mm_load_ps(p[stride_z + stride_y + 1]), fx);
+	const __m128 c0 = LERP(c00, c10, fy);
+	const __m128 c1 = LERP(c01, c11, fy);
+	float result[4];
+	_mm_storeu_ps(result, LERP(c0, c1, fz));
+#  undef LERP
+	copy_v3_v3(pixel, result);
+#else
+	for (int i = 0; i < 3; i++) {
+		const float c00 = interpf(p[1][i], p[0][i], frac[0]);
+		const float c10 = interpf(p[stride_y + 1][i], p[stride_y][i], frac[0]);
+		const float c01 = interpf(p[stride_z + 1][i], p[stride_z][i], frac[0]);
+		const float c11 = interpf(p[stride_z + stride_y + 1][i], p[stride_z + stride_y][i], frac[0]);
+		pixel[i] = interpf(interpf(c11, c01, frac[1]), interpf(c10, c00, frac[1]), frac[2]);
+	}
+#endif
+}
+
+/* same alpha handling as OCIO_processorApplyRGBA_predivide */
+BLI_INLINE void display_lut_apply_v4_predivide(const DisplayLUT *lut, float pixel[4])
+{
+	if (pixel[3] == 1.0f || pixel[3] == 0.0f) {
+		display_lut_apply_v3(lut, pixel);
+	}
+	else {
+		const float alpha = pixel[3];
+		mul_v3_fl(pixel, 1.0f / alpha);
+		display_lut_apply_v3(lut, pixel);
+		mul_v3_fl(pixel, alpha);
+	}
+}
+
+static void display_lut_apply(const DisplayLUT *lut, float *buffer, int width, int height,
+                              int channels, bool predivide)
+{
+	const size_t i_last = ((size_t)width) * height;
+	size_t i;
+	float *fp;
+
+	for (i = 0, fp = buffer; i != i_last; i++, fp += channels) {
+		if (predivide && channels == 4) {
+			display_lut_apply_v4_predivide(lut, fp);
+		}
+		else {
+			display_lut_apply_v3(lut, fp);
+		}
+	}
+}
+
+/* Use a baked LUT for the display processor, a new LUT is only baked when it's
+ * applied to enough pixels. */
+static void display_processor_use_lut(ColormanageProcessor *cm_processor,
+                                      const ColorManagedViewSettings *view_settings,
+                                      const ColorManagedDisplaySettings *display_settings,
+                                      size_t num_pixels)
+{
+	if (cm_processor->processor && view_settings) {
+		cm_processor->display_lut = display_lut_acquire(cm_processor->processor, view_settings, display_settings,
+		                                                num_pixels >= DISPLAY_LUT_MIN_PIXELS);
+	}
+}
+
 /*********************** Threaded display buffer transform routines *************************/
 
 typedef struct DisplayBufferThread {
@@ -1556,7 +1819,8 @@ static bool is_ibuf_rect_in_display_space(ImBuf *ibuf, const ColorManagedViewSet
 
 static void colormanage_display_buffer_process_ex(ImBuf *ibuf, float *display_buffer, unsigned char *display_buffer_byte,
                                                   const ColorManagedViewSettings *view_settings,
-                                                  const ColorManagedDisplaySettings *display_settings)
+                                                  const ColorManagedDisplaySettings *display_settings,
+                                                  bool use_lut)
 {
 	ColormanageProcessor *cm_processor = NULL;
 	bool skip_transform = false;
@@ -1570,9 +1834,16 @@ static void colormanage_display_buffer_process_ex(ImBuf *ibuf, float *display_bu
 		skip_transform = is_ibuf_rect_in_display_space(ibuf, view_settings, display_settings);
 	}
 
-	if (skip_transform == false)
+	if (skip_transform == false) {
 		cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
 
+		/* the interpolation error of the LUT is only hidden by byte quantization of the
+		 * display buffer, images which are written to disk always use the exact transform */
+		if (use_lut) {
+			display_processor_use_lut(cm_processor, view_settings, display_settings, (size_t)ibuf->x * ibuf->y);
+		}
+	}
+
 	display_buffer_apply_threaded(ibuf, ibuf->rect_float, (unsigned char *) ibuf->rect,
 	                              display_buffer, display_buffer_byte, cm_processor);
 
@@ -1584,7 +1855,7 @@ static void colormanage_display_buffer_process(ImBuf *ibuf, unsigned char *displ
                                                const ColorManagedViewSettings *view_settings,
                                                const ColorManagedDisplaySettings *display_settings)
 {
-	colormanage_display_buffer_process_ex(ibuf, NULL, display_buffer, view_settings, display_settings);
+	colormanage_display_buffer_process_ex(ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /*********************** Threaded processor transform routines *************************/
@@ -2051,7 +2322,7 @@ static void colormanagement_imbuf_make_display_space(ImBuf *ibuf, const ColorMan
 		imb_addrectImBuf(ibuf);
 
 	colormanage_display_buffer_process_ex(ibuf, ibuf->rect_float, (unsigned char *)ibuf->rect,
-	                                      view_settings, display_settings);
+	                                      view_settings, display_settings, false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(ImBuf *ibuf, const ColorManagedViewSettings *view_settings,
@@ -3125,6 +3396,8 @@ static void imb_partial_display_buffer_update_ex(ImBuf *ibuf,
 		if (!skip_transform) {
 			cm_processor = IMB_colormanagement_display_processor_new(
 			        view_settings, display_settings);
+			display_processor_use_lut(cm_processor, view_settings, display_settings,
+			                          (size_t)(xmax - xmin) * (ymax - ymin));
 		}
 
 		if (do_threads) {
@@ -3319,7 +3592,16 @@ void IMB_colormanagement_processor_apply_v3(ColormanageProcessor *cm_processor,
 
 void IMB_colormanagement_processor_apply_pixel(struct ColormanageProcessor *cm_processor, float *pixel, int channels)
 {
-	if (channels == 4) {
+	if (cm_processor->display_lut && channels >= 3) {
+		if (cm_processor->curve_mapping)
+			curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
+
+		if (channels == 4)
+			display_lut_apply_v4_predivide(cm_processor->display_lut, pixel);
+		else
+			display_lut_apply_v3(cm_processor->display_lut, pixel);
+	}
+	else if (channels == 4) {
 		IMB_colormanagement_processor_apply_v4_predivide(cm_processor, pixel);
 	}
 	else if (channels == 3) {
@@ -3351,7 +3633,10 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor, flo
 		}
 	}
 
-	if (cm_processor->processor && channels >= 3) {
+	if (cm_processor->display_lut && channels >= 3) {
+		display_lut_apply(cm_processor->display_lut, buffer, width, height, channels, predivide);
+	}
+	else if (cm_processor->processor && channels >= 3) {
 		OCIO_PackedImageDesc *img;
 
 		/* apply OCIO processor */
@@ -3394,6 +3679,8 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
 		curvemapping_free(cm_processor->curve_mapping);
 	if (cm_processor->processor)
 		OCIO_processorRelease(cm_processor->processor);
+	if (cm_processor->display_lut)
+		display_lut_release(cm_processor->display_lut);
 
 	MEM_freeN(cm_processor);
 }
@@ -29,6 +29,8 @@
 #include "BLI_string.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_math_base.h"
+#include "BLI_threads.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -52,12 +54,10 @@ static const int proxy_sizes[] = { IMB_PROXY_25, IMB_PROXY_50, IMB_PROXY_75,
 	                         IMB_PROXY_100 };
 static const float proxy_fac[] = { 0.25, 0.50, 0.75, 1.00 };
 
-#ifdef WITH_FFMPEG
 static int tc_types[] = {IMB_TC_RECORD_RUN,
                          IMB_TC_FREE_RUN,
                          IMB_TC_INTERPOLATED_REC_DATE_FREE_RUN,
                          IMB_TC_RECORD_RUN_NO_GAPS};
-#endif
 
 #define INDEX_FILE_VERSION 1
 
@@ -275,6 +275,36 @@ int IMB_indexer_get_frame_index(struct anim_index *idx, int frameno)
 	}
 }
 
+/* First frame presented at or after pts, the entries are ordered by pts. */
+int IMB_indexer_get_frame_index_from_pts(struct anim_index *idx,
+                                         unsigned long long pts)
+{
+	int len = idx->num_entries;
+	int half;
+	int middle;
+	int first = 0;
+
+	while (len > 0) {
+		half = len >> 1;
+		middle = first + half;
+
+		if (idx->entries[middle].pts < pts) {
+			first = middle + 1;
+			len = len - half - 1;
+		}
+		else {
+			len = half;
+		}
+	}
+
+	if (first == idx->num_entries) {
+		return idx->num_entries - 1;
+	}
+	else {
+		return first;
+	}
+}
+
 unsigned long long IMB_indexer_get_pts(struct anim_index *idx,
                                        int frame_index)
 {
@@ -452,6 +482,8 @@ struct proxy_output_ctx {
 	int proxy_size;
 	int orig_height;
 	struct anim *anim;
+	/* frames to encode, see proxy_output_thread */
+	ThreadQueue *queue;
 };
 
 // work around stupid swscaler 16 bytes alignment bug...
@@ -715,18 +747,183 @@ typedef struct FFmpegIndexBuilderContext {
 	double pts_time_base;
 	int frameno, frameno_gapless;
 	int start_pts_set;
+
+	/* every proxy output encodes on its own thread */
+	ListBase proxy_threads;
+	int num_proxy_threads;
+	/* decoded frames not encoded by all outputs yet */
+	ThreadMutex proxy_frames_lock;
+	ThreadCondition proxy_frames_cond;
+	int proxy_frames_queued;
 } FFmpegIndexBuilderContext;
 
+/* ----------------------------------------------------------------------
+ * - proxy encoding threads
+ *
+ * The building thread decodes the movie and hands a copy of every frame
+ * to all proxy outputs, which scale and encode it on their own thread.
+ * ---------------------------------------------------------------------- */
+
+/* decoded frames waiting for the slowest output */
+#define PROXY_FRAMES_MAX 8
+
+/* frame shared by the proxy outputs, freed by the last one encoding it */
+struct proxy_frame {
+	AVFrame *frame;
+	int users;
+	FFmpegIndexBuilderContext *context;
+};
+
+static AVFrame *proxy_frame_copy(FFmpegIndexBuilderContext *context, AVFrame *in_frame)
+{
+	AVCodecContext *c = context->iCodecCtx;
+	AVFrame *frame = av_frame_alloc();
+
+	avpicture_fill((AVPicture *) frame,
+	               MEM_mallocN(avpicture_get_size(c->pix_fmt, c->width, c->height),
+	                           "proxy frame"),
+	               c->pix_fmt, c->width, c->height);
+	av_picture_copy((AVPicture *) frame, (const AVPicture *) in_frame,
+	                c->pix_fmt, c->width, c->height);
+
+	frame->format = c->pix_fmt;
+	frame->width = c->width;
+	frame->height = c->height;
+
+	return frame;
+}
+
+static void proxy_frame_release(struct proxy_frame *pframe)
+{
+	FFmpegIndexBuilderContext *context = pframe->context;
+	bool is_last;
+
+	BLI_mutex_lock(&context->proxy_frames_lock);
+	is_last = (--pframe->users == 0);
+	if (is_last) {
+		context->proxy_frames_queued--;
+		BLI_condition_notify_one(&context->proxy_frames_cond);
+	}
+	BLI_mutex_unlock(&context->proxy_frames_lock);
+
+	if (is_last) {
+		MEM_freeN(pframe->frame->data[0]);
+		av_frame_free(&pframe->frame);
+		MEM_freeN(pframe);
+	}
+}
+
+static void *proxy_output_thread(void *ctx_v)
+{
+	struct proxy_output_ctx *ctx = ctx_v;
+	struct proxy_frame *pframe;
+
+	/* returns NULL once the decoding is done and the queue is empty */
+	while ((pframe = BLI_thread_queue_pop(ctx->queue))) {
+		add_to_proxy_output_ffmpeg(ctx, pframe->frame);
+		proxy_frame_release(pframe);
+	}
+
+	return NULL;
+}
+
+static void proxy_threads_start(FFmpegIndexBuilderContext *context)
+{
+	int i;
+
+	context->num_proxy_threads = 0;
+	for (i = 0; i < context->num_proxy_sizes; i++) {
+		if (context->proxy_ctx[i]) {
+			context->num_proxy_threads++;
+		}
+	}
+
+	if (context->num_proxy_threads == 0) {
+		return;
+	}
+
+	BLI_mutex_init(&context->proxy_frames_lock);
+	BLI_condition_init(&context->proxy_frames_cond);
+	context->proxy_frames_queued = 0;
+
+	BLI_threadpool_init(&context->proxy_threads, proxy_output_thread, context->num_proxy_threads);
+
+	for (i = 0; i < context->num_proxy_sizes; i++) {
+		if (context->proxy_ctx[i]) {
+			context->proxy_ctx[i]->queue = BLI_thread_queue_init();
+			BLI_threadpool_insert(&context->proxy_threads, context->proxy_ctx[i]);
+		}
+	}
+}
+
+static void proxy_threads_push_frame(FFmpegIndexBuilderContext *context, AVFrame *in_frame)
+{
+	struct proxy_frame *pframe;
+	int i;
+
+	if (context->num_proxy_threads == 0) {
+		return;
+	}
+
+	/* don't decode further ahead than the outputs can encode */
+	BLI_mutex_lock(&context->proxy_frames_lock);
+	while (context->proxy_frames_queued >= PROXY_FRAMES_MAX) {
+		BLI_condition_wait(&context->proxy_frames_cond, &context->proxy_frames_lock);
+	}
+	context->proxy_frames_queued++;
+	BLI_mutex_unlock(&context->proxy_frames_lock);
+
+	pframe = MEM_mallocN(sizeof(struct proxy_frame), "proxy frame");
+	pframe->frame = proxy_frame_copy(context, in_frame);
+	pframe->users = context->num_proxy_threads;
+	pframe->context = context;
+
+	for (i = 0; i < context->num_proxy_sizes; i++) {
+		if (context->proxy_ctx[i]) {
+			BLI_thread_queue_push(context->proxy_ctx[i]->queue, pframe);
+		}
+	}
+}
+
+/* Waits for the outputs to encode the queued frames. */
+static void proxy_threads_end(FFmpegIndexBuilderContext *context)
+{
+	int i;
+
+	if (context->num_proxy_threads == 0) {
+		return;
+	}
+
+	for (i = 0; i < context->num_proxy_sizes; i++) {
+		if (context->proxy_ctx[i]) {
+			BLI_thread_queue_nowait(context->proxy_ctx[i]->queue);
+		}
+	}
+
+	BLI_threadpool_end(&context->proxy_threads);
+
+	for (i = 0; i < context->num_proxy_sizes; i++) {
+		if (context->proxy_ctx[i]) {
+			BLI_thread_queue_free(context->proxy_ctx[i]->queue);
+			context->proxy_ctx[i]->queue = NULL;
+		}
+	}
+
+	BLI_condition_end(&context->proxy_frames_cond);
+	BLI_mutex_end(&context->proxy_frames_lock);
+
+	context->num_proxy_threads = 0;
+}
+
 static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Timecode_Type tcs_in_use,
-                                                      IMB_Proxy_Size proxy_sizes_in_use, int quality)
+                                                      IMB_Proxy_Size proxy_sizes_in_use, int quality,
+                                                      int num_threads)
 {
 	FFmpegIndexBuilderContext *context = MEM_callocN(sizeof(FFmpegIndexBuilderContext), "FFmpeg index builder context");
 	int num_proxy_sizes = IMB_PROXY_MAX_SLOT;
 	int num_indexers = IMB_TC_MAX_SLOT;
 	int i, streamcount;
 
-	context->tcs_in_use = tcs_in_use;
-	context->proxy_sizes_in_use = proxy_sizes_in_use;
 	context->num_proxy_sizes = IMB_PROXY_MAX_SLOT;
 	context->num_indexers = IMB_TC_MAX_SLOT;
 
@@ -777,6 +974,14 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Tim
 
 	context->iCodecCtx->workaround_bugs = 1;
 
+	/* frame threading delays the output by a frame per thread, the position of the packet
+	 * read last would not be the one of the decoded frame anymore */
+	if (num_threads <= 0) {
+		num_threads = BLI_system_thread_count();
+	}
+	context->iCodecCtx->thread_count = min_ii(num_threads, FFMPEG_DECODE_THREADS_MAX);
+	context->iCodecCtx->thread_type = FF_THREAD_SLICE;
+
 	if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
 		avformat_close_input(&context->iFormatCtx);
 		MEM_freeN(context);
@@ -810,6 +1015,10 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim, IMB_Tim
 		}
 	}
 
+	/* without the outputs that couldn't be created */
+	context->tcs_in_use = tcs_in_use;
+	context->proxy_sizes_in_use = proxy_sizes_in_use;
+
 	return (IndexBuildContext *)context;
 }
 
@@ -845,9 +1054,7 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(
 	unsigned long long s_dts = context->seek_pos_dts;
 	unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
-	for (i = 0; i < context->num_proxy_sizes; i++) {
-		add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
-	}
+	proxy_threads_push_frame(context, in_frame);
 
 	if (!context->start_pts_set) {
 		context->start_pts = pts;
@@ -905,6 +1112,8 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 	context->frame_rate = av_q2d(av_get_r_frame_rate_compat(context->iFormatCtx, context->iStream));
 	context->pts_time_base = av_q2d(context->iStream->time_base);
 
+	proxy_threads_start(context);
+
 	while (av_read_frame(context->iFormatCtx, &next_packet) >= 0) {
 		int frame_finished = 0;
 		float next_progress =  (float)((int)floor(((double) next_packet.pos) * 100 /
@@ -966,6 +1175,8 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
 		} while (frame_finished);
 	}
 
+	proxy_threads_end(context);
+
 	av_free(in_frame);
 
 	return 1;
@@ -1118,7 +1329,7 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
 
 				struct ImBuf *s_ibuf = IMB_dupImBuf(tmp_ibuf);
 
-				IMB_scalefastImBuf(s_ibuf, x, y);
+				IMB_resampleImBuf(s_ibuf, x, y, IMB_RESAMPLE_MITCHELL);
 
 				IMB_convert_rgba_to_abgr(s_ibuf);
 
@@ -1146,10 +1357,11 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
 
 IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecode_Type tcs_in_use,
                                                   IMB_Proxy_Size proxy_sizes_in_use, int quality,
-                                                  const bool overwrite, GSet *file_list)
+                                                  const bool overwrite, GSet *file_list, int num_threads)
 {
 	IndexBuildContext *context = NULL;
 	IMB_Proxy_Size proxy_sizes_to_build = proxy_sizes_in_use;
+	IMB_Timecode_Type tcs_to_build = tcs_in_use;
 	int i;
 
 	/* Don't generate the same file twice! */
@@ -1170,6 +1382,21 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 				}
 			}
 		}
+
+		for (i = 0; i < IMB_TC_MAX_SLOT; ++i) {
+			if (tc_types[i] & tcs_to_build) {
+				char filename[FILE_MAX];
+				get_tc_filename(anim, tc_types[i], filename);
+
+				void **filename_key_p;
+				if (!BLI_gset_ensure_p_ex(file_list, filename, &filename_key_p)) {
+					*filename_key_p = BLI_strdup(filename);
+				}
+				else {
+					tcs_to_build &= ~tc_types[i];
+				}
+			}
+		}
 	}
 
 	if (!overwrite) {
@@ -1186,11 +1413,22 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 			}
 		}
 		proxy_sizes_to_build &= ~built_proxies;
+
+		for (i = 0; i < IMB_TC_MAX_SLOT; ++i) {
+			if (tc_types[i] & tcs_to_build) {
+				char filename[FILE_MAX];
+				get_tc_filename(anim, tc_types[i], filename);
+				if (BLI_exists(filename)) {
+					tcs_to_build &= ~tc_types[i];
+				}
+			}
+		}
 	}
 
 	fflush(stdout);
 
-	if (proxy_sizes_to_build == 0) {
+	/* only movies read with FFmpeg have timecode indices */
+	if (proxy_sizes_to_build == 0 && (tcs_to_build == 0 || anim->curtype != ANIM_FFMPEG)) {
 		return NULL;
 	}
 
@@ -1198,7 +1436,7 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 	switch (anim->curtype) {
 #ifdef WITH_FFMPEG
 		case ANIM_FFMPEG:
-			context = index_ffmpeg_create_context(anim, tcs_in_use, proxy_sizes_to_build, quality);
+			context = index_ffmpeg_create_context(anim, tcs_to_build, proxy_sizes_to_build, quality, num_threads);
 			break;
 #endif
 #ifdef WITH_AVI
@@ -1213,7 +1451,7 @@ IndexBuildContext *IMB_anim_index_rebuild_context(struct anim *anim, IMB_Timecod
 
 	return context;
 
-	UNUSED_VARS(tcs_in_use, proxy_sizes_in_use, quality);
+	UNUSED_VARS(tcs_in_use, proxy_sizes_in_use, quality, num_threads);
 }
 
 void IMB_anim_index_rebuild(struct IndexBuildContext *context,
@@ -22,22 +22,40 @@
 
 #undef DEBUG_MESSAGES
 
+#include <stdio.h>
 #include <stdlib.h> /* for qsort */
 #include <memory.h>
 
 #include "MEM_guardedalloc.h"
 #include "MEM_CacheLimiterC-Api.h"
 
+#include "BLI_math_base.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_threads.h"
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#include "BKE_appdir.h"
 
 #include "IMB_moviecache.h"
 
 #include "IMB_imbuf_types.h"
 #include "IMB_imbuf.h"
+#include "IMB_colormanagement_intern.h"
+
+#include "atomic_ops.h"
+
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#endif
 
 #ifdef DEBUG_MESSAGES
 #  if defined __GNUC__
@@ -52,6 +70,22 @@
 static MEM_CacheLimiterC *limitor = NULL;
 static pthread_mutex_t limitor_lock = BLI_MUTEX_INITIALIZER;
 
+/* items of caches with a lower priority are freed first,
+ * the per item priorities are offset by the cache priority times this range */
+#define MOVIECACHE_PRIORITY_RANGE (1 << 24)
+
+/* pixels of spilled items are written in chunks of this size */
+#define SPILL_CHUNK_SIZE (1 << 20)
+
+static size_t spill_limit = 0;
+static size_t spill_in_use = 0;
+static unsigned int spill_counter = 0;
+
+/* Items which the limitor freed wait here until their pixels are written, the writing
+ * happens after limitor_lock is released. Protects the spill state of all items. */
+static ListBase spill_queue = {NULL, NULL};
+static ThreadMutex spill_lock = BLI_MUTEX_INITIALIZER;
+
 typedef struct MovieCache {
 	char name[64];
 
@@ -73,7 +107,10 @@ typedef struct MovieCache {
 	void *last_userkey;
 
 	int totseg, *points, proxy, render_flags;  /* for visual statistics optimization */
-	int pad;
+
+	int priority;
+	bool use_disk_spill;
+	bool defer_spill_flush;
 } MovieCache;
 
 typedef struct MovieCacheKey {
@@ -86,8 +123,26 @@ typedef struct MovieCacheItem {
 	ImBuf *ibuf;
 	MEM_CacheLimiterHandleC *c_handle;
 	void *priority_data;
+
+	/* buffer of an item which was freed by the limitor and is written to disk,
+	 * it has no pixels once the write finished */
+	ImBuf *spill_ibuf;
+	struct MovieCacheSpill *spill;
+	size_t spill_size;
+	unsigned int spill_id;
+	int spill_flags;
 } MovieCacheItem;
 
+/* Pending write of a spilled item, holds a reference to the buffer. */
+typedef struct MovieCacheSpill {
+	struct MovieCacheSpill *next, *prev;
+	/* NULL when the item was freed or used again before the write finished */
+	MovieCacheItem *item;
+	ImBuf *ibuf;
+	unsigned int spill_id;
+	bool is_queued;
+} MovieCacheSpill;
+
 static unsigned int moviecache_hashhash(const void *keyv)
 {
 	const MovieCacheKey *key = keyv;
@@ -112,6 +167,312 @@ static void moviecache_keyfree(void *val)
 	BLI_mempool_free(key->cache_owner->keys_pool, key);
 }
 
+/* ******** Disk spill ******** */
+
+static void moviecache_spill_filepath(unsigned int spill_id, char *r_filepath)
+{
+	char filename[64];
+
+	BLI_snprintf(filename, sizeof(filename), "imbuf_cache_%u.bin", spill_id);
+	BLI_join_dirfile(r_filepath, FILE_MAX, BKE_tempdir_session(), filename);
+}
+
+/* every chunk is stored as its packed length followed by the data,
+ * chunks which don't compress are stored as is */
+static bool moviecache_spill_write(FILE *f, const void *data, size_t len, size_t *r_size)
+{
+	const unsigned char *in = data;
+	size_t offset;
+	bool ok = true;
+#ifdef WITH_LZO
+	unsigned char *buffer = MEM_mallocN(SPILL_CHUNK_SIZE + SPILL_CHUNK_SIZE / 16 + 64 + 3, "moviecache spill buffer");
+	void *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, "moviecache spill wrkmem");
+#endif
+
+	for (offset = 0; ok && offset < len; offset += SPILL_CHUNK_SIZE) {
+		const unsigned int chunk_len = (unsigned int)min_zz(SPILL_CHUNK_SIZE, len - offset);
+		const unsigned char *out = in + offset;
+		unsigned int packed_len = chunk_len;
+
+#ifdef WITH_LZO
+		{
+			lzo_uint lzo_len;
+
+			if (lzo1x_1_compress(in + offset, chunk_len, buffer, &lzo_len, wrkmem) == LZO_E_OK &&
+			    lzo_len < chunk_len)
+			{
+				out = buffer;
+				packed_len = (unsigned int)lzo_len;
+			}
+		}
+#endif
+
+		ok = fwrite(&packed_len, sizeof(packed_len), 1, f) == 1 &&
+		     fwrite(out, 1, packed_len, f) == packed_len;
+
+		*r_size += sizeof(packed_len) + packed_len;
+	}
+
+#ifdef WITH_LZO
+	MEM_freeN(buffer);
+	MEM_freeN(wrkmem);
+#endif
+
+	return ok;
+}
+
+static bool moviecache_spill_read(FILE *f, void *data, size_t len)
+{
+	unsigned char *out = data;
+	unsigned char *buffer = NULL;
+	size_t offset;
+	bool ok = true;
+
+	for (offset = 0; ok && offset < len; offset += SPILL_CHUNK_SIZE) {
+		const unsigned int chunk_len = (unsigned int)min_zz(SPILL_CHUNK_SIZE, len - offset);
+		unsigned int packed_len;
+
+		if (fread(&packed_len, sizeof(packed_len), 1, f) != 1 || packed_len > chunk_len) {
+			ok = false;
+		}
+		else if (packed_len == chunk_len) {
+			ok = fread(out + offset, 1, chunk_len, f) == chunk_len;
+		}
+		else {
+#ifdef WITH_LZO
+			lzo_uint lzo_len = chunk_len;
+
+			if (buffer == NULL) {
+				buffer = MEM_mallocN(SPILL_CHUNK_SIZE, "moviecache spill buffer");
+			}
+
+			ok = fread(buffer, 1, packed_len, f) == packed_len &&
+			     lzo1x_decompress_safe(buffer, packed_len, out + offset, &lzo_len, NULL) == LZO_E_OK &&
+			     lzo_len == chunk_len;
+#else
+			ok = false;
+#endif
+		}
+	}
+
+	if (buffer) {
+		MEM_freeN(buffer);
+	}
+
+	return ok;
+}
+
+static void moviecache_spill_free(MovieCacheItem *item)
+{
+	char filepath[FILE_MAX];
+
+	moviecache_spill_filepath(item->spill_id, filepath);
+	BLI_delete(filepath, false, false);
+
+	atomic_sub_and_fetch_z(&spill_in_use, item->spill_size);
+
+	item->spill_ibuf = NULL;
+	item->spill_size = 0;
+}
+
+/* Queue the pixels of an item which is freed by the limitor to be written to disk. The ImBuf
+ * is kept without its pixels, so metadata and color spaces don't need to be written.
+ * Only done when the cache holds the only reference to the buffer.
+ * Called with the limitor locked. */
+static bool moviecache_spill_queue(MovieCacheItem *item)
+{
+	ImBuf *ibuf = item->ibuf;
+	MovieCacheSpill *spill;
+
+	if (ibuf->refcounter != 0 || ibuf->tiles || ibuf->zbuf || ibuf->zbuf_float) {
+		return false;
+	}
+	if ((ibuf->rect == NULL && ibuf->rect_float == NULL) || spill_in_use >= spill_limit) {
+		return false;
+	}
+
+	spill = MEM_callocN(sizeof(MovieCacheSpill), "moviecache spill");
+	spill->item = item;
+	spill->ibuf = ibuf;
+	spill->spill_id = atomic_add_and_fetch_u(&spill_counter, 1);
+	spill->is_queued = true;
+
+	/* the writer keeps the pixels alive when the item is freed meanwhile */
+	IMB_refImBuf(ibuf);
+
+	BLI_mutex_lock(&spill_lock);
+	item->spill_ibuf = ibuf;
+	item->spill = spill;
+	BLI_addtail(&spill_queue, spill);
+	BLI_mutex_unlock(&spill_lock);
+
+	PRINT("%s: cache '%s' queue item %p buffer %p\n", __func__, item->cache_owner->name, item, ibuf);
+
+	return true;
+}
+
+/* Stop a pending write of the item, the writer only drops its reference.
+ * Called with spill_lock locked. */
+static void moviecache_spill_cancel(MovieCacheItem *item)
+{
+	MovieCacheSpill *spill = item->spill;
+
+	spill->item = NULL;
+	item->spill = NULL;
+
+	if (spill->is_queued) {
+		BLI_remlink(&spill_queue, spill);
+		IMB_freeImBuf(spill->ibuf);
+		MEM_freeN(spill);
+	}
+}
+
+static bool moviecache_spill_write_file(ImBuf *ibuf, unsigned int spill_id, size_t *r_size)
+{
+	char filepath[FILE_MAX];
+	FILE *f;
+	bool ok = true;
+
+	moviecache_spill_filepath(spill_id, filepath);
+
+	f = BLI_fopen(filepath, "wb");
+	if (f == NULL) {
+		return false;
+	}
+
+	if (ibuf->rect) {
+		ok = moviecache_spill_write(f, ibuf->rect, sizeof(unsigned int) * ibuf->x * ibuf->y, r_size);
+	}
+	if (ok && ibuf->rect_float) {
+		ok = moviecache_spill_write(f, ibuf->rect_float,
+		                            sizeof(float) * ibuf->channels * ibuf->x * ibuf->y, r_size);
+	}
+
+	if (fclose(f) != 0 || !ok) {
+		BLI_delete(filepath, false, false);
+		return false;
+	}
+
+	return true;
+}
+
+/* Write the queued items, compression and file access happen without any lock held.
+ * Called after limitor_lock was released by anything that enforces the limits. */
+static void moviecache_spill_flush(void)
+{
+	for (;;) {
+		MovieCacheSpill *spill;
+		MovieCacheItem *item;
+		ImBuf *ibuf;
+		size_t size = 0;
+		bool ok;
+
+		BLI_mutex_lock(&spill_lock);
+		spill = BLI_pophead(&spill_queue);
+		if (spill) {
+			spill->is_queued = false;
+		}
+		BLI_mutex_unlock(&spill_lock);
+
+		if (spill == NULL) {
+			break;
+		}
+
+		ibuf = spill->ibuf;
+		ok = moviecache_spill_write_file(ibuf, spill->spill_id, &size);
+
+		BLI_mutex_lock(&spill_lock);
+		item = spill->item;
+
+		if (item && ok && ibuf->refcounter == 1 && spill_in_use + size <= spill_limit) {
+			item->spill = NULL;
+			item->spill_id = spill->spill_id;
+			item->spill_flags = (ibuf->rect ? IB_rect : 0) | (ibuf->rect_float ? IB_rectfloat : 0);
+			item->spill_size = size;
+			atomic_add_and_fetch_z(&spill_in_use, size);
+
+			imb_freerectImBuf(ibuf);
+			imb_freerectfloatImBuf(ibuf);
+			colormanage_cache_free(ibuf);
+
+			PRINT("%s: cache '%s' spill item %p buffer %p, %zu bytes\n", __func__,
+			      item->cache_owner->name, item, ibuf, size);
+		}
+		else {
+			if (ok) {
+				char filepath[FILE_MAX];
+
+				moviecache_spill_filepath(spill->spill_id, filepath);
+				BLI_delete(filepath, false, false);
+			}
+
+			/* the pixels could not be written, the item loses its buffer like
+			 * it would without disk spill */
+			if (item) {
+				item->spill = NULL;
+				item->spill_ibuf = NULL;
+				IMB_freeImBuf(ibuf);
+			}
+		}
+		BLI_mutex_unlock(&spill_lock);
+
+		IMB_freeImBuf(ibuf);
+		MEM_freeN(spill);
+	}
+}
+
+/* Read the pixels of a spilled item back. The item is detached while the file is read,
+ * afterwards the buffer is handed to the limitor again. */
+static void moviecache_unspill(MovieCacheItem *item, ImBuf *ibuf)
+{
+	const int channels = ibuf->channels;
+	char filepath[FILE_MAX];
+	FILE *f;
+	bool ok = false;
+
+	moviecache_spill_filepath(item->spill_id, filepath);
+
+	f = BLI_fopen(filepath, "rb");
+	if (f) {
+		ok = true;
+
+		if (item->spill_flags & IB_rect) {
+			ok = imb_addrectImBuf(ibuf) &&
+			     moviecache_spill_read(f, ibuf->rect, sizeof(unsigned int) * ibuf->x * ibuf->y);
+		}
+		if (ok && (item->spill_flags & IB_rectfloat)) {
+			ok = imb_addrectfloatImBuf(ibuf);
+			ibuf->channels = channels;
+			ok = ok && moviecache_spill_read(f, ibuf->rect_float, sizeof(float) * channels * ibuf->x * ibuf->y);
+		}
+
+		fclose(f);
+	}
+
+	item->spill_ibuf = ibuf;
+	moviecache_spill_free(item);
+
+	if (!ok) {
+		IMB_freeImBuf(ibuf);
+		return;
+	}
+
+	PRINT("%s: cache '%s' restore item %p buffer %p\n", __func__, item->cache_owner->name, item, ibuf);
+
+	BLI_mutex_lock(&limitor_lock);
+
+	item->ibuf = ibuf;
+	item->c_handle = MEM_CacheLimiter_insert(limitor, item);
+
+	MEM_CacheLimiter_ref(item->c_handle);
+	MEM_CacheLimiter_enforce_limits(limitor);
+	MEM_CacheLimiter_unref(item->c_handle);
+
+	BLI_mutex_unlock(&limitor_lock);
+}
+
+/* ******** Cache ******** */
+
 static void moviecache_valfree(void *val)
 {
 	MovieCacheItem *item = (MovieCacheItem *)val;
@@ -124,6 +485,21 @@ static void moviecache_valfree(void *val)
 		IMB_freeImBuf(item->ibuf);
 	}
 
+	if (item->spill_ibuf) {
+		BLI_mutex_lock(&spill_lock);
+		if (item->spill) {
+			moviecache_spill_cancel(item);
+			IMB_freeImBuf(item->spill_ibuf);
+			item->spill_ibuf = NULL;
+		}
+		BLI_mutex_unlock(&spill_lock);
+
+		if (item->spill_ibuf) {
+			IMB_freeImBuf(item->spill_ibuf);
+			moviecache_spill_free(item);
+		}
+	}
+
 	if (item->priority_data && cache->prioritydeleterfp) {
 		cache->prioritydeleterfp(item->priority_data);
 	}
@@ -144,7 +520,7 @@ static void check_unused_keys(MovieCache *cache)
 
 		BLI_ghashIterator_step(&gh_iter);
 
-		remove = !item->ibuf;
+		remove = !item->ibuf && !item->spill_ibuf;
 
 		if (remove) {
 			PRINT("%s: cache '%s' remove item %p without buffer\n", __func__, cache->name, item);
@@ -171,7 +547,9 @@ static void IMB_moviecache_destructor(void *p)
 
 		PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
-		IMB_freeImBuf(item->ibuf);
+		if (!(cache->use_disk_spill && moviecache_spill_queue(item))) {
+			IMB_freeImBuf(item->ibuf);
+		}
 
 		item->ibuf = NULL;
 		item->c_handle = NULL;
@@ -188,7 +566,7 @@ static void IMB_moviecache_destructor(void *p)
 static size_t IMB_get_size_in_memory(ImBuf *ibuf)
 {
 	int a;
-	size_t size = 0, channel_size = 0;
+	size_t size = 0;
 
 	/* Persistent images should have no affect on how "normal"
 	 * images are cached.
@@ -204,13 +582,21 @@ static size_t IMB_get_size_in_memory(ImBuf *ibuf)
 
 	size += sizeof(ImBuf);
 
+	/* byte buffers are always RGBA, channels only applies to float buffers */
 	if (ibuf->rect)
-		channel_size += sizeof(char);
+		size += sizeof(unsigned int) * ibuf->x * ibuf->y;
 
 	if (ibuf->rect_float)
-		channel_size += sizeof(float);
+		size += sizeof(float) * ibuf->x * ibuf->y * ibuf->channels;
+
+	if (ibuf->zbuf)
+		size += sizeof(int) * ibuf->x * ibuf->y;
 
-	size += channel_size * ibuf->x * ibuf->y * ibuf->channels;
+	if (ibuf->zbuf_float)
+		size += sizeof(float) * ibuf->x * ibuf->y;
+
+	if (ibuf->encodedbuffer)
+		size += ibuf->encodedbuffersize;
 
 	if (ibuf->miptot) {
 		for (a = 0; a < ibuf->miptot; a++) {
@@ -246,14 +632,15 @@ static int get_item_priority(void *item_v, int default_priority)
 	if (!cache->getitempriorityfp) {
 		PRINT("%s: cache '%s' item %p use default priority %d\n", __func__, cache-> name, item, default_priority);
 
-		return default_priority;
+		priority = default_priority;
 	}
+	else {
+		priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
 
-	priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
-
-	PRINT("%s: cache '%s' item %p priority %d\n", __func__, cache-> name, item, priority);
+		PRINT("%s: cache '%s' item %p priority %d\n", __func__, cache-> name, item, priority);
+	}
 
-	return priority;
+	return priority + cache->priority * MOVIECACHE_PRIORITY_RANGE;
 }
 
 static bool get_item_destroyable(void *item_v)
@@ -314,6 +701,31 @@ void IMB_moviecache_set_getdata_callback(MovieCache *cache, MovieCacheGetKeyData
 	cache->getdatafp = getdatafp;
 }
 
+void IMB_moviecache_set_cache_priority(MovieCache *cache, int priority)
+{
+	cache->priority = priority;
+}
+
+void IMB_moviecache_set_disk_spill(MovieCache *cache, bool use_disk_spill)
+{
+	cache->use_disk_spill = use_disk_spill;
+}
+
+void IMB_moviecache_set_disk_limit(size_t limit)
+{
+	spill_limit = limit;
+}
+
+void IMB_moviecache_set_defer_spill_flush(MovieCache *cache, bool defer_spill_flush)
+{
+	cache->defer_spill_flush = defer_spill_flush;
+}
+
+void IMB_moviecache_spill_flush(void)
+{
+	moviecache_spill_flush();
+}
+
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache, MovieCacheGetPriorityDataFP getprioritydatafp,
                                           MovieCacheGetItemPriorityFP getitempriorityfp,
                                           MovieCachePriorityDeleterFP prioritydeleterfp)
@@ -348,6 +760,9 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 	item->cache_owner = cache;
 	item->c_handle = NULL;
 	item->priority_data = NULL;
+	item->spill_ibuf = NULL;
+	item->spill = NULL;
+	item->spill_size = 0;
 
 	if (cache->getprioritydatafp) {
 		item->priority_data = cache->getprioritydatafp(userkey);
@@ -368,9 +783,14 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 	MEM_CacheLimiter_enforce_limits(limitor);
 	MEM_CacheLimiter_unref(item->c_handle);
 
-	if (need_lock)
+	if (need_lock) {
 		BLI_mutex_unlock(&limitor_lock);
 
+		if (!cache->defer_spill_flush) {
+			moviecache_spill_flush();
+		}
+	}
+
 	/* cache limiter can't remove unused keys which points to destroyed values */
 	check_unused_keys(cache);
 
@@ -403,6 +823,10 @@ bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibu
 
 	BLI_mutex_unlock(&limitor_lock);
 
+	if (!cache->defer_spill_flush) {
+		moviecache_spill_flush();
+	}
+
 	return result;
 }
 
@@ -411,23 +835,60 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
 	MovieCacheKey key;
 	MovieCacheItem *item;
 
+	ImBuf *ibuf = NULL;
+
 	key.cache_owner = cache;
 	key.userkey = userkey;
 	item = (MovieCacheItem *)BLI_ghash_lookup(cache->hash, &key);
 
-	if (item) {
-		if (item->ibuf) {
-			BLI_mutex_lock(&limitor_lock);
-			MEM_CacheLimiter_touch(item->c_handle);
+	if (item && (item->ibuf || item->spill_ibuf)) {
+		ImBuf *spill_ibuf = NULL;
+
+		BLI_mutex_lock(&limitor_lock);
+
+		/* a buffer which is still being written is taken back as it is,
+		 * a buffer on disk is detached and read without holding the locks */
+		BLI_mutex_lock(&spill_lock);
+		if (item->spill_ibuf) {
+			if (item->spill) {
+				moviecache_spill_cancel(item);
+				item->ibuf = item->spill_ibuf;
+			}
+			else {
+				spill_ibuf = item->spill_ibuf;
+			}
+			item->spill_ibuf = NULL;
+		}
+		BLI_mutex_unlock(&spill_lock);
+
+		if (item->ibuf && item->c_handle == NULL) {
+			item->c_handle = MEM_CacheLimiter_insert(limitor, item);
+
+			MEM_CacheLimiter_ref(item->c_handle);
+			MEM_CacheLimiter_enforce_limits(limitor);
+			MEM_CacheLimiter_unref(item->c_handle);
+		}
+		else if (spill_ibuf) {
 			BLI_mutex_unlock(&limitor_lock);
+			moviecache_unspill(item, spill_ibuf);
+			BLI_mutex_lock(&limitor_lock);
+		}
 
+		/* reference while locked, the limitor spills the pixels of unreferenced buffers */
+		if (item->ibuf) {
+			MEM_CacheLimiter_touch(item->c_handle);
 			IMB_refImBuf(item->ibuf);
+			ibuf = item->ibuf;
+		}
+
+		BLI_mutex_unlock(&limitor_lock);
 
-			return item->ibuf;
+		if (!cache->defer_spill_flush) {
+			moviecache_spill_flush();
 		}
 	}
 
-	return NULL;
+	return ibuf;
 }
 
 bool IMB_moviecache_has_frame(MovieCache *cache, void *userkey)
@@ -475,6 +936,7 @@ void IMB_moviecache_cleanup(MovieCache *cache, bool (cleanup_check_cb) (ImBuf *i
 
 		BLI_ghashIterator_step(&gh_iter);
 
+		/* buffers on disk or being written are NULL, like for the iterators */
 		if (cleanup_check_cb(item->ibuf, key->userkey, userdata)) {
 			PRINT("%s: cache '%s' remove item %p\n", __func__, cache->name, item);
 
@@ -515,7 +977,7 @@ void IMB_moviecache_get_cache_segments(MovieCache *cache, int proxy, int render_
 			MovieCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
 			int framenr, curproxy, curflags;
 
-			if (item->ibuf) {
+			if (item->ibuf || item->spill_ibuf) {
 				cache->getdatafp(key->userkey, &framenr, &curproxy, &curflags);
 
 				if (curproxy == proxy && curflags == render_flags)
@@ -53,6 +53,7 @@
 #include <ImfOutputPart.h>
 #include <ImfMultiPartOutputFile.h>
 #include <ImfTiledOutputPart.h>
+#include <ImfTiledOutputFile.h>
 #include <ImfPartType.h>
 #include <ImfPartHelper.h>
 
@@ -78,6 +79,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 
 #include "BLI_blenlib.h"
 #include "BLI_math_color.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -563,6 +565,7 @@ typedef struct ExrHandle {
 	OFileStream *ofile_stream;
 	MultiPartOutputFile *mpofile;
 	OutputFile *ofile;
+	TiledOutputFile *tofile;
 
 	int tilex, tiley;
 	int width, height;
@@ -573,8 +576,6 @@ typedef struct ExrHandle {
 
 	ListBase channels;  /* flattened out, ExrChannel */
 	ListBase layers;    /* hierarchical, pointing in end to ExrChannel */
-
-	int num_half_channels;  /* used during filr save, allows faster temporary buffers allocation */
 } ExrHandle;
 
 /* flattened out channel */
@@ -753,10 +754,6 @@ void IMB_exr_add_channel(void *handle,
 	echan->rect = rect;
 	echan->use_half_float = use_half_float;
 
-	if (echan->use_half_float) {
-		data->num_half_channels++;
-	}
-
 	exr_printf("added channel %s\n", echan->name);
 	BLI_addtail(&data->channels, echan);
 }
@@ -778,6 +775,11 @@ int IMB_exr_begin_write(void *handle, const char *filename, int width, int heigh
 		                         Channel(echan->use_half_float ? Imf::HALF : Imf::FLOAT));
 	}
 
+	const bool is_tiled = (data->tilex > 0 && data->tiley > 0);
+	if (is_tiled) {
+		header.setTileDescription(TileDescription(data->tilex, data->tiley, ONE_LEVEL));
+	}
+
 	openexr_header_compression(&header, compress);
 	BKE_stamp_info_callback(&header, const_cast<StampData *>(stamp), openexr_header_metadata_callback, false);
 	/* header.lineOrder() = DECREASING_Y; this crashes in windows for file read! */
@@ -794,19 +796,35 @@ int IMB_exr_begin_write(void *handle, const char *filename, int width, int heigh
 	/* manually create ofstream, so we can handle utf-8 filepaths on windows */
 	try {
 		data->ofile_stream = new OFileStream(filename);
-		data->ofile = new OutputFile(*(data->ofile_stream), header);
+		if (is_tiled) {
+			data->tofile = new TiledOutputFile(*(data->ofile_stream), header);
+		}
+		else {
+			data->ofile = new OutputFile(*(data->ofile_stream), header);
+		}
 	}
 	catch (const std::exception& exc) {
 		std::cerr << "IMB_exr_begin_write: ERROR: " << exc.what() << std::endl;
 
 		delete data->ofile;
+		delete data->tofile;
 		delete data->ofile_stream;
 
 		data->ofile = NULL;
+		data->tofile = NULL;
 		data->ofile_stream = NULL;
 	}
 
-	return (data->ofile != NULL);
+	return (data->ofile != NULL || data->tofile != NULL);
+}
+
+/* write the file of IMB_exr_begin_write with tiles instead of scanlines, call before it */
+void IMB_exr_set_tile_size(void *handle, int tilex, int tiley)
+{
+	ExrHandle *data = (ExrHandle *)handle;
+
+	data->tilex = tilex;
+	data->tiley = tiley;
 }
 
 /* only used for writing temp. render results (not image files)
@@ -995,49 +1013,120 @@ void IMB_exr_clear_channels(void *handle)
 	BLI_freelistN(&data->channels);
 }
 
+typedef struct ExrHalfConvertData {
+	const std::vector<ExrChannel *> *channels;
+	half *rect_half;
+	int width, height;
+	/* first file scanline and number of scanlines of the chunk */
+	int start_line, num_lines;
+} ExrHalfConvertData;
+
+static void imb_exr_half_convert_line(void *__restrict userdata, const int line, const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const ExrHalfConvertData *data = (const ExrHalfConvertData *)userdata;
+	/* Files are written from the top scanline, Blender buffers start at the bottom. */
+	const size_t y = data->height - 1 - (data->start_line + line);
+
+	for (size_t c = 0; c < data->channels->size(); c++) {
+		const ExrChannel *echan = (*data->channels)[c];
+		const float *rect = echan->rect + y * echan->ystride;
+		half *cur = data->rect_half + ((size_t)c * data->num_lines + line) * data->width;
+
+		for (int x = 0; x < data->width; x++, cur++) {
+			*cur = rect[x * echan->xstride];
+		}
+	}
+}
+
+/* Half channels are converted and written in chunks of scanlines, so the temporary buffer
+ * doesn't hold the entire image. A chunk has enough scanlines to keep the OpenEXR threads
+ * busy compressing. */
+static int imb_exr_write_chunk_lines(ExrHandle *data)
+{
+	int lines = std::max(256, 64 * BLI_system_thread_count());
+
+	if (data->tofile) {
+		lines = ((lines + data->tiley - 1) / data->tiley) * data->tiley;
+	}
+	return std::min(lines, data->height);
+}
+
 void IMB_exr_write_channels(void *handle)
 {
 	ExrHandle *data = (ExrHandle *)handle;
-	FrameBuffer frameBuffer;
 	ExrChannel *echan;
 
 	if (data->channels.first) {
-		const size_t num_pixels = ((size_t)data->width) * data->height;
-		half *rect_half = NULL, *current_rect_half = NULL;
-
-		/* We allocate teporary storage for half pixels for all the channels at once. */
-		if (data->num_half_channels != 0) {
-			rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * num_pixels, __func__);
-			current_rect_half = rect_half;
-		}
+		std::vector<ExrChannel *> half_channels;
+		half *rect_half = NULL;
+		int chunk_lines = data->height;
 
 		for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
-			/* Writing starts from last scanline, stride negative. */
 			if (echan->use_half_float) {
-				float *rect = echan->rect;
-				half *cur = current_rect_half;
-				for (size_t i = 0; i < num_pixels; ++i, ++cur) {
-					*cur = rect[i * echan->xstride];
-				}
-				half *rect_to_write = current_rect_half + (data->height - 1L) * data->width;
-				frameBuffer.insert(echan->name, Slice(Imf::HALF,  (char *)rect_to_write,
-				                                      sizeof(half), -data->width * sizeof(half)));
-				current_rect_half += num_pixels;
-			}
-			else {
-				float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
-				frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)rect,
-				                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
+				half_channels.push_back(echan);
 			}
 		}
 
-		data->ofile->setFrameBuffer(frameBuffer);
-		try {
-			data->ofile->writePixels(data->height);
+		/* Temporary storage for a chunk of scanlines of all half channels. */
+		if (!half_channels.empty()) {
+			chunk_lines = imb_exr_write_chunk_lines(data);
+			rect_half = (half *)MEM_mallocN(sizeof(half) * half_channels.size() * data->width * chunk_lines, __func__);
 		}
-		catch (const std::exception& exc) {
-			std::cerr << "OpenEXR-writePixels: ERROR: " << exc.what() << std::endl;
+
+		for (int start_line = 0; start_line < data->height; start_line += chunk_lines) {
+			const int num_lines = std::min(chunk_lines, data->height - start_line);
+			FrameBuffer frameBuffer;
+
+			if (rect_half != NULL) {
+				ExrHalfConvertData convert_data;
+				ParallelRangeSettings settings;
+
+				convert_data.channels = &half_channels;
+				convert_data.rect_half = rect_half;
+				convert_data.width = data->width;
+				convert_data.height = data->height;
+				convert_data.start_line = start_line;
+				convert_data.num_lines = num_lines;
+
+				BLI_parallel_range_settings_defaults(&settings);
+				settings.min_iter_per_thread = 16;
+				BLI_task_parallel_range(0, num_lines, &convert_data, imb_exr_half_convert_line, &settings);
+			}
+
+			size_t half_index = 0;
+			for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+				if (echan->use_half_float) {
+					/* Slices are addressed by file scanline, offset the chunk to its first one. */
+					char *rect_to_write = (char *)(rect_half + half_index++ * data->width * num_lines) -
+					                      (ptrdiff_t)start_line * data->width * sizeof(half);
+					frameBuffer.insert(echan->name, Slice(Imf::HALF, rect_to_write,
+					                                      sizeof(half), data->width * sizeof(half)));
+				}
+				else {
+					/* Writing starts from last scanline, stride negative. */
+					float *rect = echan->rect + echan->ystride * (data->height - 1L);
+					frameBuffer.insert(echan->name, Slice(Imf::FLOAT,  (char *)rect,
+					                                      echan->xstride * sizeof(float), -echan->ystride * sizeof(float)));
+				}
+			}
+
+			try {
+				if (data->tofile) {
+					data->tofile->setFrameBuffer(frameBuffer);
+					data->tofile->writeTiles(0, data->tofile->numXTiles() - 1,
+					                         start_line / data->tiley, (start_line + num_lines - 1) / data->tiley);
+				}
+				else {
+					data->ofile->setFrameBuffer(frameBuffer);
+					data->ofile->writePixels(num_lines);
+				}
+			}
+			catch (const std::exception& exc) {
+				std::cerr << "OpenEXR-writePixels: ERROR: " << exc.what() << std::endl;
+				break;
+			}
 		}
+
 		/* Free temporary buffers. */
 		if (rect_half != NULL) {
 			MEM_freeN(rect_half);
@@ -1102,6 +1191,7 @@ void IMB_exrtile_write_channels(void *handle, int partx, int party, int level, c
 	}
 }
 
+/* Only the channels that got a rect from IMB_exr_set_channel are read. */
 void IMB_exr_read_channels(void *handle)
 {
 	ExrHandle *data = (ExrHandle *)handle;
@@ -1114,6 +1204,19 @@ void IMB_exr_read_channels(void *handle)
 	exr_printf("\nIMB_exr_read_channels\n%s %-6s %-22s \"%s\"\n---------------------------------------------------------------------\n", "p", "view", "name", "internal_name");
 
 	for (int i = 0; i < numparts; i++) {
+		/* Parts without any requested channel are not decoded. */
+		bool has_channels = false;
+		for (ExrChannel *echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+			if (echan->m->part_number == i && echan->rect) {
+				has_channels = true;
+				break;
+			}
+		}
+		if (!has_channels) {
+			exr_printf("skipping part %d, no channels requested\n", i);
+			continue;
+		}
+
 		/* Read part header. */
 		InputPart in(*data->ifile, i);
 		Header header = in.header();
@@ -1150,7 +1253,7 @@ void IMB_exr_read_channels(void *handle)
 				frameBuffer.insert(echan->m->internal_name, Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
 			}
 			else
-				printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
+				exr_printf("skipping channel with no rect set %s\n", echan->m->internal_name.c_str());
 		}
 
 		/* Read pixels. */
@@ -1214,6 +1317,7 @@ void IMB_exr_close(void *handle)
 	delete data->ifile;
 	delete data->ifile_stream;
 	delete data->ofile;
+	delete data->tofile;
 	delete data->mpofile;
 	delete data->ofile_stream;
 	delete data->multiView;
@@ -1221,6 +1325,7 @@ void IMB_exr_close(void *handle)
 	data->ifile = NULL;
 	data->ifile_stream = NULL;
 	data->ofile = NULL;
+	data->tofile = NULL;
 	data->mpofile = NULL;
 	data->ofile_stream = NULL;
 
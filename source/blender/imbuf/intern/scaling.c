@@ -23,8 +23,11 @@
 
 
 #include "BLI_utildefines.h"
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.h"
 #include "MEM_guardedalloc.h"
 
 #include "imbuf.h"
@@ -35,6 +38,10 @@
 
 #include "BLI_sys_types.h" // for intptr_t support
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
 	uchar *p1, *_p1, *dest;
@@ -1760,3 +1767,342 @@ void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
 		ibuf->rect_float = init_data.float_buffer;
 	}
 }
+
+/* ******** separable filtered scaling ******** */
+
+/* The weights of the source pixels that contribute to every destination pixel are
+ * computed once per axis. The image is then filtered horizontally into a float
+ * buffer and vertically into the result, both passes are split over rows. */
+
+typedef struct ResampleAxis {
+	/* number of source pixels contributing to a destination pixel */
+	int taps;
+	/* first contributing source pixel, for every destination pixel */
+	int *start;
+	/* normalized weights, taps for every destination pixel */
+	float *weights;
+} ResampleAxis;
+
+typedef struct ResampleHorizontalData {
+	const ResampleAxis *axis;
+	int channels;
+	int src_width, dst_width;
+	const unsigned char *src_byte;
+	const float *src_float;
+	float *dst;
+} ResampleHorizontalData;
+
+typedef struct ResampleVerticalData {
+	const ResampleAxis *axis;
+	int channels;
+	int width;
+	const float *src;
+	unsigned char *dst_byte;
+	float *dst_float;
+} ResampleVerticalData;
+
+/* Mitchell-Netravali cubic with B = C = 1/3, support of 2 */
+static float resample_filter_mitchell(float x)
+{
+	const float B = 1.0f / 3.0f, C = 1.0f / 3.0f;
+
+	x = fabsf(x);
+	if (x < 1.0f) {
+		return ((12.0f - 9.0f * B - 6.0f * C) * x * x * x +
+		        (-18.0f + 12.0f * B + 6.0f * C) * x * x +
+		        (6.0f - 2.0f * B)) / 6.0f;
+	}
+	else if (x < 2.0f) {
+		return ((-B - 6.0f * C) * x * x * x +
+		        (6.0f * B + 30.0f * C) * x * x +
+		        (-12.0f * B - 48.0f * C) * x +
+		        (8.0f * B + 24.0f * C)) / 6.0f;
+	}
+	return 0.0f;
+}
+
+static float resample_sinc(float x)
+{
+	if (x == 0.0f) {
+		return 1.0f;
+	}
+	x *= (float)M_PI;
+	return sinf(x) / x;
+}
+
+/* Lanczos windowed sinc, support of 3 */
+static float resample_filter_lanczos(float x)
+{
+	x = fabsf(x);
+	return (x < 3.0f) ? resample_sinc(x) * resample_sinc(x / 3.0f) : 0.0f;
+}
+
+static void resample_axis_init(ResampleAxis *axis, int src_size, int dst_size, IMB_Resample_Filter filter)
+{
+	float (*filter_func)(float) = (filter == IMB_RESAMPLE_LANCZOS) ? resample_filter_lanczos : resample_filter_mitchell;
+	const float support = (filter == IMB_RESAMPLE_LANCZOS) ? 3.0f : 2.0f;
+	const float factor = (float)src_size / (float)dst_size;
+	/* when scaling down the filter is stretched to cover all source pixels */
+	const float scale = max_ff(factor, 1.0f);
+	const float radius = support * scale;
+	const int window = (int)ceilf(2.0f * radius) + 1;
+	int i, t;
+
+	axis->taps = min_ii(window, src_size);
+	axis->start = MEM_mallocN(sizeof(int) * dst_size, "resample start");
+	axis->weights = MEM_callocN(sizeof(float) * dst_size * axis->taps, "resample weights");
+
+	for (i = 0; i < dst_size; i++) {
+		const float center = ((float)i + 0.5f) * factor - 0.5f;
+		const int first = (int)floorf(center - radius);
+		const int start = CLAMPIS(first, 0, src_size - axis->taps);
+		float *weights = axis->weights + (size_t)i * axis->taps;
+		float total = 0.0f;
+
+		/* pixels outside of the image repeat the edge pixels */
+		for (t = 0; t < window; t++) {
+			const int x = first + t;
+			const float weight = filter_func(((float)x - center) / scale);
+
+			weights[CLAMPIS(x, 0, src_size - 1) - start] += weight;
+			total += weight;
+		}
+
+		if (total != 0.0f) {
+			mul_vn_fl(weights, axis->taps, 1.0f / total);
+		}
+
+		axis->start[i] = start;
+	}
+}
+
+static void resample_axis_free(ResampleAxis *axis)
+{
+	MEM_freeN(axis->start);
+	MEM_freeN(axis->weights);
+}
+
+#ifdef __SSE2__
+BLI_INLINE __m128 resample_load_byte4(const unsigned char *p)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i v = _mm_cvtsi32_si128(*(const int *)p);
+
+	v = _mm_unpacklo_epi8(v, zero);
+	v = _mm_unpacklo_epi16(v, zero);
+	return _mm_cvtepi32_ps(v);
+}
+#endif
+
+static void resample_horizontal_row(void *__restrict userdata, const int y, const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const ResampleHorizontalData *data = userdata;
+	const ResampleAxis *axis = data->axis;
+	const int channels = data->channels;
+	float *dst = data->dst + (size_t)y * data->dst_width * channels;
+	int x, t, c;
+
+	if (data->src_byte) {
+		const unsigned char *src = data->src_byte + (size_t)y * data->src_width * 4;
+
+		for (x = 0; x < data->dst_width; x++, dst += 4) {
+			const unsigned char *p = src + axis->start[x] * 4;
+			const float *w = axis->weights + (size_t)x * axis->taps;
+#ifdef __SSE2__
+			__m128 sum = _mm_setzero_ps();
+
+			for (t = 0; t < axis->taps; t++, p += 4) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(w[t]), resample_load_byte4(p)));
+			}
+			_mm_storeu_ps(dst, sum);
+#else
+			zero_v4(dst);
+			for (t = 0; t < axis->taps; t++, p += 4) {
+				for (c = 0; c < 4; c++) {
+					dst[c] += w[t] * (float)p[c];
+				}
+			}
+#endif
+		}
+	}
+	else {
+		const float *src = data->src_float + (size_t)y * data->src_width * channels;
+
+		for (x = 0; x < data->dst_width; x++, dst += channels) {
+			const float *p = src + axis->start[x] * channels;
+			const float *w = axis->weights + (size_t)x * axis->taps;
+#ifdef __SSE2__
+			if (channels == 4) {
+				__m128 sum = _mm_setzero_ps();
+
+				for (t = 0; t < axis->taps; t++, p += 4) {
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(w[t]), _mm_loadu_ps(p)));
+				}
+				_mm_storeu_ps(dst, sum);
+				continue;
+			}
+#endif
+			for (c = 0; c < channels; c++) {
+				dst[c] = 0.0f;
+			}
+			for (t = 0; t < axis->taps; t++, p += channels) {
+				for (c = 0; c < channels; c++) {
+					dst[c] += w[t] * p[c];
+				}
+			}
+		}
+	}
+}
+
+static void resample_vertical_row(void *__restrict userdata, const int y, const ParallelRangeTLS *__restrict UNUSED(tls))
+{
+	const ResampleVerticalData *data = userdata;
+	const ResampleAxis *axis = data->axis;
+	const size_t row_len = (size_t)data->width * data->channels;
+	const float *src = data->src + (size_t)axis->start[y] * row_len;
+	const float *w = axis->weights + (size_t)y * axis->taps;
+	size_t i = 0;
+	int t;
+
+	if (data->dst_byte) {
+		unsigned char *dst = data->dst_byte + (size_t)y * row_len;
+
+#ifdef __SSE2__
+		/* byte rows always have 4 channels */
+		for (; i < row_len; i += 4) {
+			const float *p = src + i;
+			__m128 sum = _mm_setzero_ps();
+			__m128i v;
+
+			for (t = 0; t < axis->taps; t++, p += row_len) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(w[t]), _mm_loadu_ps(p)));
+			}
+			/* round and saturate to 0..255 */
+			v = _mm_cvtps_epi32(sum);
+			v = _mm_packs_epi32(v, v);
+			v = _mm_packus_epi16(v, v);
+			*(int *)(dst + i) = _mm_cvtsi128_si32(v);
+		}
+#else
+		for (; i < row_len; i++) {
+			const float *p = src + i;
+			float sum = 0.0f;
+
+			for (t = 0; t < axis->taps; t++, p += row_len) {
+				sum += w[t] * *p;
+			}
+			dst[i] = (unsigned char)clamp_i((int)floorf(sum + 0.5f), 0, 255);
+		}
+#endif
+	}
+	else {
+		float *dst = data->dst_float + (size_t)y * row_len;
+
+#ifdef __SSE2__
+		for (; i + 4 <= row_len; i += 4) {
+			const float *p = src + i;
+			__m128 sum = _mm_setzero_ps();
+
+			for (t = 0; t < axis->taps; t++, p += row_len) {
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(w[t]), _mm_loadu_ps(p)));
+			}
+			_mm_storeu_ps(dst + i, sum);
+		}
+#endif
+		for (; i < row_len; i++) {
+			const float *p = src + i;
+			float sum = 0.0f;
+
+			for (t = 0; t < axis->taps; t++, p += row_len) {
+				sum += w[t] * *p;
+			}
+			dst[i] = sum;
+		}
+	}
+}
+
+static void resample_buffer(
+        const ResampleAxis *axis_x, const ResampleAxis *axis_y,
+        int width, int height, int newx, int newy, int channels,
+        const unsigned char *src_byte, const float *src_float,
+        unsigned char *dst_byte, float *dst_float)
+{
+	ResampleHorizontalData horizontal_data;
+	ResampleVerticalData vertical_data;
+	ParallelRangeSettings settings;
+	float *tmp = MEM_mallocN(sizeof(float) * newx * height * channels, "resample tmp buffer");
+
+	BLI_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 8;
+
+	horizontal_data.axis = axis_x;
+	horizontal_data.channels = channels;
+	horizontal_data.src_width = width;
+	horizontal_data.dst_width = newx;
+	horizontal_data.src_byte = src_byte;
+	horizontal_data.src_float = src_float;
+	horizontal_data.dst = tmp;
+	BLI_task_parallel_range(0, height, &horizontal_data, resample_horizontal_row, &settings);
+
+	vertical_data.axis = axis_y;
+	vertical_data.channels = channels;
+	vertical_data.width = newx;
+	vertical_data.src = tmp;
+	vertical_data.dst_byte = dst_byte;
+	vertical_data.dst_float = dst_float;
+	BLI_task_parallel_range(0, newy, &vertical_data, resample_vertical_row, &settings);
+
+	MEM_freeN(tmp);
+}
+
+/**
+ * Scale with a separable Mitchell or Lanczos filter, higher quality than #IMB_scaleImBuf
+ * and threaded. Return true if \a ibuf is modified.
+ */
+bool IMB_resampleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy, IMB_Resample_Filter filter)
+{
+	ResampleAxis axis_x, axis_y;
+
+	if (ibuf == NULL) return false;
+	if (ibuf->rect == NULL && ibuf->rect_float == NULL) return false;
+	if (newx == 0 || newy == 0) return false;
+
+	if (newx == ibuf->x && newy == ibuf->y) {
+		return false;
+	}
+
+	/* scale the Z-buffer while ibuf->x and ibuf->y are still the old size */
+	scalefast_Z_ImBuf(ibuf, newx, newy);
+
+	resample_axis_init(&axis_x, ibuf->x, newx, filter);
+	resample_axis_init(&axis_y, ibuf->y, newy, filter);
+
+	if (ibuf->rect) {
+		unsigned char *rect = MEM_mallocN(sizeof(int) * newx * newy, "resample byte buffer");
+
+		resample_buffer(&axis_x, &axis_y, ibuf->x, ibuf->y, newx, newy, 4,
+		                (unsigned char *)ibuf->rect, NULL, rect, NULL);
+
+		imb_freerectImBuf(ibuf);
+		ibuf->mall |= IB_rect;
+		ibuf->rect = (unsigned int *)rect;
+	}
+
+	if (ibuf->rect_float) {
+		float *rect_float = MEM_mallocN(sizeof(float) * ibuf->channels * newx * newy, "resample float buffer");
+
+		resample_buffer(&axis_x, &axis_y, ibuf->x, ibuf->y, newx, newy, ibuf->channels,
+		                NULL, ibuf->rect_float, NULL, rect_float);
+
+		imb_freerectfloatImBuf(ibuf);
+		ibuf->mall |= IB_rectfloat;
+		ibuf->rect_float = rect_float;
+	}
+
+	resample_axis_free(&axis_x);
+	resample_axis_free(&axis_y);
+
+	ibuf->x = newx;
+	ibuf->y = newy;
+	return true;
+}
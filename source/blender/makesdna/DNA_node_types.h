@@ -395,6 +395,12 @@ typedef struct bNodeLink {
 #define NTREE_CHUNCKSIZE_512 512
 #define NTREE_CHUNCKSIZE_1024 1024
 
+/* tree->proxy_size, divider of the resolution when editing */
+#define NTREE_PROXY_FULL    0
+#define NTREE_PROXY_HALF    2
+#define NTREE_PROXY_QUARTER 4
+#define NTREE_PROXY_EIGHTH  8
+
 /* the basis for a Node tree, all links and nodes reside internal here */
 /* only re-usable node trees are in the library though,
  * materials and textures allocate own tree struct */
@@ -432,7 +438,8 @@ typedef struct bNodeTree {
 	short is_updating;
 	/** Generic temporary flag for recursion check (DFS/BFS). */
 	short done;
-	int pad2;
+	/** Memory limit in MB for compositor results kept between executions, 0 disables it. */
+	int cache_limit;
 
 	/** Specific node type this tree is used for. */
 	int nodetype DNA_DEPRECATED;
@@ -445,6 +452,8 @@ typedef struct bNodeTree {
 	int chunksize;
 
 	rctf viewer_border;
+	/** Part of the viewer visible in the backdrop, only set on the localized tree when editing. */
+	rctf viewer_region;
 
 	/* Lists of bNodeSocket to hold default values and own_index.
 	 * Warning! Don't make links to these sockets, input/output nodes are used for that.
@@ -460,7 +469,9 @@ typedef struct bNodeTree {
 	 * in case multiple different editors are used and make context ambiguous.
 	 */
 	bNodeInstanceKey active_viewer_key;
-	int pad;
+	/** Resolution divider for compositing while editing, see NTREE_PROXY_*. */
+	short proxy_size;
+	short pad;
 
 	/* execution data */
 	/* XXX It would be preferable to completely move this data out of the underlying node tree,
@@ -498,6 +509,9 @@ typedef struct bNodeTree {
 #define NTREE_TWO_PASS				(1 << 2)	/* two pass */
 #define NTREE_COM_GROUPNODE_BUFFER	(1 << 3)	/* use groupnode buffers */
 #define NTREE_VIEWER_BORDER			(1 << 4)	/* use a border for viewer nodes */
+#define NTREE_COM_AREA_EXECUTION	(1 << 6)	/* execute operations on whole areas instead of per pixel */
+#define NTREE_COM_HALF_FLOAT		(1 << 7)	/* store color buffers between execution groups as half float */
+#define NTREE_COM_VIEWER_REGION		(1 << 8)	/* only calculate the part of the viewer visible in the backdrop */
 /* NOTE: DEPRECATED, use (id->tag & LIB_TAG_LOCALIZED) instead. */
 
 /* tree is localized copy, free when deleting node groups */
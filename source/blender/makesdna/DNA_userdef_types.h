@@ -757,7 +757,8 @@ typedef struct UserDef {
 	/** #eMultiSample_Type, amount of samples for Grease Pencil. */
 	short gpencil_multisamples;
 
-	char _pad5[4];
+	/** Disk space for cached frames that don't fit in #memcachelimit, in megabytes. */
+	int diskcachelimit;
 } UserDef;
 
 /* from blenkernel blender.c */
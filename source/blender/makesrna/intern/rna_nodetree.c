@@ -102,6 +102,14 @@ static const EnumPropertyItem node_chunksize_items[] = {
 	{NTREE_CHUNCKSIZE_1024, "1024",   0,    "1024x1024", "Chunksize of 1024x1024"},
 	{0, NULL, 0, NULL, NULL},
 };
+
+static const EnumPropertyItem node_proxy_size_items[] = {
+	{NTREE_PROXY_FULL,    "FULL",    0,    "Full",    "Calculate at full resolution"},
+	{NTREE_PROXY_HALF,    "HALF",    0,    "1/2",     "Calculate at half resolution"},
+	{NTREE_PROXY_QUARTER, "QUARTER", 0,    "1/4",     "Calculate at a quarter of the resolution"},
+	{NTREE_PROXY_EIGHTH,  "EIGHTH",  0,    "1/8",     "Calculate at an eighth of the resolution"},
+	{0, NULL, 0, NULL, NULL},
+};
 #endif
 
 const EnumPropertyItem rna_enum_node_math_items[] = {
@@ -8455,6 +8463,12 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
 	RNA_def_property_enum_items(prop, node_quality_items);
 	RNA_def_property_ui_text(prop, "Edit Quality", "Quality when editing");
 
+	prop = RNA_def_property(srna, "proxy_size", PROP_ENUM, PROP_NONE);
+	RNA_def_property_enum_sdna(prop, NULL, "proxy_size");
+	RNA_def_property_enum_items(prop, node_proxy_size_items);
+	RNA_def_property_ui_text(prop, "Edit Resolution", "Resolution of images and render layers when editing, "
+	                                                  "viewer and composite outputs are scaled back to full size");
+
 	prop = RNA_def_property(srna, "chunk_size", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_sdna(prop, NULL, "chunksize");
 	RNA_def_property_enum_items(prop, node_chunksize_items);
@@ -8478,6 +8492,29 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_VIEWER_BORDER);
 	RNA_def_property_ui_text(prop, "Viewer Border", "Use boundaries for viewer nodes and composite backdrop");
 	RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_NodeTree_update");
+
+	prop = RNA_def_property(srna, "use_viewer_region", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_VIEWER_REGION);
+	RNA_def_property_ui_text(prop, "Visible Region Only", "Only calculate the part of the viewer visible in the "
+	                                                     "backdrop, panning or zooming the backdrop updates it");
+	RNA_def_property_update(prop, NC_NODE | ND_DISPLAY, "rna_NodeTree_update");
+
+	prop = RNA_def_property(srna, "use_area_execution", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_AREA_EXECUTION);
+	RNA_def_property_ui_text(prop, "Area Execution", "Calculate nodes for whole rows of a tile at once instead of "
+	                                                 "pixel by pixel, faster for nodes that support it");
+
+	prop = RNA_def_property(srna, "use_half_float", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", NTREE_COM_HALF_FLOAT);
+	RNA_def_property_ui_text(prop, "Half Float Buffers", "Store color buffers between nodes as half float, "
+	                                                     "uses less memory at the cost of a small loss of precision");
+
+	prop = RNA_def_property(srna, "cache_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "cache_limit");
+	RNA_def_property_range(prop, 0, INT_MAX);
+	RNA_def_property_ui_range(prop, 0, 16384, 64, -1);
+	RNA_def_property_ui_text(prop, "Cache Limit", "Memory in MB for keeping node results between updates, "
+	                                              "so only changed nodes are recalculated (0 disables the cache)");
 }
 
 static void rna_def_shader_nodetree(BlenderRNA *brna)
@@ -271,6 +271,24 @@ static void engine_update_render_passes(RenderEngine *engine, struct Scene *scen
 	RNA_parameter_list_free(&list);
 }
 
+static void engine_bake_jobs(RenderEngine *engine, struct Depsgraph *depsgraph, struct BakeJob *jobs)
+{
+	extern FunctionRNA rna_RenderEngine_bake_jobs_func;
+	PointerRNA ptr;
+	ParameterList list;
+	FunctionRNA *func;
+
+	RNA_pointer_create(NULL, engine->type->ext.srna, engine, &ptr);
+	func = &rna_RenderEngine_bake_jobs_func;
+
+	RNA_parameter_list_create(&list, &ptr, func);
+	RNA_parameter_set_lookup(&list, "depsgraph", &depsgraph);
+	RNA_parameter_set_lookup(&list, "jobs", &jobs);
+	engine->type->ext.call(NULL, &ptr, func, &list);
+
+	RNA_parameter_list_free(&list);
+}
+
 /* RenderEngine registration */
 
 static void rna_RenderEngine_unregister(Main *bmain, StructRNA *type)
@@ -338,6 +356,7 @@ static StructRNA *rna_RenderEngine_register(
 	et->view_draw = (have_function[4]) ? engine_view_draw : NULL;
 	et->update_script_node = (have_function[5]) ? engine_update_script_node : NULL;
 	et->update_render_passes = (have_function[6]) ? engine_update_render_passes : NULL;
+	et->bake_jobs = (have_function[7]) ? engine_bake_jobs : NULL;
 
 	RE_engines_register(et);
 
@@ -436,6 +455,24 @@ static PointerRNA rna_BakePixel_next_get(PointerRNA *ptr)
 	return rna_pointer_inherit_refine(ptr, &RNA_BakePixel, bp + 1);
 }
 
+static PointerRNA rna_BakeJob_next_get(PointerRNA *ptr)
+{
+	BakeJob *job = ptr->data;
+	return rna_pointer_inherit_refine(ptr, &RNA_BakeJob, job->next);
+}
+
+static PointerRNA rna_BakeJob_pixel_array_get(PointerRNA *ptr)
+{
+	BakeJob *job = ptr->data;
+	return rna_pointer_inherit_refine(ptr, &RNA_BakePixel, (BakePixel *)job->pixel_array);
+}
+
+static PointerRNA rna_BakeJob_result_get(PointerRNA *ptr)
+{
+	BakeJob *job = ptr->data;
+	return rna_pointer_inherit_refine(ptr, &RNA_AnyType, job->result);
+}
+
 static RenderPass *rna_RenderPass_find_by_type(RenderLayer *rl, int passtype, const char *view)
 {
 	return RE_pass_find_by_type(rl, passtype, view);
@@ -530,6 +567,14 @@ static void rna_def_render_engine(BlenderRNA *brna)
 	parm = RNA_def_pointer(func, "scene", "Scene", "", "");
 	parm = RNA_def_pointer(func, "renderlayer", "ViewLayer", "", "");
 
+	func = RNA_def_function(srna, "bake_jobs", NULL);
+	RNA_def_function_ui_description(func, "Bake the passes of multiple objects at once, used instead of bake when defined");
+	RNA_def_function_flag(func, FUNC_REGISTER_OPTIONAL | FUNC_ALLOW_WRITE);
+	parm = RNA_def_pointer(func, "depsgraph", "Depsgraph", "", "");
+	RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+	parm = RNA_def_pointer(func, "jobs", "BakeJob", "", "First job, followed by the others through next");
+	RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
 	/* tag for redraw */
 	func = RNA_def_function(srna, "tag_redraw", "engine_tag_redraw");
 	RNA_def_function_ui_description(func, "Request redraw for viewport rendering");
@@ -999,6 +1044,64 @@ static void rna_def_render_bake_pixel(BlenderRNA *brna)
 	RNA_define_verify_sdna(1);
 }
 
+static void rna_def_render_bake_job(BlenderRNA *brna)
+{
+	StructRNA *srna;
+	PropertyRNA *prop;
+
+	srna = RNA_def_struct(brna, "BakeJob", NULL);
+	RNA_def_struct_ui_text(srna, "Bake Job", "Pass of an object to bake");
+
+	RNA_define_verify_sdna(0);
+
+	prop = RNA_def_property(srna, "object", PROP_POINTER, PROP_NONE);
+	RNA_def_property_struct_type(prop, "Object");
+	RNA_def_property_pointer_sdna(prop, NULL, "object");
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	prop = RNA_def_property(srna, "object_id", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "object_id");
+	RNA_def_property_ui_text(prop, "Object Id", "Id of the object in the object_id of the pixels");
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	prop = RNA_def_property(srna, "pixel_array", PROP_POINTER, PROP_NONE);
+	RNA_def_property_struct_type(prop, "BakePixel");
+	RNA_def_property_pointer_funcs(prop, "rna_BakeJob_pixel_array_get", NULL, NULL, NULL);
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	prop = RNA_def_property(srna, "num_pixels", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "num_pixels");
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	prop = RNA_def_property(srna, "depth", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "depth");
+	RNA_def_property_ui_text(prop, "Pixels depth", "Number of channels");
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	prop = RNA_def_property(srna, "pass_type", PROP_ENUM, PROP_NONE);
+	RNA_def_property_enum_sdna(prop, NULL, "pass_type");
+	RNA_def_property_enum_items(prop, rna_enum_bake_pass_type_items);
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	prop = RNA_def_property(srna, "pass_filter", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "pass_filter");
+	RNA_def_property_ui_text(prop, "Pass Filter", "Filter to combined, diffuse, glossy, transmission and subsurface passes");
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	prop = RNA_def_property(srna, "result", PROP_POINTER, PROP_NONE);
+	RNA_def_property_struct_type(prop, "AnyType");
+	RNA_def_property_pointer_funcs(prop, "rna_BakeJob_result_get", NULL, NULL, NULL);
+	RNA_def_property_ui_text(prop, "Result", "Pixels of depth floats to write the result to");
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	prop = RNA_def_property(srna, "next", PROP_POINTER, PROP_NONE);
+	RNA_def_property_struct_type(prop, "BakeJob");
+	RNA_def_property_pointer_funcs(prop, "rna_BakeJob_next_get", NULL, NULL, NULL);
+	RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+
+	RNA_define_verify_sdna(1);
+}
+
 void RNA_def_render(BlenderRNA *brna)
 {
 	rna_def_render_engine(brna);
@@ -1007,6 +1110,7 @@ void RNA_def_render(BlenderRNA *brna)
 	rna_def_render_layer(brna);
 	rna_def_render_pass(brna);
 	rna_def_render_bake_pixel(brna);
+	rna_def_render_bake_job(brna);
 }
 
 #endif /* RNA_RUNTIME */
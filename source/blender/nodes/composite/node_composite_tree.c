@@ -271,6 +271,11 @@ void ntreeCompositTagRender(Scene *curscene)
 {
 	Scene *sce;
 
+#ifdef WITH_COMPOSITOR
+	/* cached results of render layer nodes are outdated */
+	COM_clearCaches();
+#endif
+
 	/* XXX Think using G_MAIN here is valid, since you want to update current file's scene nodes,
 	 * not the ones in temp main generated for rendering?
 	 * This is still rather weak though, ideally render struct would store own main AND original G_MAIN... */
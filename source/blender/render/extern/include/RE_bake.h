@@ -48,6 +48,19 @@ typedef struct BakePixel {
 	float dv_dx, dv_dy;
 } BakePixel;
 
+/* A pass of an object to bake, linked so the engine can bake all of them at once. */
+typedef struct BakeJob {
+	struct BakeJob *next;
+	struct Object *object;
+	int object_id;
+	const BakePixel *pixel_array;
+	int num_pixels;
+	int depth;
+	int pass_type;
+	int pass_filter;
+	float *result;
+} BakeJob;
+
 typedef struct BakeHighPolyData {
 	struct Object *ob;
 	struct Object *ob_eval;
@@ -61,9 +74,7 @@ typedef struct BakeHighPolyData {
 /* external_engine.c */
 bool RE_bake_has_engine(struct Render *re);
 
-bool RE_bake_engine(
-        struct Render *re, struct Depsgraph *depsgraph, struct Object *object, const int object_id, const BakePixel pixel_array[],
-        const size_t num_pixels, const int depth, const eScenePassType pass_type, const int pass_filter, float result[]);
+bool RE_bake_engine_jobs(struct Render *re, struct Depsgraph *depsgraph, BakeJob *jobs);
 
 /* bake.c */
 int RE_pass_depth(const eScenePassType pass_type);
@@ -30,6 +30,7 @@
 
 #include "BLI_threads.h"
 
+struct BakeJob;
 struct BakePixel;
 struct Depsgraph;
 struct IDProperty;
@@ -86,6 +87,8 @@ typedef struct RenderEngineType {
 	             struct Object *object, const int pass_type,
 	             const int pass_filter, const int object_id, const struct BakePixel *pixel_array, const int num_pixels,
 	             const int depth, void *result);
+	/* bake a list of jobs, engines which don't support it get every job passed to bake */
+	void (*bake_jobs)(struct RenderEngine *engine, struct Depsgraph *depsgraph, struct BakeJob *jobs);
 
 	void (*view_update)(struct RenderEngine *engine, const struct bContext *context);
 	void (*view_draw)(struct RenderEngine *engine, const struct bContext *context);
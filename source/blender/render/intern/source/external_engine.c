@@ -537,15 +537,10 @@ void RE_bake_engine_set_engine_parameters(Render *re, Main *bmain, Scene *scene)
 bool RE_bake_has_engine(Render *re)
 {
 	RenderEngineType *type = RE_engines_find(re->r.engine);
-	return (type->bake != NULL);
+	return (type->bake != NULL || type->bake_jobs != NULL);
 }
 
-bool RE_bake_engine(
-        Render *re, Depsgraph *depsgraph, Object *object,
-        const int object_id, const BakePixel pixel_array[],
-        const size_t num_pixels, const int depth,
-        const eScenePassType pass_type, const int pass_filter,
-        float result[])
+bool RE_bake_engine_jobs(Render *re, Depsgraph *depsgraph, BakeJob *jobs)
 {
 	RenderEngineType *type = RE_engines_find(re->r.engine);
 	RenderEngine *engine;
@@ -576,23 +571,32 @@ bool RE_bake_engine(
 	engine->tile_x = re->r.tilex;
 	engine->tile_y = re->r.tiley;
 
-	if (type->bake) {
+	if (type->bake || type->bake_jobs) {
 		engine->depsgraph = depsgraph;
 
 		/* update is only called so we create the engine.session */
 		if (type->update)
 			type->update(engine, re->main, engine->depsgraph);
 
-		type->bake(engine,
-		           engine->depsgraph,
-		           object,
-		           pass_type,
-		           pass_filter,
-		           object_id,
-		           pixel_array,
-		           num_pixels,
-		           depth,
-		           result);
+		if (type->bake_jobs) {
+			type->bake_jobs(engine, engine->depsgraph, jobs);
+		}
+		else {
+			BakeJob *job;
+
+			for (job = jobs; job; job = job->next) {
+				type->bake(engine,
+				           engine->depsgraph,
+				           job->object,
+				           job->pass_type,
+				           job->pass_filter,
+				           job->object_id,
+				           job->pixel_array,
+				           job->num_pixels,
+				           job->depth,
+				           job->result);
+			}
+		}
 
 		engine->depsgraph = NULL;
 	}
@@ -910,6 +910,9 @@ bool RE_WriteRenderResult(ReportList *reports, RenderResult *rr, const char *fil
 	BLI_make_existing_file(filename);
 
 	int compress = (imf ? imf->exr_codec : 0);
+	if (imf && imf->imtype == R_IMF_IMTYPE_MULTILAYER && (imf->flag & R_IMF_FLAG_EXR_TILES)) {
+		IMB_exr_set_tile_size(exrhandle, 64, 64);
+	}
 	bool success = IMB_exr_begin_write(exrhandle, filename, rr->rectx, rr->recty, compress, rr->stamp_data);
 	if (success) {
 		IMB_exr_write_channels(exrhandle);
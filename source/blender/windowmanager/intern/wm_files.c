@@ -93,6 +93,7 @@
 
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
 #include "IMB_thumbs.h"
 
 #include "ED_datafiles.h"
@@ -346,6 +347,7 @@ static void wm_init_userdef(Main *bmain, const bool read_userdef_from_memory)
 	UI_init_userdef(bmain);
 
 	MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+	IMB_moviecache_set_disk_limit(((size_t)U.diskcachelimit) * 1024 * 1024);
 	BKE_sound_init(bmain);
 
 	/* needed so loading a file from the command line respects user-pref [#26156] */
@@ -0,0 +1,232 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "COM_test_operations.h"
+
+#include "COM_ConvertOperation.h"
+#include "COM_GammaOperation.h"
+#include "COM_GaussianXBlurOperation.h"
+#include "COM_GaussianYBlurOperation.h"
+#include "COM_InvertOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MixOperation.h"
+#include "COM_SetValueOperation.h"
+#include "COM_TranslateOperation.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_rect.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+}
+
+/* Odd sizes so rows don't line up with any vector width. */
+#define TEST_WIDTH 37
+#define TEST_HEIGHT 23
+
+static void set_test_resolution(NodeOperation *operation)
+{
+	set_test_resolution(operation, TEST_WIDTH, TEST_HEIGHT);
+}
+
+/* Calculate area with renderArea and compare every pixel against the per pixel path. */
+static void expect_area_matches_pixels(NodeOperation *operation, const rcti &area)
+{
+	rcti render_area = area;
+	const DataType datatype = operation->getOutputSocket()->getDataType();
+	MemoryBuffer output(datatype, &render_area);
+	const int num_channels = output.get_num_channels();
+
+	ASSERT_TRUE(operation->canExecuteArea());
+	operation->renderArea(&output, &render_area);
+
+	void *data = operation->isComplex() ? operation->initializeTileData(&render_area) : NULL;
+	for (int y = area.ymin; y < area.ymax; y++) {
+		for (int x = area.xmin; x < area.xmax; x++) {
+			float expected[4];
+			if (operation->isComplex()) {
+				operation->read(expected, x, y, data);
+			}
+			else {
+				operation->readSampled(expected, x, y, COM_PS_NEAREST);
+			}
+
+			const float *result = output.getElem(x, y);
+			for (int channel = 0; channel < num_channels; channel++) {
+				EXPECT_NEAR(expected[channel], result[channel], 1e-5f * max_ff(1.0f, fabsf(expected[channel])))
+				        << "pixel " << x << ", " << y << " channel " << channel;
+			}
+		}
+	}
+}
+
+/* Part of the frame not starting at the origin. */
+static rcti test_area()
+{
+	rcti area;
+	BLI_rcti_init(&area, 3, TEST_WIDTH - 5, 2, TEST_HEIGHT - 1);
+	return area;
+}
+
+static rcti full_area()
+{
+	rcti area;
+	BLI_rcti_init(&area, 0, TEST_WIDTH, 0, TEST_HEIGHT);
+	return area;
+}
+
+static void test_operation(NodeOperation *operation)
+{
+	PatternOperation value(COM_DT_VALUE);
+	PatternOperation vector(COM_DT_VECTOR);
+	PatternOperation color(COM_DT_COLOR);
+
+	for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+		switch (operation->getInputSocket(index)->getDataType()) {
+			case COM_DT_VALUE:
+				connect_input(operation, index, &value);
+				break;
+			case COM_DT_VECTOR:
+				connect_input(operation, index, &vector);
+				break;
+			case COM_DT_COLOR:
+				connect_input(operation, index, &color);
+				break;
+		}
+	}
+
+	set_test_resolution(operation);
+	operation->initExecution();
+	expect_area_matches_pixels(operation, test_area());
+	expect_area_matches_pixels(operation, full_area());
+	operation->deinitExecution();
+}
+
+template<typename MixOperationType>
+static void test_mix_operation()
+{
+	for (int flag = 0; flag < 4; flag++) {
+		MixOperationType operation;
+		operation.setUseValueAlphaMultiply(flag & 1);
+		operation.setUseClamp(flag & 2);
+		test_operation(&operation);
+	}
+}
+
+template<typename MathOperationType>
+static void test_math_operation()
+{
+	for (int use_clamp = 0; use_clamp < 2; use_clamp++) {
+		MathOperationType operation;
+		operation.setUseClamp(use_clamp);
+		test_operation(&operation);
+	}
+}
+
+template<typename OperationType>
+static void test_convert_operation()
+{
+	OperationType operation;
+	test_operation(&operation);
+}
+
+TEST(area_execution, mix)
+{
+	test_mix_operation<MixAddOperation>();
+	test_mix_operation<MixBlendOperation>();
+	test_mix_operation<MixMultiplyOperation>();
+	test_mix_operation<MixSubtractOperation>();
+}
+
+TEST(area_execution, math)
+{
+	test_math_operation<MathAddOperation>();
+	test_math_operation<MathSubtractOperation>();
+	test_math_operation<MathMultiplyOperation>();
+	test_math_operation<MathDivideOperation>();
+	test_math_operation<MathMinimumOperation>();
+	test_math_operation<MathMaximumOperation>();
+}
+
+TEST(area_execution, convert)
+{
+	test_convert_operation<ConvertValueToColorOperation>();
+	test_convert_operation<ConvertColorToValueOperation>();
+	test_convert_operation<ConvertColorToBWOperation>();
+	test_convert_operation<ConvertColorToVectorOperation>();
+	test_convert_operation<ConvertValueToVectorOperation>();
+	test_convert_operation<ConvertVectorToColorOperation>();
+	test_convert_operation<ConvertVectorToValueOperation>();
+	test_convert_operation<ConvertPremulToStraightOperation>();
+	test_convert_operation<ConvertStraightToPremulOperation>();
+}
+
+TEST(area_execution, color)
+{
+	GammaOperation gamma;
+	test_operation(&gamma);
+
+	for (int flag = 0; flag < 4; flag++) {
+		InvertOperation invert;
+		invert.setColor(flag & 1);
+		invert.setAlpha(flag & 2);
+		test_operation(&invert);
+	}
+}
+
+TEST(area_execution, translate)
+{
+	PatternOperation color(COM_DT_COLOR);
+	SetValueOperation delta_x, delta_y;
+	delta_x.setValue(4.0f);
+	delta_y.setValue(-3.0f);
+
+	TranslateOperation translate;
+	connect_input(&translate, 0, &color);
+	connect_input(&translate, 1, &delta_x);
+	connect_input(&translate, 2, &delta_y);
+	set_test_resolution(&translate);
+	translate.initExecution();
+
+	expect_area_matches_pixels(&translate, test_area());
+	expect_area_matches_pixels(&translate, full_area());
+
+	translate.deinitExecution();
+}
+
+/* The blur reads a whole buffer, windows at the borders are clipped. */
+template<typename BlurOperationType>
+static void test_blur_operation(CompositorQuality quality)
+{
+	PatternBuffer input(TEST_WIDTH, TEST_HEIGHT);
+
+	SetValueOperation size;
+	size.setValue(1.0f);
+
+	NodeBlurData data;
+	memset(&data, 0, sizeof(data));
+	data.sizex = data.sizey = 5;
+	data.filtertype = R_FILTER_GAUSS;
+
+	BlurOperationType blur;
+	blur.setData(&data);
+	blur.setSize(1.0f);
+	blur.setQuality(quality);
+	connect_input(&blur, 0, &input.read);
+	connect_input(&blur, 1, &size);
+	set_test_resolution(&blur);
+	blur.initExecution();
+
+	expect_area_matches_pixels(&blur, test_area());
+	expect_area_matches_pixels(&blur, full_area());
+
+	blur.deinitExecution();
+}
+
+TEST(area_execution, gaussian_blur)
+{
+	test_blur_operation<GaussianXBlurOperation>(COM_QUALITY_HIGH);
+	test_blur_operation<GaussianXBlurOperation>(COM_QUALITY_LOW);
+	test_blur_operation<GaussianYBlurOperation>(COM_QUALITY_HIGH);
+	test_blur_operation<GaussianYBlurOperation>(COM_QUALITY_LOW);
+}
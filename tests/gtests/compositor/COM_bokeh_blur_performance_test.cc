@@ -0,0 +1,65 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "COM_test_operations.h"
+
+#include "COM_BokehBlurOperation.h"
+#include "COM_BokehImageOperation.h"
+#include "COM_SetValueOperation.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "DNA_node_types.h"
+#include "PIL_time_utildefines.h"
+}
+
+/* Full HD frame, radii from the spatial path up to the largest FFT kernels. */
+#define SRC_WIDTH 1920
+#define SRC_HEIGHT 1080
+
+static void bokeh_blur_timeit(int radius)
+{
+	PatternBuffer input(SRC_WIDTH, SRC_HEIGHT);
+
+	NodeBokehImage bokehData = {0.0f, 5, 0.0f, 0.0f, 0.0f};
+	BokehImageOperation bokeh;
+	bokeh.setData(&bokehData);
+	set_test_resolution(&bokeh, COM_BLUR_BOKEH_PIXELS, COM_BLUR_BOKEH_PIXELS);
+	bokeh.initExecution();
+
+	const float size = radius * 100.0f / SRC_WIDTH;
+	SetValueOperation boundingBox, sizeValue;
+	boundingBox.setValue(1.0f);
+	sizeValue.setValue(size);
+
+	BokehBlurOperation blur;
+	blur.setSize(size);
+	connect_input(&blur, 0, &input.read);
+	connect_input(&blur, 1, &bokeh);
+	connect_input(&blur, 2, &boundingBox);
+	connect_input(&blur, 3, &sizeValue);
+	set_test_resolution(&blur, SRC_WIDTH, SRC_HEIGHT);
+	blur.initExecution();
+
+	printf("\n========== radius %d ==========\n", radius);
+	TIMEIT_START(bokeh_blur);
+	void *data = blur.initializeTileData(NULL);
+	float output[4];
+	for (int y = 0; y < SRC_HEIGHT; y++) {
+		for (int x = 0; x < SRC_WIDTH; x++) {
+			blur.executePixel(output, x, y, data);
+		}
+	}
+	TIMEIT_END(bokeh_blur);
+
+	blur.deinitExecution();
+	bokeh.deinitExecution();
+}
+
+TEST(bokeh_blur_performance, radius)
+{
+	const int radii[] = {10, 25, 50, 100, 250, 500};
+	for (unsigned int i = 0; i < ARRAY_SIZE(radii); i++) {
+		bokeh_blur_timeit(radii[i]);
+	}
+}
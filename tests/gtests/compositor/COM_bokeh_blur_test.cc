@@ -0,0 +1,131 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "COM_test_operations.h"
+
+#include <vector>
+
+#include "COM_BokehBlurOperation.h"
+#include "COM_BokehImageOperation.h"
+#include "COM_SetValueOperation.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_rect.h"
+#include "DNA_node_types.h"
+}
+
+#define TEST_WIDTH 120
+#define TEST_HEIGHT 80
+
+/* Bokeh blur of the pattern with a hexagonal bokeh, the size is a percentage of the width. */
+class BokehBlurTest : public testing::Test {
+protected:
+	NodeBokehImage m_bokehData;
+	BokehImageOperation m_bokeh;
+	SetValueOperation m_boundingBox;
+	SetValueOperation m_size;
+
+	virtual void SetUp()
+	{
+		m_bokehData.angle = 0.3f;
+		m_bokehData.flaps = 6;
+		m_bokehData.rounding = 0.2f;
+		m_bokehData.catadioptric = 0.0f;
+		m_bokehData.lensshift = 0.0f;
+		m_bokeh.setData(&m_bokehData);
+		set_test_resolution(&m_bokeh, COM_BLUR_BOKEH_PIXELS, COM_BLUR_BOKEH_PIXELS);
+		m_bokeh.initExecution();
+		m_boundingBox.setValue(1.0f);
+	}
+
+	virtual void TearDown()
+	{
+		m_bokeh.deinitExecution();
+	}
+
+	void setup_blur(BokehBlurOperation *blur, PatternBuffer *input, float size, CompositorQuality quality)
+	{
+		m_size.setValue(size);
+		blur->setSize(size);
+		blur->setQuality(quality);
+		connect_input(blur, 0, &input->read);
+		connect_input(blur, 1, &m_bokeh);
+		connect_input(blur, 2, &m_boundingBox);
+		connect_input(blur, 3, &m_size);
+		set_test_resolution(blur, TEST_WIDTH, TEST_HEIGHT);
+		blur->initExecution();
+	}
+
+	/* The spatial path is used until initializeTileData calculated the FFT result,
+	 * compare both on pixels that are at least min_distance away from the left and bottom. */
+	void expect_fft_matches_spatial(CompositorQuality quality, int min_distance)
+	{
+		PatternBuffer input(TEST_WIDTH, TEST_HEIGHT);
+		BokehBlurOperation blur;
+		/* radius of 18 pixels */
+		setup_blur(&blur, &input, 15.0f, quality);
+
+		MemoryBuffer *buffer = input.proxy.getBuffer();
+		std::vector<float> spatial(TEST_WIDTH * TEST_HEIGHT * 4);
+		for (int y = 0; y < TEST_HEIGHT; y++) {
+			for (int x = 0; x < TEST_WIDTH; x++) {
+				blur.executePixel(&spatial[(y * TEST_WIDTH + x) * 4], x, y, buffer);
+			}
+		}
+
+		blur.initializeTileData(NULL);
+		for (int y = min_distance; y < TEST_HEIGHT; y++) {
+			for (int x = min_distance; x < TEST_WIDTH; x++) {
+				float fft[4];
+				blur.executePixel(fft, x, y, buffer);
+				for (int channel = 0; channel < 4; channel++) {
+					EXPECT_NEAR(spatial[(y * TEST_WIDTH + x) * 4 + channel], fft[channel], 1e-4f)
+					        << "pixel " << x << ", " << y << " channel " << channel;
+				}
+			}
+		}
+
+		blur.deinitExecution();
+	}
+};
+
+TEST_F(BokehBlurTest, fft_matches_spatial)
+{
+	expect_fft_matches_spatial(COM_QUALITY_HIGH, 0);
+}
+
+/* With a quality step the spatial path starts sampling at the clipped window,
+ * so only pixels with a complete window on the left and bottom are the same. */
+TEST_F(BokehBlurTest, fft_matches_spatial_quality_step)
+{
+	expect_fft_matches_spatial(COM_QUALITY_MEDIUM, 18);
+	expect_fft_matches_spatial(COM_QUALITY_LOW, 18);
+}
+
+/* The FFT path convolves the whole input, the whole input must be calculated first. */
+TEST_F(BokehBlurTest, area_of_interest)
+{
+	PatternBuffer input(TEST_WIDTH, TEST_HEIGHT);
+	rcti tile, area;
+	BLI_rcti_init(&tile, 40, 60, 30, 50);
+
+	BokehBlurOperation fft_blur;
+	setup_blur(&fft_blur, &input, 15.0f, COM_QUALITY_HIGH);
+	EXPECT_TRUE(fft_blur.determineDependingAreaOfInterest(&tile, &input.read, &area));
+	EXPECT_EQ(0, area.xmin);
+	EXPECT_EQ(TEST_WIDTH, area.xmax);
+	EXPECT_EQ(0, area.ymin);
+	EXPECT_EQ(TEST_HEIGHT, area.ymax);
+	fft_blur.deinitExecution();
+
+	/* radius of 6 pixels, only the window around the tile */
+	BokehBlurOperation spatial_blur;
+	setup_blur(&spatial_blur, &input, 5.0f, COM_QUALITY_HIGH);
+	EXPECT_TRUE(spatial_blur.determineDependingAreaOfInterest(&tile, &input.read, &area));
+	EXPECT_EQ(34, area.xmin);
+	EXPECT_EQ(66, area.xmax);
+	EXPECT_EQ(24, area.ymin);
+	EXPECT_EQ(56, area.ymax);
+	spatial_blur.deinitExecution();
+}
@@ -0,0 +1,142 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "COM_test_operations.h"
+
+#include <cmath>
+
+#include "COM_MemoryBuffer.h"
+#include "COM_MemoryProxy.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_rect.h"
+}
+
+#define TEST_WIDTH 19
+#define TEST_HEIGHT 11
+
+/* Largest finite half float. */
+#define HALF_MAX 65504.0f
+
+/* Half floats keep 11 significant bits, values round to the nearest one. */
+static float half_tolerance(float value)
+{
+	return max_ff(fabsf(value) / 2048.0f, 1.0f / 16777216.0f);
+}
+
+class MemoryBufferHalfTest : public testing::Test {
+protected:
+	MemoryProxy m_proxy;
+	MemoryBuffer *m_buffer;
+
+	MemoryBufferHalfTest() : m_proxy(COM_DT_COLOR), m_buffer(NULL) {}
+
+	virtual void SetUp()
+	{
+		m_proxy.setHalfFloat(true);
+		m_proxy.allocate(TEST_WIDTH, TEST_HEIGHT);
+		m_buffer = m_proxy.getBuffer();
+		ASSERT_TRUE(m_buffer->isHalfFloat());
+	}
+
+	virtual void TearDown()
+	{
+		m_proxy.free();
+	}
+};
+
+TEST_F(MemoryBufferHalfTest, write_read)
+{
+	EXPECT_TRUE(m_buffer->getBuffer() == NULL);
+	EXPECT_EQ(sizeof(unsigned short) * 4 * TEST_WIDTH * TEST_HEIGHT, m_buffer->getMemorySize());
+
+	/* The pattern scaled over the whole half range, small and large values. */
+	for (int y = 0; y < TEST_HEIGHT; y++) {
+		for (int x = 0; x < TEST_WIDTH; x++) {
+			float color[4];
+			for (int channel = 0; channel < 4; channel++) {
+				color[channel] = pattern_value(x, y, channel) * powf(10.0f, (float)((x + y) % 10 - 5));
+			}
+			m_buffer->writePixel(x, y, color);
+		}
+	}
+
+	for (int y = 0; y < TEST_HEIGHT; y++) {
+		for (int x = 0; x < TEST_WIDTH; x++) {
+			float result[4];
+			m_buffer->read(result, x, y);
+			for (int channel = 0; channel < 4; channel++) {
+				const float expected = pattern_value(x, y, channel) * powf(10.0f, (float)((x + y) % 10 - 5));
+				EXPECT_NEAR(expected, result[channel], half_tolerance(expected))
+				        << "pixel " << x << ", " << y << " channel " << channel;
+			}
+		}
+	}
+}
+
+TEST_F(MemoryBufferHalfTest, exact_values)
+{
+	const float color[4] = {0.0f, 1.0f, -0.5f, HALF_MAX};
+	m_buffer->writePixel(3, 4, color);
+
+	float result[4];
+	m_buffer->read(result, 3, 4);
+	for (int channel = 0; channel < 4; channel++) {
+		EXPECT_EQ(color[channel], result[channel]);
+	}
+}
+
+/* Values beyond the half range are clamped instead of becoming infinite, infinity is kept. */
+TEST_F(MemoryBufferHalfTest, clamp)
+{
+	const float color[4] = {70000.0f, -1e10f, 65519.0f, INFINITY};
+	m_buffer->writePixel(0, 0, color);
+
+	float result[4];
+	m_buffer->read(result, 0, 0);
+	EXPECT_EQ(HALF_MAX, result[0]);
+	EXPECT_EQ(-HALF_MAX, result[1]);
+	EXPECT_EQ(HALF_MAX, result[2]);
+	EXPECT_TRUE(std::isinf(result[3]));
+
+	/* Accumulating past the range clamps as well. */
+	const float half_color[4] = {40000.0f, 40000.0f, 40000.0f, 40000.0f};
+	m_buffer->writePixel(1, 0, half_color);
+	m_buffer->addPixel(1, 0, half_color);
+	m_buffer->read(result, 1, 0);
+	for (int channel = 0; channel < 4; channel++) {
+		EXPECT_EQ(HALF_MAX, result[channel]);
+	}
+}
+
+/* Copying from a float buffer converts, with the same clamping. */
+TEST_F(MemoryBufferHalfTest, copy_from_float)
+{
+	rcti rect;
+	BLI_rcti_init(&rect, 0, TEST_WIDTH, 0, TEST_HEIGHT);
+	MemoryBuffer float_buffer(COM_DT_COLOR, &rect);
+	for (int y = 0; y < TEST_HEIGHT; y++) {
+		for (int x = 0; x < TEST_WIDTH; x++) {
+			float *elem = float_buffer.getElem(x, y);
+			for (int channel = 0; channel < 4; channel++) {
+				elem[channel] = pattern_value(x, y, channel) * 1e5f;
+			}
+		}
+	}
+
+	m_buffer->copyContentFrom(&float_buffer);
+
+	for (int y = 0; y < TEST_HEIGHT; y++) {
+		for (int x = 0; x < TEST_WIDTH; x++) {
+			float result[4];
+			m_buffer->read(result, x, y);
+			for (int channel = 0; channel < 4; channel++) {
+				const float value = float_buffer.getElem(x, y)[channel];
+				const float expected = max_ff(min_ff(value, HALF_MAX), -HALF_MAX);
+				EXPECT_NEAR(expected, result[channel], half_tolerance(expected))
+				        << "pixel " << x << ", " << y << " channel " << channel;
+			}
+		}
+	}
+}
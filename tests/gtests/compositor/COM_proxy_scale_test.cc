@@ -0,0 +1,172 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "COM_test_operations.h"
+
+#include "COM_ExecutionGroup.h"
+#include "COM_GammaOperation.h"
+#include "COM_ScaleOperation.h"
+#include "COM_SetValueOperation.h"
+
+extern "C" {
+#include "BLI_rect.h"
+}
+
+#define TEST_WIDTH 64
+#define TEST_HEIGHT 48
+#define TEST_CHUNK_SIZE 4
+
+static void determine_resolution(NodeOperation *operation)
+{
+	unsigned int resolution[2];
+	unsigned int preferredResolution[2] = {TEST_WIDTH, TEST_HEIGHT};
+	operation->determineResolution(resolution, preferredResolution);
+	operation->setResolution(resolution);
+}
+
+/* Gamma of the pattern, per pixel so the full and proxy resolution results are comparable. */
+class GammaGraph {
+public:
+	SetValueOperation gamma_value;
+	GammaOperation gamma;
+
+	GammaGraph(NodeOperation *input)
+	{
+		this->gamma_value.setValue(2.2f);
+		connect_input(&this->gamma, 0, input);
+		connect_input(&this->gamma, 1, &this->gamma_value);
+	}
+};
+
+static void expect_proxy_matches_full(float scale)
+{
+	PatternOperation pattern(COM_DT_COLOR);
+	set_test_resolution(&pattern, TEST_WIDTH, TEST_HEIGHT);
+
+	GammaGraph full(&pattern);
+	determine_resolution(&full.gamma);
+
+	ProxyScaleOperation proxy(COM_DT_COLOR, scale);
+	connect_input(&proxy, 0, &pattern);
+	GammaGraph scaled(&proxy);
+	determine_resolution(&scaled.gamma);
+
+	/* scaled back up like the inputs of the outputs */
+	ProxyScaleOperation output(COM_DT_COLOR, 1.0f / scale);
+	connect_input(&output, 0, &scaled.gamma);
+	determine_resolution(&output);
+
+	const int proxy_width = TEST_WIDTH * scale;
+	const int proxy_height = TEST_HEIGHT * scale;
+	ASSERT_EQ(proxy_width, scaled.gamma.getWidth());
+	ASSERT_EQ(proxy_height, scaled.gamma.getHeight());
+	ASSERT_EQ(TEST_WIDTH, output.getWidth());
+	ASSERT_EQ(TEST_HEIGHT, output.getHeight());
+
+	NodeOperation *operations[] = {&full.gamma_value, &full.gamma, &proxy, &scaled.gamma_value,
+	                               &scaled.gamma, &output};
+	for (size_t index = 0; index < ARRAY_SIZE(operations); index++) {
+		operations[index]->initExecution();
+	}
+
+	/* the proxy is the full resolution result downscaled with nearest sampling */
+	for (int y = 0; y < proxy_height; y++) {
+		for (int x = 0; x < proxy_width; x++) {
+			float result[4], expected[4];
+			scaled.gamma.readSampled(result, x, y, COM_PS_NEAREST);
+			full.gamma.readSampled(expected, (int)((x + 0.5f) / scale), (int)((y + 0.5f) / scale), COM_PS_NEAREST);
+			for (int channel = 0; channel < 4; channel++) {
+				EXPECT_EQ(expected[channel], result[channel])
+				        << "scale " << scale << " pixel " << x << ", " << y << " channel " << channel;
+			}
+		}
+	}
+
+	/* scaling back up repeats the proxy pixels */
+	for (int y = 0; y < TEST_HEIGHT; y++) {
+		for (int x = 0; x < TEST_WIDTH; x++) {
+			float result[4], expected[4];
+			output.readSampled(result, x, y, COM_PS_NEAREST);
+			scaled.gamma.readSampled(expected, (int)((x + 0.5f) * scale), (int)((y + 0.5f) * scale), COM_PS_NEAREST);
+			for (int channel = 0; channel < 4; channel++) {
+				EXPECT_EQ(expected[channel], result[channel])
+				        << "scale " << scale << " pixel " << x << ", " << y << " channel " << channel;
+			}
+		}
+	}
+
+	for (size_t index = 0; index < ARRAY_SIZE(operations); index++) {
+		operations[index]->deinitExecution();
+	}
+}
+
+TEST(ProxyScale, matches_full_resolution)
+{
+	expect_proxy_matches_full(0.5f);
+	expect_proxy_matches_full(0.25f);
+	expect_proxy_matches_full(0.125f);
+}
+
+/* Viewer output, only used to limit the chunks of its group. */
+class RegionViewerOperation : public NodeOperation {
+public:
+	RegionViewerOperation() : NodeOperation()
+	{
+		this->addInputSocket(COM_DT_COLOR);
+	}
+
+	bool isOutputOperation(bool /*rendering*/) const { return true; }
+	bool isViewerOperation() const { return true; }
+};
+
+/* Chunks outside the visible region of the viewer are never calculated, and of the input only
+ * the area the region depends on is requested. */
+TEST(ProxyScale, viewer_region)
+{
+	PatternBuffer input(TEST_WIDTH, TEST_HEIGHT);
+	ProxyScaleOperation proxy(COM_DT_COLOR, 0.5f);
+	connect_input(&proxy, 0, &input.read);
+	RegionViewerOperation viewer;
+	connect_input(&viewer, 0, &proxy);
+	determine_resolution(&viewer);
+
+	ExecutionGroup group;
+	ASSERT_TRUE(group.addOperation(&viewer));
+	ASSERT_TRUE(group.addOperation(&proxy));
+	unsigned int resolution[2];
+	group.determineResolution(resolution);
+	ASSERT_EQ(TEST_WIDTH / 2, resolution[0]);
+	ASSERT_EQ(TEST_HEIGHT / 2, resolution[1]);
+	group.setChunksize(TEST_CHUNK_SIZE);
+	group.setViewerRegion(0.25f, 0.5f, 0.5f, 1.0f);
+	group.initExecution();
+
+	rcti region;
+	BLI_rcti_init(&region, TEST_WIDTH / 8, TEST_WIDTH / 4, TEST_HEIGHT / 4, TEST_HEIGHT / 2);
+
+	/* 6 of the 48 chunks of the image */
+	const unsigned int region_chunks = (BLI_rcti_size_x(&region) / TEST_CHUNK_SIZE) *
+	                                   (BLI_rcti_size_y(&region) / TEST_CHUNK_SIZE);
+	EXPECT_EQ(region_chunks, group.getNumberOfChunks());
+
+	int chunk_pixels = 0;
+	for (unsigned int chunk = 0; chunk < group.getNumberOfChunks(); chunk++) {
+		rcti rect;
+		group.determineChunkRect(&rect, chunk);
+		EXPECT_TRUE(BLI_rcti_inside_rcti(&region, &rect))
+		        << "chunk " << rect.xmin << ", " << rect.ymin << " outside the region";
+		chunk_pixels += BLI_rcti_size_x(&rect) * BLI_rcti_size_y(&rect);
+
+		/* the input area is the chunk at full resolution, plus a pixel for rounding */
+		rcti area;
+		BLI_rcti_init(&area, 0, 0, 0, 0);
+		viewer.determineDependingAreaOfInterest(&rect, &input.read, &area);
+		EXPECT_EQ(rect.xmin * 2, area.xmin);
+		EXPECT_EQ(rect.ymin * 2, area.ymin);
+		EXPECT_EQ(rect.xmax * 2 + 1, area.xmax);
+		EXPECT_EQ(rect.ymax * 2 + 1, area.ymax);
+	}
+	EXPECT_EQ(BLI_rcti_size_x(&region) * BLI_rcti_size_y(&region), chunk_pixels);
+
+	group.deinitExecution();
+}
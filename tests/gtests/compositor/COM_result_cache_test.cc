@@ -0,0 +1,165 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "COM_test_operations.h"
+
+#include "COM_CompositorContext.h"
+#include "COM_ConvertOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MixOperation.h"
+#include "COM_ResultCache.h"
+#include "COM_SetColorOperation.h"
+#include "COM_SetValueOperation.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+#include "BKE_node.h"
+}
+
+class ResultCacheTest : public testing::Test {
+protected:
+	bNodeTree m_ntree;
+	RenderData m_rd;
+	CompositorContext m_context;
+
+	virtual void SetUp()
+	{
+		memset(&m_ntree, 0, sizeof(m_ntree));
+		memset(&m_rd, 0, sizeof(m_rd));
+		m_rd.xsch = 1920;
+		m_rd.ysch = 1080;
+		m_rd.size = 100;
+		m_context.setbNodeTree(&m_ntree);
+		m_context.setRenderData(&m_rd);
+		m_context.setViewName("");
+	}
+
+	uint64_t key(NodeOperation *operation)
+	{
+		uint64_t result = 0;
+		EXPECT_TRUE(ResultCache::calculateKey(m_context, operation, &result));
+		return result;
+	}
+};
+
+/* Constants of unlinked sockets have no node, a changed socket value must change the key. */
+TEST_F(ResultCacheTest, constant_value)
+{
+	SetValueOperation value;
+	value.setValue(1.0f);
+	MathAddOperation add;
+	connect_input(&add, 0, &value);
+	connect_input(&add, 1, &value);
+
+	const uint64_t original = key(&add);
+	value.setValue(2.0f);
+	EXPECT_NE(original, key(&add));
+	value.setValue(1.0f);
+	EXPECT_EQ(original, key(&add));
+}
+
+/* Same for colors, which also come from the sockets of group nodes. */
+TEST_F(ResultCacheTest, constant_color)
+{
+	const float red[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+	const float green[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+	SetValueOperation factor;
+	factor.setValue(0.5f);
+	SetColorOperation color;
+	color.setChannels(red);
+	MixBlendOperation mix;
+	connect_input(&mix, 0, &factor);
+	connect_input(&mix, 1, &color);
+	connect_input(&mix, 2, &color);
+
+	const uint64_t original = key(&mix);
+	color.setChannels(green);
+	EXPECT_NE(original, key(&mix));
+}
+
+/* Nodes read the render size when they are converted to operations. */
+TEST_F(ResultCacheTest, render_data)
+{
+	SetValueOperation value;
+	value.setValue(1.0f);
+
+	const uint64_t original = key(&value);
+	m_rd.size = 50;
+	EXPECT_NE(original, key(&value));
+	m_rd.size = 100;
+	m_rd.xsch = 1280;
+	EXPECT_NE(original, key(&value));
+	m_rd.xsch = 1920;
+	m_rd.mode |= R_BORDER;
+	EXPECT_NE(original, key(&value));
+	m_rd.mode = 0;
+	EXPECT_EQ(original, key(&value));
+}
+
+/* Defocus with a Z buffer depends on the scene camera, which is not part of the node tree. */
+TEST_F(ResultCacheTest, defocus_camera)
+{
+	bNode node;
+	memset(&node, 0, sizeof(node));
+	node.type = CMP_NODE_DEFOCUS;
+	NodeDefocus *data = (NodeDefocus *)MEM_callocN(sizeof(NodeDefocus), __func__);
+	node.storage = data;
+
+	SetValueOperation value;
+	value.setbNode(&node);
+
+	uint64_t result;
+	EXPECT_FALSE(ResultCache::calculateKey(m_context, &value, &result));
+
+	data->no_zbuf = 1;
+	const uint64_t original = key(&value);
+	data->scale = 2.0f;
+	EXPECT_NE(original, key(&value));
+
+	MEM_freeN(data);
+}
+
+/* The channels of a Separate RGBA node are operations of the same type and node which only
+ * differ by the channel, buffering two of them must not share a cache entry. */
+TEST_F(ResultCacheTest, separate_channels)
+{
+	bNode node;
+	memset(&node, 0, sizeof(node));
+	node.type = CMP_NODE_SEPRGBA;
+
+	PatternOperation color(COM_DT_COLOR);
+	set_test_resolution(&color, 4, 4);
+
+	SeparateChannelOperation channels[2];
+	WriteBufferOperation *buffers[2];
+	for (int i = 0; i < 2; i++) {
+		channels[i].setbNode(&node);
+		channels[i].setChannel(i);
+		connect_input(&channels[i], 0, &color);
+		set_test_resolution(&channels[i], 4, 4);
+
+		buffers[i] = new WriteBufferOperation(COM_DT_VALUE);
+		connect_input(buffers[i], 0, &channels[i]);
+		set_test_resolution(buffers[i], 4, 4);
+	}
+
+	/* the channel alone tells them apart */
+	EXPECT_NE(key(buffers[0]), key(buffers[1]));
+
+	/* as do the node output and the order of creation, used for operations without parameters */
+	channels[1].setChannel(0);
+	EXPECT_EQ(key(buffers[0]), key(buffers[1]));
+	channels[1].setbNodeOutputIndex(1);
+	EXPECT_NE(key(buffers[0]), key(buffers[1]));
+	channels[1].setbNodeOutputIndex(-1);
+	channels[1].setbNodeOperationIndex(1);
+	EXPECT_NE(key(buffers[0]), key(buffers[1]));
+
+	for (int i = 0; i < 2; i++) {
+		delete buffers[i];
+	}
+}
@@ -0,0 +1,78 @@
+/* Apache License, Version 2.0 */
+
+#ifndef __COM_TEST_OPERATIONS_H__
+#define __COM_TEST_OPERATIONS_H__
+
+#include "COM_MemoryProxy.h"
+#include "COM_NodeOperation.h"
+#include "COM_ReadBufferOperation.h"
+
+/* Different value for every pixel and channel, including negative values and zeros. */
+inline float pattern_value(int x, int y, int channel)
+{
+	return (float)((x * 7 + y * 13 + channel * 5) % 31) * 0.05f - 0.2f;
+}
+
+/* Input operation reading the pattern, it supports any coordinate so inputs
+ * of translated areas are defined everywhere. */
+class PatternOperation : public NodeOperation {
+private:
+	int m_num_channels;
+
+public:
+	PatternOperation(DataType datatype) : NodeOperation()
+	{
+		this->addOutputSocket(datatype);
+		this->m_num_channels = (datatype == COM_DT_VALUE) ? 1 : (datatype == COM_DT_VECTOR) ? 3 : 4;
+	}
+
+	void executePixelSampled(float output[4], float x, float y, PixelSampler /*sampler*/)
+	{
+		for (int channel = 0; channel < this->m_num_channels; channel++) {
+			output[channel] = pattern_value((int)x, (int)y, channel);
+		}
+	}
+};
+
+inline void set_test_resolution(NodeOperation *operation, unsigned int width, unsigned int height)
+{
+	unsigned int resolution[2] = {width, height};
+	operation->setResolution(resolution);
+}
+
+inline void connect_input(NodeOperation *operation, unsigned int index, NodeOperation *input)
+{
+	operation->getInputSocket(index)->setLink(input->getOutputSocket());
+}
+
+/* Color buffer filled with the pattern, complex operations read their input from it. */
+class PatternBuffer {
+public:
+	MemoryProxy proxy;
+	ReadBufferOperation read;
+
+	PatternBuffer(unsigned int width, unsigned int height) : proxy(COM_DT_COLOR), read(COM_DT_COLOR)
+	{
+		this->proxy.allocate(width, height);
+		MemoryBuffer *buffer = this->proxy.getBuffer();
+		for (unsigned int y = 0; y < height; y++) {
+			for (unsigned int x = 0; x < width; x++) {
+				float *elem = buffer->getElem(x, y);
+				for (int channel = 0; channel < 4; channel++) {
+					elem[channel] = pattern_value(x, y, channel);
+				}
+			}
+		}
+
+		this->read.setMemoryProxy(&this->proxy);
+		this->read.updateMemoryBuffer();
+		set_test_resolution(&this->read, width, height);
+	}
+
+	~PatternBuffer()
+	{
+		this->proxy.free();
+	}
+};
+
+#endif  /* __COM_TEST_OPERATIONS_H__ */
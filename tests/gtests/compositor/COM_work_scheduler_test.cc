@@ -0,0 +1,93 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "COM_test_operations.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "COM_CompositorContext.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_WorkScheduler.h"
+
+#define TEST_SIZE 128
+#define TEST_CHUNK_SIZE 8
+#define TEST_THREADS 4
+
+/* Output operation counting how often every chunk is executed and by which thread. The first
+ * chunks wait until all chunks are scheduled, so every queue has work before any thread runs out. */
+class CountingOperation : public NodeOperation {
+public:
+	std::vector<std::atomic<int> > executions;
+	std::atomic<int> thread_executions[TEST_THREADS];
+	std::atomic<bool> scheduled;
+
+	CountingOperation(int num_chunks) : NodeOperation(), executions(num_chunks), scheduled(false)
+	{
+		this->addOutputSocket(COM_DT_COLOR);
+		for (int chunk = 0; chunk < num_chunks; chunk++) {
+			executions[chunk] = 0;
+		}
+		for (int thread = 0; thread < TEST_THREADS; thread++) {
+			thread_executions[thread] = 0;
+		}
+	}
+
+	bool isOutputOperation(bool /*rendering*/) const { return true; }
+
+	void executeRegion(rcti * /*rect*/, unsigned int chunkNumber)
+	{
+		while (!scheduled) {
+			std::this_thread::yield();
+		}
+
+		const int thread = WorkScheduler::current_thread_id();
+		executions[chunkNumber]++;
+		thread_executions[thread]++;
+
+		/* the first thread is slow, the others run out of work and take chunks from its queue */
+		if (thread == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+};
+
+TEST(WorkScheduler, steal_chunks_once)
+{
+	const int num_chunks = (TEST_SIZE / TEST_CHUNK_SIZE) * (TEST_SIZE / TEST_CHUNK_SIZE);
+	CountingOperation operation(num_chunks);
+	set_test_resolution(&operation, TEST_SIZE, TEST_SIZE);
+
+	ExecutionGroup group;
+	ASSERT_TRUE(group.addOperation(&operation));
+	unsigned int resolution[2];
+	group.determineResolution(resolution);
+	group.setChunksize(TEST_CHUNK_SIZE);
+	group.initExecution();
+
+	CompositorContext context;
+	WorkScheduler::initialize(false, TEST_THREADS);
+	WorkScheduler::start(context);
+	for (int chunk = 0; chunk < num_chunks; chunk++) {
+		WorkScheduler::schedule(&group, chunk);
+	}
+	operation.scheduled = true;
+	WorkScheduler::finish();
+	WorkScheduler::stop();
+	WorkScheduler::deinitialize();
+	group.deinitExecution();
+
+	for (int chunk = 0; chunk < num_chunks; chunk++) {
+		EXPECT_EQ(1, operation.executions[chunk]) << "chunk " << chunk;
+	}
+
+	/* the queues were filled evenly, the slow thread must have lost chunks to the others */
+	int total = 0;
+	for (int thread = 0; thread < TEST_THREADS; thread++) {
+		total += operation.thread_executions[thread];
+	}
+	EXPECT_EQ(num_chunks, total);
+	EXPECT_LT(operation.thread_executions[0], num_chunks / TEST_THREADS);
+}
@@ -0,0 +1,92 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "IMB_test_movie.h"
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "BLI_fileops.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+#define TEST_WIDTH 64
+#define TEST_HEIGHT 48
+#define TEST_FRAMES 20
+
+class AnimTest : public testing::Test {
+protected:
+	std::string m_dir;
+	std::string m_movie;
+
+	virtual void SetUp()
+	{
+		IMB_init();
+		IMB_ffmpeg_init();
+
+		m_dir = testing::internal::TempDir() + "imbuf_anim_test";
+		BLI_dir_create_recursive(m_dir.c_str());
+		m_movie = m_dir + "/movie.avi";
+		ASSERT_TRUE(imb_test_write_movie(m_movie.c_str(), TEST_WIDTH, TEST_HEIGHT, TEST_FRAMES));
+	}
+
+	virtual void TearDown()
+	{
+		BLI_delete(m_dir.c_str(), true, true);
+		IMB_exit();
+	}
+};
+
+static std::vector<unsigned int> frame_pixels(struct anim *anim, int frame)
+{
+	std::vector<unsigned int> pixels;
+	ImBuf *ibuf = IMB_anim_absolute(anim, frame, IMB_TC_NONE, IMB_PROXY_NONE);
+
+	if (ibuf == NULL || ibuf->rect == NULL) {
+		ADD_FAILURE() << "frame " << frame << " not decoded";
+	}
+	else {
+		pixels.assign(ibuf->rect, ibuf->rect + ibuf->x * ibuf->y);
+	}
+
+	IMB_freeImBuf(ibuf);
+	return pixels;
+}
+
+/* Fetch the frame and overwrite the returned buffer, like drawing into it does. */
+static void frame_overwrite(struct anim *anim, int frame)
+{
+	ImBuf *ibuf = IMB_anim_absolute(anim, frame, IMB_TC_NONE, IMB_PROXY_NONE);
+
+	ASSERT_TRUE(ibuf != NULL && ibuf->rect != NULL);
+	memset(ibuf->rect, 0, sizeof(unsigned int) * ibuf->x * ibuf->y);
+	IMB_freeImBuf(ibuf);
+}
+
+/* Frames fetched again from the window of decoded frames must not show the changes callers
+ * made to the buffer they got before. */
+TEST_F(AnimTest, frame_window_copy)
+{
+	char colorspace[IM_MAX_SPACE] = "";
+	struct anim *reference = IMB_open_anim(m_movie.c_str(), IB_rect, 0, colorspace);
+	struct anim *anim = IMB_open_anim(m_movie.c_str(), IB_rect, 0, colorspace);
+	ASSERT_TRUE(reference != NULL);
+	ASSERT_TRUE(anim != NULL);
+
+	const std::vector<unsigned int> expected = frame_pixels(reference, 10);
+	ASSERT_EQ(TEST_WIDTH * TEST_HEIGHT, expected.size());
+
+	/* the decoded buffer, the anim moves past the frame so it is fetched from the window */
+	frame_overwrite(anim, 10);
+	frame_pixels(anim, 11);
+	EXPECT_EQ(expected, frame_pixels(anim, 10));
+
+	/* the buffer fetched from the window */
+	frame_overwrite(anim, 10);
+	EXPECT_EQ(expected, frame_pixels(anim, 10));
+
+	IMB_close_anim(anim);
+	IMB_close_anim(reference);
+}
@@ -0,0 +1,96 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "DNA_color_types.h"
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+/* Large enough for the display buffer to bake the LUT. */
+#define TEST_WIDTH 1024
+#define TEST_HEIGHT 512
+
+class ColormanagementTest : public testing::Test {
+protected:
+	ColorManagedViewSettings m_view_settings;
+	ColorManagedDisplaySettings m_display_settings;
+
+	virtual void SetUp()
+	{
+		IMB_init();
+
+		memset(&m_view_settings, 0, sizeof(m_view_settings));
+		memset(&m_display_settings, 0, sizeof(m_display_settings));
+		STRNCPY(m_display_settings.display_device, IMB_colormanagement_display_get_default_name());
+		STRNCPY(m_view_settings.view_transform,
+		        IMB_colormanagement_view_get_default_name(m_display_settings.display_device));
+		STRNCPY(m_view_settings.look, "None");
+		m_view_settings.gamma = 1.0f;
+	}
+
+	virtual void TearDown()
+	{
+		IMB_exit();
+	}
+};
+
+/* Scene linear values from deep shadows to bright highlights, with varying hue. */
+static ImBuf *linear_test_image(void)
+{
+	ImBuf *ibuf = IMB_allocImBuf(TEST_WIDTH, TEST_HEIGHT, 32, IB_rectfloat);
+
+	for (int y = 0; y < TEST_HEIGHT; y++) {
+		for (int x = 0; x < TEST_WIDTH; x++) {
+			float *pixel = ibuf->rect_float + ((size_t)y * TEST_WIDTH + x) * 4;
+			const float exposure = -10.0f + 14.0f * x / (TEST_WIDTH - 1);
+			const float hue = (float)y / (TEST_HEIGHT - 1);
+			pixel[0] = powf(2.0f, exposure);
+			pixel[1] = powf(2.0f, exposure - 2.0f * hue);
+			pixel[2] = powf(2.0f, exposure - 4.0f * (1.0f - hue));
+			pixel[3] = 1.0f;
+		}
+	}
+
+	return ibuf;
+}
+
+/* The display buffer uses the baked LUT, compare against the exact display transform. */
+TEST_F(ColormanagementTest, display_lut_error)
+{
+	ImBuf *ibuf = linear_test_image();
+	const size_t num_pixels = (size_t)TEST_WIDTH * TEST_HEIGHT;
+
+	void *cache_handle;
+	unsigned char *display_buffer = IMB_display_buffer_acquire(ibuf, &m_view_settings, &m_display_settings,
+	                                                           &cache_handle);
+	ASSERT_TRUE(display_buffer != NULL);
+
+	float *exact = (float *)MEM_dupallocN(ibuf->rect_float);
+	ColormanageProcessor *cm_processor = IMB_colormanagement_display_processor_new(&m_view_settings,
+	                                                                                &m_display_settings);
+	IMB_colormanagement_processor_apply(cm_processor, exact, TEST_WIDTH, TEST_HEIGHT, 4, true);
+	IMB_colormanagement_processor_free(cm_processor);
+
+	unsigned char *exact_byte = (unsigned char *)MEM_mallocN(num_pixels * 4, __func__);
+	IMB_buffer_byte_from_float(exact_byte, exact, 4, 0.0f, IB_PROFILE_SRGB, IB_PROFILE_SRGB, true,
+	                           TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH, TEST_WIDTH);
+
+	int max_error = 0;
+	for (size_t i = 0; i < num_pixels * 4; i++) {
+		max_error = max_ii(max_error, abs((int)display_buffer[i] - (int)exact_byte[i]));
+	}
+	EXPECT_LE(max_error, 1);
+
+	MEM_freeN(exact_byte);
+	MEM_freeN(exact);
+	IMB_display_buffer_release(cache_handle);
+	IMB_freeImBuf(ibuf);
+}
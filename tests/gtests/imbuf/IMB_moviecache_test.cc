@@ -0,0 +1,270 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_CacheLimiterC-Api.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BKE_appdir.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
+}
+
+#define TEST_SIZE 64
+#define TEST_FRAMES 16
+
+/* Room for this many frames in memory, less than the frames of a test. */
+#define TEST_MEMORY_FRAMES 5
+
+static unsigned int test_hash(const void *key)
+{
+	return *(const int *)key;
+}
+
+static bool test_cmp(const void *a, const void *b)
+{
+	return *(const int *)a != *(const int *)b;
+}
+
+static unsigned char test_byte_value(int frame, int i)
+{
+	return (unsigned char)((frame * 31 + i * 7) % 251);
+}
+
+static float test_float_value(int frame, int i)
+{
+	return (float)(frame * 1000 + i % 1000) * 0.25f;
+}
+
+/* Even frames have float pixels, odd frames byte pixels. The patterns compress,
+ * the noise of frame 1 doesn't and is stored as is. */
+static ImBuf *test_frame(int frame)
+{
+	const bool use_float = (frame % 2) == 0;
+	ImBuf *ibuf = IMB_allocImBuf(TEST_SIZE, TEST_SIZE, 32, use_float ? IB_rectfloat : IB_rect);
+	const int len = TEST_SIZE * TEST_SIZE * 4;
+
+	for (int i = 0; i < len; i++) {
+		if (use_float) {
+			ibuf->rect_float[i] = test_float_value(frame, i);
+		}
+		else if (frame == 1) {
+			((unsigned char *)ibuf->rect)[i] = (unsigned char)((i * 2654435761u) >> 24);
+		}
+		else {
+			((unsigned char *)ibuf->rect)[i] = test_byte_value(frame, i);
+		}
+	}
+
+	return ibuf;
+}
+
+static void expect_test_frame(ImBuf *ibuf, int frame)
+{
+	ImBuf *expected = test_frame(frame);
+
+	EXPECT_EQ(TEST_SIZE, ibuf->x);
+	EXPECT_EQ(TEST_SIZE, ibuf->y);
+	if (expected->rect_float) {
+		ASSERT_TRUE(ibuf->rect_float != NULL);
+		EXPECT_EQ(0, memcmp(expected->rect_float, ibuf->rect_float, sizeof(float) * 4 * TEST_SIZE * TEST_SIZE));
+	}
+	else {
+		ASSERT_TRUE(ibuf->rect != NULL);
+		EXPECT_EQ(0, memcmp(expected->rect, ibuf->rect, sizeof(unsigned int) * TEST_SIZE * TEST_SIZE));
+	}
+
+	IMB_freeImBuf(expected);
+}
+
+class MovieCacheTest : public testing::Test {
+protected:
+	size_t m_memory_limit;
+
+	virtual void SetUp()
+	{
+		BKE_tempdir_init(NULL);
+
+		/* memory of a float frame with its cache item */
+		const size_t frame_size = sizeof(ImBuf) + sizeof(float) * 4 * TEST_SIZE * TEST_SIZE + 256;
+
+		m_memory_limit = MEM_CacheLimiter_get_maximum();
+		MEM_CacheLimiter_set_maximum(frame_size * TEST_MEMORY_FRAMES);
+		IMB_moviecache_set_disk_limit(64 * 1024 * 1024);
+	}
+
+	virtual void TearDown()
+	{
+		IMB_moviecache_set_disk_limit(0);
+		MEM_CacheLimiter_set_maximum(m_memory_limit);
+		BKE_tempdir_session_purge();
+	}
+
+	MovieCache *create_cache(const char *name, int priority, bool use_disk_spill)
+	{
+		MovieCache *cache = IMB_moviecache_create(name, sizeof(int), test_hash, test_cmp);
+		IMB_moviecache_set_cache_priority(cache, priority);
+		IMB_moviecache_set_disk_spill(cache, use_disk_spill);
+		return cache;
+	}
+
+	void put_frame(MovieCache *cache, int frame)
+	{
+		ImBuf *ibuf = test_frame(frame);
+		IMB_moviecache_put(cache, &frame, ibuf);
+		IMB_freeImBuf(ibuf);
+	}
+
+	/* Number of frames which are still cached, the pixels must be the original ones. */
+	int count_frames(MovieCache *cache, int totframe)
+	{
+		int count = 0;
+		for (int frame = 0; frame < totframe; frame++) {
+			ImBuf *ibuf = IMB_moviecache_get(cache, &frame);
+			if (ibuf) {
+				expect_test_frame(ibuf, frame);
+				IMB_freeImBuf(ibuf);
+				count++;
+			}
+		}
+		return count;
+	}
+};
+
+/* Frames the limitor frees are written to disk and read back on access. */
+TEST_F(MovieCacheTest, spill_round_trip)
+{
+	MovieCache *cache = create_cache("spill test", IMB_MOVIECACHE_PRIORITY_NORMAL, true);
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		put_frame(cache, frame);
+	}
+
+	/* reading the frames back spills others again */
+	EXPECT_EQ(TEST_FRAMES, count_frames(cache, TEST_FRAMES));
+	EXPECT_EQ(TEST_FRAMES, count_frames(cache, TEST_FRAMES));
+
+	IMB_moviecache_free(cache);
+}
+
+/* Without disk spill the same frames don't fit. */
+TEST_F(MovieCacheTest, no_spill)
+{
+	MovieCache *cache = create_cache("memory test", IMB_MOVIECACHE_PRIORITY_NORMAL, false);
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		put_frame(cache, frame);
+	}
+	EXPECT_LT(count_frames(cache, TEST_FRAMES), TEST_FRAMES);
+
+	IMB_moviecache_free(cache);
+}
+
+/* The disk limit stops spilling, frames which don't fit are freed. */
+TEST_F(MovieCacheTest, spill_disk_limit)
+{
+	MovieCache *cache = create_cache("disk limit test", IMB_MOVIECACHE_PRIORITY_NORMAL, true);
+	IMB_moviecache_set_disk_limit(0);
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		put_frame(cache, frame);
+	}
+	EXPECT_LT(count_frames(cache, TEST_FRAMES), TEST_FRAMES);
+
+	IMB_moviecache_free(cache);
+}
+
+/* Frames of the low priority cache are freed first, even when they were added last.
+ * Only float frames, each cache fits in memory on its own. */
+TEST_F(MovieCacheTest, cache_priority)
+{
+	const int totframe = (TEST_MEMORY_FRAMES - 1) * 2;
+	MovieCache *low = create_cache("low priority test", IMB_MOVIECACHE_PRIORITY_LOW, false);
+	MovieCache *high = create_cache("high priority test", IMB_MOVIECACHE_PRIORITY_HIGH, false);
+
+	for (int frame = 0; frame < totframe; frame += 2) {
+		put_frame(high, frame);
+		put_frame(low, frame);
+	}
+
+	EXPECT_EQ(totframe / 2, count_frames(high, totframe));
+	EXPECT_LT(count_frames(low, totframe), totframe / 2);
+
+	IMB_moviecache_free(low);
+	IMB_moviecache_free(high);
+}
+
+static bool test_cleanup_check(ImBuf *ibuf, void * /*userkey*/, void *userdata)
+{
+	int *num_null = (int *)userdata;
+	if (ibuf == NULL) {
+		(*num_null)++;
+	}
+	else {
+		EXPECT_TRUE(ibuf->rect != NULL || ibuf->rect_float != NULL);
+	}
+	return false;
+}
+
+/* Items on disk have no buffer for the iterators and the cleanup callback. */
+TEST_F(MovieCacheTest, spill_cleanup)
+{
+	MovieCache *cache = create_cache("cleanup test", IMB_MOVIECACHE_PRIORITY_NORMAL, true);
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		put_frame(cache, frame);
+	}
+
+	int num_iter_null = 0, num_items = 0;
+	struct MovieCacheIter *iter = IMB_moviecacheIter_new(cache);
+	while (!IMB_moviecacheIter_done(iter)) {
+		ImBuf *ibuf = IMB_moviecacheIter_getImBuf(iter);
+		if (ibuf == NULL) {
+			num_iter_null++;
+		}
+		else {
+			EXPECT_TRUE(ibuf->rect != NULL || ibuf->rect_float != NULL);
+		}
+		num_items++;
+		IMB_moviecacheIter_step(iter);
+	}
+	IMB_moviecacheIter_free(iter);
+
+	int num_cleanup_null = 0;
+	IMB_moviecache_cleanup(cache, test_cleanup_check, &num_cleanup_null);
+
+	EXPECT_EQ(TEST_FRAMES, num_items);
+	EXPECT_GT(num_iter_null, 0);
+	EXPECT_EQ(num_iter_null, num_cleanup_null);
+	EXPECT_EQ(TEST_FRAMES, count_frames(cache, TEST_FRAMES));
+
+	IMB_moviecache_free(cache);
+}
+
+/* With a deferred flush the buffers wait in memory until the owner writes them, frames
+ * taken back before that still have their pixels. */
+TEST_F(MovieCacheTest, spill_deferred_flush)
+{
+	MovieCache *cache = create_cache("deferred flush test", IMB_MOVIECACHE_PRIORITY_NORMAL, true);
+	IMB_moviecache_set_defer_spill_flush(cache, true);
+
+	for (int frame = 0; frame < TEST_FRAMES; frame++) {
+		put_frame(cache, frame);
+	}
+
+	int frame = 0;
+	ImBuf *ibuf = IMB_moviecache_get(cache, &frame);
+	ASSERT_TRUE(ibuf != NULL);
+	expect_test_frame(ibuf, frame);
+	IMB_freeImBuf(ibuf);
+
+	IMB_moviecache_spill_flush();
+	EXPECT_EQ(TEST_FRAMES, count_frames(cache, TEST_FRAMES));
+	IMB_moviecache_spill_flush();
+	EXPECT_EQ(TEST_FRAMES, count_frames(cache, TEST_FRAMES));
+	IMB_moviecache_spill_flush();
+
+	IMB_moviecache_free(cache);
+}
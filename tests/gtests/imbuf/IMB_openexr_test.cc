@@ -0,0 +1,224 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_threads.h"
+#include "DNA_scene_types.h"
+#include "IMB_imbuf.h"
+#include "intern/openexr/openexr_multi.h"
+}
+
+/* Not a multiple of the tile size, so there are partial tiles at the borders. */
+#define TEST_WIDTH 100
+#define TEST_HEIGHT 70
+#define TEST_TILE 64
+
+/* Half channels are written in chunks of at least 256 scanlines when running on one thread. */
+#define TEST_TALL_WIDTH 16
+#define TEST_TALL_HEIGHT 600
+
+/* Marks pixels which were not read. */
+#define UNREAD_VALUE -1.0f
+
+#define TEST_LAYERS 2
+#define TEST_VIEWS 2
+
+static const char *test_layers[TEST_LAYERS] = {"A", "B"};
+static const char test_chan_id[] = "RGBA";
+
+/* Values which are exact in half float too, different for each layer, view, pixel and channel. */
+static float test_value(int layer, int view, int x, int y, int channel)
+{
+	return (float)(layer * 64 + view * 32 + channel * 8 + (x + y) % 8) / 16.0f;
+}
+
+/* Interleaved RGBA pass, the layout of a render pass. */
+static std::vector<float> test_pass(int layer, int view, int width = TEST_WIDTH, int height = TEST_HEIGHT)
+{
+	std::vector<float> rect(width * height * 4);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			for (int channel = 0; channel < 4; channel++) {
+				rect[(y * width + x) * 4 + channel] = test_value(layer, view, x, y, channel);
+			}
+		}
+	}
+	return rect;
+}
+
+/* Name of a channel as given to IMB_exr_set_channel, the view goes before the channel. */
+static std::string test_channel_name(const char *view, int channel)
+{
+	std::string name = "Combined";
+	if (view[0]) {
+		name += ".";
+		name += view;
+	}
+	name += ".";
+	name += test_chan_id[channel];
+	return name;
+}
+
+class OpenEXRTest : public testing::Test {
+protected:
+	std::string m_filepath;
+	int m_width, m_height;
+
+	virtual void SetUp()
+	{
+		IMB_init();
+		m_width = TEST_WIDTH;
+		m_height = TEST_HEIGHT;
+		m_filepath = testing::internal::TempDir() + "IMB_openexr_test.exr";
+	}
+
+	virtual void TearDown()
+	{
+		BLI_delete(m_filepath.c_str(), false, false);
+		BLI_system_num_threads_override_set(0);
+		IMB_exit();
+	}
+
+	/* Multilayer file with both test layers, written with IMB_exr_begin_write. */
+	void write_multilayer(bool use_half_float, bool use_tiles)
+	{
+		std::vector<float> rects[TEST_LAYERS];
+		void *handle = IMB_exr_get_handle();
+
+		for (int layer = 0; layer < TEST_LAYERS; layer++) {
+			rects[layer] = test_pass(layer, 0, m_width, m_height);
+			for (int channel = 0; channel < 4; channel++) {
+				IMB_exr_add_channel(handle, test_layers[layer], test_channel_name("", channel).c_str(), "",
+				                    4, 4 * m_width, &rects[layer][channel], use_half_float);
+			}
+		}
+
+		if (use_tiles) {
+			IMB_exr_set_tile_size(handle, TEST_TILE, TEST_TILE);
+		}
+		ASSERT_TRUE(IMB_exr_begin_write(handle, m_filepath.c_str(), m_width, m_height, R_IMF_EXR_CODEC_ZIP, NULL));
+		IMB_exr_write_channels(handle);
+		IMB_exr_close(handle);
+	}
+
+	/* Read only the given layer of a file, the view selects the part of multipart files. */
+	void expect_read_layer(int layer, const char *view, int view_id)
+	{
+		void *handle = IMB_exr_get_handle();
+		int width, height;
+		ASSERT_TRUE(IMB_exr_begin_read(handle, m_filepath.c_str(), &width, &height));
+		ASSERT_EQ(m_width, width);
+		ASSERT_EQ(m_height, height);
+
+		std::vector<float> rect(m_width * m_height * 4, UNREAD_VALUE);
+		for (int channel = 0; channel < 4; channel++) {
+			IMB_exr_set_channel(handle, test_layers[layer], test_channel_name(view, channel).c_str(),
+			                    4, 4 * m_width, &rect[channel]);
+		}
+		IMB_exr_read_channels(handle);
+
+		/* The layer that was not requested has no rect. */
+		for (int other = 0; other < TEST_LAYERS; other++) {
+			if (other != layer) {
+				EXPECT_TRUE(IMB_exr_channel_rect(handle, test_layers[other], "Combined.R", view) == NULL);
+			}
+		}
+		IMB_exr_close(handle);
+
+		const std::vector<float> expected = test_pass(layer, view_id, m_width, m_height);
+		for (size_t i = 0; i < rect.size(); i++) {
+			EXPECT_EQ(expected[i], rect[i]) << "pixel " << i / 4 << " channel " << i % 4;
+		}
+	}
+};
+
+TEST_F(OpenEXRTest, channel_subset)
+{
+	write_multilayer(false, false);
+	expect_read_layer(1, "", 0);
+	expect_read_layer(0, "", 0);
+}
+
+TEST_F(OpenEXRTest, channel_subset_half_float)
+{
+	write_multilayer(true, false);
+	expect_read_layer(1, "", 0);
+}
+
+TEST_F(OpenEXRTest, channel_subset_tiles)
+{
+	write_multilayer(false, true);
+	expect_read_layer(0, "", 0);
+	expect_read_layer(1, "", 0);
+}
+
+/* Half channels are converted in chunks of scanlines, the last one partial. */
+TEST_F(OpenEXRTest, channel_subset_half_float_chunks)
+{
+	BLI_system_num_threads_override_set(1);
+	m_width = TEST_TALL_WIDTH;
+	m_height = TEST_TALL_HEIGHT;
+
+	write_multilayer(true, false);
+	expect_read_layer(0, "", 0);
+	expect_read_layer(1, "", 0);
+}
+
+TEST_F(OpenEXRTest, channel_subset_half_float_chunks_tiles)
+{
+	BLI_system_num_threads_override_set(1);
+	m_width = TEST_TALL_WIDTH;
+	m_height = TEST_TALL_HEIGHT;
+
+	write_multilayer(true, true);
+	expect_read_layer(0, "", 0);
+	expect_read_layer(1, "", 0);
+}
+
+/* Temporary render files have one part per view, the part of the other view is skipped. */
+TEST_F(OpenEXRTest, multipart_subset)
+{
+	const char *views[TEST_VIEWS] = {"left", "right"};
+	std::vector<float> rects[TEST_VIEWS][TEST_LAYERS];
+	void *handle = IMB_exr_get_handle();
+
+	for (int view = 0; view < TEST_VIEWS; view++) {
+		IMB_exr_add_view(handle, views[view]);
+	}
+	for (int view = 0; view < TEST_VIEWS; view++) {
+		for (int layer = 0; layer < TEST_LAYERS; layer++) {
+			rects[view][layer] = test_pass(layer, view);
+			for (int channel = 0; channel < 4; channel++) {
+				IMB_exr_add_channel(handle, test_layers[layer], test_channel_name("", channel).c_str(), views[view],
+				                    0, 0, NULL, false);
+			}
+		}
+	}
+
+	IMB_exrtile_begin_write(handle, m_filepath.c_str(), 0, TEST_WIDTH, TEST_HEIGHT, TEST_TILE, TEST_TILE);
+	for (int view = 0; view < TEST_VIEWS; view++) {
+		for (int party = 0; party < TEST_HEIGHT; party += TEST_TILE) {
+			for (int partx = 0; partx < TEST_WIDTH; partx += TEST_TILE) {
+				/* the rect points to the first pixel of the tile */
+				for (int layer = 0; layer < TEST_LAYERS; layer++) {
+					float *tile = &rects[view][layer][(party * TEST_WIDTH + partx) * 4];
+					for (int channel = 0; channel < 4; channel++) {
+						IMB_exr_set_channel(handle, test_layers[layer], test_channel_name(views[view], channel).c_str(),
+						                    4, 4 * TEST_WIDTH, tile + channel);
+					}
+				}
+				IMB_exrtile_write_channels(handle, partx, party, 0, views[view], false);
+			}
+		}
+	}
+	IMB_exr_close(handle);
+
+	expect_read_layer(0, "right", 1);
+	expect_read_layer(1, "left", 0);
+}
@@ -0,0 +1,143 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "IMB_test_movie.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+extern "C" {
+#include "BLI_fileops.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+/* Proxy sizes are multiples of 8 at 25% and 50%. */
+#define TEST_WIDTH 128
+#define TEST_HEIGHT 96
+#define TEST_FRAMES 30
+
+class ProxyTest : public testing::Test {
+protected:
+	std::string m_dir;
+	std::string m_movie;
+
+	virtual void SetUp()
+	{
+		IMB_init();
+		IMB_ffmpeg_init();
+
+		m_dir = testing::internal::TempDir() + "imbuf_proxy_test";
+		BLI_dir_create_recursive(m_dir.c_str());
+		m_movie = m_dir + "/movie.avi";
+		ASSERT_TRUE(imb_test_write_movie(m_movie.c_str(), TEST_WIDTH, TEST_HEIGHT, TEST_FRAMES));
+	}
+
+	virtual void TearDown()
+	{
+		BLI_delete(m_dir.c_str(), true, true);
+		IMB_exit();
+	}
+
+	/* Build the 25% and 50% proxies into index_dir with the given number of decoder threads. */
+	void build_proxies(const std::string &index_dir, int num_threads)
+	{
+		char colorspace[IM_MAX_SPACE] = "";
+		struct anim *anim = IMB_open_anim(m_movie.c_str(), IB_rect, 0, colorspace);
+		ASSERT_TRUE(anim != NULL);
+		IMB_anim_set_index_dir(anim, index_dir.c_str());
+
+		struct IndexBuildContext *context = IMB_anim_index_rebuild_context(
+		        anim, IMB_TC_NONE, (IMB_Proxy_Size)(IMB_PROXY_25 | IMB_PROXY_50), 90, true, NULL, num_threads);
+		ASSERT_TRUE(context != NULL);
+
+		short stop = 0, do_update = 0;
+		float progress = 0.0f;
+		IMB_anim_index_rebuild(context, &stop, &do_update, &progress);
+		IMB_anim_index_rebuild_finish(context, stop);
+
+		IMB_close_anim(anim);
+	}
+
+	/* Number of frames in a proxy, every one is decoded and checked for the proxy size. */
+	int proxy_frame_count(const std::string &index_dir, int percentage)
+	{
+		char colorspace[IM_MAX_SPACE] = "";
+		std::string filepath = index_dir + "/proxy_" + std::to_string(percentage) + ".avi";
+		struct anim *proxy = IMB_open_anim(filepath.c_str(), IB_rect, 0, colorspace);
+		if (proxy == NULL) {
+			ADD_FAILURE() << "no proxy " << filepath;
+			return 0;
+		}
+
+		const int duration = IMB_anim_get_duration(proxy, IMB_TC_NONE);
+		for (int frame = 0; frame < duration; frame++) {
+			ImBuf *ibuf = IMB_anim_absolute(proxy, frame, IMB_TC_NONE, IMB_PROXY_NONE);
+			if (ibuf == NULL) {
+				ADD_FAILURE() << "frame " << frame << " of " << filepath << " not decoded";
+				continue;
+			}
+			EXPECT_EQ(TEST_WIDTH * percentage / 100, ibuf->x);
+			EXPECT_EQ(TEST_HEIGHT * percentage / 100, ibuf->y);
+			IMB_freeImBuf(ibuf);
+		}
+
+		IMB_close_anim(proxy);
+		return duration;
+	}
+};
+
+/* Proxies encoded on their own threads must contain every frame of the movie, with a serially
+ * decoding builder as well as with a threaded decoder. */
+TEST_F(ProxyTest, frame_count)
+{
+	const std::string serial_dir = m_dir + "/serial";
+	const std::string threaded_dir = m_dir + "/threaded";
+
+	build_proxies(serial_dir, 1);
+	build_proxies(threaded_dir, 0);
+
+	for (int percentage = 25; percentage <= 50; percentage += 25) {
+		const int serial_count = proxy_frame_count(serial_dir, percentage);
+		EXPECT_EQ(TEST_FRAMES, serial_count) << percentage << "% proxy";
+		EXPECT_EQ(serial_count, proxy_frame_count(threaded_dir, percentage)) << percentage << "% proxy";
+	}
+}
+
+/* Stopping part-way must not deadlock on the queue of frames waiting for the outputs, they are
+ * drained and the incomplete proxies are removed. */
+TEST_F(ProxyTest, stop)
+{
+	const std::string index_dir = m_dir + "/stopped";
+	char colorspace[IM_MAX_SPACE] = "";
+	struct anim *anim = IMB_open_anim(m_movie.c_str(), IB_rect, 0, colorspace);
+	ASSERT_TRUE(anim != NULL);
+	IMB_anim_set_index_dir(anim, index_dir.c_str());
+
+	struct IndexBuildContext *context = IMB_anim_index_rebuild_context(
+	        anim, IMB_TC_NONE, (IMB_Proxy_Size)(IMB_PROXY_25 | IMB_PROXY_50), 90, true, NULL, 0);
+	ASSERT_TRUE(context != NULL);
+
+	/* stopped from another thread like the job system does, once some frames are queued */
+	short stop = 0, do_update = 0;
+	float progress = 0.0f;
+	std::atomic<bool> done(false);
+	std::thread stopper([&]() {
+		while (!done && progress < 0.3f) {
+			std::this_thread::yield();
+		}
+		stop = 1;
+	});
+
+	IMB_anim_index_rebuild(context, &stop, &do_update, &progress);
+	done = true;
+	stopper.join();
+
+	EXPECT_EQ(1, stop);
+	IMB_anim_index_rebuild_finish(context, stop);
+	IMB_close_anim(anim);
+
+	EXPECT_FALSE(BLI_exists((index_dir + "/proxy_25.avi").c_str()));
+	EXPECT_FALSE(BLI_exists((index_dir + "/proxy_50.avi").c_str()));
+}
@@ -0,0 +1,90 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_compiler_attrs.h"
+#include "BLI_rand.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "PIL_time_utildefines.h"
+}
+
+/* Full HD frame, the common input of sequencer and proxy scaling. */
+#define SRC_WIDTH 1920
+#define SRC_HEIGHT 1080
+
+static ImBuf *scaling_test_image(bool use_float)
+{
+	ImBuf *ibuf = IMB_allocImBuf(SRC_WIDTH, SRC_HEIGHT, 32, use_float ? IB_rectfloat : IB_rect);
+	RNG *rng = BLI_rng_new(0);
+	const size_t len = (size_t)SRC_WIDTH * SRC_HEIGHT * 4;
+
+	/* Noise is the worst case for filter quality, the timings don't depend on the content. */
+	for (size_t i = 0; i < len; i++) {
+		const float value = BLI_rng_get_float(rng);
+		if (use_float) {
+			ibuf->rect_float[i] = value;
+		}
+		else {
+			((unsigned char *)ibuf->rect)[i] = (unsigned char)(value * 255.0f);
+		}
+	}
+
+	BLI_rng_free(rng);
+	return ibuf;
+}
+
+#define SCALING_TIMEIT(var, use_float, newx, newy, expr) \
+{ \
+	ImBuf *ibuf = scaling_test_image(use_float); \
+	TIMEIT_START(var); \
+	expr; \
+	TIMEIT_END(var); \
+	EXPECT_EQ(ibuf->x, newx); \
+	EXPECT_EQ(ibuf->y, newy); \
+	IMB_freeImBuf(ibuf); \
+} (void)0
+
+static void scaling_tests(const char *id, bool use_float, int newx, int newy)
+{
+	printf("\n========== STARTING %s ==========\n", id);
+
+	SCALING_TIMEIT(scalefast, use_float, newx, newy, IMB_scalefastImBuf(ibuf, newx, newy));
+	SCALING_TIMEIT(scale, use_float, newx, newy, IMB_scaleImBuf(ibuf, newx, newy));
+	SCALING_TIMEIT(scale_threaded, use_float, newx, newy, IMB_scaleImBuf_threaded(ibuf, newx, newy));
+	SCALING_TIMEIT(resample_mitchell, use_float, newx, newy,
+	               IMB_resampleImBuf(ibuf, newx, newy, IMB_RESAMPLE_MITCHELL));
+	SCALING_TIMEIT(resample_lanczos, use_float, newx, newy,
+	               IMB_resampleImBuf(ibuf, newx, newy, IMB_RESAMPLE_LANCZOS));
+
+	printf("========== ENDED %s ==========\n\n", id);
+}
+
+/* Proxy sizes */
+TEST(imbuf_scaling, ByteDown25)
+{
+	scaling_tests("Byte 25%", false, SRC_WIDTH / 4, SRC_HEIGHT / 4);
+}
+
+TEST(imbuf_scaling, ByteDown50)
+{
+	scaling_tests("Byte 50%", false, SRC_WIDTH / 2, SRC_HEIGHT / 2);
+}
+
+TEST(imbuf_scaling, FloatDown50)
+{
+	scaling_tests("Float 50%", true, SRC_WIDTH / 2, SRC_HEIGHT / 2);
+}
+
+/* Full HD footage in an UHD sequencer render */
+TEST(imbuf_scaling, ByteUp200)
+{
+	scaling_tests("Byte 200%", false, SRC_WIDTH * 2, SRC_HEIGHT * 2);
+}
+
+TEST(imbuf_scaling, FloatUp200)
+{
+	scaling_tests("Float 200%", true, SRC_WIDTH * 2, SRC_HEIGHT * 2);
+}
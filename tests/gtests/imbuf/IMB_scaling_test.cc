@@ -0,0 +1,111 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+#define SRC_WIDTH 67
+#define SRC_HEIGHT 43
+
+static const float constant_color[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+
+static ImBuf *constant_test_image(bool use_float, int channels)
+{
+	ImBuf *ibuf = IMB_allocImBuf(SRC_WIDTH, SRC_HEIGHT, 32, use_float ? IB_rectfloat : IB_rect);
+	const size_t num_pixels = (size_t)SRC_WIDTH * SRC_HEIGHT;
+
+	for (size_t i = 0; i < num_pixels; i++) {
+		for (int c = 0; c < channels; c++) {
+			if (use_float) {
+				ibuf->rect_float[i * channels + c] = constant_color[c];
+			}
+			else {
+				((unsigned char *)ibuf->rect)[i * 4 + c] = (unsigned char)(constant_color[c] * 255.0f);
+			}
+		}
+	}
+	ibuf->channels = channels;
+
+	return ibuf;
+}
+
+/* Normalized filter weights must keep a constant image constant, also at the borders
+ * where the filter window is clamped. */
+static void expect_resample_constant(bool use_float, int channels, int newx, int newy, IMB_Resample_Filter filter)
+{
+	ImBuf *ibuf = constant_test_image(use_float, channels);
+
+	EXPECT_TRUE(IMB_resampleImBuf(ibuf, newx, newy, filter));
+	EXPECT_EQ(newx, ibuf->x);
+	EXPECT_EQ(newy, ibuf->y);
+	EXPECT_EQ(channels, ibuf->channels);
+
+	const size_t num_pixels = (size_t)newx * newy;
+	if (use_float) {
+		ASSERT_TRUE(ibuf->rect_float != NULL);
+		EXPECT_TRUE(ibuf->rect == NULL);
+		for (size_t i = 0; i < num_pixels; i++) {
+			for (int c = 0; c < channels; c++) {
+				EXPECT_NEAR(constant_color[c], ibuf->rect_float[i * channels + c], 1e-5f)
+				        << "pixel " << i << " channel " << c;
+			}
+		}
+	}
+	else {
+		ASSERT_TRUE(ibuf->rect != NULL);
+		EXPECT_TRUE(ibuf->rect_float == NULL);
+		for (size_t i = 0; i < num_pixels; i++) {
+			for (int c = 0; c < 4; c++) {
+				EXPECT_EQ((unsigned char)(constant_color[c] * 255.0f), ((unsigned char *)ibuf->rect)[i * 4 + c])
+				        << "pixel " << i << " channel " << c;
+			}
+		}
+	}
+
+	IMB_freeImBuf(ibuf);
+}
+
+static void expect_resample_constant_sizes(bool use_float, int channels, IMB_Resample_Filter filter)
+{
+	/* downscale as for 25% and 50% proxies */
+	expect_resample_constant(use_float, channels, SRC_WIDTH / 4, SRC_HEIGHT / 4, filter);
+	expect_resample_constant(use_float, channels, SRC_WIDTH / 2, SRC_HEIGHT / 2, filter);
+	/* upscale, and a different factor per axis */
+	expect_resample_constant(use_float, channels, SRC_WIDTH * 2, SRC_HEIGHT * 3, filter);
+	expect_resample_constant(use_float, channels, SRC_WIDTH / 3, SRC_HEIGHT * 2, filter);
+	/* smaller than the filter window */
+	expect_resample_constant(use_float, channels, 1, 1, filter);
+}
+
+TEST(resample, constant_byte)
+{
+	expect_resample_constant_sizes(false, 4, IMB_RESAMPLE_MITCHELL);
+	expect_resample_constant_sizes(false, 4, IMB_RESAMPLE_LANCZOS);
+}
+
+TEST(resample, constant_float)
+{
+	for (int channels = 1; channels <= 4; channels++) {
+		expect_resample_constant_sizes(true, channels, IMB_RESAMPLE_MITCHELL);
+		expect_resample_constant_sizes(true, channels, IMB_RESAMPLE_LANCZOS);
+	}
+}
+
+/* Nothing to do for the same size, invalid sizes are rejected. */
+TEST(resample, unchanged)
+{
+	ImBuf *ibuf = constant_test_image(true, 4);
+	float *rect_float = ibuf->rect_float;
+
+	EXPECT_FALSE(IMB_resampleImBuf(ibuf, SRC_WIDTH, SRC_HEIGHT, IMB_RESAMPLE_MITCHELL));
+	EXPECT_FALSE(IMB_resampleImBuf(ibuf, 0, SRC_HEIGHT, IMB_RESAMPLE_MITCHELL));
+	EXPECT_EQ(SRC_WIDTH, ibuf->x);
+	EXPECT_EQ(SRC_HEIGHT, ibuf->y);
+	EXPECT_EQ(rect_float, ibuf->rect_float);
+
+	IMB_freeImBuf(ibuf);
+}
@@ -0,0 +1,53 @@
+/* Apache License, Version 2.0 */
+
+#ifndef __IMB_TEST_MOVIE_H__
+#define __IMB_TEST_MOVIE_H__
+
+/* Movies for the tests reading them with FFmpeg, written by Blender's own AVI code. */
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "AVI_avi.h"
+}
+
+/* Motion JPEG of which every frame is different: red is full, green the frame and blue and
+ * alpha the position of the pixel. */
+static inline bool imb_test_write_movie(const char *filepath, int width, int height, int frames)
+{
+	char name[FILE_MAX];
+	int quality = 90;
+	double framerate = 25.0;
+	AviMovie avi;
+
+	BLI_strncpy(name, filepath, sizeof(name));
+	if (AVI_open_compress(name, &avi, 1, AVI_FORMAT_MJPEG) != AVI_ERROR_NONE) {
+		return false;
+	}
+	AVI_set_compress_option(&avi, AVI_OPTION_TYPE_MAIN, 0, AVI_OPTION_WIDTH, &width);
+	AVI_set_compress_option(&avi, AVI_OPTION_TYPE_MAIN, 0, AVI_OPTION_HEIGHT, &height);
+	AVI_set_compress_option(&avi, AVI_OPTION_TYPE_MAIN, 0, AVI_OPTION_QUALITY, &quality);
+	AVI_set_compress_option(&avi, AVI_OPTION_TYPE_MAIN, 0, AVI_OPTION_FRAMERATE, &framerate);
+	avi.interlace = 0;
+	avi.odd_fields = 0;
+
+	for (int frame = 0; frame < frames; frame++) {
+		/* freed by the AVI code */
+		unsigned char *rect = (unsigned char *)MEM_mallocN(width * height * 4, __func__);
+		for (int i = 0; i < width * height; i++) {
+			rect[i * 4 + 0] = 255;
+			rect[i * 4 + 1] = (unsigned char)(frame * 8);
+			rect[i * 4 + 2] = (unsigned char)(i % width);
+			rect[i * 4 + 3] = (unsigned char)(i / width);
+		}
+		AVI_write_frame(&avi, frame, AVI_FORMAT_RGB32, rect, width * height * 4);
+	}
+
+	AVI_close_compress(&avi);
+	return true;
+}
+
+#endif  /* __IMB_TEST_MOVIE_H__ */
@@ -0,0 +1,118 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+# Measures how fast the sequencer composites a timeline of stacked image strips.
+#
+# Every channel holds an image sequence blended over the channels below it,
+# each frame reads and blends a new image per channel, so the sequencer cache
+# doesn't hide the cost of rendering the stack.
+#
+#   blender --background --factory-startup --python bl_sequencer_playback_benchmark.py -- \
+#       [--channels 12] [--frames 48] [--size 1920x1080]
+
+import bpy
+import os
+import sys
+import tempfile
+import time
+
+IMAGE_VARIATIONS = 4
+
+
+def parse_args():
+    import argparse
+
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    parser = argparse.ArgumentParser(description="Sequencer playback benchmark")
+    parser.add_argument("--channels", type=int, default=12)
+    parser.add_argument("--frames", type=int, default=48)
+    parser.add_argument("--size", default="1920x1080")
+    args = parser.parse_args(argv)
+    args.width, args.height = (int(value) for value in args.size.split("x"))
+    return args
+
+
+def write_images(directory, channel, width, height):
+    filenames = []
+    for index in range(IMAGE_VARIATIONS):
+        filename = "channel_%02d_%d.png" % (channel, index)
+        value = (channel * IMAGE_VARIATIONS + index) / 64.0 % 1.0
+
+        image = bpy.data.images.new(filename, width, height, alpha=True)
+        image.generated_color = (value, 1.0 - value, 0.5, 1.0)
+        image.filepath_raw = os.path.join(directory, filename)
+        image.file_format = 'PNG'
+        image.save()
+        bpy.data.images.remove(image)
+
+        filenames.append(filename)
+    return filenames
+
+
+def build_timeline(scene, directory, args):
+    scene.render.resolution_x = args.width
+    scene.render.resolution_y = args.height
+    scene.render.resolution_percentage = 100
+    scene.render.use_sequencer = True
+    scene.render.use_compositing = False
+    scene.frame_start = 1
+    scene.frame_end = args.frames
+
+    sequences = scene.sequence_editor_create().sequences
+    for channel in range(1, args.channels + 1):
+        filenames = write_images(directory, channel, args.width, args.height)
+
+        strip = sequences.new_image(
+            "channel_%02d" % channel, os.path.join(directory, filenames[0]), channel, 1)
+        for frame in range(1, args.frames):
+            strip.elements.append(filenames[frame % len(filenames)])
+        strip.frame_final_duration = args.frames
+
+        if channel > 1:
+            strip.blend_type = 'ALPHA_OVER'
+            strip.blend_alpha = 0.5
+
+
+def render_timeline(scene):
+    frames = scene.frame_end - scene.frame_start + 1
+
+    start = time.time()
+    for frame in range(scene.frame_start, scene.frame_end + 1):
+        scene.frame_set(frame)
+        bpy.ops.render.render(write_still=False)
+    elapsed = time.time() - start
+
+    return frames, elapsed
+
+
+def main():
+    args = parse_args()
+
+    scene = bpy.context.scene
+    with tempfile.TemporaryDirectory() as directory:
+        build_timeline(scene, directory, args)
+        frames, elapsed = render_timeline(scene)
+
+    print("Sequencer playback: %d channels, %dx%d, %d frames in %.3f sec, %.2f fps" %
+          (args.channels, args.width, args.height, frames, elapsed, frames / elapsed))
+
+
+if __name__ == "__main__":
+    main()